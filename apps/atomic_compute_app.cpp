@@ -59,6 +59,7 @@ bool AtomicComputeApp::Prepare(Platform &platform) {
     ForwardApplication::Prepare(platform);
 
     pipeline_ = std::make_unique<PostProcessingPipeline>(*render_context_, ShaderSource());
+    pipeline_->SetGpuScope("Atomic Counter", StatIndex::GPU_COMPUTE_TIME, true);
     auto atomic_pass = &pipeline_->AddPass<PostProcessingComputePass>(
             ShaderManager::GetSingleton().LoadShader("base/compute/atomic_counter.comp"));
     atomic_pass->SetDispatchSize({1, 1, 1});
@@ -69,7 +70,9 @@ bool AtomicComputeApp::Prepare(Platform &platform) {
 
 void AtomicComputeApp::UpdateGpuTask(CommandBuffer &command_buffer, RenderTarget &render_target) {
     ForwardApplication::UpdateGpuTask(command_buffer, render_target);
-    pipeline_->Draw(command_buffer, render_target);
+    if (simulate_gpu_tasks_) {
+        pipeline_->Draw(command_buffer, render_target);
+    }
 }
 
 }  // namespace vox
@@ -19,17 +19,20 @@ class CustomGUI : public ui::Widget {
 };
 
 void GuiCustomApp::LoadScene() {
-    gui_->LoadFont("Ruda_Big", "Fonts/Ruda-Bold.ttf", 16);
-    gui_->LoadFont("Ruda_Medium", "Fonts/Ruda-Bold.ttf", 14);
-    gui_->LoadFont("Ruda_Small", "Fonts/Ruda-Bold.ttf", 12);
-    gui_->UseFont("Ruda_Medium");
-    gui_->SetEditorLayoutAutosaveFrequency(60.0f);
-    gui_->EnableEditorLayoutSave(true);
-    gui_->EnableDocking(true);
-
-    gui_->SetCanvas(canvas_);
-    canvas_.AddPanel(panel_);
-    panel_.CreateWidget<CustomGUI>();
+    // headless benchmark runs have no gui, only the scene is rendered
+    if (gui_) {
+        gui_->LoadFont("Ruda_Big", "Fonts/Ruda-Bold.ttf", 16);
+        gui_->LoadFont("Ruda_Medium", "Fonts/Ruda-Bold.ttf", 14);
+        gui_->LoadFont("Ruda_Small", "Fonts/Ruda-Bold.ttf", 12);
+        gui_->UseFont("Ruda_Medium");
+        gui_->SetEditorLayoutAutosaveFrequency(60.0f);
+        gui_->EnableEditorLayoutSave(true);
+        gui_->EnableDocking(true);
+
+        gui_->SetCanvas(canvas_);
+        canvas_.AddPanel(panel_);
+        panel_.CreateWidget<CustomGUI>();
+    }
 
     auto scene = scene_manager_->CurrentScene();
     auto root_entity = scene->CreateRootEntity();
@@ -4,6 +4,9 @@
 //  personal capacity and am not conveying any rights to any intellectual
 //  property of any third parties.
 
+#include <functional>
+#include <map>
+
 #include "apps/assimp_app.h"
 #include "apps/atomic_compute_app.h"
 #include "apps/cascade_shadowmap_app.h"
@@ -19,6 +22,8 @@
 #include "apps/physx_app.h"
 #include "apps/physx_dynamic_app.h"
 #include "apps/physx_joint_app.h"
+#include "apps/plugins/batch_render/batch_render.h"
+#include "apps/plugins/benchmark_mode/benchmark_mode.h"
 #include "apps/plugins/plugins.h"
 #include "apps/primitive_app.h"
 #include "apps/shadowmap_app.h"
@@ -26,6 +31,49 @@
 #include "vox.base/logging.h"
 #include "vox.render/platform/platform.h"
 
+namespace {
+using AppFactory = std::function<std::unique_ptr<vox::Application>()>;
+
+#define APP_ENTRY(name, type) \
+    { name, [] { return std::make_unique<type>(); } }
+
+const std::map<std::string, AppFactory> &GetApps() {
+    static const std::map<std::string, AppFactory> apps = {
+            APP_ENTRY("assimp", vox::AssimpApp),
+            APP_ENTRY("atomic_compute", vox::AtomicComputeApp),
+            APP_ENTRY("cascade_shadowmap", vox::CascadeShadowMapApp),
+            APP_ENTRY("cluster_forward", vox::ClusterForwardApp),
+            APP_ENTRY("framebuffer_picker", vox::FramebufferPickerApp),
+            APP_ENTRY("gui", vox::GuiApp),
+            APP_ENTRY("gui_custom", vox::GuiCustomApp),
+            APP_ENTRY("ibl", vox::IBLApp),
+            APP_ENTRY("irradiance", vox::IrradianceApp),
+            APP_ENTRY("multi_light", vox::MultiLightApp),
+            APP_ENTRY("particle", vox::ParticleApp),
+            APP_ENTRY("pbr", vox::PbrApp),
+            APP_ENTRY("physx", vox::PhysXApp),
+            APP_ENTRY("physx_dynamic", vox::PhysXDynamicApp),
+            APP_ENTRY("physx_joint", vox::PhysXJointApp),
+            APP_ENTRY("primitive", vox::PrimitiveApp),
+            APP_ENTRY("shadowmap", vox::ShadowMapApp),
+            APP_ENTRY("skybox", vox::SkyboxApp),
+    };
+    return apps;
+}
+
+#undef APP_ENTRY
+
+template <typename T>
+T *GetPlugin() {
+    for (auto *plugin : plugins::GetAll()) {
+        if (auto *result = dynamic_cast<T *>(plugin)) {
+            return result;
+        }
+    }
+    return nullptr;
+}
+}  // namespace
+
 // MARK: - Entry
 #if defined(VK_USE_PLATFORM_ANDROID_KHR)
 #include "vox.render/platform/android/android_platform.h"
@@ -52,13 +100,33 @@ int main(int argc, char *argv[]) {
 #endif
 
     auto code = platform.Initialize(plugins::GetAll());
+    auto *benchmark = GetPlugin<plugins::BenchmarkMode>();
+    auto *batch = GetPlugin<plugins::BatchRender>();
     if (code == vox::ExitCode::SUCCESS) {
-        platform.SetApp(std::make_unique<vox::PhysXJointApp>());
-        code = platform.MainLoop();
+        std::string app_name = "physx_joint";
+        if (benchmark && !benchmark->RequestedApp().empty()) {
+            app_name = benchmark->RequestedApp();
+        } else if (batch && !batch->RequestedApp().empty()) {
+            app_name = batch->RequestedApp();
+        }
+
+        auto iter = GetApps().find(app_name);
+        if (iter != GetApps().end()) {
+            platform.SetApp(iter->second());
+            code = platform.MainLoop();
+        } else {
+            LOGE("Unknown app {}", app_name)
+            code = vox::ExitCode::FATAL_ERROR;
+        }
     }
     platform.Terminate(code);
 
 #ifndef VK_USE_PLATFORM_ANDROID_KHR
+    // benchmark regressions and invalid batch images fail the process so that pipelines can gate on them
+    if (code == vox::ExitCode::FATAL_ERROR || (benchmark && benchmark->HasRegression()) ||
+        (batch && batch->HasFailed())) {
+        return EXIT_FAILURE;
+    }
     return EXIT_SUCCESS;
 #endif
 }
@@ -0,0 +1,117 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "apps/plugins/batch_render/batch_render.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "vox.base/logging.h"
+#include "vox.render/forward_application.h"
+#include "vox.render/platform/platform.h"
+
+namespace plugins {
+namespace {
+/* an image with a single color is the clear color, nothing of the scene was drawn */
+bool IsValidImage(const vox::BatchImage &image, uint32_t size) {
+    const size_t kPixelSize = image.hdr ? 4 * sizeof(float) : 4;
+    if (image.width != size || image.height != size || image.pixels.size() != size_t(size) * size * kPixelSize) {
+        return false;
+    }
+    for (size_t offset = kPixelSize; offset < image.pixels.size(); offset += kPixelSize) {
+        if (std::memcmp(image.pixels.data(), image.pixels.data() + offset, kPixelSize) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+BatchRender::BatchRender()
+    : BatchRenderTags("Batch Render",
+                      "Render a batch of offscreen images of an app headless, and check them.",
+                      {vox::Hook::ON_UPDATE, vox::Hook::ON_APP_START},
+                      {&batch_group_}) {}
+
+bool BatchRender::IsActive(const vox::CommandParser &parser) { return parser.Contains(&batch_flag_); }
+
+void BatchRender::Init(const vox::CommandParser &parser) {
+    // the batch renderer records several frames in flight into its own targets, which needs a headless context
+    vox::Window::OptionalProperties properties;
+    properties.mode = vox::Window::Mode::HEADLESS;
+    platform_->SetWindowProperties(properties);
+
+    if (parser.Contains(&app_flag_)) {
+        requested_app_ = parser.As<std::string>(&app_flag_);
+    }
+    if (parser.Contains(&frame_flag_)) {
+        batch_frame_ = std::max(parser.As<uint32_t>(&frame_flag_), 1u);
+    }
+    if (parser.Contains(&images_flag_)) {
+        image_count_ = std::max(parser.As<uint32_t>(&images_flag_), 1u);
+    }
+    if (parser.Contains(&size_flag_)) {
+        image_size_ = std::max(parser.As<uint32_t>(&size_flag_), 1u);
+    }
+    if (parser.Contains(&output_flag_)) {
+        output_name_ = parser.As<std::string>(&output_flag_);
+    }
+}
+
+void BatchRender::OnUpdate(float delta_time) {
+    // Called before the app update, outside of any frame
+    if (++total_frames_ != batch_frame_) {
+        return;
+    }
+
+    auto *app = dynamic_cast<vox::ForwardApplication *>(&platform_->GetApp());
+    if (!app) {
+        LOGE("Batch rendering needs a forward application")
+        failed_ = true;
+        platform_->Close();
+        return;
+    }
+
+    valid_images_ = 0;
+    for (uint32_t i = 0; i < image_count_; i++) {
+        vox::BatchJob job;
+        job.width = image_size_;
+        job.height = image_size_;
+        if (!output_name_.empty()) {
+            job.filename = output_name_ + "-" + std::to_string(i);
+        }
+        job.on_complete = [this](const vox::BatchImage &image) {
+            if (IsValidImage(image, image_size_)) {
+                valid_images_++;
+            }
+        };
+        app->EnqueueBatchJob(std::move(job));
+    }
+
+    const auto kStart = std::chrono::steady_clock::now();
+    app->FlushBatch();
+    const float kSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - kStart).count();
+
+    LOGI("Batch rendered {} images of {}x{} in {:.3f} seconds ({:.1f} images per second)", image_count_, image_size_,
+         image_size_, kSeconds, kSeconds > 0.f ? static_cast<float>(image_count_) / kSeconds : 0.f)
+    if (valid_images_ != image_count_) {
+        LOGE("Batch render produced {} valid images out of {}", valid_images_.load(), image_count_)
+        failed_ = true;
+    }
+    platform_->Close();
+}
+
+void BatchRender::OnAppStart(const std::string &app_id) {
+    total_frames_ = 0;
+    failed_ = false;
+}
+
+const std::string &BatchRender::RequestedApp() const { return requested_app_; }
+
+bool BatchRender::HasFailed() const { return failed_; }
+}  // namespace plugins
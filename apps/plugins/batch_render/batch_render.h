@@ -0,0 +1,79 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#include "vox.render/platform/plugins/plugin_base.h"
+
+namespace plugins {
+class BatchRender;
+
+using BatchRenderTags = vox::PluginBase<BatchRender, vox::tags::Stopping>;
+
+/**
+ * @brief Batch Render
+ *
+ * Runs the app headless and, once the scene has settled for a number of frames, renders a batch of offscreen images
+ * of the main camera through ForwardApplication::FlushBatch. The throughput is logged, and the run fails when an
+ * image is missing, has the wrong size or is a single flat color.
+ *
+ * Usage: vox.apps --batch-render --batch-app pbr --batch-images 32 --batch-size 1024 --batch-output pbr-batch
+ *
+ */
+class BatchRender : public BatchRenderTags {
+public:
+    BatchRender();
+
+    ~BatchRender() override = default;
+
+    bool IsActive(const vox::CommandParser &parser) override;
+
+    void Init(const vox::CommandParser &parser) override;
+
+    void OnUpdate(float delta_time) override;
+
+    void OnAppStart(const std::string &app_info) override;
+
+    /**
+     * @brief Name of the app requested with --batch-app, empty if none
+     */
+    [[nodiscard]] const std::string &RequestedApp() const;
+
+    /**
+     * @brief Whether the last batch produced fewer valid images than requested
+     */
+    [[nodiscard]] bool HasFailed() const;
+
+    vox::FlagCommand batch_flag_ = {vox::FlagType::FLAG_ONLY, "batch-render", "", "Enable batch rendering"};
+    vox::FlagCommand app_flag_ = {vox::FlagType::ONE_VALUE, "batch-app", "", "Name of the app to render"};
+    vox::FlagCommand frame_flag_ = {vox::FlagType::ONE_VALUE, "batch-frame", "",
+                                    "Frame rendered as a batch, once the scene has settled (default 10)"};
+    vox::FlagCommand images_flag_ = {vox::FlagType::ONE_VALUE, "batch-images", "",
+                                     "Number of images in the batch (default 16)"};
+    vox::FlagCommand size_flag_ = {vox::FlagType::ONE_VALUE, "batch-size", "",
+                                   "Width and height of the images (default 512)"};
+    vox::FlagCommand output_flag_ = {vox::FlagType::ONE_VALUE, "batch-output", "",
+                                     "Name of the images in the screenshots folder, numbered, none written if unset"};
+
+    vox::CommandGroup batch_group_ = {
+            "Batch Render", {&batch_flag_, &app_flag_, &frame_flag_, &images_flag_, &size_flag_, &output_flag_}};
+
+private:
+    std::string requested_app_;
+    uint32_t batch_frame_{10};
+    uint32_t image_count_{16};
+    uint32_t image_size_{512};
+    std::string output_name_;
+
+    uint32_t total_frames_{0};
+    /* written by the encoding workers of the batch renderer */
+    std::atomic<uint32_t> valid_images_{0};
+    bool failed_{false};
+};
+}  // namespace plugins
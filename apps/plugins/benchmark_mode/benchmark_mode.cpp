@@ -6,14 +6,44 @@
 
 #include "apps/plugins/benchmark_mode/benchmark_mode.h"
 
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+#include "vox.base/tracer.h"
+#include "vox.render/graphics_application.h"
 #include "vox.render/platform/platform.h"
 
+VKBP_DISABLE_WARNINGS()
+#include <nlohmann/json.hpp>
+VKBP_ENABLE_WARNINGS()
+
 namespace plugins {
+namespace {
+/* metric name in the report, tracer scope name */
+const std::pair<const char *, const char *> kPhases[] = {
+        {"physics", "Physics"},     {"scripts", "Scripts"},     {"animators", "Animators"},
+        {"culling", "Culling"},     {"recording", "Recording"}, {"submit", "Submit"},
+};
+
+/* differences below this are measurement noise, whatever the tolerance */
+constexpr double kNoiseFloor = 0.02;
+
+bool IsCsv(const std::string &path) {
+    auto extension = path.substr(path.find_last_of('.') + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == "csv";
+}
+
+}  // namespace
+
 BenchmarkMode::BenchmarkMode()
     : BenchmarkModeTags("Benchmark Mode",
-                        "Log frame averages after running an app.",
+                        "Measure frame and phase timings after running an app, and compare them to a baseline.",
                         {vox::Hook::ON_UPDATE, vox::Hook::ON_APP_START, vox::Hook::ON_APP_CLOSE},
-                        {&benchmark_flag_}) {}
+                        {&benchmark_group_}) {}
 
 bool BenchmarkMode::IsActive(const vox::CommandParser &parser) { return parser.Contains(&benchmark_flag_); }
 
@@ -21,21 +51,204 @@ void BenchmarkMode::Init(const vox::CommandParser &parser) {
     // Whilst in benchmark mode fix the fps so that separate runs are consistently simulated
     // This will affect the graph outputs of framerate
     platform_->ForceSimulationFps(60.0f);
+
+    vox::Window::OptionalProperties properties;
+    properties.mode = vox::Window::Mode::HEADLESS;
+    platform_->SetWindowProperties(properties);
+
+    if (parser.Contains(&app_flag_)) requested_app_ = parser.As<std::string>(&app_flag_);
+    if (parser.Contains(&warmup_flag_)) warmup_frames_ = parser.As<uint32_t>(&warmup_flag_);
+    if (parser.Contains(&frames_flag_)) measured_frames_ = std::max(parser.As<uint32_t>(&frames_flag_), 1u);
+    if (parser.Contains(&output_flag_)) output_path_ = parser.As<std::string>(&output_flag_);
+    if (parser.Contains(&baseline_flag_)) baseline_path_ = parser.As<std::string>(&baseline_flag_);
+    if (parser.Contains(&tolerance_flag_)) tolerance_ = parser.As<float>(&tolerance_flag_) * 0.01;
 }
 
 void BenchmarkMode::OnUpdate(float delta_time) {
+    // Called before the app update: the collected scopes belong to the previous frame
+    vox::utility::Tracer::Flush();
+    auto statistics = vox::utility::Tracer::Statistics();
+    vox::utility::Tracer::ClearStatistics();
+
     elapsed_time_ += delta_time;
     total_frames_++;
+    if (total_frames_ <= warmup_frames_) {
+        return;
+    }
+
+    samples_["frame"].push_back(delta_time * 1000.0);
+    for (auto &[metric, scope] : kPhases) {
+        auto iter = std::find_if(statistics.begin(), statistics.end(),
+                                 [scope = scope](const auto &entry) { return entry.name == scope; });
+        samples_[metric].push_back(iter != statistics.end() ? iter->duration * 1000.0 : 0.0);
+    }
+
+    auto *app = dynamic_cast<vox::GraphicsApplication *>(&platform_->GetApp());
+    if (app && app->GetGpuFrameTime() > 0.f) {
+        samples_["gpu"].push_back(app->GetGpuFrameTime() * 1000.0);
+    }
+
+    if (samples_["frame"].size() >= measured_frames_) {
+        platform_->Close();
+    }
 }
 
 void BenchmarkMode::OnAppStart(const std::string &app_id) {
     elapsed_time_ = 0;
     total_frames_ = 0;
-    LOGI("Starting Benchmark for {}", app_id)
+    samples_.clear();
+    regression_ = false;
+
+    vox::utility::Tracer::Enable();
+    vox::utility::Tracer::Flush();
+    vox::utility::Tracer::ClearStatistics();
+    LOGI("Starting Benchmark for {} ({} warm-up frames, {} measured frames)", app_id, warmup_frames_,
+         measured_frames_)
 }
 
 void BenchmarkMode::OnAppClose(const std::string &app_id) {
+    vox::utility::Tracer::Disable();
+
     LOGI("Benchmark for {} completed in {} seconds (ran {} frames, averaged {} fps)", app_id, elapsed_time_,
          total_frames_, total_frames_ / elapsed_time_)
+
+    if (samples_.empty()) {
+        LOGW("Benchmark for {} stopped during warm-up, no report written", app_id)
+        return;
+    }
+
+    std::map<std::string, Summary> summaries;
+    for (auto &[metric, samples] : samples_) {
+        summaries[metric] = Summarize(samples);
+        const auto &summary = summaries[metric];
+        LOGI("{:>10}: mean {:.3f} ms, p50 {:.3f} ms, p95 {:.3f} ms, p99 {:.3f} ms", metric, summary.mean, summary.p50,
+             summary.p95, summary.p99)
+    }
+
+    if (WriteReport(app_id, summaries)) {
+        LOGI("Benchmark report written to {}", output_path_)
+    }
+
+    if (!baseline_path_.empty()) {
+        regression_ = Compare(summaries);
+    }
+}
+
+const std::string &BenchmarkMode::RequestedApp() const { return requested_app_; }
+
+bool BenchmarkMode::HasRegression() const { return regression_; }
+
+BenchmarkMode::Summary BenchmarkMode::Summarize(std::vector<double> &samples) {
+    Summary summary;
+    if (samples.empty()) return summary;
+
+    std::sort(samples.begin(), samples.end());
+    // nearest rank percentile
+    auto percentile = [&](double p) {
+        auto rank = static_cast<size_t>(std::ceil(p * static_cast<double>(samples.size())));
+        return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+    };
+
+    summary.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+    summary.p50 = percentile(0.50);
+    summary.p95 = percentile(0.95);
+    summary.p99 = percentile(0.99);
+    summary.min = samples.front();
+    summary.max = samples.back();
+    return summary;
+}
+
+bool BenchmarkMode::WriteReport(const std::string &app_id, const std::map<std::string, Summary> &summaries) const {
+    std::ofstream stream(output_path_, std::ios::out | std::ios::trunc);
+    if (!stream.is_open()) {
+        LOGE("Failed to open benchmark report {}", output_path_)
+        return false;
+    }
+
+    if (IsCsv(output_path_)) {
+        stream << "metric,mean,p50,p95,p99,min,max\n";
+        for (auto &[metric, summary] : summaries) {
+            stream << metric << "," << summary.mean << "," << summary.p50 << "," << summary.p95 << "," << summary.p99
+                   << "," << summary.min << "," << summary.max << "\n";
+        }
+    } else {
+        nlohmann::json report;
+        report["app"] = app_id;
+        report["warmup_frames"] = warmup_frames_;
+        report["frames"] = samples_.at("frame").size();
+        for (auto &[metric, summary] : summaries) {
+            report["metrics"][metric] = {{"mean", summary.mean}, {"p50", summary.p50}, {"p95", summary.p95},
+                                         {"p99", summary.p99},   {"min", summary.min}, {"max", summary.max}};
+        }
+        stream << report.dump(4) << "\n";
+    }
+    return stream.good();
+}
+
+bool BenchmarkMode::ReadReport(const std::string &path, std::map<std::string, Summary> &summaries) {
+    std::ifstream stream(path);
+    if (!stream.is_open()) {
+        return false;
+    }
+
+    if (IsCsv(path)) {
+        std::string line;
+        std::getline(stream, line);  // header
+        while (std::getline(stream, line)) {
+            std::replace(line.begin(), line.end(), ',', ' ');
+            std::istringstream fields(line);
+            std::string metric;
+            Summary summary;
+            if (fields >> metric >> summary.mean >> summary.p50 >> summary.p95 >> summary.p99 >> summary.min >>
+                summary.max) {
+                summaries[metric] = summary;
+            }
+        }
+    } else {
+        auto report = nlohmann::json::parse(stream, nullptr, false);
+        if (report.is_discarded() || !report.contains("metrics")) {
+            return false;
+        }
+        for (auto &[metric, value] : report["metrics"].items()) {
+            Summary summary;
+            summary.mean = value.value("mean", 0.0);
+            summary.p50 = value.value("p50", 0.0);
+            summary.p95 = value.value("p95", 0.0);
+            summary.p99 = value.value("p99", 0.0);
+            summary.min = value.value("min", 0.0);
+            summary.max = value.value("max", 0.0);
+            summaries[metric] = summary;
+        }
+    }
+    return true;
+}
+
+bool BenchmarkMode::Compare(const std::map<std::string, Summary> &summaries) const {
+    std::map<std::string, Summary> baseline;
+    if (!ReadReport(baseline_path_, baseline)) {
+        LOGE("Failed to read benchmark baseline {}", baseline_path_)
+        return false;
+    }
+
+    bool regression = false;
+    auto check = [&](const std::string &metric, const char *statistic, double base, double current) {
+        if (current > base * (1.0 + tolerance_) + kNoiseFloor) {
+            LOGE("Regression in {} {}: {:.3f} ms against {:.3f} ms baseline (+{:.1f}%)", metric, statistic, current,
+                 base, base > 0.0 ? (current / base - 1.0) * 100.0 : 100.0)
+            regression = true;
+        }
+    };
+
+    for (auto &[metric, base] : baseline) {
+        auto iter = summaries.find(metric);
+        if (iter == summaries.end()) continue;
+        check(metric, "mean", base.mean, iter->second.mean);
+        check(metric, "p95", base.p95, iter->second.p95);
+    }
+
+    if (!regression) {
+        LOGI("No regression against baseline {} (tolerance {:.1f}%)", baseline_path_, tolerance_ * 100.0)
+    }
+    return regression;
 }
 }  // namespace plugins
@@ -6,6 +6,10 @@
 
 #pragma once
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include "vox.render/platform/plugins/plugin_base.h"
 
 namespace plugins {
@@ -16,15 +20,29 @@ using BenchmarkModeTags = vox::PluginBase<BenchmarkMode, vox::tags::Passive>;
 /**
  * @brief Benchmark Mode
  *
- * When enabled frame time statistics of a samples run will be printed to the console when an application closes. The
- * simulation frame time (delta time) is also locked to 60FPS so that statistics can be compared more accurately across
- * different devices.
+ * When enabled the app runs headless with a fixed 60FPS simulation step. After a number of warm-up frames, the wall
+ * frame time, the CPU time of each engine phase (recorded by utility::Tracer scopes) and the GPU frame time are sampled
+ * for a number of measured frames, then mean, p50, p95 and p99 are written to a JSON or CSV report (chosen by the file
+ * extension). When a baseline report is given, metrics slower than the baseline by more than the tolerance are flagged
+ * as regressions.
  *
- * Usage: vulkan_samples sample afbc --benchmark
+ * Usage: vox.apps --benchmark --benchmark-app pbr --benchmark-frames 600 --benchmark-baseline baseline.json
  *
  */
 class BenchmarkMode : public BenchmarkModeTags {
 public:
+    /**
+     * @brief Statistics of one metric, in milliseconds
+     */
+    struct Summary {
+        double mean{0};
+        double p50{0};
+        double p95{0};
+        double p99{0};
+        double min{0};
+        double max{0};
+    };
+
     BenchmarkMode();
 
     ~BenchmarkMode() override = default;
@@ -39,11 +57,54 @@ public:
 
     void OnAppClose(const std::string &app_info) override;
 
+    /**
+     * @brief Name of the app requested with --benchmark-app, empty if none
+     */
+    [[nodiscard]] const std::string &RequestedApp() const;
+
+    /**
+     * @brief Whether the last comparison against the baseline found a regression
+     */
+    [[nodiscard]] bool HasRegression() const;
+
     vox::FlagCommand benchmark_flag_ = {vox::FlagType::FLAG_ONLY, "benchmark", "", "Enable benchmark mode"};
+    vox::FlagCommand app_flag_ = {vox::FlagType::ONE_VALUE, "benchmark-app", "", "Name of the app to benchmark"};
+    vox::FlagCommand warmup_flag_ = {vox::FlagType::ONE_VALUE, "benchmark-warmup", "",
+                                     "Number of frames to skip before measuring (default 60)"};
+    vox::FlagCommand frames_flag_ = {vox::FlagType::ONE_VALUE, "benchmark-frames", "",
+                                     "Number of measured frames (default 600)"};
+    vox::FlagCommand output_flag_ = {vox::FlagType::ONE_VALUE, "benchmark-output", "",
+                                     "Report file, .csv or .json (default benchmark.json)"};
+    vox::FlagCommand baseline_flag_ = {vox::FlagType::ONE_VALUE, "benchmark-baseline", "",
+                                       "Baseline report to compare against"};
+    vox::FlagCommand tolerance_flag_ = {vox::FlagType::ONE_VALUE, "benchmark-tolerance", "",
+                                        "Allowed slowdown against the baseline in percent (default 5)"};
+
+    vox::CommandGroup benchmark_group_ = {"Benchmark Mode",
+                                          {&benchmark_flag_, &app_flag_, &warmup_flag_, &frames_flag_, &output_flag_,
+                                           &baseline_flag_, &tolerance_flag_}};
 
 private:
-    uint32_t total_frames_{0};
+    static Summary Summarize(std::vector<double> &samples);
 
+    bool WriteReport(const std::string &app_id, const std::map<std::string, Summary> &summaries) const;
+
+    static bool ReadReport(const std::string &path, std::map<std::string, Summary> &summaries);
+
+    bool Compare(const std::map<std::string, Summary> &summaries) const;
+
+    std::string requested_app_;
+    uint32_t warmup_frames_{60};
+    uint32_t measured_frames_{600};
+    std::string output_path_{"benchmark.json"};
+    std::string baseline_path_;
+    double tolerance_{0.05};
+
+    uint32_t total_frames_{0};
     float elapsed_time_{0.0f};
+
+    /* per metric samples of the measured frames, in milliseconds */
+    std::map<std::string, std::vector<double>> samples_;
+    bool regression_{false};
 };
 }  // namespace plugins
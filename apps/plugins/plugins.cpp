@@ -8,6 +8,7 @@
 
 #include <memory>
 
+#include "apps/plugins/batch_render/batch_render.h"
 #include "apps/plugins/benchmark_mode/benchmark_mode.h"
 #include "apps/plugins/file_logger/file_logger.h"
 #include "apps/plugins/fps_logger/fps_logger.h"
@@ -25,6 +26,7 @@ std::vector<vox::Plugin *> GetAll() {
 
     if (once) {
         once = false;
+        ADD_PLUGIN(BatchRender);
         ADD_PLUGIN(BenchmarkMode);
         ADD_PLUGIN(FileLogger);
         ADD_PLUGIN(FpsLogger);
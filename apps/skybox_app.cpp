@@ -14,6 +14,8 @@
 
 namespace vox {
 bool SkyboxApp::Prepare(Platform &platform) {
+    // the unlit cube samples its texture from the bindless table when the device supports it
+    bindless_textures_ = true;
     ForwardApplication::Prepare(platform);
 
     auto scene = scene_manager_->CurrentScene();
@@ -41,6 +43,7 @@ void SkyboxApp::LoadScene() {
     renderer->SetMesh(PrimitiveMesh::CreateCuboid());
     auto material = std::make_shared<UnlitMaterial>(*device_);
     material->SetBaseColor(Color(0.6, 0.4, 0.7, 1.0));
+    material->SetBaseTexture(TextureManager::GetSingleton().LoadTexture("Textures/wood.png"));
     renderer->SetMaterial(material);
 
     scene->Play();
@@ -34,12 +34,12 @@ void ClothApp::InitializeCloth(Entity *entity, const physx::PxVec3 &offset) {
 
     nv::cloth::ClothMeshDesc mesh_desc = cloth_mesh.GetClothMeshDesc();
     nv::cloth::Vector<int32_t>::Type phase_type_info;
-    fabric_ = NvClothCookFabricFromMesh(controller_.Factory(), mesh_desc, physx::PxVec3(0.0f, 0.0f, 1.0f),
-                                        &phase_type_info, false);
+    fabric_ = controller_.FabricCache().CookFabricFromMesh(controller_.Factory(), mesh_desc,
+                                                           physx::PxVec3(0.0f, 0.0f, 1.0f), &phase_type_info, false);
     controller_.TrackFabric(fabric_);
 
     cloth_actor_ = entity->AddComponent<vox::cloth::ClothRenderer>();
-    cloth_actor_->SetClothMeshDesc(mesh_desc);
+    cloth_actor_->SetClothMeshDesc(mesh_desc, cloth_mesh.m_uvs);
     auto material = std::make_shared<BlinnPhongMaterial>(*device_);
     material->SetRenderFace(RenderFace::DOUBLE);
     material->SetBaseColor(Color(247 / 256.0, 86 / 256.0, 11 / 256.0));
@@ -95,8 +95,17 @@ void ClothApp::InitializeCloth(Entity *entity, const physx::PxVec3 &offset) {
     controller_.AddClothToSolver(cloth_actor_, solver_);
 }
 
+bool ClothApp::Prepare(Platform &platform) {
+    // loads its shader through the ShaderManager created by DemoApplication::Prepare
+    if (!DemoApplication::Prepare(platform)) {
+        return false;
+    }
+    cloth_normal_manager_ = std::make_unique<cloth::ClothNormalManager>(*device_, *render_context_);
+    return true;
+}
+
 Camera *ClothApp::LoadScene(Entity *root_entity) {
-    wireframe_manager_ = std::make_unique<WireframeManager>(root_entity);
+    wireframe_manager_ = std::make_unique<WireframeManager>(root_entity, *render_context_);
 
     auto camera_entity = root_entity->CreateChild();
     camera_entity->transform->SetPosition(10, 10, 10);
@@ -141,8 +150,13 @@ void ClothApp::InputEvent(const vox::InputEvent &input_event) {
 
 void ClothApp::Update(float delta_time) {
     controller_.Update(delta_time);
-    wireframe_manager_->Flush();
     DemoApplication::Update(delta_time);
 }
 
+void ClothApp::UpdateGpuTask(CommandBuffer &command_buffer, RenderTarget &render_target) {
+    cloth_normal_manager_->Draw(command_buffer, render_target);
+    wireframe_manager_->Flush();
+    DemoApplication::UpdateGpuTask(command_buffer, render_target);
+}
+
 }  // namespace vox::editor
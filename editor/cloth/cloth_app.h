@@ -7,12 +7,15 @@
 #pragma once
 
 #include "vox.cloth/cloth_controller.h"
+#include "vox.cloth/cloth_normal_manager.h"
 #include "vox.editor/demo_application.h"
 #include "vox.render/wireframe/wireframe_manager.h"
 
 namespace vox::editor {
 class ClothApp : public DemoApplication {
 public:
+    bool Prepare(Platform &platform) override;
+
     void SetupUi() override;
 
     Camera *LoadScene(Entity *root_entity) override;
@@ -21,9 +24,12 @@ public:
 
     void Update(float delta_time) override;
 
+    void UpdateGpuTask(CommandBuffer &command_buffer, RenderTarget &render_target) override;
+
 private:
     std::unique_ptr<WireframeManager> wireframe_manager_{nullptr};
     cloth::ClothController controller_;
+    std::unique_ptr<cloth::ClothNormalManager> cloth_normal_manager_{nullptr};
     Camera *scene_camera_{nullptr};
 
     void InitializeCloth(Entity *entity, const physx::PxVec3 &offset);
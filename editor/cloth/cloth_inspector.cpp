@@ -543,30 +543,7 @@ private:
             Vector3F dy = Vector3F(0.0f, d.y, 0.0f);
             Vector3F dz = Vector3F(0.0f, 0.0f, d.z);
 
-            kDebugManager->AddLine(transform, c + dy + dz - dx, c + dy + dz + dx,
-                                   WireframeManager::FrameColor::RGB_DARKGREEN);
-            kDebugManager->AddLine(transform, c + dy - dz - dx, c + dy - dz + dx,
-                                   WireframeManager::FrameColor::RGB_DARKGREEN);
-            kDebugManager->AddLine(transform, c - dy + dz - dx, c - dy + dz + dx,
-                                   WireframeManager::FrameColor::RGB_DARKGREEN);
-            kDebugManager->AddLine(transform, c - dy - dz - dx, c - dy - dz + dx,
-                                   WireframeManager::FrameColor::RGB_DARKGREEN);
-            kDebugManager->AddLine(transform, c + dy + dx - dz, c + dy + dx + dz,
-                                   WireframeManager::FrameColor::RGB_DARKGREEN);
-            kDebugManager->AddLine(transform, c + dy - dx - dz, c + dy - dx + dz,
-                                   WireframeManager::FrameColor::RGB_DARKGREEN);
-            kDebugManager->AddLine(transform, c - dy + dx - dz, c - dy + dx + dz,
-                                   WireframeManager::FrameColor::RGB_DARKGREEN);
-            kDebugManager->AddLine(transform, c - dy - dx - dz, c - dy - dx + dz,
-                                   WireframeManager::FrameColor::RGB_DARKGREEN);
-            kDebugManager->AddLine(transform, c + dz + dx - dy, c + dz + dx + dy,
-                                   WireframeManager::FrameColor::RGB_DARKGREEN);
-            kDebugManager->AddLine(transform, c + dz - dx - dy, c + dz - dx + dy,
-                                   WireframeManager::FrameColor::RGB_DARKGREEN);
-            kDebugManager->AddLine(transform, c - dz + dx - dy, c - dz + dx + dy,
-                                   WireframeManager::FrameColor::RGB_DARKGREEN);
-            kDebugManager->AddLine(transform, c - dz - dx - dy, c - dz - dx + dy,
-                                   WireframeManager::FrameColor::RGB_DARKGREEN);
+            kDebugManager->AddBox(transform, c, d, WireframeManager::FrameColor::RGB_DARKGREEN);
             kDebugManager->AddLine(transform, c + dy + dz + dx, c - dy - dz - dx,
                                    WireframeManager::FrameColor::RGB_DARKGREEN);
             kDebugManager->AddLine(transform, c + dy + dz - dx, c - dy - dz + dx,
@@ -0,0 +1,4 @@
+#extension GL_EXT_nonuniform_qualifier : require
+
+// every registered material texture, indexed by the material data
+layout(set = 3, binding = 0) uniform sampler2D bindlessTextures[];
@@ -23,14 +23,18 @@ vec4 linearToGamma(vec4 linearIn){
     return vec4(pow(linearIn.rgb, vec3(1.0 / 2.2)), linearIn.a);
 }
 
-layout(binding = 21) buffer clusterLights {
-    ClusterLightGroup value;
+layout(binding = 21) readonly buffer clusterLights {
+    ClusterLights lights[];
 } cluster_lights;
 
 layout(set = 0, binding = 22) uniform clusterUniform {
-    vec4 value;
+    ClusterUniform value;
 } cluster_uniform;
 
+layout(binding = 23) readonly buffer clusterLightIndices {
+    uint indices[];
+} cluster_light_indices;
+
 //----------------------------------------------------------------------------------------------------------------------
 layout(set = 0, binding = 5) uniform cameraData {
     mat4 view_mat;
@@ -41,7 +45,7 @@ layout(set = 0, binding = 5) uniform cameraData {
     vec3 camera_pos;
 } camera_data;
 
-layout(set = 0, binding = 6) uniform rendererData {
+layout(set = 2, binding = 6) uniform rendererData {
     mat4 local_mat;
     mat4 model_mat;
     mat4 normal_mat;
@@ -68,51 +72,12 @@ layout (location = 0) in vec2 v_uv;
     layout (location = 4) in vec3 v_pos;
 #endif
 
-#ifdef SHADOW_MAP_COUNT
+#ifdef HAS_SHADOW_MAP
     layout (location = 5) in vec3 view_pos;
 #endif
 
 //----------------------------------------------------------------------------------------------------------------------
-// directional light
-#ifdef DIRECT_LIGHT_COUNT
-    struct DirectLight {
-        vec3 color;
-        vec3 direction;
-    };
-
-    layout(set = 0, binding = 9) uniform directLight {
-        DirectLight value[DIRECT_LIGHT_COUNT];
-    } direct_light;
-#endif
-
-// point light
-#ifdef POINT_LIGHT_COUNT
-    struct PointLight {
-        vec3 color;
-        vec3 position;
-        float distance;
-    };
-
-    layout(set = 0, binding = 10) uniform pointLight {
-        PointLight value[POINT_LIGHT_COUNT];
-    } point_light;
-#endif
-
-// spot light
-#ifdef SPOT_LIGHT_COUNT
-    struct SpotLight {
-        vec3 color;
-        vec3 position;
-        vec3 direction;
-        float distance;
-        float angleCos;
-        float penumbraCos;
-    };
-
-    layout(set = 0, binding = 11) uniform spotLight {
-        SpotLight value[SPOT_LIGHT_COUNT];
-    } spot_light;
-#endif
+#include "base/light/light_common.h"
 
 // ambient light
 layout(set = 0, binding = 12) uniform envMapLight {
@@ -133,7 +98,7 @@ layout(set = 0, binding = 12) uniform envMapLight {
 #endif
 
 //----------------------------------------------------------------------------------------------------------------------
-layout(set = 0, binding = 15) uniform blinnPhongData {
+layout(set = 1, binding = 15) uniform blinnPhongData {
     vec4 diffuse_color;
     vec4 specular_color;
     vec4 emissive_color;
@@ -141,24 +106,24 @@ layout(set = 0, binding = 15) uniform blinnPhongData {
     float shininess;
 } blinn_phong_data;
 
-layout(set = 0, binding = 16) uniform alphaCutoff {
+layout(set = 1, binding = 16) uniform alphaCutoff {
     float value;
 } alpha_cutoff;
 
 #ifdef HAS_EMISSIVE_TEXTURE
-    layout(set = 0, binding = 17) uniform sampler2D emissiveTexture;
+    layout(set = 1, binding = 17) uniform sampler2D emissiveTexture;
 #endif
 
 #ifdef HAS_DIFFUSE_TEXTURE
-    layout(set = 0, binding = 18) uniform sampler2D diffuseTexture;
+    layout(set = 1, binding = 18) uniform sampler2D diffuseTexture;
 #endif
 
 #ifdef HAS_SPECULAR_TEXTURE
-    layout(set = 0, binding = 19) uniform sampler2D specularTexture;
+    layout(set = 1, binding = 19) uniform sampler2D specularTexture;
 #endif
 
 #ifdef HAS_NORMAL_TEXTURE
-    layout(set = 0, binding = 20) uniform sampler2D normalTexture;
+    layout(set = 1, binding = 20) uniform sampler2D normalTexture;
 #endif
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -259,97 +224,91 @@ void main() {
     vec3 lightDiffuse = vec3(0.0, 0.0, 0.0);
     vec3 lightSpecular = vec3(0.0, 0.0, 0.0);
 
-    #ifdef DIRECT_LIGHT_COUNT
-        DirectLight directionalLight;
-        for (int i = 0; i < DIRECT_LIGHT_COUNT; i++) {
-            directionalLight = direct_light.value[i];
+    DirectLight directionalLight;
+    for (uint i = 0; i < light_count.direct_light_count; i++) {
+        directionalLight = direct_light.value[i];
 
-            float d = max(dot(N, -directionalLight.direction), 0.0);
-            lightDiffuse += directionalLight.color * d;
+        float d = max(dot(N, -directionalLight.direction), 0.0);
+        lightDiffuse += directionalLight.color * d;
 
-            vec3 halfDir = normalize(V - directionalLight.direction);
-            float s = pow(clamp(dot(N, halfDir), 0.0, 1.0), blinn_phong_data.shininess);
-            lightSpecular += directionalLight.color * s;
-        }
-    #endif
+        vec3 halfDir = normalize(V - directionalLight.direction);
+        float s = pow(clamp(dot(N, halfDir), 0.0, 1.0), blinn_phong_data.shininess);
+        lightSpecular += directionalLight.color * s;
+    }
 
     uint clusterIndex = 0;
     uint lightOffset = 0;
     #ifdef NEED_FORWARD_PLUS
         clusterIndex = getClusterIndex(cluster_uniform.value, gl_FragCoord);
-        lightOffset  = cluster_lights.value.lights[clusterIndex].offset;
+        lightOffset  = cluster_lights.lights[clusterIndex].offset;
+    #endif
+
+    uint lightCount = light_count.point_light_count;
+    #ifdef NEED_FORWARD_PLUS
+        lightCount = cluster_lights.lights[clusterIndex].point_count;
     #endif
 
-    #ifdef POINT_LIGHT_COUNT
-        uint lightCount = POINT_LIGHT_COUNT;
+    PointLight pointLight;
+    for (uint i = 0; i < lightCount; i++) {
+        uint index = i;
         #ifdef NEED_FORWARD_PLUS
-            lightCount = cluster_lights.value.lights[clusterIndex].point_count;
+            index = cluster_light_indices.indices[lightOffset + i];
         #endif
+        pointLight = point_light.value[index];
 
-        PointLight pointLight;
-        for (int i = 0; i < lightCount; i++) {
-            uint index = i;
-            #ifdef NEED_FORWARD_PLUS
-                index = cluster_lights.value.indices[lightOffset + i];
-            #endif
-            pointLight = point_light.value[index];
+        vec3 direction = v_pos - pointLight.position;
+        float dist = length(direction);
+        direction /= dist;
+        float decay = clamp(1.0 - pow(dist / pointLight.distance, 4.0), 0.0, 1.0);
 
-            vec3 direction = v_pos - pointLight.position;
-            float dist = length(direction);
-            direction /= dist;
-            float decay = clamp(1.0 - pow(dist / pointLight.distance, 4.0), 0.0, 1.0);
+        float d =  max(dot(N, -direction), 0.0) * decay;
+        lightDiffuse += pointLight.color * d;
 
-            float d =  max(dot(N, -direction), 0.0) * decay;
-            lightDiffuse += pointLight.color * d;
+        vec3 halfDir = normalize(V - direction);
+        float s = pow(clamp(dot(N, halfDir), 0.0, 1.0), blinn_phong_data.shininess)  * decay;
+        lightSpecular += pointLight.color * s;
+    }
 
-            vec3 halfDir = normalize(V - direction);
-            float s = pow(clamp(dot(N, halfDir), 0.0, 1.0), blinn_phong_data.shininess)  * decay;
-            lightSpecular += pointLight.color * s;
-        }
+    uint pointlightCount = 0;
+    uint lightCount2 = light_count.spot_light_count;
+    #ifdef NEED_FORWARD_PLUS
+        pointlightCount = cluster_lights.lights[clusterIndex].point_count;
+        lightCount2 = cluster_lights.lights[clusterIndex].spot_count;
     #endif
 
-    #ifdef SPOT_LIGHT_COUNT
-        uint pointlightCount;
-        uint lightCount2 = SPOT_LIGHT_COUNT;
+    SpotLight spotLight;
+    for (uint i = 0; i < lightCount2; i++) {
+        uint index = i;
         #ifdef NEED_FORWARD_PLUS
-            pointlightCount = cluster_lights.value.lights[clusterIndex].point_count;
-            lightCount2 = cluster_lights.value.lights[clusterIndex].spot_count;
+            index = cluster_light_indices.indices[lightOffset + i + pointlightCount];
         #endif
-
-        SpotLight spotLight;
-        for (int i = 0; i < lightCount2; i++) {
-            uint index = i;
-            #ifdef NEED_FORWARD_PLUS
-                index = cluster_lights.value.indices[lightOffset + i + pointlightCount];
-            #endif
-            spotLight = spot_light.value[index];
-
-            vec3 direction = spotLight.position - v_pos;
-            float lightDistance = length(direction);
-            direction /= lightDistance;
-            float angleCos = dot(direction, -spotLight.direction);
-            float decay = clamp(1.0 - pow(lightDistance/spotLight.distance, 4.0), 0.0, 1.0);
-            float spotEffect = smoothstep(spotLight.penumbraCos, spotLight.angleCos, angleCos);
-            float decayTotal = decay * spotEffect;
-            float d = max(dot(N, direction), 0.0)  * decayTotal;
-            lightDiffuse += spotLight.color * d;
-
-            vec3 halfDir = normalize(V + direction);
-            float s = pow(clamp(dot(N, halfDir), 0.0, 1.0), blinn_phong_data.shininess) * decayTotal;
-            lightSpecular += spotLight.color * s;
-        }
-    #endif
+        spotLight = spot_light.value[index];
+
+        vec3 direction = spotLight.position - v_pos;
+        float lightDistance = length(direction);
+        direction /= lightDistance;
+        float angleCos = dot(direction, -spotLight.direction);
+        float decay = clamp(1.0 - pow(lightDistance/spotLight.distance, 4.0), 0.0, 1.0);
+        float spotEffect = smoothstep(spotLight.penumbraCos, spotLight.angleCos, angleCos);
+        float decayTotal = decay * spotEffect;
+        float d = max(dot(N, direction), 0.0)  * decayTotal;
+        lightDiffuse += spotLight.color * d;
+
+        vec3 halfDir = normalize(V + direction);
+        float s = pow(clamp(dot(N, halfDir), 0.0, 1.0), blinn_phong_data.shininess) * decayTotal;
+        lightSpecular += spotLight.color * s;
+    }
 
     diffuse *= vec4(lightDiffuse, 1.0);
     specular *= vec4(lightSpecular, 1.0);
 
-    #ifdef SHADOW_MAP_COUNT
+    #ifdef HAS_SHADOW_MAP
         float shadow = 0;
-        for( int i = 0; i < SHADOW_MAP_COUNT; i++) {
-            shadow += filterPCF(v_pos, view_pos, i);
-            // shadow += textureProj(v_pos, view_pos, vec2(0), i);
+        for (uint i = 0; i < shadow_count.value; i++) {
+            shadow += filterPCF(v_pos, view_pos, int(i));
+            // shadow += textureProj(v_pos, view_pos, vec2(0), int(i));
         }
-        shadow /= SHADOW_MAP_COUNT;
+        shadow = shadow_count.value > 0 ? shadow / float(shadow_count.value) : 1.0;
         diffuse *= shadow;
         specular *= shadow;
     #endif
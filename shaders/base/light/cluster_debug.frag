@@ -6,18 +6,21 @@ layout(location = 0) in vec2 v_uv;
 layout(location = 0) out vec4 o_color;
 
 layout(set = 0, binding = 10) uniform clusterUniform {
-    vec4 value;
+    ClusterUniform value;
 } cluster_uniform;
 
-layout(binding = 12) buffer clusterLights {
-    ClusterLightGroup value;
+layout(binding = 12) readonly buffer clusterLights {
+    ClusterLights lights[];
 } cluster_lights;
 
+// light count shown in red
+const float DEBUG_MAX_LIGHTS = 64.0;
+
 void main() {
     uint clusterIndex = getClusterIndex(cluster_uniform.value, gl_FragCoord);
-    uint lightCount = cluster_lights.value.lights[clusterIndex].point_count + cluster_lights.value.lights[clusterIndex].spot_count;
-    float lightFactor = float(lightCount) / float(MAX_LIGHTS_PER_CLUSTER);
+    uint lightCount = cluster_lights.lights[clusterIndex].point_count + cluster_lights.lights[clusterIndex].spot_count;
+    float lightFactor = min(float(lightCount) / DEBUG_MAX_LIGHTS, 1.0);
 
     o_color =  mix(vec4(0.0, 0.0, 1.0, 1.0), vec4(1.0, 0.0, 0.0, 1.0),
     vec4(lightFactor, lightFactor, lightFactor, lightFactor));
-}
\ No newline at end of file
+}
@@ -0,0 +1,40 @@
+// Light arrays are runtime-sized, their lengths are read from lightCount,
+// so the number of lights never changes the shader variant.
+
+struct DirectLight {
+    vec3 color;
+    vec3 direction;
+};
+
+struct PointLight {
+    vec3 color;
+    vec3 position;
+    float distance;
+};
+
+struct SpotLight {
+    vec3 color;
+    vec3 position;
+    vec3 direction;
+    float distance;
+    float angleCos;
+    float penumbraCos;
+};
+
+layout(set = 0, binding = 27) uniform lightCount {
+    uint direct_light_count;
+    uint point_light_count;
+    uint spot_light_count;
+} light_count;
+
+layout(set = 0, binding = 28) readonly buffer directLight {
+    DirectLight value[];
+} direct_light;
+
+layout(set = 0, binding = 29) readonly buffer pointLight {
+    PointLight value[];
+} point_light;
+
+layout(set = 0, binding = 30) readonly buffer spotLight {
+    SpotLight value[];
+} spot_light;
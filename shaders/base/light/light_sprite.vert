@@ -16,35 +16,25 @@ layout(set = 0, binding = 5) uniform cameraData {
     vec3 camera_pos;
 } camera_data;
 
-// spot light
-#ifdef IS_SPOT_LIGHT
-    struct SpotLight {
-        vec3 color;
-        vec3 position;
-        vec3 direction;
-        float distance;
-        float angleCos;
-        float penumbraCos;
-    };
-    layout(set = 0, binding = 11) uniform spotLight {
-        SpotLight value[SPOT_LIGHT_COUNT];
-    } spot_light;
-#else
-    struct PointLight {
-        vec3 color;
-        vec3 position;
-        float distance;
-    };
-    layout(set = 0, binding = 10) uniform pointLight {
-        PointLight value[POINT_LIGHT_COUNT];
-    } point_light;
-#endif
+#include "base/light/light_common.h"
 
 layout (location = 0) out vec2 localPos;
 layout (location = 1) out vec3 color;
 
 void main() {
     localPos = pos[gl_VertexIndex];
+    // only the lights visible to the camera are uploaded, the other instances are clipped
+    #ifdef IS_SPOT_LIGHT
+        uint visibleCount = light_count.spot_light_count;
+    #else
+        uint visibleCount = light_count.point_light_count;
+    #endif
+    if (uint(gl_InstanceIndex) >= visibleCount) {
+        color = vec3(0.0);
+        gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+        return;
+    }
+
     #ifdef IS_SPOT_LIGHT
         color = spot_light.value[gl_InstanceIndex].color;
         vec3 worldPos = vec3(localPos, 0.0) * spot_light.value[gl_InstanceIndex].distance * 0.025;
@@ -7,47 +7,29 @@
 
 // ----------------------------------------------------------------------------
 
-// Decide which structure layout to use.
-#ifndef SPARKLE_USE_SOA_LAYOUT
-#define SPARKLE_USE_SOA_LAYOUT              FALSE
-#endif
-
-/// @note
-/// GPUParticle should hold all the main buffer objects it uses and give
-/// references to subclasses.
-#if SPARKLE_USE_SOA_LAYOUT
-	#define STORAGE_BINDING_PARTICLE_POSITIONS_A             0
-	#define STORAGE_BINDING_PARTICLE_VELOCITIES_A            1
-	#define STORAGE_BINDING_PARTICLE_ATTRIBUTES_A            2
-
-	#define STORAGE_BINDING_PARTICLE_POSITIONS_B             3
-	#define STORAGE_BINDING_PARTICLE_VELOCITIES_B            4
-	#define STORAGE_BINDING_PARTICLE_ATTRIBUTES_B            5
-
-	#define STORAGE_BINDING_RANDOM_VALUES                    6
-	#define STORAGE_BINDING_INDIRECT_ARGS                    7
-	#define STORAGE_BINDING_DOT_PRODUCTS                     8
-	#define STORAGE_BINDING_INDICES_FIRST                    9
-	#define STORAGE_BINDING_INDICES_SECOND                  10
-
-	#define COUNT_STORAGE_BINDING                           11
-#else
-	#define STORAGE_BINDING_PARTICLES_FIRST                  0
-	#define STORAGE_BINDING_PARTICLES_SECOND                 1
-
-	#define STORAGE_BINDING_RANDOM_VALUES                    2
-	#define STORAGE_BINDING_INDIRECT_ARGS                    3
-	#define STORAGE_BINDING_DOT_PRODUCTS                     4
-	#define STORAGE_BINDING_INDICES_FIRST                    5
-	#define STORAGE_BINDING_INDICES_SECOND                   6
-
-	#define COUNT_STORAGE_BINDING                            7
-#endif
+// Particles of every emitter live in the same pair of buffers, each emitter owns
+// a range of its capacity, read in the first and written in the second.
+#define STORAGE_BINDING_PARTICLES_FIRST                  0
+#define STORAGE_BINDING_PARTICLES_SECOND                 1
+
+#define STORAGE_BINDING_EMITTERS                         2
+#define STORAGE_BINDING_INDIRECT_ARGS                    3
+#define STORAGE_BINDING_DOT_PRODUCTS                     4
+#define STORAGE_BINDING_INDICES_FIRST                    5
+#define STORAGE_BINDING_INDICES_SECOND                   6
+#define STORAGE_BINDING_READBACK                         7
+#define STORAGE_BINDING_BATCHES                          8
+
+#define ATOMIC_COUNTER_BINDING                          12
 
 // ----------------------------------------------------------------------------
 
-#define ATOMIC_COUNTER_BINDING_FIRST                     12
-#define ATOMIC_COUNTER_BINDING_SECOND                    13
+// Emitter flags, features are runtime switches so all emitters share a dispatch.
+#define PARTICLE_FLAG_SCATTERING                        0x1u
+#define PARTICLE_FLAG_CURL_NOISE                        0x2u
+#define PARTICLE_FLAG_VELOCITY_CONTROL                  0x4u
+// The sorted indices are in the second index buffer.
+#define PARTICLE_FLAG_SORTED_SECOND                     0x8u
 
 // ----------------------------------------------------------------------------
 
@@ -60,4 +42,59 @@ struct TParticle {
   uint id;
 };
 
+struct TEmitter {
+  // emission
+  vec3 emitter_position;
+  uint emit_count;
+  vec3 emitter_direction;
+  uint emitter_type;
+  float emitter_radius;
+  float particle_min_age;
+  float particle_max_age;
+  uint emit_offset;
+
+  // simulation
+  float time_step;
+  uint bounding_volume_type;
+  float bbox_size;
+  float scattering_factor;
+  float vector_field_factor;
+  float curl_noise_factor;
+  float curl_noise_scale;
+  float velocity_factor;
+
+  // layout
+  uint flags;
+  uint particle_base;
+  uint capacity;
+  uint sort_base;
+  uint sort_count;
+  uint seed;
+  uint _padding1;
+  uint _padding2;
+};
+
+struct TCounter {
+  // particles in the read range, may exceed the capacity after an emission
+  uint read_count;
+  uint write_count;
+  // first simulation thread of the emitter in its batch
+  uint first_thread;
+  uint alive_count;
+};
+
+// ----------------------------------------------------------------------------
+
+// Hash based random numbers, in [0, 1).
+uint pcg_hash(uint v) {
+  uint state = v * 747796405u + 2891336453u;
+  uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+  return (word >> 22u) ^ word;
+}
+
+float random_float(inout uint state) {
+  state = pcg_hash(state);
+  return float(state >> 8u) * (1.0f / 16777216.0f);
+}
+
 #endif  // SHADERS_SPARKLE_INTEROP_H_
@@ -19,29 +19,50 @@ layout(set = 0, binding = 25) uniform cameraData {
     vec3 camera_pos;
 };
 
-layout(binding = 10)
-readonly buffer writeConsumeBuffer {
-    TParticle write_particles[];
+layout(binding = STORAGE_BINDING_PARTICLES_FIRST)
+readonly buffer readConsumeBuffer {
+    TParticle particles[];
 };
 
-layout(location = 0) in vec3 POSITION;
+layout(binding = STORAGE_BINDING_EMITTERS)
+readonly buffer particleEmitters {
+    TEmitter emitters[];
+};
+
+layout(binding = STORAGE_BINDING_INDICES_FIRST)
+readonly buffer sortIndicesBuffer {
+    uint indices[];
+};
+
+layout(set = 0, binding = 11) uniform particleEmitter {
+    uint emitter_index;
+};
 
 layout (location = 0) out vec2 uv;
 layout (location = 1) out vec3 color;
 layout (location = 2) out float decay;
 
 void main() {
+    const TEmitter emitter = emitters[emitter_index];
+
+    // Sorted emitters are drawn back to front through the sorted indices.
+    uint index = gl_InstanceIndex;
+    if (index < emitter.sort_count) {
+        index = indices[emitter.sort_base + index + ((emitter.flags & PARTICLE_FLAG_SORTED_SECOND) != 0u ? emitter.sort_count : 0u)];
+    }
+    const TParticle particle = particles[emitter.particle_base + index];
+
     // Time alived in [0, 1].
-    const float dAge = 1.0f - maprange(0.0f, write_particles[gl_InstanceIndex].start_age, write_particles[gl_InstanceIndex].age);
+    const float dAge = 1.0f - maprange(0.0f, particle.start_age, particle.age);
     decay = curve_inout(dAge, 0.55f);
 
     uv = pos[gl_VertexIndex];
-    vec4 worldPosApprox = proj_mat * view_mat * vec4(POSITION.xyz, 1.0);
+    vec4 worldPosApprox = proj_mat * view_mat * vec4(particle.position.xyz, 1.0);
     vec3 worldPos = vec3(uv, 0.0) * compute_size(worldPosApprox.z/worldPosApprox.w, decay) * 0.025; // todo
 
     // Generate a billboarded model view matrix
     mat4 bbModelViewMatrix = mat4(1.0);
-    bbModelViewMatrix[3] = vec4(write_particles[gl_InstanceIndex].position.xyz, 1.0);
+    bbModelViewMatrix[3] = vec4(particle.position.xyz, 1.0);
     bbModelViewMatrix = view_mat * bbModelViewMatrix;
     bbModelViewMatrix[0][0] = 1.0;
     bbModelViewMatrix[0][1] = 0.0;
@@ -56,5 +77,5 @@ void main() {
     bbModelViewMatrix[2][2] = 1.0;
 
     gl_Position = proj_mat * bbModelViewMatrix * vec4(worldPos, 1.0);
-    color = base_color(write_particles[gl_InstanceIndex].position.xyz, decay);
+    color = base_color(particle.position.xyz, decay);
 }
\ No newline at end of file
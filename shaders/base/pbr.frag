@@ -34,7 +34,7 @@ layout(set = 0, binding = 5) uniform cameraData {
     vec3 camera_pos;
 } camera_data;
 
-layout(set = 0, binding = 6) uniform rendererData {
+layout(set = 2, binding = 6) uniform rendererData {
     mat4 local_mat;
     mat4 model_mat;
     mat4 normal_mat;
@@ -62,46 +62,20 @@ layout (location = 0) in vec2 v_uv;
 #endif
 
 //----------------------------------------------------------------------------------------------------------------------
-// directional light
-#ifdef DIRECT_LIGHT_COUNT
-    struct DirectLight {
-        vec3 color;
-        vec3 direction;
-    };
-
-    layout(set = 0, binding = 7) uniform directLight {
-        DirectLight value[DIRECT_LIGHT_COUNT];
-    } direct_light;
-#endif
+#include "base/light/light_common.h"
+#include "base/light/cluster_common.comp"
 
-// point light
-#ifdef POINT_LIGHT_COUNT
-    struct PointLight {
-        vec3 color;
-        vec3 position;
-        float distance;
-    };
-
-    layout(set = 0, binding = 8) uniform pointLight {
-        PointLight value[POINT_LIGHT_COUNT];
-    } point_light;
-#endif
+layout(binding = 32) readonly buffer clusterLights {
+    ClusterLights lights[];
+} cluster_lights;
 
-// spot light
-#ifdef SPOT_LIGHT_COUNT
-    struct SpotLight {
-        vec3 color;
-        vec3 position;
-        vec3 direction;
-        float distance;
-        float angleCos;
-        float penumbraCos;
-    };
-
-    layout(set = 0, binding = 9) uniform spotLight {
-        SpotLight value[SPOT_LIGHT_COUNT];
-    } spot_light;
-#endif
+layout(set = 0, binding = 33) uniform clusterUniform {
+    ClusterUniform value;
+} cluster_uniform;
+
+layout(binding = 34) readonly buffer clusterLightIndices {
+    uint indices[];
+} cluster_light_indices;
 
 // ambient light
 layout(set = 0, binding = 10) uniform envMapLight {
@@ -122,49 +96,49 @@ layout(set = 0, binding = 10) uniform envMapLight {
 #endif
 
 //----------------------------------------------------------------------------------------------------------------------
-layout(set = 0, binding = 13) uniform alphaCutoff {
+layout(set = 1, binding = 13) uniform alphaCutoff {
     float value;
 } alpha_cutoff;
 
-layout(set = 0, binding = 14) uniform pbrBaseData {
+layout(set = 1, binding = 14) uniform pbrBaseData {
     vec4 base_color;
     vec4 emissive_color;
     float normal_texture_intensity;
     float occlusion_texture_intensity;
 } pbr_base_data;
 
-layout(set = 0, binding = 15) uniform pbrData {
+layout(set = 1, binding = 15) uniform pbrData {
     float metal;
     float roughness;
 } pbr_data;
 
-layout(set = 0, binding = 16) uniform pbrSpecularData {
+layout(set = 1, binding = 16) uniform pbrSpecularData {
     vec3 specular_color;
     float glossiness;
 } pbr_specular_data;
 
 #ifdef HAS_BASECOLORMAP
-    layout(set = 0, binding = 17) uniform sampler2D baseColorTexture;
+    layout(set = 1, binding = 17) uniform sampler2D baseColorTexture;
 #endif
 
 #ifdef HAS_NORMAL_TEXTURE
-    layout(set = 0, binding = 18) uniform sampler2D normalTexture;
+    layout(set = 1, binding = 18) uniform sampler2D normalTexture;
 #endif
 
 #ifdef HAS_EMISSIVEMAP
-    layout(set = 0, binding = 19) uniform sampler2D emissiveTexture;
+    layout(set = 1, binding = 19) uniform sampler2D emissiveTexture;
 #endif
 
 #ifdef HAS_METALROUGHNESSMAP
-    layout(set = 0, binding = 20) uniform sampler2D metallicRoughnessTexture;
+    layout(set = 1, binding = 20) uniform sampler2D metallicRoughnessTexture;
 #endif
 
 #ifdef HAS_SPECULARGLOSSINESSMAP
-    layout(set = 0, binding = 21) uniform sampler2D specularGlossinessTexture;
+    layout(set = 1, binding = 21) uniform sampler2D specularGlossinessTexture;
 #endif
 
 #ifdef HAS_OCCLUSIONMAP
-    layout(set = 0, binding = 22) uniform sampler2D occlusionTexture;
+    layout(set = 1, binding = 22) uniform sampler2D occlusionTexture;
 #endif
 
 struct ReflectedLight {
@@ -363,73 +337,80 @@ void addDirectRadiance(vec3 incidentDirection, vec3 color, GeometricContext geom
     reflectedLight.directDiffuse += irradiance * BRDF_Diffuse_Lambert(material.diffuseColor);
 }
 
-#ifdef DIRECT_LIGHT_COUNT
-    void addDirectionalDirectLightRadiance(DirectLight directionalLight, GeometricContext geometry, PhysicalMaterial material, inout ReflectedLight reflectedLight) {
-        vec3 color = directionalLight.color;
-        vec3 direction = -directionalLight.direction;
+void addDirectionalDirectLightRadiance(DirectLight directionalLight, GeometricContext geometry, PhysicalMaterial material, inout ReflectedLight reflectedLight) {
+    vec3 color = directionalLight.color;
+    vec3 direction = -directionalLight.direction;
 
-        addDirectRadiance(direction, color, geometry, material, reflectedLight);
-    }
-#endif
+    addDirectRadiance(direction, color, geometry, material, reflectedLight);
+}
 
-#ifdef POINT_LIGHT_COUNT
-    void addPointDirectLightRadiance(PointLight pointLight, GeometricContext geometry, PhysicalMaterial material, inout ReflectedLight reflectedLight) {
-        vec3 lVector = pointLight.position - geometry.position;
-        vec3 direction = normalize(lVector);
+void addPointDirectLightRadiance(PointLight pointLight, GeometricContext geometry, PhysicalMaterial material, inout ReflectedLight reflectedLight) {
+    vec3 lVector = pointLight.position - geometry.position;
+    vec3 direction = normalize(lVector);
 
-        float lightDistance = length(lVector);
+    float lightDistance = length(lVector);
 
-        vec3 color = pointLight.color;
-        color *= clamp(1.0 - pow(lightDistance/pointLight.distance, 4.0), 0.0, 1.0);
+    vec3 color = pointLight.color;
+    color *= clamp(1.0 - pow(lightDistance/pointLight.distance, 4.0), 0.0, 1.0);
 
-        addDirectRadiance(direction, color, geometry, material, reflectedLight);
-    }
- #endif
+    addDirectRadiance(direction, color, geometry, material, reflectedLight);
+}
 
-#ifdef SPOT_LIGHT_COUNT
-    void addSpotDirectLightRadiance(SpotLight spotLight, GeometricContext geometry, PhysicalMaterial material, inout ReflectedLight reflectedLight) {
-        vec3 lVector = spotLight.position - geometry.position;
-        vec3 direction = normalize(lVector);
+void addSpotDirectLightRadiance(SpotLight spotLight, GeometricContext geometry, PhysicalMaterial material, inout ReflectedLight reflectedLight) {
+    vec3 lVector = spotLight.position - geometry.position;
+    vec3 direction = normalize(lVector);
 
-        float lightDistance = length(lVector);
-        float angleCos = dot(direction, -spotLight.direction);
+    float lightDistance = length(lVector);
+    float angleCos = dot(direction, -spotLight.direction);
 
-        float spotEffect = smoothstep(spotLight.penumbraCos, spotLight.angleCos, angleCos);
-        float decayEffect = clamp(1.0 - pow(lightDistance/spotLight.distance, 4.0), 0.0, 1.0);
+    float spotEffect = smoothstep(spotLight.penumbraCos, spotLight.angleCos, angleCos);
+    float decayEffect = clamp(1.0 - pow(lightDistance/spotLight.distance, 4.0), 0.0, 1.0);
 
-        vec3 color = spotLight.color;
-        color *= spotEffect * decayEffect;
+    vec3 color = spotLight.color;
+    color *= spotEffect * decayEffect;
 
-        addDirectRadiance(direction, color, geometry, material, reflectedLight);
-    }
-#endif
+    addDirectRadiance(direction, color, geometry, material, reflectedLight);
+}
 
 void addTotalDirectRadiance(GeometricContext geometry, PhysicalMaterial material, inout ReflectedLight reflectedLight){
-    #ifdef DIRECT_LIGHT_COUNT
-        DirectLight directionalLight;
-        for (int i = 0; i < DIRECT_LIGHT_COUNT; i ++) {
-            directionalLight = direct_light.value[i];
+    DirectLight directionalLight;
+    for (uint i = 0; i < light_count.direct_light_count; i ++) {
+        directionalLight = direct_light.value[i];
 
-            addDirectionalDirectLightRadiance(directionalLight, geometry, material, reflectedLight);
-        }
+        addDirectionalDirectLightRadiance(directionalLight, geometry, material, reflectedLight);
+    }
+
+    uint pointLightCount = light_count.point_light_count;
+    uint spotLightCount = light_count.spot_light_count;
+    #ifdef NEED_FORWARD_PLUS
+        uint clusterIndex = getClusterIndex(cluster_uniform.value, gl_FragCoord);
+        uint lightOffset = cluster_lights.lights[clusterIndex].offset;
+        pointLightCount = cluster_lights.lights[clusterIndex].point_count;
+        spotLightCount = cluster_lights.lights[clusterIndex].spot_count;
     #endif
 
-    #ifdef POINT_LIGHT_COUNT
-        PointLight pointLight;
-        for (int i = 0; i < POINT_LIGHT_COUNT; i ++) {
-            pointLight = point_light.value[i];
+    PointLight pointLight;
+    for (uint i = 0; i < pointLightCount; i ++) {
+        uint index = i;
+        #ifdef NEED_FORWARD_PLUS
+            index = cluster_light_indices.indices[lightOffset + i];
+        #endif
+        pointLight = point_light.value[index];
 
-            addPointDirectLightRadiance(pointLight, geometry, material, reflectedLight);
-        }
-    #endif
+        addPointDirectLightRadiance(pointLight, geometry, material, reflectedLight);
+    }
 
-    #ifdef SPOT_LIGHT_COUNT
-        SpotLight spotLight;
-        for (int i = 0; i < SPOT_LIGHT_COUNT; i ++) {
-            spotLight = spot_light.value[i];
+    SpotLight spotLight;
+    for (uint i = 0; i < spotLightCount; i ++) {
+        uint index = i;
+        #ifdef NEED_FORWARD_PLUS
+            index = cluster_light_indices.indices[lightOffset + pointLightCount + i];
+        #endif
+        spotLight = spot_light.value[index];
 
-            addSpotDirectLightRadiance(spotLight, geometry, material, reflectedLight);
-        }
+        addSpotDirectLightRadiance(spotLight, geometry, material, reflectedLight);
+    }
+}
     #endif
 }
 
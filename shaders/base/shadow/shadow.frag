@@ -1,4 +1,4 @@
-#ifdef SHADOW_MAP_COUNT
+#ifdef HAS_SHADOW_MAP
 layout(set = 0, binding = 25) uniform sampler2DArrayShadow shadowMap;
 
 struct ShadowData {
@@ -10,10 +10,15 @@ struct ShadowData {
     vec4 cascadeSplits;
 };
 
-layout(set = 0, binding = 26) uniform shadowData {
-    ShadowData value[10];
+layout(set = 0, binding = 26) readonly buffer shadowData {
+    ShadowData value[];
 } shadow_data;
 
+layout(set = 0, binding = 31) uniform shadowCount {
+    uint value;
+    uint cube_value;
+} shadow_count;
+
 const vec2 offsets[4] = vec2[](
     vec2(0, 0),
     vec2(0.5, 0),
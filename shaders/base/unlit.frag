@@ -1,5 +1,9 @@
 #version 450
 
+#ifdef HAS_BINDLESS_TEXTURES
+#include "base/bindless.h"
+#endif
+
 #define PI 3.14159265359
 #define RECIPROCAL_PI 0.31830988618
 #define EPSILON 1e-6
@@ -20,15 +24,21 @@ vec4 linearToGamma(vec4 linearIn){
     return vec4(pow(linearIn.rgb, vec3(1.0 / 2.2)), linearIn.a);
 }
 
-layout(set = 0, binding = 1) uniform baseColor {
+layout(set = 1, binding = 1) uniform baseColor {
     vec4 value;
 } base_color;
-layout(set = 0, binding = 2) uniform alphaCutoff {
+layout(set = 1, binding = 2) uniform alphaCutoff {
     float value;
 } alpha_cutoff;
 
 #ifdef HAS_BASE_TEXTURE
-    layout(set = 0, binding = 3) uniform sampler2D baseTexture;
+#ifdef HAS_BINDLESS_TEXTURES
+    layout(set = 1, binding = 4) uniform materialTextureIndices {
+        uvec4 value;
+    } texture_indices;
+#else
+    layout(set = 1, binding = 3) uniform sampler2D baseTexture;
+#endif
 #endif
 
 layout(location = 0) in vec2 v_uv;
@@ -38,7 +48,11 @@ void main() {
     vec4 baseColor = base_color.value;
 
     #ifdef HAS_BASE_TEXTURE
-        vec4 textureColor = texture(baseTexture, v_uv);
+        #ifdef HAS_BINDLESS_TEXTURES
+            vec4 textureColor = texture(bindlessTextures[nonuniformEXT(texture_indices.value.x)], v_uv);
+        #else
+            vec4 textureColor = texture(baseTexture, v_uv);
+        #endif
         baseColor *= textureColor;
     #endif
 
@@ -8,36 +8,6 @@ layout(location = Position) in vec3 POSITION;
     layout(location = UV_0) in vec2 TEXCOORD_0;
 #endif
 
-//----------------------------------------------------------------------------------------------------------------------
-#ifdef HAS_SKIN
-    layout(location = Joints_0) in vec4 JOINTS_0;
-    layout(location = Weights_0) in vec4 WEIGHTS_0;
-
-    #ifdef HAS_JOINT_TEXTURE
-        layout(set = 0, binding = 2) uniform sampler2D jointSampler;
-        layout(set = 0, binding = 3) uniform jointCount {
-            float value;
-        } joint_count;
-
-        mat4 getJointMatrix(sampler2D smp, float index) {
-            float base = index / joint_count.value;
-            float hf = 0.5 / joint_count.value;
-            float v = base + hf;
-
-            vec4 m0 = texture2D(smp, vec2(0.125, v));
-            vec4 m1 = texture2D(smp, vec2(0.375, v));
-            vec4 m2 = texture2D(smp, vec2(0.625, v));
-            vec4 m3 = texture2D(smp, vec2(0.875, v));
-
-            return mat4(m0, m1, m2, m3);
-        }
-    #else
-        layout(set = 0, binding = 4) uniform jointMatrix {
-            mat4 value[JOINTS_NUM];
-        } joint_matrix;
-    #endif
-#endif
-
 //----------------------------------------------------------------------------------------------------------------------
 #ifdef HAS_VERTEXCOLOR
     layout(location = Color_0) in vec4 COLOR_0;
@@ -52,13 +22,13 @@ layout(set = 0, binding = 5) uniform cameraData {
     vec3 camera_pos;
 } camera_data;
 
-layout(set = 0, binding = 6) uniform rendererData {
+layout(set = 2, binding = 6) uniform rendererData {
     mat4 local_mat;
     mat4 model_mat;
     mat4 normal_mat;
 } renderer_data;
 
-layout(set = 0, binding = 7) uniform tilingOffset {
+layout(set = 1, binding = 7) uniform tilingOffset {
     vec4 value;
 } tiling_offset;
 
@@ -95,7 +65,7 @@ layout(set = 0, binding = 7) uniform tilingOffset {
             layout(location = 23) in vec3 TANGENT_BS3;
         #endif
     #endif
-    layout(set = 0, binding = 8) uniform blendShapeWeights {
+    layout(set = 2, binding = 8) uniform blendShapeWeights {
         float value[4];
     } blend_shape_weights;
 #endif
@@ -133,32 +103,6 @@ void main() {
         #endif
     #endif
 
-    //------------------------------------------------------------------------------------------------------------------
-    #ifdef HAS_SKIN
-        #ifdef HAS_JOINT_TEXTURE
-            mat4 skinMatrix =
-            WEIGHTS_0.x * getJointMatrix(jointSampler, JOINTS_0.x) +
-            WEIGHTS_0.y * getJointMatrix(jointSampler, JOINTS_0.y) +
-            WEIGHTS_0.z * getJointMatrix(jointSampler, JOINTS_0.z) +
-            WEIGHTS_0.w * getJointMatrix(jointSampler, JOINTS_0.w);
-        #else
-            mat4 skinMatrix =
-            WEIGHTS_0.x * joint_matrix.value[int(JOINTS_0.x)] +
-            WEIGHTS_0.y * joint_matrix.value[int(JOINTS_0.y)] +
-            WEIGHTS_0.z * joint_matrix.value[int(JOINTS_0.z)] +
-            WEIGHTS_0.w * joint_matrix.value[int(JOINTS_0.w)];
-        #endif
-
-        position = skinMatrix * position;
-
-        #if defined(HAS_NORMAL) && !defined(OMIT_NORMAL)
-            normal = vec4(skinMatrix * vec4(normal, 0.0)).xyz;
-            #if defined(HAS_TANGENT) && defined(NORMAL_TEXTURE)
-                tangent.xyz = vec4(skinMatrix * vec4(tangent.xyz, 0.0)).xyz;
-            #endif
-        #endif
-    #endif
-
     //------------------------------------------------------------------------------------------------------------------
     #ifdef HAS_UV
         v_uv = TEXCOORD_0;
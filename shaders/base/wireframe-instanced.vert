@@ -0,0 +1,34 @@
+#version 450
+
+layout(location = 0) in vec3 POSITION;
+layout(location = 2) in vec4 INSTANCE_COLUMN_0;
+layout(location = 3) in vec4 INSTANCE_COLUMN_1;
+layout(location = 4) in vec4 INSTANCE_COLUMN_2;
+layout(location = 5) in vec4 INSTANCE_COLUMN_3;
+layout(location = 6) in uint INSTANCE_COLOR;
+
+layout(set = 0, binding = 5) uniform cameraData {
+    mat4 view_mat;
+    mat4 proj_mat;
+    mat4 vp_mat;
+    mat4 view_inv_mat;
+    mat4 proj_inv_mat;
+    vec3 camera_pos;
+};
+
+layout(set = 0, binding = 6) uniform rendererData {
+    mat4 local_mat;
+    mat4 model_mat;
+    mat4 normal_mat;
+};
+
+layout (location = 0) out uint v_color;
+
+void main() {
+    v_color = INSTANCE_COLOR;
+    mat4 instance_mat = mat4(INSTANCE_COLUMN_0, INSTANCE_COLUMN_1, INSTANCE_COLUMN_2, INSTANCE_COLUMN_3);
+    // frusta are unprojected, divide before the camera projection
+    vec4 position = instance_mat * vec4(POSITION, 1.0);
+    position /= position.w;
+    gl_Position = vp_mat * model_mat * position;
+}
\ No newline at end of file
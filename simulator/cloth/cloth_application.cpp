@@ -12,6 +12,10 @@ namespace vox::cloth {
 using namespace physx;
 
 ClothApplication::~ClothApplication() {
+    if (step_started_) {
+        WaitForSimulationStep();
+    }
+
     // Remove all cloths from solvers
     for (auto it : cloth_solver_map_) {
         it.second->removeCloth(it.first->cloth);
@@ -46,14 +50,58 @@ ClothApplication::ClothApplication() : ForwardApplication() {
     }
 }
 
+bool ClothApplication::Prepare(Platform &platform) {
+    // loads its shader through the ShaderManager created by ForwardApplication::Prepare
+    if (!ForwardApplication::Prepare(platform)) {
+        return false;
+    }
+    cloth_normal_manager_ = std::make_unique<ClothNormalManager>(*device_, *render_context_);
+    return true;
+}
+
 void ClothApplication::Update(float delta_time) {
-    StartSimulationStep(delta_time);
-    WaitForSimulationStep();
-    UpdateSimulationGraphics();
+    if (step_started_) {
+        WaitForSimulationStep();
+        step_started_ = false;
+        UpdateSimulationGraphics();
+    }
 
     ForwardApplication::Update(delta_time);
 }
 
+void ClothApplication::AddUpdateTasks(utility::TaskGraph &graph, const UpdatePhases &phases, float delta_time) {
+    using Affinity = utility::TaskGraph::Affinity;
+
+    // the solvers run on the job manager threads until the step is waited for
+    auto start = [this, delta_time] {
+        StartSimulationStep(delta_time);
+        step_started_ = true;
+    };
+    if (pipelined_simulation_) {
+        // waited for by the next Update, after the frame is recorded
+        graph.AddTask("Cloth Start", start, Affinity::MAIN_THREAD, {phases.shader_data});
+        return;
+    }
+
+    // the cloth step overlaps the physics step, its particles are read back before the script updates as they were
+    // before the update graph
+    const auto kStart = graph.AddTask("Cloth Start", start, Affinity::MAIN_THREAD);
+    const auto kGraphics = graph.AddTask(
+            "Cloth Graphics",
+            [this] {
+                WaitForSimulationStep();
+                step_started_ = false;
+                UpdateSimulationGraphics();
+            },
+            Affinity::MAIN_THREAD, {kStart, phases.physics_start});
+    graph.AddDependency(phases.scripts_update, kGraphics);
+}
+
+void ClothApplication::UpdateGpuTask(CommandBuffer &command_buffer, RenderTarget &render_target) {
+    cloth_normal_manager_->Draw(command_buffer, render_target);
+    ForwardApplication::UpdateGpuTask(command_buffer, render_target);
+}
+
 void ClothApplication::StartSimulationStep(float dt) {
     for (auto &solver_helper : solver_helpers_) {
         solver_helper.second.StartSimulation(dt);
@@ -69,10 +117,7 @@ void ClothApplication::WaitForSimulationStep() {
 void ClothApplication::UpdateSimulationGraphics() {
     for (auto actor : cloth_list_) {
         nv::cloth::MappedRange<physx::PxVec4> particles = actor->cloth->getCurrentParticles();
-        std::vector<PxVec3> particles3(particles.size());
-        for (uint32_t i = 0; i < particles.size(); ++i) particles3[i] = particles[i].getXYZ();
-
-        actor->cloth_renderer->Update(particles3.data(), particles.size());
+        actor->cloth_renderer->Update(particles.begin(), particles.size());
     }
 }
 
@@ -8,6 +8,8 @@
 
 #include <map>
 
+#include "vox.cloth/cloth_fabric_cache.h"
+#include "vox.cloth/cloth_normal_manager.h"
 #include "vox.cloth/cloth_renderer.h"
 #include "vox.cloth/job_manager.h"
 #include "vox.cloth/NvCloth/Cloth.h"
@@ -25,12 +27,27 @@ public:
 
     ClothApplication();
 
+    bool Prepare(Platform &platform) override;
+
+    /**
+     * The cloths may be changed before calling this, the step of the frame runs during the update graph. In
+     * pipelined mode the step started by the previous frame is finished here.
+     */
     void Update(float delta_time) override;
 
+    /**
+     * The vertices of the cloths updated during the frame are rebuilt before the other GPU tasks.
+     */
+    void UpdateGpuTask(CommandBuffer &command_buffer, RenderTarget &render_target) override;
+
     ~ClothApplication() override;
 
 protected:
     nv::cloth::Factory *factory_{nullptr};
+    // fabrics of unchanged meshes are loaded instead of cooked at startup
+    ClothFabricCache fabric_cache_;
+
+    void AddUpdateTasks(utility::TaskGraph &graph, const UpdatePhases &phases, float delta_time) override;
 
     // Helper functions to enable automatic deinitialize
     // Tracking an object will delete it when autoDeinitialize is called
@@ -66,6 +83,8 @@ private:
     std::map<ClothActor *, nv::cloth::Solver *> cloth_solver_map_;
 
     JobManager job_manager_;
+    std::unique_ptr<ClothNormalManager> cloth_normal_manager_{nullptr};
+    bool step_started_{false};
 };
 
 }  // namespace vox::cloth
@@ -29,7 +29,8 @@ void ConvexCollisionApp::InitializeCloth(Entity* entity, const physx::PxVec3& of
 
     nv::cloth::ClothMeshDesc mesh_desc = cloth_mesh.GetClothMeshDesc();
     nv::cloth::Vector<int32_t>::Type phase_type_info;
-    fabric_ = NvClothCookFabricFromMesh(factory_, mesh_desc, physx::PxVec3(0.0f, 0.0f, 1.0f), &phase_type_info, false);
+    fabric_ = fabric_cache_.CookFabricFromMesh(factory_, mesh_desc, physx::PxVec3(0.0f, 0.0f, 1.0f), &phase_type_info,
+                                               false);
     TrackFabric(fabric_);
 
     cloth_actor_.cloth_renderer = entity->AddComponent<ClothRenderer>();
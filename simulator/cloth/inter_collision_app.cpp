@@ -29,8 +29,8 @@ void InterCollisionApp::InitializeCloth(Entity* entity, int index, physx::PxMat4
 
     nv::cloth::ClothMeshDesc mesh_desc = cloth_mesh.GetClothMeshDesc();
     nv::cloth::Vector<int32_t>::Type phase_type_info;
-    fabric_[index] =
-            NvClothCookFabricFromMesh(factory_, mesh_desc, physx::PxVec3(0.0f, 0.0f, 1.0f), &phase_type_info, false);
+    fabric_[index] = fabric_cache_.CookFabricFromMesh(factory_, mesh_desc, physx::PxVec3(0.0f, 0.0f, 1.0f),
+                                                      &phase_type_info, false);
     TrackFabric(fabric_[index]);
 
     cloth_actor_[index].cloth_renderer = entity->AddComponent<ClothRenderer>();
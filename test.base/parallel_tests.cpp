@@ -0,0 +1,245 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.base/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+#include "tests.h"
+#include "vox.base/logging.h"
+
+namespace vox::tests {
+
+namespace {
+std::vector<uint32_t> RandomKeys(size_t count, uint32_t seed) {
+    std::mt19937 generator(seed);
+    std::vector<uint32_t> keys(count);
+    for (auto &key : keys) {
+        key = generator();
+    }
+    return keys;
+}
+
+template <typename Func>
+double MeasureMilliseconds(const Func &func, int repeats = 3) {
+    double best = std::numeric_limits<double>::max();
+    for (int i = 0; i < repeats; i++) {
+        const auto kStart = std::chrono::steady_clock::now();
+        func();
+        const auto kEnd = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(kEnd - kStart).count());
+    }
+    return best;
+}
+}  // namespace
+
+TEST(Parallel, ParallelForVisitsEveryIndexOnce) {
+    for (size_t grain : {size_t(0), size_t(1), size_t(7), size_t(100000)}) {
+        std::vector<std::atomic<int>> visits(10007);
+        utility::ParallelFor(
+                0, visits.size(), [&](size_t i) { visits[i]++; }, grain);
+        for (const auto &visit : visits) {
+            EXPECT_EQ(visit.load(), 1);
+        }
+    }
+
+    // empty and offset ranges
+    int calls = 0;
+    utility::ParallelFor(5, 5, [&](size_t) { calls++; });
+    EXPECT_EQ(calls, 0);
+    std::atomic<size_t> sum{0};
+    utility::ParallelForRange(10, 20, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) sum += i;
+    });
+    EXPECT_EQ(sum.load(), 145u);
+}
+
+TEST(Parallel, ParallelReduce) {
+    std::vector<double> values(100000);
+    std::iota(values.begin(), values.end(), 1.0);
+    const double kSum = utility::ParallelReduce(
+            0, values.size(), 0.0,
+            [&](size_t begin, size_t end, double init) {
+                for (size_t i = begin; i < end; i++) init += values[i];
+                return init;
+            },
+            std::plus<>());
+    EXPECT_DOUBLE_EQ(kSum, 100000.0 * 100001.0 / 2.0);
+
+    // combined in range order
+    const std::string kConcat = utility::ParallelReduce(
+            0, 26, std::string(),
+            [](size_t begin, size_t end, std::string init) {
+                for (size_t i = begin; i < end; i++) init += static_cast<char>('a' + i);
+                return init;
+            },
+            [](std::string a, const std::string &b) { return a + b; }, 3);
+    EXPECT_EQ(kConcat, "abcdefghijklmnopqrstuvwxyz");
+}
+
+TEST(Parallel, ParallelScan) {
+    const auto kKeys = RandomKeys(100003, 1);
+    std::vector<uint64_t> values(kKeys.begin(), kKeys.end());
+    for (auto &value : values) value %= 1000;
+
+    std::vector<uint64_t> expected(values.size());
+    std::partial_sum(values.begin(), values.end(), expected.begin());
+    std::vector<uint64_t> inclusive(values.size());
+    utility::ParallelInclusiveScan(values.begin(), values.end(), inclusive.begin());
+    EXPECT_EQ(inclusive, expected);
+
+    std::vector<uint64_t> exclusive = values;
+    const uint64_t kTotal = utility::ParallelExclusiveScan(exclusive.begin(), exclusive.end(), exclusive.begin(),
+                                                           uint64_t(5));
+    EXPECT_EQ(kTotal, expected.back() + 5);
+    EXPECT_EQ(exclusive[0], 5u);
+    for (size_t i = 1; i < values.size(); i++) {
+        EXPECT_EQ(exclusive[i], expected[i - 1] + 5);
+    }
+}
+
+TEST(Parallel, ParallelSortIsStable) {
+    const auto kKeys = RandomKeys(200001, 2);
+    std::vector<std::pair<uint32_t, size_t>> values(kKeys.size());
+    for (size_t i = 0; i < kKeys.size(); i++) {
+        values[i] = {kKeys[i] % 1000, i};
+    }
+    auto expected = values;
+    auto by_key = [](const auto &a, const auto &b) { return a.first < b.first; };
+    std::stable_sort(expected.begin(), expected.end(), by_key);
+
+    auto merge_sorted = values;
+    utility::ParallelSort(merge_sorted.begin(), merge_sorted.end(), by_key);
+    EXPECT_EQ(merge_sorted, expected);
+
+    auto radix_sorted = values;
+    utility::ParallelRadixSort(radix_sorted.begin(), radix_sorted.end(),
+                               [](const auto &value) { return value.first; });
+    EXPECT_EQ(radix_sorted, expected);
+
+    auto keys = kKeys;
+    auto sorted_keys = kKeys;
+    std::sort(sorted_keys.begin(), sorted_keys.end());
+    utility::ParallelRadixSort(keys.begin(), keys.end());
+    EXPECT_EQ(keys, sorted_keys);
+}
+
+TEST(Parallel, ParallelInvokeAndNesting) {
+    std::atomic<int> a{0}, b{0};
+    utility::ParallelInvoke(
+            [&] {
+                // nested calls run on the calling thread instead of waiting for the pool
+                utility::ParallelFor(0, 1000, [&](size_t) { a++; });
+            },
+            [&] { utility::ParallelFor(0, 1000, [&](size_t) { b++; }); });
+    EXPECT_EQ(a.load(), 1000);
+    EXPECT_EQ(b.load(), 1000);
+}
+
+TEST(Parallel, ExceptionIsRethrown) {
+    EXPECT_THROW(utility::ParallelFor(
+                         0, 1000,
+                         [](size_t i) {
+                             if (i == 500) throw std::runtime_error("task failed");
+                         },
+                         1),
+                 std::runtime_error);
+
+    // the pool is usable afterwards
+    std::atomic<int> count{0};
+    utility::ParallelFor(0, 100, [&](size_t) { count++; });
+    EXPECT_EQ(count.load(), 100);
+}
+
+// opt-in as it takes several seconds, set VOX_PARALLEL_SCALING=1 to run it
+TEST(Parallel, Scaling) {
+    if (std::getenv("VOX_PARALLEL_SCALING") == nullptr) {
+        GTEST_SKIP() << "set VOX_PARALLEL_SCALING=1 to measure the scaling of the parallel algorithms";
+    }
+
+    auto &pool = utility::ThreadPool::GetInstance();
+    const size_t kMaxThreads = pool.NumThreads();
+    const auto kKeys = RandomKeys(1 << 22, 3);
+    auto sorted_keys = kKeys;
+    std::sort(sorted_keys.begin(), sorted_keys.end());
+    std::vector<uint64_t> expected_prefix(kKeys.begin(), kKeys.end());
+    std::partial_sum(expected_prefix.begin(), expected_prefix.end(), expected_prefix.begin());
+    std::vector<float> values(kKeys.size());
+
+    LOGI("threads       for    reduce      scan      sort     radix  (ms, {} elements)", kKeys.size())
+    std::vector<size_t> thread_counts;
+    for (size_t threads = 1; threads < kMaxThreads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(kMaxThreads);
+    double serial_for = 0;
+    for (auto threads : thread_counts) {
+        pool.SetMaxConcurrency(threads);
+        EXPECT_EQ(pool.MaxConcurrency(), threads);
+
+        const double kFor = MeasureMilliseconds([&] {
+            utility::ParallelFor(0, values.size(), [&](size_t i) {
+                values[i] = std::sqrt(static_cast<float>(kKeys[i])) * std::sin(static_cast<float>(i));
+            });
+        });
+        double sum = 0;
+        const double kReduce = MeasureMilliseconds([&] {
+            sum = utility::ParallelReduce(
+                    0, values.size(), 0.0,
+                    [&](size_t begin, size_t end, double init) {
+                        for (size_t i = begin; i < end; i++) init += values[i];
+                        return init;
+                    },
+                    std::plus<>());
+        });
+        std::vector<uint64_t> prefix(kKeys.size());
+        const double kScan = MeasureMilliseconds([&] {
+            utility::ParallelInclusiveScan(kKeys.begin(), kKeys.end(), prefix.begin(), std::plus<uint64_t>());
+        });
+        std::vector<uint32_t> merge_sorted;
+        const double kSort = MeasureMilliseconds([&] {
+            merge_sorted = kKeys;
+            utility::ParallelSort(merge_sorted.begin(), merge_sorted.end());
+        });
+        std::vector<uint32_t> radix_sorted;
+        const double kRadix = MeasureMilliseconds([&] {
+            radix_sorted = kKeys;
+            utility::ParallelRadixSort(radix_sorted.begin(), radix_sorted.end());
+        });
+
+        // the partition of the work depends on the thread count, the results must not
+        double expected_sum = 0;
+        double magnitude = 0;
+        for (auto value : values) {
+            expected_sum += value;
+            magnitude += std::fabs(value);
+        }
+        EXPECT_NEAR(sum, expected_sum, 1e-9 * magnitude);
+        EXPECT_EQ(prefix, expected_prefix);
+        EXPECT_EQ(merge_sorted, sorted_keys);
+        EXPECT_EQ(radix_sorted, sorted_keys);
+
+        LOGI("{:7}{:10.2f}{:10.2f}{:10.2f}{:10.2f}{:10.2f}", threads, kFor, kReduce, kScan, kSort, kRadix)
+        if (threads == 1) {
+            serial_for = kFor;
+        } else if (threads == kMaxThreads && kMaxThreads >= 4) {
+            // independent iterations with no shared state, more threads must pay off
+            EXPECT_LT(kFor, serial_for) << "ParallelFor does not scale to " << threads << " threads";
+        }
+    }
+    pool.SetMaxConcurrency(0);
+}
+
+}  // namespace vox::tests
@@ -0,0 +1,90 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.render/rendering/render_graph_placement.h"
+
+#include "tests.h"
+
+namespace vox::tests {
+
+namespace {
+TransientAllocation Allocation(uint64_t size, uint32_t first_pass, uint32_t last_pass, uint32_t memory_types = ~0u) {
+    TransientAllocation allocation;
+    allocation.size = size;
+    allocation.alignment = 256;
+    allocation.memory_type_bits = memory_types;
+    allocation.first_pass = first_pass;
+    allocation.last_pass = last_pass;
+    return allocation;
+}
+
+}  // namespace
+
+TEST(RenderGraphPlacement, LifetimeOverlap) {
+    EXPECT_TRUE(LifetimesOverlap(Allocation(1, 0, 2), Allocation(1, 1, 3)));
+    EXPECT_TRUE(LifetimesOverlap(Allocation(1, 1, 3), Allocation(1, 0, 2)));
+    EXPECT_TRUE(LifetimesOverlap(Allocation(1, 0, 4), Allocation(1, 2, 2)));
+    // the pass ending one lifetime and starting the other uses both images
+    EXPECT_TRUE(LifetimesOverlap(Allocation(1, 0, 1), Allocation(1, 1, 2)));
+    EXPECT_FALSE(LifetimesOverlap(Allocation(1, 0, 1), Allocation(1, 2, 3)));
+    EXPECT_FALSE(LifetimesOverlap(Allocation(1, 3, 3), Allocation(1, 0, 2)));
+}
+
+TEST(RenderGraphPlacement, DisjointLifetimesShareMemory) {
+    // a chain of passes, each one reading the image of the previous one
+    const std::vector<TransientAllocation> kAllocations = {Allocation(1024, 0, 1), Allocation(4096, 1, 2),
+                                                           Allocation(2048, 2, 3), Allocation(512, 3, 4)};
+    std::vector<TransientBlock> blocks;
+    const auto kPlacement = PlaceTransientAllocations(kAllocations, blocks);
+
+    ASSERT_EQ(kPlacement.size(), kAllocations.size());
+    ASSERT_EQ(blocks.size(), 2u);
+    for (size_t i = 0; i < kAllocations.size(); i++) {
+        for (size_t j = i + 1; j < kAllocations.size(); j++) {
+            if (kPlacement[i] == kPlacement[j]) {
+                EXPECT_FALSE(LifetimesOverlap(kAllocations[i], kAllocations[j]));
+            }
+        }
+        EXPECT_GE(blocks[kPlacement[i]].size, kAllocations[i].size);
+        EXPECT_EQ(blocks[kPlacement[i]].alignment, 256u);
+    }
+    // the largest images open the blocks, the smaller ones fit in them
+    EXPECT_EQ(blocks[0].size + blocks[1].size, 4096u + 2048u);
+}
+
+TEST(RenderGraphPlacement, OverlappingLifetimesDoNotShareMemory) {
+    const std::vector<TransientAllocation> kAllocations = {Allocation(1024, 0, 3), Allocation(1024, 1, 2),
+                                                           Allocation(1024, 3, 4)};
+    std::vector<TransientBlock> blocks;
+    const auto kPlacement = PlaceTransientAllocations(kAllocations, blocks);
+
+    EXPECT_EQ(blocks.size(), 2u);
+    EXPECT_NE(kPlacement[0], kPlacement[1]);
+    EXPECT_NE(kPlacement[0], kPlacement[2]);
+    EXPECT_EQ(kPlacement[1], kPlacement[2]);
+}
+
+TEST(RenderGraphPlacement, IncompatibleMemoryTypesDoNotShareMemory) {
+    const std::vector<TransientAllocation> kAllocations = {
+            Allocation(1024, 0, 0, 0b0011), Allocation(512, 1, 1, 0b0100), Allocation(256, 2, 2, 0b1100)};
+    std::vector<TransientBlock> blocks;
+    const auto kPlacement = PlaceTransientAllocations(kAllocations, blocks);
+
+    EXPECT_EQ(blocks.size(), 2u);
+    EXPECT_NE(kPlacement[0], kPlacement[1]);
+    // the third image only accepts the memory types of the second block, which keeps the types both accept
+    EXPECT_EQ(kPlacement[1], kPlacement[2]);
+    EXPECT_EQ(blocks[kPlacement[1]].memory_type_bits, 0b0100u);
+    EXPECT_EQ(blocks[kPlacement[0]].memory_type_bits, 0b0011u);
+}
+
+TEST(RenderGraphPlacement, EmptyGraph) {
+    std::vector<TransientBlock> blocks(1);
+    EXPECT_TRUE(PlaceTransientAllocations({}, blocks).empty());
+    EXPECT_TRUE(blocks.empty());
+}
+
+}  // namespace vox::tests
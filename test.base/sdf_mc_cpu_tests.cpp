@@ -0,0 +1,92 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.compute/sdf_mc_cpu.h"
+
+#include <array>
+#include <cmath>
+#include <map>
+#include <utility>
+
+#include "tests.h"
+
+namespace vox::tests {
+
+namespace {
+// the radius keeps the surface off the grid points, where the vertices of several edges would meet
+constexpr float kRadius = 0.8137f;
+constexpr float kCellSize = 0.1f;
+constexpr uint32_t kNumCells = 24;
+
+compute::SdfFieldData SphereField(float band) {
+    compute::SdfFieldData field;
+    field.origin = Point3F(-1.2f, -1.2f, -1.2f);
+    field.cell_size = kCellSize;
+    field.num_cells_x = field.num_cells_y = field.num_cells_z = kNumCells;
+    field.distances.resize(kNumCells * kNumCells * kNumCells);
+    for (uint32_t z = 0; z < kNumCells; z++) {
+        for (uint32_t y = 0; y < kNumCells; y++) {
+            for (uint32_t x = 0; x < kNumCells; x++) {
+                const Vector3F kPosition(field.origin.x + (float)x * kCellSize, field.origin.y + (float)y * kCellSize,
+                                         field.origin.z + (float)z * kCellSize);
+                const float kDistance = kPosition.length() - kRadius;
+                field.distances[(z * kNumCells + y) * kNumCells + x] =
+                        std::fabs(kDistance) <= band ? kDistance : compute::SdfFieldData::initial_distance_;
+            }
+        }
+    }
+    return field;
+}
+
+void ExpectClosedAndWelded(const compute::MarchingCubesMesh &mesh) {
+    ASSERT_FALSE(mesh.indices.empty());
+    ASSERT_EQ(mesh.indices.size() % 3, 0u);
+    ASSERT_EQ(mesh.positions.size(), mesh.normals.size());
+
+    // closed: every edge is shared by exactly two triangles, which walk it in opposite directions
+    std::map<std::pair<uint32_t, uint32_t>, int> directed_edges;
+    for (size_t t = 0; t < mesh.indices.size(); t += 3) {
+        for (size_t e = 0; e < 3; e++) {
+            const uint32_t kA = mesh.indices[t + e];
+            const uint32_t kB = mesh.indices[t + (e + 1) % 3];
+            ASSERT_LT(kA, mesh.positions.size());
+            ASSERT_NE(kA, kB);
+            directed_edges[{kA, kB}]++;
+        }
+    }
+    for (const auto &[edge, count] : directed_edges) {
+        EXPECT_EQ(count, 1);
+        const auto kOpposite = directed_edges.find({edge.second, edge.first});
+        EXPECT_TRUE(kOpposite != directed_edges.end() && kOpposite->second == 1);
+    }
+
+    // welded: no two vertices share a position, and every vertex is on the sphere
+    std::map<std::array<int64_t, 3>, size_t> positions;
+    for (size_t v = 0; v < mesh.positions.size(); v++) {
+        const auto &kP = mesh.positions[v];
+        const std::array<int64_t, 3> kKey = {std::llround(kP.x * 1e5), std::llround(kP.y * 1e5),
+                                             std::llround(kP.z * 1e5)};
+        EXPECT_TRUE(positions.emplace(kKey, v).second);
+        EXPECT_NEAR(Vector3F(kP.x, kP.y, kP.z).length(), kRadius, 0.1f * kCellSize);
+    }
+}
+
+}  // namespace
+
+TEST(SdfMarchingCubes, SphereIsClosedAndWelded) {
+    compute::MarchingCubesMesh mesh;
+    compute::ExtractMarchingCubes(SphereField(compute::SdfFieldData::initial_distance_), 0.0f, mesh);
+    ExpectClosedAndWelded(mesh);
+}
+
+TEST(SdfMarchingCubes, NarrowBandSphereIsClosedAndWelded) {
+    // two cells of band on each side cover the corners of every crossed cell
+    compute::MarchingCubesMesh mesh;
+    compute::ExtractMarchingCubes(SphereField(2.0f * kCellSize), 0.0f, mesh);
+    ExpectClosedAndWelded(mesh);
+}
+
+}  // namespace vox::tests
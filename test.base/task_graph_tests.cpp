@@ -0,0 +1,108 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.base/task_graph.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include "tests.h"
+#include "vox.base/thread_pool.h"
+
+namespace vox::tests {
+
+using utility::TaskGraph;
+
+TEST(TaskGraph, DependenciesRunFirst) {
+    TaskGraph graph;
+    std::atomic<int> step{0};
+    int a_step = -1, b_step = -1, c_step = -1, d_step = -1;
+    const auto kA = graph.AddTask("a", [&] { a_step = step++; });
+    const auto kB = graph.AddTask("b", [&] { b_step = step++; }, TaskGraph::Affinity::ANY, {kA});
+    const auto kC = graph.AddTask("c", [&] { c_step = step++; }, TaskGraph::Affinity::MAIN_THREAD, {kA});
+    const auto kD = graph.AddTask("d", [&] { d_step = step++; }, TaskGraph::Affinity::ANY,
+                                  {kB, TaskGraph::invalid_task_});
+    graph.AddDependency(kD, kC);
+    graph.Execute();
+
+    EXPECT_EQ(step.load(), 4);
+    EXPECT_EQ(a_step, 0);
+    EXPECT_LT(a_step, b_step);
+    EXPECT_LT(a_step, c_step);
+    EXPECT_EQ(d_step, 3);
+    EXPECT_EQ(graph.GetName(kD), "d");
+
+    // the graph runs again until cleared
+    graph.Execute();
+    EXPECT_EQ(step.load(), 8);
+    graph.Clear();
+    EXPECT_EQ(graph.TaskCount(), 0u);
+}
+
+TEST(TaskGraph, MainThreadAffinity) {
+    TaskGraph graph;
+    const auto kCaller = std::this_thread::get_id();
+    std::atomic<int> wrong_thread{0};
+    std::atomic<int> count{0};
+    auto previous = TaskGraph::invalid_task_;
+    for (int i = 0; i < 64; i++) {
+        graph.AddTask("any", [&] { count++; });
+        previous = graph.AddTask(
+                "main",
+                [&] {
+                    if (std::this_thread::get_id() != kCaller) wrong_thread++;
+                    count++;
+                },
+                TaskGraph::Affinity::MAIN_THREAD, {previous});
+    }
+    graph.Execute();
+    EXPECT_EQ(count.load(), 128);
+    EXPECT_EQ(wrong_thread.load(), 0);
+}
+
+TEST(TaskGraph, OverlapsIndependentTasks) {
+    if (utility::ThreadPool::GetInstance().MaxConcurrency() < 2) {
+        GTEST_SKIP();
+    }
+    // the worker task can only finish while the main thread task runs
+    TaskGraph graph;
+    std::atomic<bool> main_running{false};
+    std::atomic<bool> overlapped{false};
+    graph.AddTask(
+            "main",
+            [&] {
+                main_running = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                main_running = false;
+            },
+            TaskGraph::Affinity::MAIN_THREAD);
+    graph.AddTask("worker", [&] {
+        const auto kEnd = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+        while (!main_running && std::chrono::steady_clock::now() < kEnd) std::this_thread::yield();
+        overlapped = main_running.load();
+    });
+    graph.Execute();
+    EXPECT_TRUE(overlapped.load());
+}
+
+TEST(TaskGraph, ExceptionSkipsDependents) {
+    TaskGraph graph;
+    bool ran = false;
+    const auto kFail = graph.AddTask("fail", [] { throw std::runtime_error("task failed"); });
+    graph.AddTask("after", [&] { ran = true; }, TaskGraph::Affinity::ANY, {kFail});
+    EXPECT_THROW(graph.Execute(), std::runtime_error);
+    EXPECT_FALSE(ran);
+
+    TaskGraph cycle;
+    const auto kA = cycle.AddTask("a", [] {});
+    const auto kB = cycle.AddTask("b", [] {}, TaskGraph::Affinity::ANY, {kA});
+    cycle.AddDependency(kA, kB);
+    EXPECT_THROW(cycle.Execute(), std::logic_error);
+}
+
+}  // namespace vox::tests
@@ -0,0 +1,81 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.base/tracer.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "tests.h"
+
+namespace vox::tests {
+
+using utility::Tracer;
+
+namespace {
+size_t CountOccurrences(const std::string &text, const std::string &pattern) {
+    size_t count = 0;
+    for (size_t position = text.find(pattern); position != std::string::npos;
+         position = text.find(pattern, position + pattern.size())) {
+        count++;
+    }
+    return count;
+}
+
+}  // namespace
+
+TEST(Tracer, ExitedThreadsRecycleTheirBuffers) {
+    Tracer::Enable();
+    Tracer::Flush();
+    Tracer::ClearStatistics();
+    for (int i = 0; i < 8; i++) {
+        std::thread([] { VOX_TRACE_SCOPE("Recycled"); }).join();
+    }
+    Tracer::Flush();
+
+    // every thread took the buffer the previous one returned
+    EXPECT_EQ(Tracer::WorkingThreads(), 1u);
+    const auto kStatistics = Tracer::Statistics();
+    ASSERT_EQ(kStatistics.size(), 1u);
+    EXPECT_EQ(kStatistics[0].calls, 8u);
+    Tracer::Disable();
+}
+
+TEST(Tracer, CaptureLimitKeepsScopesBalanced) {
+    Tracer::Enable();
+    Tracer::BeginCapture();
+    // six events per iteration, the capture limit of 4M events falls inside a scope
+    for (int i = 0; i < (1 << 22) / 6 + 16; i++) {
+        VOX_TRACE_SCOPE("Outer");
+        {
+            VOX_TRACE_SCOPE("Middle");
+            {
+                VOX_TRACE_SCOPE("Inner");
+            }
+        }
+        if (i % 1024 == 0) {
+            Tracer::Flush();
+        }
+    }
+    const std::string kPath = "tracer_capture_test.json";
+    ASSERT_TRUE(Tracer::EndCapture(kPath));
+    Tracer::Disable();
+
+    std::ifstream stream(kPath);
+    std::stringstream content;
+    content << stream.rdbuf();
+    stream.close();
+    std::remove(kPath.c_str());
+
+    const auto kBegins = CountOccurrences(content.str(), R"("ph":"B")");
+    EXPECT_GT(kBegins, 0u);
+    EXPECT_EQ(kBegins, CountOccurrences(content.str(), R"("ph":"E")"));
+}
+
+}  // namespace vox::tests
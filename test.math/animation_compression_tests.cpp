@@ -0,0 +1,110 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include <cmath>
+
+#include "unit_tests_utils.h"
+#include "vox.render/animation_compression.h"
+
+using namespace vox;
+
+namespace {
+// decoding rounds a little differently than the reduction measured it
+constexpr float kRoundingSlack = 1e-5f;
+
+float TranslationError(const Vector4F &a, const Vector4F &b) {
+    const float dx = a.x - b.x;
+    const float dy = a.y - b.y;
+    const float dz = a.z - b.z;
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+float RotationError(const Vector4F &a, const Vector4F &b) {
+    const float cos_half_angle = std::fabs(a.dot(b)) / (a.length() * b.length());
+    return 2.0f * std::acos(std::min(cos_half_angle, 1.0f));
+}
+
+float MaxError(const CompressedAnimationTrack &track,
+               const std::vector<float> &times,
+               const std::vector<Vector4F> &values,
+               bool is_rotation) {
+    float max_error = 0.0f;
+    uint32_t cursor = 0;
+    for (size_t i = 0; i < times.size(); i++) {
+        cursor = track.FindKey(times[i], cursor);
+        const Vector4F sample = track.Sample(times[i], cursor);
+        max_error = std::max(max_error, is_rotation ? RotationError(values[i], sample)
+                                                    : TranslationError(values[i], sample));
+    }
+    return max_error;
+}
+
+}  // namespace
+
+TEST(AnimationCompression, TranslationErrorBound) {
+    // the tolerance has to stay above the time quantization error of the track range
+    for (auto [duration, tolerances] : {std::make_pair(10.0f, std::vector<float>{1e-2f, 1e-3f}),
+                                        std::make_pair(1.0f, std::vector<float>{1e-3f, 1e-4f})}) {
+        std::vector<float> times;
+        std::vector<Vector4F> values;
+        for (int i = 0; i <= 600; i++) {
+            const float t = static_cast<float>(i) / 600.0f * duration;
+            times.push_back(t);
+            values.emplace_back(std::sin(t) * 2.0f, t * 0.5f, std::cos(3.0f * t), 0.0f);
+        }
+
+        for (float tolerance : tolerances) {
+            const auto track = CompressedAnimationTrack::Compress(times, values, false, false, tolerance, nullptr);
+            EXPECT_FALSE(track.IsConstant());
+            EXPECT_LT(track.KeyCount(), times.size());
+            EXPECT_LE(MaxError(track, times, values, false), tolerance + kRoundingSlack);
+        }
+    }
+}
+
+TEST(AnimationCompression, RotationErrorBound) {
+    std::vector<float> times;
+    std::vector<Vector4F> values;
+    const float inv_axis_length = 1.0f / std::sqrt(3.0f);
+    for (int i = 0; i <= 600; i++) {
+        const float t = static_cast<float>(i) / 60.0f;
+        // swinging around a diagonal axis, the dropped component of the smallest-three encoding changes
+        const float half_angle = 1.5f * std::sin(t);
+        const float s = std::sin(half_angle) * inv_axis_length;
+        times.push_back(t);
+        values.emplace_back(s, s, s, std::cos(half_angle));
+    }
+
+    for (float tolerance : {1e-2f, 1e-3f}) {
+        const auto track = CompressedAnimationTrack::Compress(times, values, false, true, tolerance, nullptr);
+        EXPECT_FALSE(track.IsConstant());
+        EXPECT_LT(track.KeyCount(), times.size());
+        EXPECT_LE(MaxError(track, times, values, true), tolerance + kRoundingSlack);
+    }
+}
+
+TEST(AnimationCompression, StepErrorBound) {
+    std::vector<float> times;
+    std::vector<Vector4F> values;
+    for (int i = 0; i <= 100; i++) {
+        times.push_back(static_cast<float>(i) / 30.0f);
+        values.emplace_back(static_cast<float>(i / 10), 0.0f, 0.0f, 0.0f);
+    }
+
+    const auto track = CompressedAnimationTrack::Compress(times, values, true, false, 1e-3f, nullptr);
+    EXPECT_LE(track.KeyCount(), 12u);
+    EXPECT_LE(MaxError(track, times, values, false), 1e-3f + kRoundingSlack);
+}
+
+TEST(AnimationCompression, ConstantTrack) {
+    const std::vector<float> times{0.0f, 0.5f, 1.0f};
+    const std::vector<Vector4F> values(3, Vector4F(1.0f, 2.0f, 3.0f, 0.0f));
+
+    const auto track = CompressedAnimationTrack::Compress(times, values, false, false, 1e-4f, nullptr);
+    EXPECT_TRUE(track.IsConstant());
+    EXPECT_EQ(1u, track.KeyCount());
+    EXPECT_LE(MaxError(track, times, values, false), kRoundingSlack);
+}
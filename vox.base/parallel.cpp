@@ -13,6 +13,7 @@
 #include <string>
 
 #include "vox.base/cpu_info.h"
+#include "vox.base/thread_pool.h"
 
 namespace vox::utility {
 
@@ -36,12 +37,15 @@ int EstimateMaxThreads() {
     }
 #else
     (void)&GetEnvVar;  // Avoids compiler warning.
-    return 1;
+    // Sizes the ThreadPool of the parallel algorithms.
+    return utility::CPUInfo::GetInstance().NumCores();
 #endif
 }
 
 bool InParallel() {
-    // TODO: when we add TBB/Parallel STL support to ParallelFor, update this.
+    if (ThreadPool::IsWorkerThread()) {
+        return true;
+    }
 #ifdef _OPENMP
     return omp_in_parallel();
 #else
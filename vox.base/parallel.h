@@ -6,6 +6,16 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "vox.base/thread_pool.h"
+
 namespace vox::utility {
 
 /// Estimate the maximum number of threads to be used in a parallel region.
@@ -14,4 +24,319 @@ int EstimateMaxThreads();
 /// Returns true if in an parallel section.
 bool InParallel();
 
+namespace detail {
+
+/// Number of chunks a range of n elements is split in. Without a grain size,
+/// a few chunks per thread balance uneven work.
+inline size_t ChunkCount(size_t n, size_t grain) {
+    if (grain == 0) {
+        return std::max<size_t>(1, std::min(n, ThreadPool::GetInstance().MaxConcurrency() * 4));
+    }
+    return std::max<size_t>(1, (n + grain - 1) / grain);
+}
+
+/// First element of chunk c, chunks differ in size by one element at most.
+inline size_t ChunkBegin(size_t n, size_t chunk_count, size_t c) {
+    return n / chunk_count * c + std::min(c, n % chunk_count);
+}
+
+/// Sorts split the range in one chunk per thread at most, merges and
+/// histograms cost per chunk.
+inline size_t SortChunkCount(size_t n, size_t grain) {
+    const size_t kThreads = ThreadPool::GetInstance().MaxConcurrency();
+    return std::min(kThreads, ChunkCount(n, grain == 0 ? std::max<size_t>(n / kThreads, 4096) : grain));
+}
+
+}  // namespace detail
+
+/// Calls func(range_begin, range_end) on consecutive ranges covering
+/// [begin, end), in parallel on the shared ThreadPool.
+/// \param grain Minimum elements per range, 0 picks a few ranges per thread.
+template <typename RangeFunc>
+void ParallelForRange(size_t begin, size_t end, const RangeFunc& func, size_t grain = 0) {
+    if (end <= begin) {
+        return;
+    }
+    const size_t kCount = end - begin;
+    const size_t kChunks = detail::ChunkCount(kCount, grain);
+    if (kChunks == 1) {
+        func(begin, end);
+        return;
+    }
+    ThreadPool::GetInstance().Run(kChunks, [&](size_t c) {
+        func(begin + detail::ChunkBegin(kCount, kChunks, c), begin + detail::ChunkBegin(kCount, kChunks, c + 1));
+    });
+}
+
+/// Calls func(i) for every i in [begin, end), in parallel.
+template <typename Func>
+void ParallelFor(size_t begin, size_t end, const Func& func, size_t grain = 0) {
+    ParallelForRange(
+            begin, end,
+            [&func](size_t range_begin, size_t range_end) {
+                for (size_t i = range_begin; i < range_end; i++) {
+                    func(i);
+                }
+            },
+            grain);
+}
+
+/// Reduces [begin, end) with func(range_begin, range_end, identity) per range,
+/// the results are combined in range order so the result is deterministic.
+template <typename T, typename RangeFunc, typename Combine>
+T ParallelReduce(
+        size_t begin, size_t end, T identity, const RangeFunc& func, const Combine& combine, size_t grain = 0) {
+    if (end <= begin) {
+        return identity;
+    }
+    const size_t kCount = end - begin;
+    const size_t kChunks = detail::ChunkCount(kCount, grain);
+    std::vector<T> partials(kChunks, identity);
+    ThreadPool::GetInstance().Run(kChunks, [&](size_t c) {
+        partials[c] = func(begin + detail::ChunkBegin(kCount, kChunks, c),
+                           begin + detail::ChunkBegin(kCount, kChunks, c + 1), identity);
+    });
+
+    T result = std::move(partials[0]);
+    for (size_t c = 1; c < kChunks; c++) {
+        result = combine(std::move(result), std::move(partials[c]));
+    }
+    return result;
+}
+
+/// Runs the functions in parallel, returns once all of them returned.
+template <typename... Funcs>
+void ParallelInvoke(Funcs&&... funcs) {
+    const std::function<void()> kTasks[] = {std::function<void()>(std::forward<Funcs>(funcs))...};
+    ThreadPool::GetInstance().Run(sizeof...(Funcs), [&kTasks](size_t i) { kTasks[i](); });
+}
+
+/// out[i] = init op in[0] op ... op in[i - 1]. Runs in two passes over the
+/// input, which may be the output.
+/// \return the reduction of the whole input with init.
+template <typename InputIt, typename OutputIt, typename T, typename Op = std::plus<>>
+T ParallelExclusiveScan(InputIt first, InputIt last, OutputIt out, T init, Op op = Op(), size_t grain = 0) {
+    const auto kCount = static_cast<size_t>(std::distance(first, last));
+    if (kCount == 0) {
+        return init;
+    }
+    const size_t kChunks = detail::ChunkCount(kCount, grain);
+
+    std::vector<T> offsets(kChunks + 1, init);
+    if (kChunks > 1) {
+        std::vector<T> sums(kChunks, init);
+        ThreadPool::GetInstance().Run(kChunks, [&](size_t c) {
+            const size_t kBegin = detail::ChunkBegin(kCount, kChunks, c);
+            const size_t kEnd = detail::ChunkBegin(kCount, kChunks, c + 1);
+            T sum = first[kBegin];
+            for (size_t i = kBegin + 1; i < kEnd; i++) {
+                sum = op(sum, first[i]);
+            }
+            sums[c] = sum;
+        });
+        for (size_t c = 0; c < kChunks; c++) {
+            offsets[c + 1] = op(offsets[c], sums[c]);
+        }
+    }
+
+    T total = init;
+    ThreadPool::GetInstance().Run(kChunks, [&](size_t c) {
+        const size_t kEnd = detail::ChunkBegin(kCount, kChunks, c + 1);
+        T sum = offsets[c];
+        for (size_t i = detail::ChunkBegin(kCount, kChunks, c); i < kEnd; i++) {
+            T value = first[i];
+            out[i] = sum;
+            sum = op(sum, value);
+        }
+        if (c + 1 == kChunks) {
+            total = sum;
+        }
+    });
+    return total;
+}
+
+/// out[i] = in[0] op ... op in[i].
+template <typename InputIt, typename OutputIt, typename Op = std::plus<>>
+void ParallelInclusiveScan(InputIt first, InputIt last, OutputIt out, Op op = Op(), size_t grain = 0) {
+    using T = std::decay_t<decltype(op(*first, *first))>;
+    const auto kCount = static_cast<size_t>(std::distance(first, last));
+    if (kCount == 0) {
+        return;
+    }
+    const size_t kChunks = detail::ChunkCount(kCount, grain);
+
+    // carries[c] reduces the chunks before c, the first chunk has none
+    std::vector<T> carries(kChunks);
+    if (kChunks > 1) {
+        std::vector<T> sums(kChunks);
+        ThreadPool::GetInstance().Run(kChunks, [&](size_t c) {
+            const size_t kBegin = detail::ChunkBegin(kCount, kChunks, c);
+            const size_t kEnd = detail::ChunkBegin(kCount, kChunks, c + 1);
+            T sum = first[kBegin];
+            for (size_t i = kBegin + 1; i < kEnd; i++) {
+                sum = op(sum, first[i]);
+            }
+            sums[c] = sum;
+        });
+        carries[1] = sums[0];
+        for (size_t c = 2; c < kChunks; c++) {
+            carries[c] = op(carries[c - 1], sums[c - 1]);
+        }
+    }
+
+    ThreadPool::GetInstance().Run(kChunks, [&](size_t c) {
+        const size_t kBegin = detail::ChunkBegin(kCount, kChunks, c);
+        const size_t kEnd = detail::ChunkBegin(kCount, kChunks, c + 1);
+        T sum = c == 0 ? T(first[kBegin]) : op(carries[c], first[kBegin]);
+        out[kBegin] = sum;
+        for (size_t i = kBegin + 1; i < kEnd; i++) {
+            sum = op(sum, first[i]);
+            out[i] = sum;
+        }
+    });
+}
+
+/// Stable merge sort: the chunks are sorted in parallel, then merged pairwise,
+/// each merge split between the threads at the positions of the first run's
+/// slices in the second run.
+template <typename RandomIt, typename Compare = std::less<>>
+void ParallelSort(RandomIt first, RandomIt last, Compare comp = Compare(), size_t grain = 0) {
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    const auto kCount = static_cast<size_t>(std::distance(first, last));
+    const size_t kThreads = ThreadPool::GetInstance().MaxConcurrency();
+    const size_t kChunks = detail::SortChunkCount(kCount, grain);
+    if (kChunks <= 1) {
+        std::stable_sort(first, last, comp);
+        return;
+    }
+
+    std::vector<size_t> runs(kChunks + 1);
+    for (size_t c = 0; c <= kChunks; c++) {
+        runs[c] = detail::ChunkBegin(kCount, kChunks, c);
+    }
+    ThreadPool::GetInstance().Run(kChunks,
+                                  [&](size_t c) { std::stable_sort(first + runs[c], first + runs[c + 1], comp); });
+
+    std::vector<T> buffer(kCount);
+    bool in_buffer = false;
+    auto merge_round = [&](auto src, auto dst) {
+        struct Piece {
+            size_t a_begin, a_end, b_begin, b_end, out;
+        };
+        std::vector<Piece> pieces;
+        const size_t kPairs = (runs.size() - 1) / 2;
+        const size_t kSlices = std::max<size_t>(1, kThreads * 2 / std::max<size_t>(kPairs, 1));
+        std::vector<size_t> merged_runs{0};
+        for (size_t r = 0; r + 1 < runs.size(); r += 2) {
+            const size_t kMid = runs[r + 1];
+            const size_t kEnd = r + 2 < runs.size() ? runs[r + 2] : kMid;
+            const size_t kLength = kMid - runs[r];
+            size_t b = kMid;
+            for (size_t s = 0; s < kSlices; s++) {
+                const size_t kA = runs[r] + kLength * s / kSlices;
+                const size_t kNextA = runs[r] + kLength * (s + 1) / kSlices;
+                size_t next_b = kEnd;
+                if (s + 1 < kSlices) {
+                    next_b = static_cast<size_t>(std::lower_bound(src + kMid, src + kEnd, src[kNextA], comp) - src);
+                }
+                // the elements of the second run before b precede the slice
+                pieces.push_back({kA, kNextA, b, next_b, kA + b - kMid});
+                b = next_b;
+            }
+            merged_runs.push_back(kEnd);
+        }
+        ThreadPool::GetInstance().Run(pieces.size(), [&](size_t p) {
+            const auto& piece = pieces[p];
+            std::merge(std::make_move_iterator(src + piece.a_begin), std::make_move_iterator(src + piece.a_end),
+                       std::make_move_iterator(src + piece.b_begin), std::make_move_iterator(src + piece.b_end),
+                       dst + piece.out, comp);
+        });
+        runs = std::move(merged_runs);
+    };
+    while (runs.size() > 2) {
+        if (in_buffer) {
+            merge_round(buffer.begin(), first);
+        } else {
+            merge_round(first, buffer.begin());
+        }
+        in_buffer = !in_buffer;
+    }
+    if (in_buffer) {
+        ParallelFor(0, kCount, [&](size_t i) { first[i] = std::move(buffer[i]); }, 4096);
+    }
+}
+
+/// Stable LSD radix sort on an unsigned integer key, one byte per pass. Passes
+/// where every key has the same byte are skipped.
+template <typename RandomIt, typename KeyFunc>
+void ParallelRadixSort(RandomIt first, RandomIt last, const KeyFunc& key, size_t grain = 0) {
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    using Key = std::decay_t<decltype(key(std::declval<const T&>()))>;
+    static_assert(std::is_unsigned_v<Key>, "radix sort keys are unsigned integers");
+    constexpr size_t kRadix = 256;
+
+    const auto kCount = static_cast<size_t>(std::distance(first, last));
+    if (kCount < 2) {
+        return;
+    }
+    const size_t kChunks = detail::SortChunkCount(kCount, grain);
+
+    std::vector<T> buffer(kCount);
+    std::vector<size_t> offsets(kChunks * kRadix);
+    bool in_buffer = false;
+    auto radix_pass = [&](auto src, auto dst, size_t shift) -> bool {
+        ThreadPool::GetInstance().Run(kChunks, [&](size_t c) {
+            size_t* histogram = offsets.data() + c * kRadix;
+            std::fill_n(histogram, kRadix, 0);
+            const size_t kEnd = detail::ChunkBegin(kCount, kChunks, c + 1);
+            for (size_t i = detail::ChunkBegin(kCount, kChunks, c); i < kEnd; i++) {
+                histogram[(key(src[i]) >> shift) & (kRadix - 1)]++;
+            }
+        });
+
+        // digit major, chunk minor: the scatter of each chunk keeps the order
+        size_t offset = 0;
+        for (size_t digit = 0; digit < kRadix; digit++) {
+            const size_t kDigitBegin = offset;
+            for (size_t c = 0; c < kChunks; c++) {
+                const size_t kDigitCount = offsets[c * kRadix + digit];
+                offsets[c * kRadix + digit] = offset;
+                offset += kDigitCount;
+            }
+            // the digit of every key, summed over all chunks
+            if (offset - kDigitBegin == kCount) {
+                return false;
+            }
+        }
+
+        ThreadPool::GetInstance().Run(kChunks, [&](size_t c) {
+            size_t* chunk_offsets = offsets.data() + c * kRadix;
+            const size_t kEnd = detail::ChunkBegin(kCount, kChunks, c + 1);
+            for (size_t i = detail::ChunkBegin(kCount, kChunks, c); i < kEnd; i++) {
+                dst[chunk_offsets[(key(src[i]) >> shift) & (kRadix - 1)]++] = std::move(src[i]);
+            }
+        });
+        return true;
+    };
+
+    for (size_t shift = 0; shift < sizeof(Key) * 8; shift += 8) {
+        const bool kMoved =
+                in_buffer ? radix_pass(buffer.begin(), first, shift) : radix_pass(first, buffer.begin(), shift);
+        if (kMoved) {
+            in_buffer = !in_buffer;
+        }
+    }
+    if (in_buffer) {
+        ParallelFor(0, kCount, [&](size_t i) { first[i] = std::move(buffer[i]); }, 4096);
+    }
+}
+
+/// Radix sort of unsigned integers.
+template <typename RandomIt>
+void ParallelRadixSort(RandomIt first, RandomIt last, size_t grain = 0) {
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    ParallelRadixSort(
+            first, last, [](const T& value) { return value; }, grain);
+}
+
 }  // namespace vox::utility
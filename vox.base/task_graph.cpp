@@ -0,0 +1,211 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.base/task_graph.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+#include "vox.base/thread_pool.h"
+
+namespace vox::utility {
+
+// shared with the jobs queued on the pool, which may outlive Execute when the calling thread ran their task
+struct TaskGraph::Execution {
+    std::vector<Task> *tasks{nullptr};
+    std::vector<uint32_t> remaining;
+    bool use_pool{false};
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<TaskId> main_ready;
+    std::deque<TaskId> any_ready;
+    size_t finished{0};
+    std::exception_ptr exception{nullptr};
+
+    // returns the tasks to hand to the pool
+    size_t Push(TaskId task) {
+        if ((*tasks)[task].affinity == Affinity::MAIN_THREAD) {
+            main_ready.push_back(task);
+            return 0;
+        }
+        any_ready.push_back(task);
+        return 1;
+    }
+
+    static void Run(const std::shared_ptr<Execution> &execution, TaskId task_id);
+
+    static void Dispatch(const std::shared_ptr<Execution> &execution, size_t count);
+};
+
+void TaskGraph::Execution::Run(const std::shared_ptr<Execution> &execution, TaskId task_id) {
+    auto &task = (*execution->tasks)[task_id];
+    bool skip;
+    {
+        std::lock_guard<std::mutex> lock(execution->mutex);
+        skip = execution->exception != nullptr;
+    }
+    if (!skip) {
+        const auto kStart = std::chrono::steady_clock::now();
+        try {
+            task.func();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(execution->mutex);
+            if (!execution->exception) {
+                execution->exception = std::current_exception();
+            }
+        }
+        task.duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - kStart).count();
+    }
+
+    size_t pool_tasks = 0;
+    {
+        std::lock_guard<std::mutex> lock(execution->mutex);
+        execution->finished++;
+        for (auto dependent : task.dependents) {
+            if (--execution->remaining[dependent] == 0) {
+                pool_tasks += execution->Push(dependent);
+            }
+        }
+    }
+    execution->condition.notify_all();
+    Dispatch(execution, pool_tasks);
+}
+
+void TaskGraph::Execution::Dispatch(const std::shared_ptr<Execution> &execution, size_t count) {
+    if (!execution->use_pool) {
+        return;
+    }
+    auto &pool = ThreadPool::GetInstance();
+    for (size_t i = 0; i < count; i++) {
+        pool.Submit([execution] {
+            TaskId task;
+            {
+                std::lock_guard<std::mutex> lock(execution->mutex);
+                // the calling thread may have taken it
+                if (execution->any_ready.empty()) {
+                    return;
+                }
+                task = execution->any_ready.front();
+                execution->any_ready.pop_front();
+            }
+            Run(execution, task);
+        });
+    }
+}
+
+TaskGraph::TaskId TaskGraph::AddTask(std::string name,
+                                     std::function<void()> func,
+                                     Affinity affinity,
+                                     const std::vector<TaskId> &dependencies) {
+    const auto kId = static_cast<TaskId>(tasks_.size());
+    Task task;
+    task.name = std::move(name);
+    task.func = std::move(func);
+    task.affinity = affinity;
+    tasks_.push_back(std::move(task));
+    for (auto dependency : dependencies) {
+        if (dependency != invalid_task_) {
+            AddDependency(kId, dependency);
+        }
+    }
+    return kId;
+}
+
+void TaskGraph::AddDependency(TaskId task, TaskId dependency) {
+    if (task >= tasks_.size() || dependency >= tasks_.size() || task == dependency) {
+        throw std::invalid_argument("TaskGraph: invalid dependency");
+    }
+    tasks_[dependency].dependents.push_back(task);
+    tasks_[task].dependency_count++;
+}
+
+void TaskGraph::Execute() {
+    if (tasks_.empty()) {
+        return;
+    }
+
+    auto execution = std::make_shared<Execution>();
+    execution->tasks = &tasks_;
+    execution->use_pool = ThreadPool::GetInstance().MaxConcurrency() > 1;
+    execution->remaining.resize(tasks_.size());
+    std::vector<TaskId> ready;
+    for (TaskId i = 0; i < tasks_.size(); i++) {
+        tasks_[i].duration = 0;
+        execution->remaining[i] = tasks_[i].dependency_count;
+        if (tasks_[i].dependency_count == 0) {
+            ready.push_back(i);
+        }
+    }
+    CheckAcyclic(ready);
+
+    size_t pool_tasks = 0;
+    for (auto task : ready) {
+        pool_tasks += execution->Push(task);
+    }
+    Execution::Dispatch(execution, pool_tasks);
+
+    while (true) {
+        TaskId task;
+        {
+            std::unique_lock<std::mutex> lock(execution->mutex);
+            execution->condition.wait(lock, [&] {
+                return !execution->main_ready.empty() || !execution->any_ready.empty() ||
+                       execution->finished == tasks_.size();
+            });
+            if (!execution->main_ready.empty()) {
+                task = execution->main_ready.front();
+                execution->main_ready.pop_front();
+            } else if (!execution->any_ready.empty()) {
+                task = execution->any_ready.front();
+                execution->any_ready.pop_front();
+            } else {
+                break;
+            }
+        }
+        Execution::Run(execution, task);
+    }
+
+    if (execution->exception) {
+        std::rethrow_exception(execution->exception);
+    }
+}
+
+void TaskGraph::CheckAcyclic(std::vector<TaskId> ready) const {
+    std::vector<uint32_t> remaining(tasks_.size());
+    for (size_t i = 0; i < tasks_.size(); i++) {
+        remaining[i] = tasks_[i].dependency_count;
+    }
+    size_t visited = 0;
+    while (!ready.empty()) {
+        const auto kTask = ready.back();
+        ready.pop_back();
+        visited++;
+        for (auto dependent : tasks_[kTask].dependents) {
+            if (--remaining[dependent] == 0) {
+                ready.push_back(dependent);
+            }
+        }
+    }
+    if (visited != tasks_.size()) {
+        throw std::logic_error("TaskGraph: dependency cycle");
+    }
+}
+
+void TaskGraph::Clear() { tasks_.clear(); }
+
+size_t TaskGraph::TaskCount() const { return tasks_.size(); }
+
+const std::string &TaskGraph::GetName(TaskId task) const { return tasks_[task].name; }
+
+double TaskGraph::GetDuration(TaskId task) const { return tasks_[task].duration; }
+
+}  // namespace vox::utility
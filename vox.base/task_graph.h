@@ -0,0 +1,72 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace vox::utility {
+
+/// \brief Tasks with dependencies, run once per Execute.
+///
+/// A task starts when all its dependencies are done. Tasks with main thread
+/// affinity run on the thread calling Execute, in the order they become ready,
+/// which keeps the code that is not thread safe serial. The others are handed
+/// to the ThreadPool workers, the calling thread picks them up as well while no
+/// main thread task is ready.
+class TaskGraph {
+public:
+    using TaskId = uint32_t;
+
+    static constexpr TaskId invalid_task_ = ~0u;
+
+    enum class Affinity { ANY, MAIN_THREAD };
+
+    /// Adds a task, the dependencies must be added before it.
+    /// Dependencies equal to invalid_task_ are ignored.
+    TaskId AddTask(std::string name,
+                   std::function<void()> func,
+                   Affinity affinity = Affinity::ANY,
+                   const std::vector<TaskId> &dependencies = {});
+
+    /// Makes task wait for dependency. Execute throws on cycles.
+    void AddDependency(TaskId task, TaskId dependency);
+
+    /// Runs every task and returns once all are done. After a task throws, the
+    /// tasks not started yet are skipped and the exception is rethrown.
+    void Execute();
+
+    /// Removes all tasks.
+    void Clear();
+
+    [[nodiscard]] size_t TaskCount() const;
+
+    [[nodiscard]] const std::string &GetName(TaskId task) const;
+
+    /// Time spent in the task by the last Execute, in milliseconds.
+    [[nodiscard]] double GetDuration(TaskId task) const;
+
+private:
+    struct Task {
+        std::string name;
+        std::function<void()> func;
+        Affinity affinity{Affinity::ANY};
+        std::vector<TaskId> dependents;
+        uint32_t dependency_count{0};
+        double duration{0};
+    };
+
+    struct Execution;
+
+    void CheckAcyclic(std::vector<TaskId> ready) const;
+
+    std::vector<Task> tasks_;
+};
+
+}  // namespace vox::utility
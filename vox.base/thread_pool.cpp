@@ -0,0 +1,162 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.base/thread_pool.h"
+
+#include <algorithm>
+
+#include "vox.base/parallel.h"
+
+namespace vox::utility {
+
+static thread_local bool is_worker_thread = false;
+
+ThreadPool& ThreadPool::GetInstance() {
+    static ThreadPool instance(static_cast<size_t>(std::max(EstimateMaxThreads(), 1)));
+    return instance;
+}
+
+ThreadPool::ThreadPool(size_t num_threads) {
+    num_threads = std::max<size_t>(num_threads, 1);
+    workers_.reserve(num_threads - 1);
+    for (size_t i = 0; i + 1 < num_threads; i++) {
+        workers_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_condition_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::NumThreads() const { return workers_.size() + 1; }
+
+void ThreadPool::SetMaxConcurrency(size_t num_threads) { max_concurrency_ = num_threads; }
+
+size_t ThreadPool::MaxConcurrency() const {
+    const size_t kMax = max_concurrency_;
+    return kMax == 0 ? NumThreads() : std::min(kMax, NumThreads());
+}
+
+bool ThreadPool::IsWorkerThread() { return is_worker_thread; }
+
+void ThreadPool::Process(Batch& batch) {
+    for (size_t i = batch.next++; i < batch.count; i = batch.next++) {
+        try {
+            (*batch.task)(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(batch.exception_mutex);
+            if (!batch.exception) {
+                batch.exception = std::current_exception();
+            }
+            // skip the remaining tasks
+            batch.next = batch.count;
+        }
+    }
+}
+
+void ThreadPool::Run(size_t count, const std::function<void(size_t)>& task) {
+    if (count == 0) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> run_lock(run_mutex_, std::defer_lock);
+    if (count == 1 || workers_.empty() || MaxConcurrency() == 1 || !run_lock.try_lock()) {
+        for (size_t i = 0; i < count; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    Batch batch;
+    batch.task = &task;
+    batch.count = count;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batch_ = &batch;
+        generation_++;
+    }
+    start_condition_.notify_all();
+
+    Process(batch);
+
+    // the batch lives on this stack, wait for every worker that joined it
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        batch_ = nullptr;
+        done_condition_.wait(lock, [this] { return active_workers_ == 0; });
+    }
+
+    if (batch.exception) {
+        std::rethrow_exception(batch.exception);
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    if (workers_.empty()) {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    start_condition_.notify_one();
+}
+
+void ThreadPool::WorkerLoop(size_t worker_index) {
+    is_worker_thread = true;
+    uint64_t seen_generation = 0;
+    while (true) {
+        Batch* batch = nullptr;
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_condition_.wait(lock, [&] { return stop_ || generation_ != seen_generation || !tasks_.empty(); });
+            if (stop_) {
+                return;
+            }
+            // batches first, the caller of Run is waiting on them
+            if (generation_ != seen_generation) {
+                seen_generation = generation_;
+                // workers over the concurrency limit sit the batch out, the caller counts as one thread
+                if (batch_ != nullptr && worker_index + 1 < MaxConcurrency()) {
+                    batch = batch_;
+                    active_workers_++;
+                }
+            }
+            if (batch == nullptr) {
+                if (tasks_.empty()) {
+                    continue;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+        }
+
+        if (task) {
+            task();
+            continue;
+        }
+
+        Process(*batch);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            active_workers_--;
+        }
+        done_condition_.notify_all();
+    }
+}
+
+}  // namespace vox::utility
@@ -0,0 +1,90 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vox::utility {
+
+/// \brief Worker threads shared by the parallel algorithms of parallel.h.
+///
+/// Run splits one batch of tasks between the workers and the calling thread. A
+/// batch runs at a time: a Run issued while another batch is running executes
+/// its tasks on the calling thread, so nested parallel calls never wait on each
+/// other. Submit queues independent tasks that idle workers pick up between
+/// batches.
+class ThreadPool {
+public:
+    /// The pool shared by the engine, with EstimateMaxThreads() threads
+    /// counting the caller.
+    static ThreadPool& GetInstance();
+
+    /// \param num_threads Threads running a batch, counting the calling thread.
+    explicit ThreadPool(size_t num_threads);
+
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    void operator=(const ThreadPool&) = delete;
+
+    /// Threads running a batch, counting the calling thread.
+    [[nodiscard]] size_t NumThreads() const;
+
+    /// Limit the threads running the next batches, 0 restores all of them.
+    /// Used to measure scaling, the workers are kept.
+    void SetMaxConcurrency(size_t num_threads);
+
+    [[nodiscard]] size_t MaxConcurrency() const;
+
+    /// Calls task(i) for every i in [0, count) and returns once all calls are
+    /// done. The first exception thrown by a task is rethrown.
+    void Run(size_t count, const std::function<void(size_t)>& task);
+
+    /// Queues task for the next idle worker and returns. A pool without workers
+    /// runs it on the calling thread. The task must not throw.
+    void Submit(std::function<void()> task);
+
+    /// Returns true on a worker thread of any pool.
+    static bool IsWorkerThread();
+
+private:
+    struct Batch {
+        const std::function<void(size_t)>* task{nullptr};
+        size_t count{0};
+        std::atomic<size_t> next{0};
+        std::exception_ptr exception{nullptr};
+        std::mutex exception_mutex;
+    };
+
+    void WorkerLoop(size_t worker_index);
+
+    static void Process(Batch& batch);
+
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> max_concurrency_{0};
+
+    // one batch at a time
+    std::mutex run_mutex_;
+
+    std::mutex mutex_;
+    std::condition_variable start_condition_;
+    std::condition_variable done_condition_;
+    Batch* batch_{nullptr};
+    uint64_t generation_{0};
+    std::deque<std::function<void()>> tasks_;
+    size_t active_workers_{0};
+    bool stop_{false};
+};
+
+}  // namespace vox::utility
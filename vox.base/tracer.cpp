@@ -0,0 +1,434 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.base/tracer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "vox.base/logging.h"
+
+namespace vox::utility {
+namespace {
+constexpr uint64_t kRingCapacity = 1 << 14;
+constexpr uint64_t kRingMask = kRingCapacity - 1;
+constexpr size_t kMaxCaptureEvents = 1 << 22;
+
+struct OpenScope {
+    const char *name;
+    uint64_t timestamp;
+    uint64_t children;
+    // the END of a captured BEGIN is captured too, past the capture limit included
+    bool captured;
+};
+
+/**
+ * Single producer (the owning thread), single consumer (Flush under the consumer mutex).
+ */
+struct ThreadBuffer {
+    explicit ThreadBuffer(uint32_t index) : index(index), events(kRingCapacity) {}
+
+    const uint32_t index;
+    std::vector<Tracer::Event> events;
+    std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> tail{0};
+
+    // producer side: scopes begun and not yet ended, their END events are always guaranteed a slot
+    uint32_t depth{0};
+
+    // consumer side
+    std::vector<OpenScope> stack;
+};
+
+struct Accumulator {
+    uint64_t duration{0};
+    uint64_t self_duration{0};
+    uint64_t calls{0};
+};
+
+struct CapturedEvent {
+    Tracer::Event event;
+    uint32_t thread;
+    uint64_t duration;
+};
+
+/* external tracks are exported after the thread ids */
+constexpr uint32_t kFirstTrack = 1 << 16;
+
+struct State {
+    std::atomic<bool> enabled{false};
+    const std::chrono::steady_clock::time_point epoch{std::chrono::steady_clock::now()};
+
+    std::mutex registry_mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    // buffers of exited threads, handed to the next new threads
+    std::vector<ThreadBuffer *> free_buffers;
+
+    std::mutex intern_mutex;
+    std::unordered_set<std::string> interned;
+
+    std::mutex consumer_mutex;
+    std::unordered_map<const char *, Accumulator> statistics;
+    std::unordered_set<uint32_t> working_threads;
+    uint32_t elapsed_frames{0};
+    bool capturing{false};
+    std::vector<CapturedEvent> capture;
+    std::vector<const char *> tracks;
+};
+
+State &GetState() {
+    static State state;
+    return state;
+}
+
+uint64_t Now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now() - GetState().epoch)
+                                         .count());
+}
+
+bool Push(ThreadBuffer &buffer, const Tracer::Event &event, uint64_t reserve);
+
+/**
+ * Returns the buffer of its thread to the free list when the thread exits, the events not flushed yet stay in it.
+ */
+struct BufferOwner {
+    ThreadBuffer *buffer{nullptr};
+
+    ~BufferOwner() {
+        if (!buffer) {
+            return;
+        }
+        // scopes left open by the thread are closed, the next owner starts at depth 0
+        while (buffer->depth > 0) {
+            --buffer->depth;
+            Push(*buffer, {nullptr, Now(), Tracer::EventType::END, buffer->depth}, 0);
+        }
+        auto &state = GetState();
+        std::lock_guard<std::mutex> lock(state.registry_mutex);
+        state.free_buffers.push_back(buffer);
+    }
+};
+
+ThreadBuffer &LocalBuffer() {
+    thread_local BufferOwner owner;
+    if (!owner.buffer) {
+        auto &state = GetState();
+        std::lock_guard<std::mutex> lock(state.registry_mutex);
+        if (state.free_buffers.empty()) {
+            state.buffers.emplace_back(std::make_unique<ThreadBuffer>(static_cast<uint32_t>(state.buffers.size())));
+            owner.buffer = state.buffers.back().get();
+        } else {
+            owner.buffer = state.free_buffers.back();
+            state.free_buffers.pop_back();
+        }
+    }
+    return *owner.buffer;
+}
+
+/**
+ * Push an event if at least `reserve` slots stay free afterwards.
+ */
+bool Push(ThreadBuffer &buffer, const Tracer::Event &event, uint64_t reserve) {
+    const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    const uint64_t tail = buffer.tail.load(std::memory_order_acquire);
+    if (head - tail + 1 + reserve > kRingCapacity) {
+        return false;
+    }
+    buffer.events[head & kRingMask] = event;
+    buffer.head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+void Consume(State &state, ThreadBuffer &buffer) {
+    const uint64_t tail = buffer.tail.load(std::memory_order_relaxed);
+    const uint64_t head = buffer.head.load(std::memory_order_acquire);
+
+    for (uint64_t i = tail; i != head; ++i) {
+        const auto &event = buffer.events[i & kRingMask];
+        // the limit only drops whole scopes, an END is kept when its BEGIN was
+        bool captured = state.capturing && state.capture.size() < kMaxCaptureEvents;
+        switch (event.type) {
+            case Tracer::EventType::BEGIN:
+                buffer.stack.push_back({event.name, event.timestamp, 0, captured});
+                state.working_threads.insert(buffer.index);
+                break;
+
+            case Tracer::EventType::END: {
+                if (buffer.stack.empty()) {
+                    captured = false;
+                    break;
+                }
+                const auto scope = buffer.stack.back();
+                buffer.stack.pop_back();
+                captured = state.capturing && scope.captured;
+
+                const uint64_t duration = event.timestamp - scope.timestamp;
+                auto &accumulator = state.statistics[scope.name];
+                accumulator.duration += duration;
+                accumulator.self_duration += duration - std::min(duration, scope.children);
+                ++accumulator.calls;
+                if (!buffer.stack.empty()) {
+                    buffer.stack.back().children += duration;
+                }
+                break;
+            }
+
+            case Tracer::EventType::FRAME:
+                ++state.elapsed_frames;
+                break;
+
+            case Tracer::EventType::ZONE:
+                break;
+        }
+
+        if (captured) {
+            state.capture.push_back({event, buffer.index, 0});
+        }
+    }
+
+    buffer.tail.store(head, std::memory_order_release);
+}
+
+void WriteEscaped(std::ofstream &stream, const char *text) {
+    for (const char *c = text; *c; ++c) {
+        switch (*c) {
+            case '"':
+                stream << "\\\"";
+                break;
+            case '\\':
+                stream << "\\\\";
+                break;
+            case '\n':
+                stream << "\\n";
+                break;
+            default:
+                if (static_cast<unsigned char>(*c) >= 0x20) {
+                    stream << *c;
+                }
+                break;
+        }
+    }
+}
+
+}  // namespace
+
+bool Tracer::IsEnabled() { return GetState().enabled.load(std::memory_order_relaxed); }
+
+void Tracer::Enable() { GetState().enabled.store(true, std::memory_order_relaxed); }
+
+void Tracer::Disable() { GetState().enabled.store(false, std::memory_order_relaxed); }
+
+bool Tracer::Begin(const char *name) {
+    auto &buffer = LocalBuffer();
+    // keep room for the END of this scope and of every enclosing one
+    if (!Push(buffer, {name, Now(), EventType::BEGIN, buffer.depth}, buffer.depth + 1)) {
+        return false;
+    }
+    ++buffer.depth;
+    return true;
+}
+
+void Tracer::End() {
+    auto &buffer = LocalBuffer();
+    if (buffer.depth == 0) {
+        return;
+    }
+    --buffer.depth;
+    Push(buffer, {nullptr, Now(), EventType::END, buffer.depth}, 0);
+}
+
+void Tracer::FrameMark() {
+    if (!IsEnabled()) {
+        return;
+    }
+    auto &buffer = LocalBuffer();
+    Push(buffer, {"Frame", Now(), EventType::FRAME, buffer.depth}, buffer.depth);
+}
+
+uint64_t Tracer::Timestamp() { return Now(); }
+
+void Tracer::RecordZone(const char *name, uint64_t begin, uint64_t end, const char *track) {
+    auto &state = GetState();
+    std::lock_guard<std::mutex> lock(state.consumer_mutex);
+    if (!state.capturing || state.capture.size() >= kMaxCaptureEvents) {
+        return;
+    }
+
+    auto iter = std::find_if(state.tracks.begin(), state.tracks.end(),
+                             [track](const char *entry) { return std::string(entry) == track; });
+    if (iter == state.tracks.end()) {
+        state.tracks.push_back(track);
+        iter = state.tracks.end() - 1;
+    }
+
+    const auto thread = kFirstTrack + static_cast<uint32_t>(iter - state.tracks.begin());
+    state.capture.push_back({{name, begin, EventType::ZONE, 0}, thread, end > begin ? end - begin : 0});
+}
+
+const char *Tracer::Intern(const std::string &name) {
+    auto &state = GetState();
+    std::lock_guard<std::mutex> lock(state.intern_mutex);
+    return state.interned.insert(name).first->c_str();
+}
+
+void Tracer::Flush() {
+    auto &state = GetState();
+    std::lock_guard<std::mutex> lock(state.consumer_mutex);
+
+    std::vector<ThreadBuffer *> buffers;
+    {
+        std::lock_guard<std::mutex> registry_lock(state.registry_mutex);
+        buffers.reserve(state.buffers.size());
+        for (auto &buffer : state.buffers) {
+            buffers.push_back(buffer.get());
+        }
+    }
+
+    for (auto *buffer : buffers) {
+        Consume(state, *buffer);
+    }
+}
+
+std::vector<Tracer::ScopeStatistics> Tracer::Statistics() {
+    auto &state = GetState();
+    std::lock_guard<std::mutex> lock(state.consumer_mutex);
+
+    // the same name may come from different pointers (literals in different translation units)
+    std::unordered_map<std::string, ScopeStatistics> merged;
+    for (auto &[name, accumulator] : state.statistics) {
+        auto &statistics = merged.try_emplace(name, ScopeStatistics{name, 0.0, 0.0, 0}).first->second;
+        statistics.duration += static_cast<double>(accumulator.duration) * 1e-9;
+        statistics.self_duration += static_cast<double>(accumulator.self_duration) * 1e-9;
+        statistics.calls += accumulator.calls;
+    }
+
+    std::vector<ScopeStatistics> result;
+    result.reserve(merged.size());
+    for (auto &entry : merged) {
+        result.push_back(std::move(entry.second));
+    }
+    std::sort(result.begin(), result.end(),
+              [](const ScopeStatistics &a, const ScopeStatistics &b) { return a.duration > b.duration; });
+    return result;
+}
+
+uint32_t Tracer::ElapsedFrames() {
+    auto &state = GetState();
+    std::lock_guard<std::mutex> lock(state.consumer_mutex);
+    return state.elapsed_frames;
+}
+
+uint32_t Tracer::WorkingThreads() {
+    auto &state = GetState();
+    std::lock_guard<std::mutex> lock(state.consumer_mutex);
+    return static_cast<uint32_t>(state.working_threads.size());
+}
+
+void Tracer::ClearStatistics() {
+    auto &state = GetState();
+    std::lock_guard<std::mutex> lock(state.consumer_mutex);
+    state.statistics.clear();
+    state.working_threads.clear();
+    state.elapsed_frames = 0;
+}
+
+void Tracer::BeginCapture() {
+    Flush();
+    auto &state = GetState();
+    std::lock_guard<std::mutex> lock(state.consumer_mutex);
+    state.capture.clear();
+    state.capturing = true;
+}
+
+bool Tracer::IsCapturing() {
+    auto &state = GetState();
+    std::lock_guard<std::mutex> lock(state.consumer_mutex);
+    return state.capturing;
+}
+
+bool Tracer::EndCapture(const std::string &path) {
+    Flush();
+    auto &state = GetState();
+    std::vector<CapturedEvent> capture;
+    std::vector<const char *> tracks;
+    {
+        std::lock_guard<std::mutex> lock(state.consumer_mutex);
+        state.capturing = false;
+        capture.swap(state.capture);
+        tracks = state.tracks;
+    }
+
+    std::ofstream stream(path, std::ios::out | std::ios::trunc);
+    if (!stream.is_open()) {
+        LOGE("Failed to open trace file {}", path)
+        return false;
+    }
+
+    std::unordered_set<uint32_t> threads;
+    stream << "{\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&]() {
+        if (!first) {
+            stream << ",\n";
+        }
+        first = false;
+    };
+
+    stream.setf(std::ios::fixed);
+    stream.precision(3);
+    for (const auto &captured : capture) {
+        const auto &event = captured.event;
+        threads.insert(captured.thread);
+        separator();
+
+        const double timestamp = static_cast<double>(event.timestamp) * 1e-3;
+        switch (event.type) {
+            case EventType::BEGIN:
+                stream << R"({"ph":"B","name":")";
+                WriteEscaped(stream, event.name);
+                stream << "\",";
+                break;
+            case EventType::END:
+                stream << R"({"ph":"E",)";
+                break;
+            case EventType::FRAME:
+                stream << R"({"ph":"i","s":"g","name":")";
+                WriteEscaped(stream, event.name);
+                stream << "\",";
+                break;
+            case EventType::ZONE:
+                stream << R"({"ph":"X","name":")";
+                WriteEscaped(stream, event.name);
+                stream << R"(","dur":)" << static_cast<double>(captured.duration) * 1e-3 << ",";
+                break;
+        }
+        stream << R"("pid":0,"tid":)" << captured.thread << R"(,"ts":)" << timestamp << "}";
+    }
+
+    for (auto thread : threads) {
+        separator();
+        stream << R"({"ph":"M","name":"thread_name","pid":0,"tid":)" << thread << R"(,"args":{"name":")";
+        if (thread >= kFirstTrack) {
+            WriteEscaped(stream, tracks[thread - kFirstTrack]);
+        } else {
+            stream << "Thread " << thread;
+        }
+        stream << "\"}}";
+    }
+    stream << "\n]}\n";
+
+    return stream.good();
+}
+
+}  // namespace vox::utility
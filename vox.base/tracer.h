@@ -0,0 +1,136 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "vox.base/preprocessor.h"
+
+namespace vox::utility {
+
+/**
+ * @brief Low overhead scope tracer. Every thread records begin/end events into its own single-producer ring buffer,
+ *        so recording never takes a lock. A consumer drains the rings with Flush() to build aggregated statistics,
+ *        and optionally keeps the raw events for a Chrome trace (chrome://tracing, ui.perfetto.dev) export.
+ * @note Event names are stored by pointer: pass string literals, or strings returned by Intern().
+ */
+class Tracer {
+public:
+    enum class EventType : uint32_t { BEGIN, END, FRAME, ZONE };
+
+    struct Event {
+        const char *name;
+        uint64_t timestamp;  // steady_clock nanoseconds
+        EventType type;
+        uint32_t depth;
+    };
+
+    struct ScopeStatistics {
+        std::string name;
+        double duration;       // inclusive, in seconds
+        double self_duration;  // exclusive of nested scopes, in seconds
+        uint64_t calls;
+    };
+
+    static bool IsEnabled();
+
+    static void Enable();
+
+    static void Disable();
+
+    /**
+     * @brief Open a scope on the calling thread. Dropped (and returns false) when the thread ring is full.
+     */
+    static bool Begin(const char *name);
+
+    /**
+     * @brief Close the innermost scope opened by a successful Begin() on the calling thread.
+     */
+    static void End();
+
+    /**
+     * @brief Mark the end of a frame.
+     */
+    static void FrameMark();
+
+    /**
+     * @brief Current time on the tracer clock, in nanoseconds.
+     */
+    static uint64_t Timestamp();
+
+    /**
+     * @brief Add a complete zone measured elsewhere (e.g. on the GPU) to the capture, on a named track.
+     *        Ignored when no capture is active. Zones do not contribute to Statistics().
+     * @param begin Start on the tracer clock, in nanoseconds
+     * @param end End on the tracer clock, in nanoseconds
+     */
+    static void RecordZone(const char *name, uint64_t begin, uint64_t end, const char *track);
+
+    /**
+     * @brief Return a pointer with static lifetime for a runtime string, identical strings share the pointer.
+     */
+    static const char *Intern(const std::string &name);
+
+    /**
+     * @brief Drain every thread ring and fold the events into the statistics (and the capture if one is active).
+     */
+    static void Flush();
+
+    /**
+     * @brief Statistics accumulated since the last ClearStatistics(), sorted by decreasing duration.
+     */
+    static std::vector<ScopeStatistics> Statistics();
+
+    static uint32_t ElapsedFrames();
+
+    /**
+     * @brief Number of threads which recorded at least one scope since the last ClearStatistics().
+     */
+    static uint32_t WorkingThreads();
+
+    static void ClearStatistics();
+
+    /**
+     * @brief Start keeping raw events for export.
+     */
+    static void BeginCapture();
+
+    /**
+     * @brief Stop keeping raw events and write them as Chrome trace event JSON.
+     * @return false if the file cannot be written.
+     */
+    static bool EndCapture(const std::string &path);
+
+    static bool IsCapturing();
+};
+
+/**
+ * @brief RAII helper around Tracer::Begin/End.
+ */
+class TraceScope {
+public:
+    explicit TraceScope(const char *name) : active_(Tracer::IsEnabled() && Tracer::Begin(name)) {}
+
+    ~TraceScope() {
+        if (active_) {
+            Tracer::End();
+        }
+    }
+
+    TraceScope(const TraceScope &) = delete;
+
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    bool active_;
+};
+
+}  // namespace vox::utility
+
+#define VOX_TRACE_SCOPE(name) ::vox::utility::TraceScope OPEN3D_CONCAT(__vox_trace_scope_, __LINE__)(name)
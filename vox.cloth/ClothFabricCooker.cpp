@@ -30,7 +30,9 @@
 #include "vox.cloth/NvClothExt/ClothFabricCooker.h"
 
 #include <algorithm>
+#include <vector>
 
+#include "vox.base/parallel.h"
 #include "vox.cloth/ClothClone.h"
 #include "vox.cloth/foundation/PxIO.h"
 #include "vox.cloth/foundation/PxStrideIterator.h"
@@ -140,22 +142,25 @@ void gatherAdjacencies(nv::cloth::Vector<PxU32>::Type& valency,
 
 template <typename T>
 void gatherTriangles(nv::cloth::Vector<PxU32>::Type& indices, const BoundedData& triangles, const BoundedData& quads) {
-    indices.reserve(triangles.count * 3 + quads.count * 6);
-
-    PxStrideIterator<const T> tIt, qIt;
-    tIt = PxMakeIterator(reinterpret_cast<const T*>(triangles.data), triangles.stride);
-    for (PxU32 i = 0; i < triangles.count; ++i, ++tIt, ++qIt) {
-        for (PxU32 j = 0; j < 3; ++j) indices.pushBack(tIt.ptr()[j]);
-    }
-    qIt = PxMakeIterator(reinterpret_cast<const T*>(quads.data), quads.stride);
-    for (PxU32 i = 0; i < quads.count; ++i, ++tIt, ++qIt) {
-        indices.pushBack(qIt.ptr()[0]);
-        indices.pushBack(qIt.ptr()[1]);
-        indices.pushBack(qIt.ptr()[2]);
-        indices.pushBack(qIt.ptr()[2]);
-        indices.pushBack(qIt.ptr()[3]);
-        indices.pushBack(qIt.ptr()[0]);
-    }
+    indices.resize(triangles.count * 3 + quads.count * 6);
+
+    const auto* tData = reinterpret_cast<const PxU8*>(triangles.data);
+    vox::utility::ParallelFor(0, triangles.count, [&](size_t i) {
+        const T* t = reinterpret_cast<const T*>(tData + i * triangles.stride);
+        for (PxU32 j = 0; j < 3; ++j) indices[PxU32(i * 3 + j)] = t[j];
+    });
+    const auto* qData = reinterpret_cast<const PxU8*>(quads.data);
+    PxU32* qIndices = indices.begin() + triangles.count * 3;
+    vox::utility::ParallelFor(0, quads.count, [&](size_t i) {
+        const T* q = reinterpret_cast<const T*>(qData + i * quads.stride);
+        PxU32* dest = qIndices + i * 6;
+        dest[0] = q[0];
+        dest[1] = q[1];
+        dest[2] = q[2];
+        dest[3] = q[2];
+        dest[4] = q[3];
+        dest[5] = q[0];
+    });
 }
 
 struct Edge {
@@ -260,6 +265,53 @@ public:
     PxU32* constraints;
 };
 
+// classify the 1-ring and 2-ring edges from particle i to the particles with a larger index.
+// Every edge used to be visited from both of its ends, the contributions are symmetric so the
+// classification is the same when summing them from the lower end only.
+void classifyEdges(PxU32 i,
+                   const nv::cloth::Vector<PxVec4>::Type& particles,
+                   const nv::cloth::Vector<PxU32>::Type& valency,
+                   const nv::cloth::Vector<PxU32>::Type& neighbors,
+                   std::vector<std::pair<PxU32, Edge>>& edges) {
+    edges.clear();
+    auto find = [&edges](PxU32 k) -> Edge& {
+        for (auto& edge : edges) {
+            if (edge.first == k) return edge.second;
+        }
+        edges.emplace_back(k, Edge());
+        return edges.back().second;
+    };
+
+    PxReal wi = particles[i].w;
+    // iterate all neighbors
+    PxU32 jlast = valency[i + 1];
+    for (PxU32 j = valency[i]; j < jlast; ++j) {
+        // add 1-ring edge
+        PxU32 m = neighbors[j];
+        if (m > i && wi + particles[m].w > 0.0f) find(m).classify();
+
+        // iterate all neighbors of neighbor
+        PxU32 klast = valency[m + 1];
+        for (PxU32 k = valency[m]; k < klast; ++k) {
+            PxU32 n = neighbors[k];
+            if (n > i && wi + particles[n].w > 0.0f) {
+                // add 2-ring edge
+                find(n).classify(particles[i], particles[m], particles[n]);
+            }
+        }
+    }
+
+    std::sort(edges.begin(), edges.end(),
+              [](const std::pair<PxU32, Edge>& a, const std::pair<PxU32, Edge>& b) { return a.first < b.first; });
+}
+
+// color set created while coloring the constraints of one phase type
+struct ColorSet {
+    PxU32 seed;   // constraint the flood that created this color started from
+    PxU32 order;  // creation order among the colors of the same type
+    PxU32 size;   // number of constraints
+};
+
 }  // anonymous namespace
 
 bool FabricCookerImpl::cook(const ClothMeshDesc& desc, PxVec3 gravity, bool useGeodesicTether) {
@@ -305,55 +357,47 @@ bool FabricCookerImpl::cook(const ClothMeshDesc& desc, PxVec3 gravity, bool useG
         valency[i] = neighbors.size();
     }
 
-    // build map of unique edges and classify
-    nv::cloth::HashMap<Pair, Edge>::Type edges;
-    for (PxU32 i = 0; i < mNumParticles; ++i) {
-        PxReal wi = particles[i].w;
-        // iterate all neighbors
-        PxU32 jlast = valency[i + 1];
-        for (PxU32 j = valency[i]; j < jlast; ++j) {
-            // add 1-ring edge
-            PxU32 m = neighbors[j];
-            if (wi + particles[m].w > 0.0f) edges[Pair(PxMin(i, m), PxMax(i, m))].classify();
-
-            // iterate all neighbors of neighbor
-            PxU32 klast = valency[m + 1];
-            for (PxU32 k = valency[m]; k < klast; ++k) {
-                PxU32 n = neighbors[k];
-                if (n != i && wi + particles[n].w > 0.0f) {
-                    // add 2-ring edge
-                    edges[Pair(PxMin(i, n), PxMax(i, n))].classify(particles[i], particles[m], particles[n]);
+    // classify the unique edges of each particle and copy them to the constraints array, in particle order
+    const PxReal sqrtHalf = PxSqrt(0.4f);
+    typedef std::vector<Entry> EntryVector;
+    EntryVector constraints = vox::utility::ParallelReduce(
+            0, mNumParticles, EntryVector(),
+            [&](size_t begin, size_t end, EntryVector result) {
+                std::vector<std::pair<PxU32, Edge>> edges;
+                for (auto i = PxU32(begin); i < end; ++i) {
+                    classifyEdges(i, particles, valency, neighbors, edges);
+                    for (const auto& e : edges) {
+                        const Edge& edge = e.second;
+                        const Pair pair(i, e.first);
+                        if ((edge.mStretching + edge.mBending + edge.mShearing) > 0.0f) {
+                            ClothFabricPhaseType::Enum type = ClothFabricPhaseType::eINVALID;
+                            if (edge.mBending > PxMax(edge.mStretching, edge.mShearing))
+                                type = ClothFabricPhaseType::eBENDING;
+                            else if (edge.mShearing > PxMax(edge.mStretching, edge.mBending))
+                                type = ClothFabricPhaseType::eSHEARING;
+                            else {
+                                PxVec4 diff = particles[pair.first] - particles[pair.second];
+                                PxReal dot = gravity.dot(reinterpret_cast<const PxVec3&>(diff).getNormalized());
+                                type = fabsf(dot) < sqrtHalf ? ClothFabricPhaseType::eHORIZONTAL
+                                                             : ClothFabricPhaseType::eVERTICAL;
+                            }
+                            result.push_back(Entry(pair, type));
+                        }
+                    }
                 }
-            }
-        }
-    }
+                return result;
+            },
+            [](EntryVector a, const EntryVector& b) {
+                a.insert(a.end(), b.begin(), b.end());
+                return a;
+            });
 
-    // copy classified edges to constraints array
     // build histogram of constraints per vertex
-    nv::cloth::Vector<Entry>::Type constraints;
-    constraints.reserve(edges.size());
     valency.resize(0);
     valency.resize(mNumParticles + 1, 0);
-
-    const PxReal sqrtHalf = PxSqrt(0.4f);
-    for (nv::cloth::HashMap<Pair, Edge>::Type::Iterator eIt = edges.getIterator(); !eIt.done(); ++eIt) {
-        const Edge& edge = eIt->second;
-        const Pair& pair = eIt->first;
-        if ((edge.mStretching + edge.mBending + edge.mShearing) > 0.0f) {
-            ClothFabricPhaseType::Enum type = ClothFabricPhaseType::eINVALID;
-            if (edge.mBending > PxMax(edge.mStretching, edge.mShearing))
-                type = ClothFabricPhaseType::eBENDING;
-            else if (edge.mShearing > PxMax(edge.mStretching, edge.mBending))
-                type = ClothFabricPhaseType::eSHEARING;
-            else {
-                PxVec4 diff = particles[pair.first] - particles[pair.second];
-                PxReal dot = gravity.dot(reinterpret_cast<const PxVec3&>(diff).getNormalized());
-                type = fabsf(dot) < sqrtHalf ? ClothFabricPhaseType::eHORIZONTAL : ClothFabricPhaseType::eVERTICAL;
-            }
-            ++valency[pair.first];
-            ++valency[pair.second];
-            constraints.pushBack(Entry(pair, type));
-        }
+    for (const Entry& entry : constraints) {
+        ++valency[entry.first.first];
+        ++valency[entry.first.second];
     }
 
     prefixSum(valency.begin(), valency.end(), valency.begin());
@@ -371,67 +415,104 @@ bool FabricCookerImpl::cook(const ClothMeshDesc& desc, PxVec3 gravity, bool useG
     nv::cloth::Vector<PxU32>::Type::ConstIterator aFirst = adjacencies.begin();
     nv::cloth::Vector<PxU32>::Type colors(numConstraints,
                                           numConstraints);  // constraint -> color, initialily not colored
-    mark.resize(0);
-    mark.resize(numConstraints + 1, PX_MAX_U32);                      // color -> constraint index
     nv::cloth::Vector<PxU32>::Type adjColorCount(numConstraints, 0);  // # of neighbors that are already colored
 
-    nv::cloth::Vector<ConstraintGraphColorCount>::Type constraintHeap;
-    constraintHeap.reserve(numConstraints);  // set of constraints to color (added in edge distance order)
+    // constraints of each phase type in index order, the seeds of the floods below
+    std::vector<PxU32> typeConstraints[ClothFabricPhaseType::eCOUNT];
+    for (PxU32 i = 0; i < numConstraints; ++i) typeConstraints[constraints[i].second].push_back(i);
 
     // Do graph coloring based on edge distance.
     // For each constraint, we add its uncolored neighbors to the heap
     // ,and we pick the constraint with most colored neighbors from the heap.
-    for (;;) {
-        PxU32 constraint = 0;
-        while ((constraint < numConstraints) && (colors[constraint] != numConstraints))
-            constraint++;  // start with the first uncolored constraint
-
-        if (constraint >= numConstraints) break;
-
-        constraintHeap.clear();
-        pushHeap(constraintHeap, ConstraintGraphColorCount(constraint, adjColorCount[constraint]));
-        ClothFabricPhaseType::Enum type = constraints[constraint].second;
-
-        while (!constraintHeap.empty()) {
-            auto heapItem = popHeap<ConstraintGraphColorCount>(constraintHeap);
-            constraint = heapItem.constraint;
-            if (colors[constraint] != numConstraints) continue;  // skip if already colored
-
-            const Pair& pair = constraints[constraint].first;
-            for (PxU32 j = 0; j < 2; ++j) {
-                PxU32 index = j ? pair.first : pair.second;
-                if (particles[index].w == 0.0f) continue;  // don't mark adjacent particles if attached
-
-                for (nv::cloth::Vector<PxU32>::Type::ConstIterator aIt = aFirst + valency[index],
-                                                                   aEnd = aFirst + valency[index + 1];
-                     aIt != aEnd; ++aIt) {
-                    PxU32 adjacentConstraint = *aIt;
-                    if ((constraints[adjacentConstraint].second != type) || (adjacentConstraint == constraint))
-                        continue;
-
-                    mark[colors[adjacentConstraint]] = constraint;
-                    ++adjColorCount[adjacentConstraint];
-                    pushHeap(constraintHeap,
-                             ConstraintGraphColorCount(adjacentConstraint, adjColorCount[adjacentConstraint]));
+    // A flood only visits and colors constraints of its own type, so the types are colored in parallel,
+    // with colors local to the type.
+    std::vector<ColorSet> typeColors[ClothFabricPhaseType::eCOUNT];
+    vox::utility::ParallelFor(
+            0, ClothFabricPhaseType::eCOUNT,
+            [&](size_t t) {
+                const auto type = ClothFabricPhaseType::Enum(t);
+                const std::vector<PxU32>& seeds = typeConstraints[t];
+                std::vector<ColorSet>& colorSets = typeColors[t];
+
+                // color -> constraint index, the last entry is marked for uncolored neighbors
+                std::vector<PxU32> mark(seeds.size() + 1, PX_MAX_U32);
+                const auto uncolored = PxU32(seeds.size());
+
+                // set of constraints to color (added in edge distance order)
+                nv::cloth::Vector<ConstraintGraphColorCount>::Type constraintHeap;
+
+                for (PxU32 seed : seeds) {
+                    if (colors[seed] != numConstraints) continue;  // start with the first uncolored constraint
+
+                    constraintHeap.clear();
+                    pushHeap(constraintHeap, ConstraintGraphColorCount(seed, adjColorCount[seed]));
+
+                    while (!constraintHeap.empty()) {
+                        auto heapItem = popHeap<ConstraintGraphColorCount>(constraintHeap);
+                        PxU32 constraint = heapItem.constraint;
+                        if (colors[constraint] != numConstraints) continue;  // skip if already colored
+
+                        const Pair& pair = constraints[constraint].first;
+                        for (PxU32 j = 0; j < 2; ++j) {
+                            PxU32 index = j ? pair.first : pair.second;
+                            if (particles[index].w == 0.0f) continue;  // don't mark adjacent particles if attached
+
+                            for (nv::cloth::Vector<PxU32>::Type::ConstIterator aIt = aFirst + valency[index],
+                                                                               aEnd = aFirst + valency[index + 1];
+                                 aIt != aEnd; ++aIt) {
+                                PxU32 adjacentConstraint = *aIt;
+                                if ((constraints[adjacentConstraint].second != type) ||
+                                    (adjacentConstraint == constraint))
+                                    continue;
+
+                                PxU32 adjacentColor = colors[adjacentConstraint];
+                                mark[adjacentColor == numConstraints ? uncolored : adjacentColor] = constraint;
+                                ++adjColorCount[adjacentConstraint];
+                                pushHeap(constraintHeap, ConstraintGraphColorCount(adjacentConstraint,
+                                                                                   adjColorCount[adjacentConstraint]));
+                            }
+                        }
+
+                        // find smallest color
+                        PxU32 color = 0;
+                        while (color < colorSets.size() && mark[color] == constraint) ++color;
+
+                        // create a new color set
+                        if (color == colorSets.size()) colorSets.push_back(ColorSet{seed, color, 0});
+
+                        colors[constraint] = color;
+                        ++colorSets[color].size;
+                    }
                 }
-            }
-
-            // find smallest color with matching type
-            PxU32 color = 0;
-            while ((color < mPhaseSetIndices.size() && mPhaseTypes[color] != type) || mark[color] == constraint)
-                ++color;
-
-            // create a new color set
-            if (color == mPhaseSetIndices.size()) {
-                mPhaseSetIndices.pushBack(mPhaseSetIndices.size());
-                mPhaseTypes.pushBack(type);
-                mSets.pushBack(0);
-            }
-
-            colors[constraint] = color;
-            ++mSets[color];
-        }
+            },
+            1);
+
+    // number the colors in the order a single flood over all types creates them,
+    // the floods are started from the first uncolored constraint
+    struct GlobalColor {
+        ColorSet set;
+        ClothFabricPhaseType::Enum type;
+    };
+    std::vector<GlobalColor> globalColors;
+    for (PxU32 t = 0; t < ClothFabricPhaseType::eCOUNT; ++t) {
+        for (const ColorSet& set : typeColors[t])
+            globalColors.push_back(GlobalColor{set, ClothFabricPhaseType::Enum(t)});
+    }
+    std::sort(globalColors.begin(), globalColors.end(), [](const GlobalColor& a, const GlobalColor& b) {
+        return a.set.seed == b.set.seed ? a.set.order < b.set.order : a.set.seed < b.set.seed;
+    });
+
+    std::vector<PxU32> typeColorBase[ClothFabricPhaseType::eCOUNT];
+    for (PxU32 t = 0; t < ClothFabricPhaseType::eCOUNT; ++t) typeColorBase[t].resize(typeColors[t].size());
+    for (const GlobalColor& color : globalColors) {
+        typeColorBase[color.type][color.set.order] = mPhaseSetIndices.size();
+        mPhaseSetIndices.pushBack(mPhaseSetIndices.size());
+        mPhaseTypes.pushBack(color.type);
+        mSets.pushBack(color.set.size);
     }
+    vox::utility::ParallelFor(0, numConstraints, [&](size_t i) {
+        colors[PxU32(i)] = typeColorBase[constraints[i].second][colors[PxU32(i)]];
+    });
 
 #if 0  // PX_DEBUG
 	printf("set[%u] = ", mSets.size());
@@ -469,24 +550,24 @@ bool FabricCookerImpl::cook(const ClothMeshDesc& desc, PxVec3 gravity, bool useG
     nv::cloth::Vector<PxF32>::Type newRestValues(mRestvalues.size());
 
     // sort each constraint set in vertex order
-    for (PxU32 i = 0; i < mSets.size() - 1; ++i) {
+    vox::utility::ParallelFor(0, mSets.size() - 1, [&](size_t i) {
         // create a re-ordering list
-        nv::cloth::Vector<PxU32>::Type reorder(mSets[i + 1] - mSets[i]);
+        std::vector<PxU32> reorder(mSets[PxU32(i + 1)] - mSets[PxU32(i)]);
 
         for (PxU32 r = 0; r < reorder.size(); ++r) reorder[r] = r;
 
-        const PxU32 indicesOffset = mSets[i] * 2;
-        const PxU32 restOffset = mSets[i];
+        const PxU32 indicesOffset = mSets[PxU32(i)] * 2;
+        const PxU32 restOffset = mSets[PxU32(i)];
 
         ConstraintSorter predicate(&mIndices[indicesOffset]);
-        ps::sort(&reorder[0], reorder.size(), predicate, nv::cloth::ps::NonTrackingAllocator());
+        std::sort(reorder.begin(), reorder.end(), predicate);
 
         for (PxU32 r = 0; r < reorder.size(); ++r) {
             newIndices[indicesOffset + r * 2] = mIndices[indicesOffset + reorder[r] * 2];
             newIndices[indicesOffset + r * 2 + 1] = mIndices[indicesOffset + reorder[r] * 2 + 1];
             newRestValues[restOffset + r] = mRestvalues[restOffset + reorder[r]];
         }
-    }
+    });
 
     mIndices = newIndices;
     mRestvalues = newRestValues;
@@ -499,13 +580,13 @@ bool FabricCookerImpl::cook(const ClothMeshDesc& desc, PxVec3 gravity, bool useG
         mStiffnessValues.resize(mIndices.size() >> 1);
         PxStrideIterator<const PxReal> stIt(reinterpret_cast<const PxReal*>(desc.pointsStiffness.data),
                                             desc.pointsStiffness.stride);
-        for (int i = 0; i < static_cast<int>(mIndices.size()); i += 2) {
-            physx::PxU32 indexA = mIndices[i];
-            physx::PxU32 indexB = mIndices[i + 1];
+        vox::utility::ParallelFor(0, mStiffnessValues.size(), [&](size_t i) {
+            physx::PxU32 indexA = mIndices[PxU32(i * 2)];
+            physx::PxU32 indexB = mIndices[PxU32(i * 2 + 1)];
 
             // Uses min instead of average to get better bending constraints
-            mStiffnessValues[i >> 1] = safeLog2(1.0f - std::min(stIt[indexA], stIt[indexB]));
-        }
+            mStiffnessValues[PxU32(i)] = safeLog2(1.0f - std::min(stIt[indexA], stIt[indexB]));
+        });
     }
 
 #if 0  // PX_DEBUG
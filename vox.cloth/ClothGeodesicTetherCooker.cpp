@@ -27,6 +27,7 @@
 // Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
 // Copyright (c) 2001-2004 NovodeX AG. All rights reserved.
 
+#include "vox.base/parallel.h"
 #include "vox.cloth/foundation/PxMemory.h"
 #include "vox.cloth/foundation/PxStrideIterator.h"
 #include "vox.cloth/foundation/PxVec4.h"
@@ -180,6 +181,7 @@ public:
 
 //---------------------------------------------------------------------------------------
 struct VertTriangle {
+    VertTriangle() = default;
     VertTriangle(int vert, int triangle) : mVertIndex(vert), mTriangleIndex(triangle) {}
 
     bool operator<(const VertTriangle& vt) const {
@@ -192,6 +194,7 @@ struct VertTriangle {
 
 // ---------------------------------------------------------------------------------------
 struct MeshEdge {
+    MeshEdge() = default;
     MeshEdge(int v0, int v1, int halfEdgeIndex) : mFromVertIndex(v0), mToVertIndex(v1), mHalfEdgeIndex(halfEdgeIndex) {
         if (mFromVertIndex > mToVertIndex) ps::swap(mFromVertIndex, mToVertIndex);
     }
@@ -282,9 +285,9 @@ public:
 
 protected:
     void createTetherData(const ClothMeshDesc& desc);
-    int computeVertexIntersection(PxU32 parent, PxU32 src, PathIntersection& path);
-    int computeEdgeIntersection(PxU32 parent, PxU32 edge, float in_s, PathIntersection& path);
-    float computeGeodesicDistance(PxU32 i, PxU32 parent, int& errorCode);
+    int computeVertexIntersection(PxU32 parent, PxU32 src, PathIntersection& path) const;
+    int computeEdgeIntersection(PxU32 parent, PxU32 edge, float in_s, PathIntersection& path) const;
+    float computeGeodesicDistance(PxU32 i, PxU32 parent, int& errorCode) const;
     PxU32 findTriNeighbors();
     void findVertTriNeighbors();
 
@@ -418,59 +421,61 @@ void ClothGeodesicTetherCooker::createTetherData(const ClothMeshDesc& desc) {
 
     nv::cloth::Vector<float>::Type vertexDistanceBuffer(bufferSize, PX_MAX_F32);
     nv::cloth::Vector<PxU32>::Type vertexParentBuffer(bufferSize, 0);
-    nv::cloth::Vector<VertexDistanceCount>::Type vertexHeap;
-
-    // now process each island
-    for (PxU32 i = 0; i < islandCnt; i++) {
-        vertexHeap.clear();
-        float* vertexDistance = &vertexDistanceBuffer[0] + (i * mNumParticles);
-        PxU32* vertexParent = &vertexParentBuffer[0] + (i * mNumParticles);
-
-        // initialize parent and distance
-        for (PxU32 j = 0; j < mNumParticles; ++j) {
-            vertexParent[j] = j;
-            vertexDistance[j] = PX_MAX_F32;
-        }
-
-        // put all the attached vertices in this island to heap
-        const PxU32 beginIsland = islandFirst[i];
-        const PxU32 endIsland = islandFirst[i + 1];
-        for (PxU32 j = beginIsland; j < endIsland; j++) {
-            PxU32 vj = islandIndices[j];
-            vertexDistance[vj] = 0.0f;
-            vertexHeap.pushBack(VertexDistanceCount(int(vj), 0.0f, 0));
-        }
-
-        // no attached vertices in this island (error?)
-        NV_CLOTH_ASSERT(vertexHeap.empty() == false);
-        if (vertexHeap.empty()) continue;
-
-        // while heap is not empty
-        while (!vertexHeap.empty()) {
-            // pop vi from heap
-            auto vi = popHeap<VertexDistanceCount>(vertexHeap);
 
-            // obsolete entry ( we already found better distance)
-            if (vi.distance > vertexDistance[vi.vertNr]) continue;
-
-            // for each adjacent vj that's not visited
-            const auto begin = PxI32(valency[PxU32(vi.vertNr)]);
-            const auto end = PxI32(valency[PxU32(vi.vertNr + 1)]);
-            for (PxI32 j = begin; j < end; ++j) {
-                const auto vj = PxI32(neighbors[PxU32(j)]);
-                PxVec3 edge = mVertices[PxU32(vj)] - mVertices[PxU32(vi.vertNr)];
-                const PxF32 edgeLength = edge.magnitude();
-                float newDistance = vi.distance + edgeLength;
+    // now process each island, the islands only write their own distances and parents
+    vox::utility::ParallelFor(
+            0, islandCnt,
+            [&](size_t i) {
+                nv::cloth::Vector<VertexDistanceCount>::Type vertexHeap;
+                float* vertexDistance = &vertexDistanceBuffer[0] + (i * mNumParticles);
+                PxU32* vertexParent = &vertexParentBuffer[0] + (i * mNumParticles);
+
+                // initialize parent and distance
+                for (PxU32 j = 0; j < mNumParticles; ++j) {
+                    vertexParent[j] = j;
+                    vertexDistance[j] = PX_MAX_F32;
+                }
 
-                if (newDistance < vertexDistance[vj]) {
-                    vertexDistance[vj] = newDistance;
-                    vertexParent[vj] = vertexParent[vi.vertNr];
+                // put all the attached vertices in this island to heap
+                const PxU32 beginIsland = islandFirst[PxU32(i)];
+                const PxU32 endIsland = islandFirst[PxU32(i + 1)];
+                for (PxU32 j = beginIsland; j < endIsland; j++) {
+                    PxU32 vj = islandIndices[j];
+                    vertexDistance[vj] = 0.0f;
+                    vertexHeap.pushBack(VertexDistanceCount(int(vj), 0.0f, 0));
+                }
 
-                    pushHeap(vertexHeap, VertexDistanceCount(vj, newDistance, 0));
+                // no attached vertices in this island (error?)
+                NV_CLOTH_ASSERT(vertexHeap.empty() == false);
+                if (vertexHeap.empty()) return;
+
+                // while heap is not empty
+                while (!vertexHeap.empty()) {
+                    // pop vi from heap
+                    auto vi = popHeap<VertexDistanceCount>(vertexHeap);
+
+                    // obsolete entry ( we already found better distance)
+                    if (vi.distance > vertexDistance[vi.vertNr]) continue;
+
+                    // for each adjacent vj that's not visited
+                    const auto begin = PxI32(valency[PxU32(vi.vertNr)]);
+                    const auto end = PxI32(valency[PxU32(vi.vertNr + 1)]);
+                    for (PxI32 j = begin; j < end; ++j) {
+                        const auto vj = PxI32(neighbors[PxU32(j)]);
+                        PxVec3 edge = mVertices[PxU32(vj)] - mVertices[PxU32(vi.vertNr)];
+                        const PxF32 edgeLength = edge.magnitude();
+                        float newDistance = vi.distance + edgeLength;
+
+                        if (newDistance < vertexDistance[vj]) {
+                            vertexDistance[vj] = newDistance;
+                            vertexParent[vj] = vertexParent[vi.vertNr];
+
+                            pushHeap(vertexHeap, VertexDistanceCount(vj, newDistance, 0));
+                        }
+                    }
                 }
-            }
-        }
-    }
+            },
+            1);
 
     const PxU32 maxTethersPerParticle = 4;  // max tethers
     const PxU32 nbTethersPerParticle = (islandCnt > maxTethersPerParticle) ? maxTethersPerParticle : islandCnt;
@@ -479,36 +484,39 @@ void ClothGeodesicTetherCooker::createTetherData(const ClothMeshDesc& desc) {
     mTetherAnchors.resize(nbTethers);
     mTetherLengths.resize(nbTethers);
 
-    // now process the parent and distance and add to fibers
-    for (PxU32 i = 0; i < mNumParticles; i++) {
-        // we use the heap to sort out N-closest island
-        vertexHeap.clear();
-        for (PxU32 j = 0; j < islandCnt; j++) {
-            int parent = int(vertexParentBuffer[j * mNumParticles + i]);
-            float edgeDistance = vertexDistanceBuffer[j * mNumParticles + i];
-            pushHeap(vertexHeap, VertexDistanceCount(parent, edgeDistance, 0));
-        }
-
-        // take out N-closest island from the heap
-        for (PxU32 j = 0; j < nbTethersPerParticle; j++) {
-            auto vi = popHeap<VertexDistanceCount>(vertexHeap);
-            auto parent = PxU32(vi.vertNr);
-            float distance = 0.0f;
-
-            if (parent != i) {
-                float euclideanDistance = (mVertices[i] - mVertices[parent]).magnitude();
-                float dijkstraDistance = vi.distance;
-                int errorCode = 0;
-                float geodesicDistance = computeGeodesicDistance(i, parent, errorCode);
-                if (errorCode < 0) geodesicDistance = dijkstraDistance;
-                distance = PxMax(euclideanDistance, geodesicDistance);
+    // now process the parent and distance and add to fibers, the geodesic paths of the particles are independent
+    vox::utility::ParallelForRange(0, mNumParticles, [&](size_t first, size_t last) {
+        nv::cloth::Vector<VertexDistanceCount>::Type vertexHeap;
+        for (auto i = PxU32(first); i < last; i++) {
+            // we use the heap to sort out N-closest island
+            vertexHeap.clear();
+            for (PxU32 j = 0; j < islandCnt; j++) {
+                int parent = int(vertexParentBuffer[j * mNumParticles + i]);
+                float edgeDistance = vertexDistanceBuffer[j * mNumParticles + i];
+                pushHeap(vertexHeap, VertexDistanceCount(parent, edgeDistance, 0));
             }
 
-            PxU32 tetherLoc = j * mNumParticles + i;
-            mTetherAnchors[tetherLoc] = parent;
-            mTetherLengths[tetherLoc] = distance;
+            // take out N-closest island from the heap
+            for (PxU32 j = 0; j < nbTethersPerParticle; j++) {
+                auto vi = popHeap<VertexDistanceCount>(vertexHeap);
+                auto parent = PxU32(vi.vertNr);
+                float distance = 0.0f;
+
+                if (parent != i) {
+                    float euclideanDistance = (mVertices[i] - mVertices[parent]).magnitude();
+                    float dijkstraDistance = vi.distance;
+                    int errorCode = 0;
+                    float geodesicDistance = computeGeodesicDistance(i, parent, errorCode);
+                    if (errorCode < 0) geodesicDistance = dijkstraDistance;
+                    distance = PxMax(euclideanDistance, geodesicDistance);
+                }
+
+                PxU32 tetherLoc = j * mNumParticles + i;
+                mTetherAnchors[tetherLoc] = parent;
+                mTetherLengths[tetherLoc] = distance;
+            }
         }
-    }
+    });
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -541,7 +549,7 @@ PxU32 ClothGeodesicTetherCooker::findTriNeighbors() {
         edges.pushBack(MeshEdge(int(i2), int(i0), int(3 * i + 2)));
     }
 
-    ps::sort(edges.begin(), edges.size(), ps::Less<MeshEdge>(), ps::NonTrackingAllocator());
+    vox::utility::ParallelSort(edges.begin(), edges.end());
 
     int numEdges = int(edges.size());
     for (int i = 0; i < numEdges;) {
@@ -580,7 +588,7 @@ void ClothGeodesicTetherCooker::findVertTriNeighbors() {
         vertTriangles.pushBack(VertTriangle(int(mIndices[PxU32(3 * i + 2)]), i));
     }
 
-    ps::sort(vertTriangles.begin(), vertTriangles.size(), ps::Less<VertTriangle>(), ps::NonTrackingAllocator());
+    vox::utility::ParallelSort(vertTriangles.begin(), vertTriangles.end());
     mFirstVertTriAdj.resize(mNumParticles);
     mVertTriAdjs.reserve(mIndices.size());
 
@@ -599,7 +607,7 @@ void ClothGeodesicTetherCooker::findVertTriNeighbors() {
 
 ///////////////////////////////////////////////////////////////////////////////
 // compute intersection of a ray from a source vertex in direction toward parent
-int ClothGeodesicTetherCooker::computeVertexIntersection(PxU32 parent, PxU32 src, PathIntersection& path) {
+int ClothGeodesicTetherCooker::computeVertexIntersection(PxU32 parent, PxU32 src, PathIntersection& path) const {
     if (src == parent) {
         path = PathIntersection(true, src, 0.0);
         return 0;
@@ -709,7 +717,10 @@ int ClothGeodesicTetherCooker::computeVertexIntersection(PxU32 parent, PxU32 src
 
 ///////////////////////////////////////////////////////////////////////////////
 // compute intersection of a ray from a source vertex in direction toward parent
-int ClothGeodesicTetherCooker::computeEdgeIntersection(PxU32 parent, PxU32 edge, float in_s, PathIntersection& path) {
+int ClothGeodesicTetherCooker::computeEdgeIntersection(PxU32 parent,
+                                                       PxU32 edge,
+                                                       float in_s,
+                                                       PathIntersection& path) const {
     int tid = int(edge / 3);
     int eid = int(edge % 3);
 
@@ -810,7 +821,7 @@ int ClothGeodesicTetherCooker::computeEdgeIntersection(PxU32 parent, PxU32 edge,
 
 ///////////////////////////////////////////////////////////////////////////////
 // compute geodesic distance and path from vertex i to its parent
-float ClothGeodesicTetherCooker::computeGeodesicDistance(PxU32 i, PxU32 parent, int& errorCode) {
+float ClothGeodesicTetherCooker::computeGeodesicDistance(PxU32 i, PxU32 parent, int& errorCode) const {
     if (i == parent) return 0.0f;
 
     PathIntersection path;
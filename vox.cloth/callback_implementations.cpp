@@ -8,6 +8,8 @@
 
 #include <iostream>
 
+#include "vox.base/tracer.h"
+
 namespace vox::cloth {
 NvClothEnvironment *NvClothEnvironment::s_env_ = nullptr;
 
@@ -34,4 +36,18 @@ void ErrorCallback::reportError(physx::PxErrorCode::Enum code, const char *messa
     std::cout << "Log " << code_name << " from file:" << file << ":" << line << "\n MSG:" << message << std::endl;
 }
 
+void *ProfilerCallback::zoneStart(const char *event_name, bool detached, uint64_t context_id) {
+    // zone names are string literals inside NvCloth, safe to keep by pointer
+    if (detached || !utility::Tracer::IsEnabled() || !utility::Tracer::Begin(event_name)) {
+        return nullptr;
+    }
+    return this;
+}
+
+void ProfilerCallback::zoneEnd(void *profiler_data, const char *event_name, bool detached, uint64_t context_id) {
+    if (profiler_data) {
+        utility::Tracer::End();
+    }
+}
+
 }  // namespace vox::cloth
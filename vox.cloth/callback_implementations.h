@@ -119,6 +119,19 @@ public:
     void reportError(physx::PxErrorCode::Enum code, const char *message, const char *file, int line) override;
 };
 
+/**
+ * Forward NvCloth profile zones to the engine tracer.
+ * Detached zones may end on another thread and are ignored.
+ */
+class ProfilerCallback : public physx::PxProfilerCallback {
+public:
+    ProfilerCallback() = default;
+
+    void *zoneStart(const char *event_name, bool detached, uint64_t context_id) override;
+
+    void zoneEnd(void *profiler_data, const char *event_name, bool detached, uint64_t context_id) override;
+};
+
 class NvClothEnvironment {
     NvClothEnvironment() { SetUp(); }
 
@@ -143,12 +156,14 @@ public:
         m_foundation_allocator_ = new Allocator;
         m_foundation_allocator_->StartTrackingLeaks();
         m_error_callback_ = new ErrorCallback;
-        nv::cloth::InitializeNvCloth(m_allocator_, m_error_callback_, nullptr, nullptr);
+        m_profiler_callback_ = new ProfilerCallback;
+        nv::cloth::InitializeNvCloth(m_allocator_, m_error_callback_, nullptr, m_profiler_callback_);
     }
 
     virtual void TearDown() {
         m_allocator_->StopTrackingLeaksAndReport();
         m_foundation_allocator_->StopTrackingLeaksAndReport();
+        delete m_profiler_callback_;
         delete m_error_callback_;
         delete m_foundation_allocator_;
         delete m_allocator_;
@@ -164,6 +179,7 @@ private:
     Allocator *m_allocator_{};
     Allocator *m_foundation_allocator_{};
     ErrorCallback *m_error_callback_{};
+    ProfilerCallback *m_profiler_callback_{};
 };
 
 }  // namespace vox::cloth
\ No newline at end of file
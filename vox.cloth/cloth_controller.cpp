@@ -6,6 +6,7 @@
 
 #include "vox.cloth/cloth_controller.h"
 
+#include "vox.base/tracer.h"
 #include "vox.cloth/NvClothExt/ClothFabricCooker.h"
 #include "vox.render/camera.h"
 #include "vox.render/entity.h"
@@ -48,6 +49,8 @@ ClothController::~ClothController() {
 
 nv::cloth::Factory *ClothController::Factory() { return factory_; }
 
+ClothFabricCache &ClothController::FabricCache() { return fabric_cache_; }
+
 void ClothController::Update(float delta_time) {
     StartSimulationStep(delta_time);
     WaitForSimulationStep();
@@ -61,18 +64,17 @@ void ClothController::StartSimulationStep(float dt) {
 }
 
 void ClothController::WaitForSimulationStep() {
+    VOX_TRACE_SCOPE("Cloth Simulation Wait");
     for (auto &solver_helper : solver_helpers_) {
         solver_helper.second.WaitForSimulation();
     }
 }
 
 void ClothController::UpdateSimulationGraphics() {
+    VOX_TRACE_SCOPE("Cloth Graphics Update");
     for (auto actor : cloth_list_) {
         nv::cloth::MappedRange<physx::PxVec4> particles = actor->cloth_->getCurrentParticles();
-        std::vector<physx::PxVec3> particles3(particles.size());
-        for (uint32_t i = 0; i < particles.size(); ++i) particles3[i] = particles[i].getXYZ();
-
-        actor->Update(particles3.data(), particles.size());
+        actor->Update(particles.begin(), particles.size());
     }
 }
 
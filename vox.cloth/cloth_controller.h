@@ -8,6 +8,7 @@
 
 #include <map>
 
+#include "vox.cloth/cloth_fabric_cache.h"
 #include "vox.cloth/cloth_renderer.h"
 #include "vox.cloth/job_manager.h"
 #include "vox.cloth/NvCloth/Fabric.h"
@@ -23,6 +24,8 @@ public:
 
     nv::cloth::Factory *Factory();
 
+    ClothFabricCache &FabricCache();
+
     void Update(float delta_time);
 
     void HandlePickingEvent(Camera *main_camera, const InputEvent &input_event);
@@ -63,6 +66,7 @@ private:
 
 private:
     nv::cloth::Factory *factory_{nullptr};
+    ClothFabricCache fabric_cache_;
     std::vector<cloth::ClothRenderer *> cloth_list_;
     std::vector<nv::cloth::Solver *> solver_list_;
     std::map<nv::cloth::Solver *, cloth::MultithreadedSolverHelper> solver_helpers_;
@@ -0,0 +1,238 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.cloth/cloth_fabric_cache.h"
+
+#include <cstdio>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+#include "vox.base/logging.h"
+#include "vox.cloth/NvCloth/Factory.h"
+#include "vox.render/platform/filesystem.h"
+
+namespace vox::cloth {
+namespace {
+constexpr uint32_t kFabricCacheMagic = 0x42414656;  // "VFAB"
+// bumped whenever the file layout or the cooked data of a mesh changes
+constexpr uint32_t kFabricCacheVersion = 1;
+
+// FNV-1a
+class Hasher {
+public:
+    void Add(const void *data, size_t size) {
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash_ ^= bytes[i];
+            hash_ *= 0x100000001b3ull;
+        }
+    }
+
+    template <typename T>
+    void Add(const T &value) {
+        Add(&value, sizeof(T));
+    }
+
+    /// Hashes count elements of element_size bytes, the stride is not part of the hash.
+    void Add(const nv::cloth::StridedData &data, uint32_t count, size_t element_size) {
+        Add(count);
+        const auto *bytes = static_cast<const uint8_t *>(data.data);
+        if (bytes == nullptr) {
+            return;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            Add(bytes + size_t(i) * data.stride, element_size);
+        }
+    }
+
+    [[nodiscard]] uint64_t Get() const { return hash_; }
+
+private:
+    uint64_t hash_{0xcbf29ce484222325ull};
+};
+
+template <typename T>
+void WriteRange(std::ofstream &file, nv::cloth::Range<const T> range) {
+    const auto kCount = static_cast<uint32_t>(range.size());
+    file.write(reinterpret_cast<const char *>(&kCount), sizeof(kCount));
+    file.write(reinterpret_cast<const char *>(range.begin()), std::streamsize(kCount * sizeof(T)));
+}
+
+template <typename T>
+bool ReadVector(std::ifstream &file, size_t file_size, std::vector<T> &vector) {
+    uint32_t count = 0;
+    file.read(reinterpret_cast<char *>(&count), sizeof(count));
+    if (!file || size_t(count) * sizeof(T) > file_size) {
+        return false;
+    }
+    vector.resize(count);
+    file.read(reinterpret_cast<char *>(vector.data()), std::streamsize(count * sizeof(T)));
+    return bool(file);
+}
+
+template <typename T>
+nv::cloth::Range<const T> CreateRange(const std::vector<T> &vector) {
+    return nv::cloth::Range<const T>(vector.data(), vector.data() + vector.size());
+}
+
+/// Cooked data read back from a cache file.
+struct CachedFabric {
+    uint32_t num_particles{0};
+    std::vector<uint32_t> phase_indices;
+    std::vector<int32_t> phase_types;
+    std::vector<uint32_t> sets;
+    std::vector<float> rest_values;
+    std::vector<float> stiffness_values;
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> anchors;
+    std::vector<float> tether_lengths;
+    std::vector<uint32_t> triangles;
+
+    bool Read(const std::string &filename, uint64_t hash) {
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        if (!file) {
+            return false;
+        }
+        const auto kFileSize = static_cast<size_t>(file.tellg());
+        file.seekg(0);
+
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint64_t file_hash = 0;
+        file.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+        file.read(reinterpret_cast<char *>(&version), sizeof(version));
+        file.read(reinterpret_cast<char *>(&file_hash), sizeof(file_hash));
+        file.read(reinterpret_cast<char *>(&num_particles), sizeof(num_particles));
+        if (!file || magic != kFabricCacheMagic || version != kFabricCacheVersion || file_hash != hash) {
+            return false;
+        }
+        return ReadVector(file, kFileSize, phase_indices) && ReadVector(file, kFileSize, phase_types) &&
+               ReadVector(file, kFileSize, sets) && ReadVector(file, kFileSize, rest_values) &&
+               ReadVector(file, kFileSize, stiffness_values) && ReadVector(file, kFileSize, indices) &&
+               ReadVector(file, kFileSize, anchors) && ReadVector(file, kFileSize, tether_lengths) &&
+               ReadVector(file, kFileSize, triangles) && phase_indices.size() == phase_types.size() &&
+               indices.size() == rest_values.size() * 2 && anchors.size() == tether_lengths.size();
+    }
+};
+
+bool Write(const std::string &filename, uint64_t hash, const nv::cloth::CookedData &data) {
+    // written next to the cache file and renamed, a cooking interrupted halfway leaves no partial file
+    const std::string kTempFilename = filename + ".tmp";
+    {
+        std::ofstream file(kTempFilename, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char *>(&kFabricCacheMagic), sizeof(kFabricCacheMagic));
+        file.write(reinterpret_cast<const char *>(&kFabricCacheVersion), sizeof(kFabricCacheVersion));
+        file.write(reinterpret_cast<const char *>(&hash), sizeof(hash));
+        file.write(reinterpret_cast<const char *>(&data.mNumParticles), sizeof(data.mNumParticles));
+        WriteRange(file, data.mPhaseIndices);
+        WriteRange(file, data.mPhaseTypes);
+        WriteRange(file, data.mSets);
+        WriteRange(file, data.mRestvalues);
+        WriteRange(file, data.mStiffnessValues);
+        WriteRange(file, data.mIndices);
+        WriteRange(file, data.mAnchors);
+        WriteRange(file, data.mTetherLengths);
+        WriteRange(file, data.mTriangles);
+        if (!file) {
+            return false;
+        }
+    }
+    std::remove(filename.c_str());
+    return std::rename(kTempFilename.c_str(), filename.c_str()) == 0;
+}
+
+void CopyPhaseTypes(nv::cloth::Range<const int32_t> types, nv::cloth::Vector<int32_t>::Type *phase_types) {
+    if (phase_types) {
+        phase_types->resize(types.size());
+        for (uint32_t i = 0; i < types.size(); i++) {
+            (*phase_types)[i] = types[i];
+        }
+    }
+}
+
+}  // namespace
+
+ClothFabricCache::ClothFabricCache(std::string folder) : folder_(std::move(folder)) {
+    if (!folder_.empty() && folder_.back() != '/') {
+        folder_ += '/';
+    }
+}
+
+uint64_t ClothFabricCache::Hash(const nv::cloth::ClothMeshDesc &desc,
+                                const physx::PxVec3 &gravity,
+                                bool use_geodesic_tether) {
+    const size_t kIndexSize = (desc.flags & nv::cloth::MeshFlag::e16_BIT_INDICES) ? sizeof(physx::PxU16)
+                                                                                  : sizeof(physx::PxU32);
+    Hasher hasher;
+    hasher.Add(kFabricCacheVersion);
+    hasher.Add(desc.flags);
+    hasher.Add(desc.points, desc.points.count, sizeof(physx::PxVec3));
+    hasher.Add(desc.invMasses, desc.invMasses.count, sizeof(physx::PxReal));
+    hasher.Add(desc.pointsStiffness, desc.pointsStiffness.count, sizeof(physx::PxReal));
+    hasher.Add(desc.triangles, desc.triangles.count, 3 * kIndexSize);
+    hasher.Add(desc.quads, desc.quads.count, 4 * kIndexSize);
+    hasher.Add(gravity.x);
+    hasher.Add(gravity.y);
+    hasher.Add(gravity.z);
+    hasher.Add(use_geodesic_tether);
+    return hasher.Get();
+}
+
+std::string ClothFabricCache::CacheFile(uint64_t hash) {
+    if (folder_.empty()) {
+        fs::CreatePath(fs::path::Get(fs::path::Type::STORAGE), "fabrics/");
+        folder_ = fs::path::Get(fs::path::Type::STORAGE, "fabrics/");
+    }
+    return fmt::format("{}{:016x}.fabric", folder_, hash);
+}
+
+size_t ClothFabricCache::HitCount() const { return hit_count_; }
+
+size_t ClothFabricCache::MissCount() const { return miss_count_; }
+
+nv::cloth::Fabric *ClothFabricCache::CookFabricFromMesh(nv::cloth::Factory *factory,
+                                                        const nv::cloth::ClothMeshDesc &desc,
+                                                        const physx::PxVec3 &gravity,
+                                                        nv::cloth::Vector<int32_t>::Type *phase_types,
+                                                        bool use_geodesic_tether) {
+    const uint64_t kHash = Hash(desc, gravity, use_geodesic_tether);
+    const std::string kFilename = CacheFile(kHash);
+
+    CachedFabric cached;
+    if (cached.Read(kFilename, kHash)) {
+        hit_count_++;
+        CopyPhaseTypes(CreateRange(cached.phase_types), phase_types);
+        return factory->createFabric(cached.num_particles, CreateRange(cached.phase_indices), CreateRange(cached.sets),
+                                     CreateRange(cached.rest_values), CreateRange(cached.stiffness_values),
+                                     CreateRange(cached.indices), CreateRange(cached.anchors),
+                                     CreateRange(cached.tether_lengths), CreateRange(cached.triangles));
+    }
+
+    miss_count_++;
+    nv::cloth::ClothFabricCooker *cooker = NvClothCreateFabricCooker();
+    if (!cooker->cook(desc, gravity, use_geodesic_tether)) {
+        NV_CLOTH_DELETE(cooker);
+        return nullptr;
+    }
+
+    nv::cloth::CookedData data = cooker->getCookedData();
+    if (!Write(kFilename, kHash, data)) {
+        LOGW("Failed to write the cooked fabric {}", kFilename)
+    }
+
+    CopyPhaseTypes(data.mPhaseTypes, phase_types);
+    auto *fabric = factory->createFabric(data.mNumParticles, data.mPhaseIndices, data.mSets, data.mRestvalues,
+                                         data.mStiffnessValues, data.mIndices, data.mAnchors, data.mTetherLengths,
+                                         data.mTriangles);
+    NV_CLOTH_DELETE(cooker);
+    return fabric;
+}
+
+}  // namespace vox::cloth
@@ -0,0 +1,52 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <string>
+
+#include "vox.cloth/NvClothExt/ClothFabricCooker.h"
+
+namespace vox::cloth {
+/**
+ * @brief Cooked fabrics stored on disk, keyed by the hash of the mesh and the cooking parameters.
+ *        A mesh that did not change since it was last cooked loads its CookedData instead of being cooked again.
+ */
+class ClothFabricCache {
+public:
+    /**
+     * @param folder Folder of the cache files, the fabrics folder of the storage path when empty, which is resolved on
+     * first use so the cache can be created before the platform
+     */
+    explicit ClothFabricCache(std::string folder = "");
+
+    /**
+     * @brief Same as NvClothCookFabricFromMesh, the mesh is only cooked when it is not in the cache.
+     */
+    nv::cloth::Fabric *CookFabricFromMesh(nv::cloth::Factory *factory,
+                                          const nv::cloth::ClothMeshDesc &desc,
+                                          const physx::PxVec3 &gravity,
+                                          nv::cloth::Vector<int32_t>::Type *phase_types = nullptr,
+                                          bool use_geodesic_tether = true);
+
+    /**
+     * @brief Hash of everything the cooked data depends on.
+     */
+    static uint64_t Hash(const nv::cloth::ClothMeshDesc &desc, const physx::PxVec3 &gravity, bool use_geodesic_tether);
+
+    [[nodiscard]] size_t HitCount() const;
+
+    [[nodiscard]] size_t MissCount() const;
+
+private:
+    std::string CacheFile(uint64_t hash);
+
+    std::string folder_;
+    size_t hit_count_{0};
+    size_t miss_count_{0};
+};
+
+}  // namespace vox::cloth
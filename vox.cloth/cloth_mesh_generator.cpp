@@ -21,6 +21,7 @@ std::vector<T> ReadValuesFromFile(const std::string &path) {
 
 void ClothMeshData::Clear() {
     m_vertices.clear();
+    m_uvs.clear();
     m_triangles.clear();
     m_quads.clear();
 }
@@ -49,6 +50,7 @@ void ClothMeshData::GeneratePlaneCloth(float width,
 
     Clear();
     m_vertices.resize((segments_x + 1) * (segments_y + 1));
+    m_uvs.resize((segments_x + 1) * (segments_y + 1));
     m_inv_masses.resize((segments_x + 1) * (segments_y + 1));
     m_triangles.resize(segments_x * segments_y * 2);
     if (create_quads) m_quads.resize(segments_x * segments_y);
@@ -93,9 +95,10 @@ void ClothMeshData::GeneratePlaneCloth(float width,
 
             m_mesh.vertices_[x + y * (segments_x + 1)].normal = transform.transform(physx::PxVec3(0.f, 1.f, 0.f));
 
-            m_mesh.vertices_[x + y * (segments_x + 1)].uv =
-                    physx::PxVec2(uv_ox + uv_sx * (float)x / (float)segments_x,
-                                  uv_oy + uv_sy * (1.0f - (float)y / (float)segments_y));
+            m_uvs[x + y * (segments_x + 1)] = physx::PxVec2(uv_ox + uv_sx * (float)x / (float)segments_x,
+                                                            uv_oy + uv_sy * (1.0f - (float)y / (float)segments_y));
+
+            m_mesh.vertices_[x + y * (segments_x + 1)].uv = m_uvs[x + y * (segments_x + 1)];
         }
     }
 
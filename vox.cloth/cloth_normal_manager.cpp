@@ -0,0 +1,100 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.cloth/cloth_normal_manager.h"
+
+#include "vox.base/parallel.h"
+#include "vox.base/tracer.h"
+#include "vox.render/shader/shader_manager.h"
+#include "vox.render/stats/gpu_profiler.h"
+
+namespace vox {
+namespace cloth {
+ClothNormalManager *ClothNormalManager::GetSingletonPtr() { return ms_singleton; }
+
+ClothNormalManager &ClothNormalManager::GetSingleton() {
+    assert(ms_singleton);
+    return (*ms_singleton);
+}
+
+ClothNormalManager::ClothNormalManager(Device &device, RenderContext &render_context)
+    : shader_data_(device), particles_property_("clothParticles") {
+    particle_buffer_ = std::make_unique<StorageBufferArray>(device, render_context, sizeof(physx::PxVec4), 1024);
+    shader_data_.SetBufferFunctor(particles_property_,
+                                  [this]() -> core::Buffer * { return particle_buffer_->Buffer(); });
+
+    normal_pipeline_ = std::make_unique<PostProcessingPipeline>(render_context, ShaderSource());
+    normal_pass_ = &normal_pipeline_->AddPass<PostProcessingComputePass>(
+            ShaderManager::GetSingleton().LoadShader("base/cloth/cloth_normals.comp"));
+    normal_pass_->SetDebugName("Cloth Normals");
+    normal_pass_->AttachShaderData(&shader_data_);
+}
+
+void ClothNormalManager::AddUpdatedRenderer(ClothRenderer *renderer) {
+    auto iter = std::find(updated_renderers_.begin(), updated_renderers_.end(), renderer);
+    if (iter == updated_renderers_.end()) {
+        updated_renderers_.push_back(renderer);
+    }
+}
+
+void ClothNormalManager::RemoveRenderer(ClothRenderer *renderer) {
+    auto iter = std::find(updated_renderers_.begin(), updated_renderers_.end(), renderer);
+    if (iter != updated_renderers_.end()) {
+        updated_renderers_.erase(iter);
+    }
+}
+
+void ClothNormalManager::Draw(CommandBuffer &command_buffer, RenderTarget &render_target) {
+    VOX_TRACE_SCOPE("Cloth Normals");
+    if (updated_renderers_.empty()) {
+        return;
+    }
+    VOX_GPU_SCOPE(command_buffer, "Cloth Normals", StatIndex::GPU_COMPUTE_TIME);
+
+    particle_offsets_.clear();
+    uint32_t particle_count = 0;
+    for (auto &renderer : updated_renderers_) {
+        particle_offsets_.push_back(particle_count);
+        particle_count += renderer->VertexCount();
+    }
+
+    auto *particles = reinterpret_cast<physx::PxVec4 *>(particle_buffer_->Map(particle_count));
+    utility::ParallelFor(
+            0, updated_renderers_.size(),
+            [&](size_t i) { updated_renderers_[i]->WriteParticles(particles + particle_offsets_[i]); }, 1);
+    particle_buffer_->Flush();
+
+    // the vertex buffers may still be read by the vertex fetch of the previous frame
+    BufferMemoryBarrier barrier{};
+    barrier.src_stage_mask = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    barrier.dst_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    barrier.src_access_mask = 0;
+    barrier.dst_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+    command_buffer.GlobalMemoryBarrier(barrier);
+
+    for (size_t i = 0; i < updated_renderers_.size(); i++) {
+        auto *renderer = updated_renderers_[i];
+        renderer->SetParticleOffset(particle_offsets_[i]);
+
+        normal_pass_->AttachShaderData(&renderer->shader_data_);
+        normal_pass_->SetDispatchSize({(renderer->VertexCount() + normal_group_size_ - 1) / normal_group_size_, 1, 1});
+        normal_pipeline_->Draw(command_buffer, render_target);
+        normal_pass_->DetachShaderData(&renderer->shader_data_);
+    }
+
+    // dispatches write disjoint buffers, a single barrier makes them visible to every following pass
+    barrier.src_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    barrier.dst_stage_mask = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    barrier.src_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dst_access_mask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+    command_buffer.GlobalMemoryBarrier(barrier);
+
+    // vertices keep their content until the particles change again
+    updated_renderers_.clear();
+}
+
+}  // namespace cloth
+}  // namespace vox
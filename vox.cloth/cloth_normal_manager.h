@@ -0,0 +1,62 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include "vox.base/singleton.h"
+#include "vox.cloth/cloth_renderer.h"
+#include "vox.render/rendering/postprocessing_computepass.h"
+#include "vox.render/rendering/postprocessing_pipeline.h"
+#include "vox.render/rendering/storage_buffer_array.h"
+#include "vox.render/shader/shader_data.h"
+
+namespace vox {
+namespace cloth {
+/**
+ * Rebuild the vertices of every ClothRenderer updated during the frame, before the passes which draw them.
+ * The particles of all renderers are packed in one buffer per frame in flight, and each renderer is rebuilt by a
+ * dispatch reading its range of it, so the CPU only copies particles.
+ */
+class ClothNormalManager : public Singleton<ClothNormalManager> {
+public:
+    static constexpr uint32_t normal_group_size_ = 64;
+
+    static ClothNormalManager &GetSingleton();
+
+    static ClothNormalManager *GetSingletonPtr();
+
+    ClothNormalManager(Device &device, RenderContext &render_context);
+
+    /**
+     * Rebuild the vertices of the renderer in the next Draw.
+     */
+    void AddUpdatedRenderer(ClothRenderer *renderer);
+
+    void RemoveRenderer(ClothRenderer *renderer);
+
+    /**
+     * Pack the particles and record the dispatches, outside a render pass.
+     */
+    void Draw(CommandBuffer &command_buffer, RenderTarget &render_target);
+
+private:
+    std::vector<ClothRenderer *> updated_renderers_{};
+    std::vector<uint32_t> particle_offsets_{};
+
+    // one particle buffer per frame in flight, the CPU writes one while the GPU reads the others
+    std::unique_ptr<StorageBufferArray> particle_buffer_{nullptr};
+
+    ShaderData shader_data_;
+    const ShaderProperty particles_property_;
+
+    PostProcessingComputePass *normal_pass_{nullptr};
+    std::unique_ptr<PostProcessingPipeline> normal_pipeline_{nullptr};
+};
+
+}  // namespace cloth
+template <>
+inline cloth::ClothNormalManager *Singleton<cloth::ClothNormalManager>::ms_singleton{nullptr};
+}  // namespace vox
@@ -6,6 +6,11 @@
 
 #include "vox.cloth/cloth_renderer.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include "vox.base/parallel.h"
+#include "vox.cloth/cloth_normal_manager.h"
 #include "vox.cloth/foundation/PxStrideIterator.h"
 #include "vox.render/entity.h"
 #include "vox.render/mesh/buffer_mesh.h"
@@ -16,7 +21,7 @@
 namespace vox::cloth {
 namespace {
 template <typename T>
-void GatherIndices(std::vector<uint16_t> &indices,
+void GatherIndices(std::vector<uint32_t> &indices,
                    const nv::cloth::BoundedData &triangles,
                    const nv::cloth::BoundedData &quads) {
     physx::PxStrideIterator<const T> t_it, q_it;
@@ -25,9 +30,9 @@ void GatherIndices(std::vector<uint16_t> &indices,
 
     t_it = physx::PxMakeIterator(reinterpret_cast<const T *>(triangles.data), triangles.stride);
     for (physx::PxU32 i = 0; i < triangles.count; ++i, ++t_it) {
-        indices.push_back(static_cast<uint16_t>(t_it.ptr()[0]));
-        indices.push_back(static_cast<uint16_t>(t_it.ptr()[1]));
-        indices.push_back(static_cast<uint16_t>(t_it.ptr()[2]));
+        indices.push_back(static_cast<uint32_t>(t_it.ptr()[0]));
+        indices.push_back(static_cast<uint32_t>(t_it.ptr()[1]));
+        indices.push_back(static_cast<uint32_t>(t_it.ptr()[2]));
     }
 
     // Only do quads in case there wasn't triangle data provided
@@ -35,30 +40,65 @@ void GatherIndices(std::vector<uint16_t> &indices,
     if (indices.empty()) {
         q_it = physx::PxMakeIterator(reinterpret_cast<const T *>(quads.data), quads.stride);
         for (physx::PxU32 i = 0; i < quads.count; ++i, ++q_it) {
-            indices.push_back(static_cast<uint16_t>(q_it.ptr()[0]));
-            indices.push_back(static_cast<uint16_t>(q_it.ptr()[1]));
-            indices.push_back(static_cast<uint16_t>(q_it.ptr()[2]));
-            indices.push_back(static_cast<uint16_t>(q_it.ptr()[0]));
-            indices.push_back(static_cast<uint16_t>(q_it.ptr()[2]));
-            indices.push_back(static_cast<uint16_t>(q_it.ptr()[3]));
+            indices.push_back(static_cast<uint32_t>(q_it.ptr()[0]));
+            indices.push_back(static_cast<uint32_t>(q_it.ptr()[1]));
+            indices.push_back(static_cast<uint32_t>(q_it.ptr()[2]));
+            indices.push_back(static_cast<uint32_t>(q_it.ptr()[0]));
+            indices.push_back(static_cast<uint32_t>(q_it.ptr()[2]));
+            indices.push_back(static_cast<uint32_t>(q_it.ptr()[3]));
         }
     }
 }
+
+// counting sort of the triangle corners by vertex, in triangle order
+void BuildAdjacency(const std::vector<uint32_t> &indices,
+                    uint32_t num_vertices,
+                    std::vector<uint32_t> &offsets,
+                    std::vector<uint32_t> &adjacency) {
+    offsets.assign(num_vertices + 1, 0);
+    for (auto index : indices) {
+        offsets[index + 1]++;
+    }
+    for (uint32_t i = 0; i < num_vertices; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    adjacency.resize(indices.size() * 2);
+    std::vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        for (size_t corner = 0; corner < 3; corner++) {
+            // the rotations of a triangle have the same normal
+            const uint32_t kSlot = cursors[indices[i + corner]]++;
+            adjacency[kSlot * 2] = indices[i + (corner + 1) % 3];
+            adjacency[kSlot * 2 + 1] = indices[i + (corner + 2) % 3];
+        }
+    }
+}
+
 }  // namespace
 
 std::string ClothRenderer::name() { return "ClothRenderer"; }
 
-ClothRenderer::ClothRenderer(Entity *entity) : Renderer(entity) {}
+ClothRenderer::ClothRenderer(Entity *entity)
+    : Renderer(entity),
+      cloth_instance_property_("clothInstance"),
+      adjacency_offsets_property_("clothAdjacencyOffsets"),
+      adjacency_property_("clothAdjacency"),
+      uvs_property_("clothUVs"),
+      vertices_property_("clothVertices") {
+    shader_data_.SetBufferFunctor(adjacency_offsets_property_,
+                                  [this]() -> core::Buffer * { return adjacency_offsets_buffer_.get(); });
+    shader_data_.SetBufferFunctor(adjacency_property_, [this]() -> core::Buffer * { return adjacency_buffer_.get(); });
+    shader_data_.SetBufferFunctor(uvs_property_, [this]() -> core::Buffer * { return uv_buffer_.get(); });
+    shader_data_.SetBufferFunctor(vertices_property_, [this]() -> core::Buffer * { return vertex_buffer_.get(); });
+}
 
 void ClothRenderer::Render(std::vector<RenderElement> &opaque_queue,
                            std::vector<RenderElement> &alpha_test_queue,
                            std::vector<RenderElement> &transparent_queue) {
-    shader_data_.RemoveDefine(HAS_UV);
-    shader_data_.RemoveDefine(HAS_NORMAL);
-    shader_data_.RemoveDefine(HAS_TANGENT);
-    shader_data_.RemoveDefine(HAS_VERTEXCOLOR);
-
-    shader_data_.AddDefine(HAS_NORMAL);
+    if (!mesh_) {
+        return;
+    }
 
     auto &sub_meshes = mesh_->SubMeshes();
     for (size_t i = 0; i < sub_meshes.size(); i++) {
@@ -75,58 +115,62 @@ void ClothRenderer::Render(std::vector<RenderElement> &opaque_queue,
     }
 }
 
-void ClothRenderer::SetClothMeshDesc(const nv::cloth::ClothMeshDesc &desc) {
-    uint32_t num_vertices = desc.points.count;
-    vertices_.resize(num_vertices);
+void ClothRenderer::SetClothMeshDesc(const nv::cloth::ClothMeshDesc &desc, const std::vector<physx::PxVec2> &uvs) {
+    num_vertices_ = desc.points.count;
+    vertices_.resize(num_vertices_);
+    particles_.resize(num_vertices_);
+    uvs_.clear();
+    if (uvs.size() == num_vertices_) {
+        uvs_ = uvs;
+    }
 
     physx::PxStrideIterator<const physx::PxVec3> p_it(reinterpret_cast<const physx::PxVec3 *>(desc.points.data),
                                                       desc.points.stride);
-    for (physx::PxU32 i = 0; i < num_vertices; ++i) {
-        vertices_[i].position = *p_it++;
-        vertices_[i].normal = physx::PxVec3(0.f);
+    for (physx::PxU32 i = 0; i < num_vertices_; ++i) {
+        particles_[i] = physx::PxVec4(*p_it++, 0.f);
     }
 
     // build triangle indices
+    indices_.clear();
     if (desc.flags & nv::cloth::MeshFlag::e16_BIT_INDICES)
         GatherIndices<physx::PxU16>(indices_, desc.triangles, desc.quads);
     else
         GatherIndices<physx::PxU32>(indices_, desc.triangles, desc.quads);
+    BuildAdjacency(indices_, num_vertices_, adjacency_offsets_, adjacency_);
 
-    for (physx::PxU32 i = 0; i < indices_.size(); i += 3) {
-        auto p_0 = vertices_[indices_[i]].position;
-        auto p_1 = vertices_[indices_[i + 1]].position;
-        auto p_2 = vertices_[indices_[i + 2]].position;
-
-        auto normal = ((p_2 - p_0).cross(p_1 - p_0)).getNormalized();
-
-        vertices_[indices_[i]].normal += normal;
-        vertices_[indices_[i + 1]].normal += normal;
-        vertices_[indices_[i + 2]].normal += normal;
-    }
-
-    for (physx::PxU32 i = 0; i < num_vertices; ++i) vertices_[i].normal.normalize();
+    UpdateVertices(particles_.data());
 
+    // the vertices are written by the compute pass, the texture coordinates never change
     auto &vertex_input_attributes = vertex_input_state_.attributes;
-    vertex_input_attributes.resize(2);
+    vertex_input_attributes.resize(3);
     vertex_input_attributes[0] = initializers::VertexInputAttributeDescription(0, (uint32_t)Attributes::POSITION,
-                                                                               VK_FORMAT_R32G32B32_SFLOAT, 0);
+                                                                               VK_FORMAT_R32G32B32A32_SFLOAT, 0);
     vertex_input_attributes[1] = initializers::VertexInputAttributeDescription(0, (uint32_t)Attributes::NORMAL,
-                                                                               VK_FORMAT_R32G32B32_SFLOAT, 12);
+                                                                               VK_FORMAT_R32G32B32A32_SFLOAT, 16);
+    vertex_input_attributes[2] = initializers::VertexInputAttributeDescription(0, (uint32_t)Attributes::TANGENT,
+                                                                               VK_FORMAT_R32G32B32A32_SFLOAT, 32);
 
     auto &vertex_input_bindings = vertex_input_state_.bindings;
     vertex_input_bindings.resize(1);
-    vertex_input_bindings[0] = vox::initializers::VertexInputBindingDescription(0, 6 * 4, VK_VERTEX_INPUT_RATE_VERTEX);
+    vertex_input_bindings[0] =
+            vox::initializers::VertexInputBindingDescription(0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX);
 
-    Initialize(vertices_.data(), (uint32_t)vertices_.size(), sizeof(Vertex), indices_.data(),
-               (uint32_t)indices_.size() / 3);
-}
+    shader_data_.RemoveDefine(HAS_UV);
+    shader_data_.RemoveDefine(HAS_TANGENT);
+    shader_data_.AddDefine(HAS_NORMAL);
+    if (!uvs_.empty()) {
+        vertex_input_attributes.push_back(initializers::VertexInputAttributeDescription(
+                1, (uint32_t)Attributes::UV_0, VK_FORMAT_R32G32_SFLOAT, 0));
+        vertex_input_bindings.push_back(vox::initializers::VertexInputBindingDescription(
+                1, sizeof(physx::PxVec2), VK_VERTEX_INPUT_RATE_VERTEX));
+        shader_data_.AddDefine(HAS_UV);
+        shader_data_.AddDefine(HAS_TANGENT);
+    }
 
-void ClothRenderer::Initialize(
-        void *vertices, uint32_t num_vertices, uint32_t vertex_size, uint16_t *faces, uint32_t num_faces) {
-    num_vertices_ = num_vertices;
-    vertex_size_ = vertex_size;
-    num_faces_ = num_faces;
+    Initialize();
+}
 
+void ClothRenderer::Initialize() {
     auto mesh = std::make_shared<BufferMesh>();
 
     auto &device = entity_->Scene()->Device();
@@ -138,34 +182,42 @@ void ClothRenderer::Initialize(
 
     command_buffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 
-    core::Buffer stage_buffer{device, num_vertices * vertex_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                              VMA_MEMORY_USAGE_CPU_ONLY};
-
-    stage_buffer.Update(vertices, num_vertices * vertex_size);
-
-    vertex_buffers_ = std::make_unique<core::Buffer>(
-            device, num_vertices * vertex_size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-            VMA_MEMORY_USAGE_GPU_ONLY);
-
-    command_buffer.CopyBuffer(stage_buffer, *vertex_buffers_, num_vertices * vertex_size);
-    mesh->SetVertexBufferBinding(0, vertex_buffers_.get());
-    transient_buffers.push_back(std::move(stage_buffer));
-
-    {
-        core::Buffer stage_buffer{device, num_faces * 3 * sizeof(uint16_t), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                  VMA_MEMORY_USAGE_CPU_ONLY};
-
-        stage_buffer.Update(faces, num_faces * 3 * sizeof(uint16_t));
-
-        core::Buffer new_index_buffer{device, num_faces * 3 * sizeof(uint16_t),
-                                      VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-                                      VMA_MEMORY_USAGE_GPU_ONLY};
+    auto upload = [&](const void *data, size_t size, VkBufferUsageFlags usage) {
+        size = std::max<size_t>(size, 4);
+        core::Buffer stage_buffer{device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY};
+        if (data) {
+            stage_buffer.Update(static_cast<const uint8_t *>(data), size);
+        }
 
-        command_buffer.CopyBuffer(stage_buffer, new_index_buffer, num_faces * 3 * sizeof(uint16_t));
-        mesh->SetIndexBufferBinding(
-                std::make_unique<vox::IndexBufferBinding>(std::move(new_index_buffer), VK_INDEX_TYPE_UINT16));
+        core::Buffer buffer{device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, VMA_MEMORY_USAGE_GPU_ONLY};
+        command_buffer.CopyBuffer(stage_buffer, buffer, size);
         transient_buffers.push_back(std::move(stage_buffer));
+        return buffer;
+    };
+
+    vertex_buffer_ = std::make_unique<core::Buffer>(
+            upload(vertices_.data(), vertices_.size() * sizeof(Vertex),
+                   VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
+    mesh->SetVertexBufferBinding(0, vertex_buffer_.get());
+
+    if (!uvs_.empty()) {
+        uv_buffer_ = std::make_unique<core::Buffer>(
+                upload(uvs_.data(), uvs_.size() * sizeof(physx::PxVec2),
+                       VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
+        mesh->SetVertexBufferBinding(1, uv_buffer_.get());
+    } else {
+        uv_buffer_.reset();
     }
+
+    adjacency_offsets_buffer_ = std::make_unique<core::Buffer>(upload(adjacency_offsets_.data(),
+                                                                      adjacency_offsets_.size() * sizeof(uint32_t),
+                                                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
+    adjacency_buffer_ = std::make_unique<core::Buffer>(
+            upload(adjacency_.data(), adjacency_.size() * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
+
+    mesh->SetIndexBufferBinding(std::make_unique<vox::IndexBufferBinding>(
+            upload(indices_.data(), indices_.size() * sizeof(uint32_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT),
+            VK_INDEX_TYPE_UINT32));
     command_buffer.End();
 
     queue.Submit(command_buffer, device.RequestFence());
@@ -174,35 +226,70 @@ void ClothRenderer::Initialize(
     device.GetFencePool().reset();
     device.GetCommandPool().ResetPool();
 
-    mesh->AddSubMesh(0, num_faces * 3);
+    mesh->AddSubMesh(0, static_cast<uint32_t>(indices_.size()));
     mesh->SetVertexInputState(vertex_input_state_.bindings, vertex_input_state_.attributes);
     mesh_ = mesh;
+
+    cloth_instance_.vertex_count = num_vertices_;
+    shader_data_.SetData(cloth_instance_property_, cloth_instance_);
 }
 
-void ClothRenderer::Update(const physx::PxVec3 *positions, uint32_t num_vertices) {
-    physx::PxStrideIterator<const physx::PxVec3> p_it(positions, sizeof(physx::PxVec3));
-    Vertex *vertices = vertices_.data();
-    const uint16_t *indices = indices_.data();
-    for (physx::PxU32 i = 0; i < num_vertices; ++i) {
-        vertices[i].position = *p_it++;
-        vertices[i].normal = physx::PxVec3(0.f);
+void ClothRenderer::Update(const physx::PxVec4 *particles, uint32_t num_particles) {
+    if (num_particles != num_vertices_) {
+        return;
     }
 
-    const auto kNumIndices = (physx::PxU32)indices_.size();
-    for (physx::PxU32 i = 0; i < kNumIndices; i += 3) {
-        const auto kP0 = vertices[indices[i]].position;
-        const auto kP1 = vertices[indices[i + 1]].position;
-        const auto kP2 = vertices[indices[i + 2]].position;
-
-        const auto kNormal = ((kP2 - kP0).cross(kP1 - kP0)).getNormalized();
-
-        vertices[indices[i]].normal += kNormal;
-        vertices[indices[i + 1]].normal += kNormal;
-        vertices[indices[i + 2]].normal += kNormal;
+    auto *manager = ClothNormalManager::GetSingletonPtr();
+    if (manager) {
+        std::memcpy(particles_.data(), particles, num_particles * sizeof(physx::PxVec4));
+        manager->AddUpdatedRenderer(this);
+    } else {
+        UpdateVertices(particles);
+        UploadVertices();
     }
+}
 
-    for (physx::PxU32 i = 0; i < num_vertices; ++i) vertices[i].normal.normalize();
+void ClothRenderer::UpdateVertices(const physx::PxVec4 *particles) {
+    const bool kHasUV = !uvs_.empty();
+    utility::ParallelForRange(0, num_vertices_, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const auto kP0 = particles[i].getXYZ();
+            physx::PxVec3 normal(0.f);
+            physx::PxVec3 tangent(0.f);
+            physx::PxVec3 bitangent(0.f);
+            for (uint32_t j = adjacency_offsets_[i]; j < adjacency_offsets_[i + 1]; j++) {
+                const uint32_t kA = adjacency_[j * 2];
+                const uint32_t kB = adjacency_[j * 2 + 1];
+                const auto kE1 = particles[kA].getXYZ() - kP0;
+                const auto kE2 = particles[kB].getXYZ() - kP0;
+                normal += kE2.cross(kE1).getNormalized();
+
+                if (kHasUV) {
+                    const auto kD1 = uvs_[kA] - uvs_[i];
+                    const auto kD2 = uvs_[kB] - uvs_[i];
+                    const float kDet = kD1.x * kD2.y - kD2.x * kD1.y;
+                    if (kDet != 0.f) {
+                        tangent += (kE1 * kD2.y - kE2 * kD1.y) / kDet;
+                        bitangent += (kE2 * kD1.x - kE1 * kD2.x) / kDet;
+                    }
+                }
+            }
+            normal.normalize();
+
+            float handedness = 1.f;
+            if (kHasUV) {
+                tangent = (tangent - normal * normal.dot(tangent)).getNormalized();
+                handedness = normal.cross(tangent).dot(bitangent) < 0.f ? -1.f : 1.f;
+            }
+
+            vertices_[i].position = physx::PxVec4(kP0, 1.f);
+            vertices_[i].normal = physx::PxVec4(normal, 0.f);
+            vertices_[i].tangent = physx::PxVec4(tangent, handedness);
+        }
+    });
+}
 
+void ClothRenderer::UploadVertices() {
     auto &device = entity_->Scene()->Device();
     auto &queue = device.GetQueueByFlags(VK_QUEUE_GRAPHICS_BIT, 0);
 
@@ -212,12 +299,12 @@ void ClothRenderer::Update(const physx::PxVec3 *positions, uint32_t num_vertices
 
     command_buffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 
-    core::Buffer stage_buffer{device, num_vertices * sizeof(Vertex), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+    core::Buffer stage_buffer{device, num_vertices_ * sizeof(Vertex), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                               VMA_MEMORY_USAGE_CPU_ONLY};
 
-    stage_buffer.Update(vertices, num_vertices * sizeof(Vertex));
+    stage_buffer.Update(reinterpret_cast<const uint8_t *>(vertices_.data()), num_vertices_ * sizeof(Vertex));
 
-    command_buffer.CopyBuffer(stage_buffer, *vertex_buffers_, num_vertices * sizeof(Vertex));
+    command_buffer.CopyBuffer(stage_buffer, *vertex_buffer_, num_vertices_ * sizeof(Vertex));
     transient_buffers.push_back(std::move(stage_buffer));
 
     command_buffer.End();
@@ -229,6 +316,24 @@ void ClothRenderer::Update(const physx::PxVec3 *positions, uint32_t num_vertices
     device.GetCommandPool().ResetPool();
 }
 
+uint32_t ClothRenderer::VertexCount() const { return num_vertices_; }
+
+void ClothRenderer::WriteParticles(physx::PxVec4 *particles) const {
+    std::memcpy(particles, particles_.data(), particles_.size() * sizeof(physx::PxVec4));
+}
+
+void ClothRenderer::SetParticleOffset(uint32_t offset) {
+    cloth_instance_.particle_offset = offset;
+    shader_data_.SetData(cloth_instance_property_, cloth_instance_);
+}
+
+void ClothRenderer::OnDisable() {
+    Renderer::OnDisable();
+    if (auto *manager = ClothNormalManager::GetSingletonPtr()) {
+        manager->RemoveRenderer(this);
+    }
+}
+
 void ClothRenderer::UpdateBounds(BoundingBox3F &world_bounds) {
     world_bounds.lower_corner.x = -std::numeric_limits<float>::max();
     world_bounds.lower_corner.y = -std::numeric_limits<float>::max();
@@ -6,16 +6,30 @@
 
 #pragma once
 
+#include "vox.cloth/foundation/PxVec2.h"
 #include "vox.cloth/NvCloth/Cloth.h"
 #include "vox.cloth/NvClothExt/ClothMeshDesc.h"
 #include "vox.render/renderer.h"
 
 namespace vox::cloth {
+/**
+ * Renderer of a simulated cloth. Only the particles are uploaded each frame, normals and tangents are rebuilt from
+ * them by the ClothNormalManager compute pass, or on the CPU when no manager exists.
+ * Both gather the triangles around each vertex from an adjacency built once from the mesh, so vertices are
+ * independent and written without atomics.
+ */
 class ClothRenderer : public Renderer {
 public:
     struct Vertex {
-        physx::PxVec3 position;
-        physx::PxVec3 normal;
+        physx::PxVec4 position;
+        physx::PxVec4 normal;
+        physx::PxVec4 tangent;
+    };
+
+    struct ClothInstance {
+        uint32_t particle_offset;
+        uint32_t vertex_count;
+        uint32_t padding[2];
     };
 
     nv::cloth::Cloth* cloth_{nullptr};
@@ -31,12 +45,35 @@ public:
                 std::vector<RenderElement>& alpha_test_queue,
                 std::vector<RenderElement>& transparent_queue) override;
 
-    void SetClothMeshDesc(const nv::cloth::ClothMeshDesc& desc);
+    /**
+     * @param uvs Texture coordinates of the points, tangents are generated when there is one per point
+     */
+    void SetClothMeshDesc(const nv::cloth::ClothMeshDesc& desc, const std::vector<physx::PxVec2>& uvs = {});
 
-    void Update(const physx::PxVec3* positions, uint32_t num_vertices);
+    /**
+     * Copy the particles of the solver, the w component is ignored.
+     * The copy is packed into the particle buffer of the frame by the ClothNormalManager, which may record the frame
+     * after the next step of the solver started.
+     */
+    void Update(const physx::PxVec4* particles, uint32_t num_particles);
 
     void UpdateBounds(BoundingBox3F& world_bounds) override;
 
+    [[nodiscard]] uint32_t VertexCount() const;
+
+    /**
+     * Write the particles copied by the last Update.
+     */
+    void WriteParticles(physx::PxVec4* particles) const;
+
+    /**
+     * Position of the first particle of the renderer in the particle buffer.
+     */
+    void SetParticleOffset(uint32_t offset);
+
+protected:
+    void OnDisable() override;
+
 public:
     /**
      * Called when the serialization is asked
@@ -54,19 +91,39 @@ public:
     void OnInspector(ui::WidgetContainer& p_root) override;
 
 private:
-    void Initialize(void* vertices, uint32_t num_vertices, uint32_t vertex_size, uint16_t* faces, uint32_t num_faces);
+    void Initialize();
+
+    /**
+     * Normals and tangents of the vertices from the particles, the fallback of the compute pass.
+     */
+    void UpdateVertices(const physx::PxVec4* particles);
+
+    void UploadVertices();
 
     std::vector<Vertex> vertices_;
-    std::vector<uint16_t> indices_;
-    std::vector<uint32_t> submesh_offsets_;
+    std::vector<physx::PxVec2> uvs_;
+    std::vector<uint32_t> indices_;
+    std::vector<physx::PxVec4> particles_;
+    // the triangles around vertex i are adjacency_[adjacency_offsets_[i]] to adjacency_[adjacency_offsets_[i + 1]],
+    // each one is stored as the two other corners in the winding order of the triangle
+    std::vector<uint32_t> adjacency_offsets_;
+    std::vector<uint32_t> adjacency_;
 
-    uint32_t num_faces_{};
     uint32_t num_vertices_{};
-    uint32_t vertex_size_{};
 
-    std::unique_ptr<core::Buffer> vertex_buffers_{nullptr};
+    std::unique_ptr<core::Buffer> vertex_buffer_{nullptr};
+    std::unique_ptr<core::Buffer> uv_buffer_{nullptr};
+    std::unique_ptr<core::Buffer> adjacency_offsets_buffer_{nullptr};
+    std::unique_ptr<core::Buffer> adjacency_buffer_{nullptr};
     VertexInputState vertex_input_state_;
 
+    ClothInstance cloth_instance_{};
+    const ShaderProperty cloth_instance_property_;
+    const ShaderProperty adjacency_offsets_property_;
+    const ShaderProperty adjacency_property_;
+    const ShaderProperty uvs_property_;
+    const ShaderProperty vertices_property_;
+
     MeshPtr mesh_{nullptr};
 };
 
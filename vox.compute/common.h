@@ -12,6 +12,8 @@ namespace vox::compute {
 #define SIM_THREAD_GROUP_SIZE 64
 #define MAX_NUM_BONES 512
 #define MAX_HAIR_GROUP_RENDER 16
+// cells along each axis of a brick of the sparse signed distance field
+#define SDF_BRICK_SIZE 8
 
 class NonCopyable {
 public:
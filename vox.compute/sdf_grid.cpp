@@ -6,6 +6,8 @@
 
 #include "vox.compute/sdf_grid.h"
 
+#include <algorithm>
+#include <climits>
 #include <utility>
 
 #include "vox.render/shader/shader_manager.h"
@@ -13,16 +15,30 @@
 namespace vox::compute {
 void SdfCollisionSystem::Initialize(Device& device, RenderContext& render_context) {
     signed_distance_field_pipeline = std::make_unique<PostProcessingPipeline>(render_context, ShaderSource());
+    clear_sdf_bricks_pass = &signed_distance_field_pipeline->AddPass<PostProcessingComputePass>(
+            ShaderManager::GetSingleton().LoadShader("compute/sdf_clear_bricks.comp"));
+    mark_sdf_bricks_pass = &signed_distance_field_pipeline->AddPass<PostProcessingComputePass>(
+            ShaderManager::GetSingleton().LoadShader("compute/sdf_mark_bricks.comp"));
     initialize_signed_distance_field_pass = &signed_distance_field_pipeline->AddPass<PostProcessingComputePass>(
-            ShaderManager::GetSingleton().LoadShader("base/particle/particle_simulation.comp"));
+            ShaderManager::GetSingleton().LoadShader("compute/sdf_initiallize.comp"));
     construct_signed_distance_field_pass = &signed_distance_field_pipeline->AddPass<PostProcessingComputePass>(
-            ShaderManager::GetSingleton().LoadShader("base/particle/particle_simulation.comp"));
+            ShaderManager::GetSingleton().LoadShader("compute/sdf_construct.comp"));
     finalize_signed_distance_field_pass = &signed_distance_field_pipeline->AddPass<PostProcessingComputePass>(
-            ShaderManager::GetSingleton().LoadShader("base/particle/particle_simulation.comp"));
+            ShaderManager::GetSingleton().LoadShader("compute/sdf_finalize.comp"));
+
+    signed_distance_field_pipeline->SetGpuScope("SDF Build", StatIndex::GPU_COMPUTE_TIME);
 
     collide_hair_vertices_with_sdf_pipeline = std::make_unique<PostProcessingPipeline>(render_context, ShaderSource());
+    collide_hair_vertices_with_sdf_pipeline->SetGpuScope("SDF Collision", StatIndex::GPU_COMPUTE_TIME);
     collide_hair_vertices_with_sdf_pass = &collide_hair_vertices_with_sdf_pipeline->AddPass<PostProcessingComputePass>(
-            ShaderManager::GetSingleton().LoadShader("base/particle/particle_simulation.comp"));
+            ShaderManager::GetSingleton().LoadShader("compute/sdf_collider.comp"));
+
+    clear_sdf_bricks_pass->SetDebugName("Clear SDF Bricks");
+    mark_sdf_bricks_pass->SetDebugName("Mark SDF Bricks");
+    initialize_signed_distance_field_pass->SetDebugName("Initialize SDF");
+    construct_signed_distance_field_pass->SetDebugName("Construct SDF");
+    finalize_signed_distance_field_pass->SetDebugName("Finalize SDF");
+    collide_hair_vertices_with_sdf_pass->SetDebugName("Collide Hair With SDF");
 }
 
 SdfGrid::SdfGrid(Device& device,
@@ -30,7 +46,9 @@ SdfGrid::SdfGrid(Device& device,
                  const char* model_name,
                  int num_cells_in_x,
                  float collision_margin)
-    : m_collision_margin_(collision_margin),
+    : m_shader_data_(device),
+      m_device_(device),
+      m_collision_margin_(collision_margin),
       m_num_cells_in_x_axis_(num_cells_in_x),
       m_grid_allocation_multiplier_(1.4f),
       m_num_total_cells_(INT_MAX) {
@@ -40,6 +58,7 @@ SdfGrid::SdfGrid(Device& device,
     auto lower_corner = m_input_collision_mesh_->bounds_.lower_corner;
     auto upper_corner = m_input_collision_mesh_->bounds_.upper_corner;
     m_constant_buffer_data_.cell_size = (upper_corner.x - lower_corner.x) / (float)m_num_cells_in_x_axis_;
+    m_constant_buffer_data_.collision_margin = m_collision_margin_;
     int num_extra_padding_cells = (int)(0.8f * (float)m_num_cells_in_x_axis_);
     m_padding_boundary_ = {(float)num_extra_padding_cells * m_constant_buffer_data_.cell_size,
                            (float)num_extra_padding_cells * m_constant_buffer_data_.cell_size,
@@ -57,43 +76,213 @@ SdfGrid::SdfGrid(Device& device,
                                   (int)((int)m_grid_allocation_multiplier_ * m_constant_buffer_data_.num_cells_x *
                                         m_constant_buffer_data_.num_cells_y * m_constant_buffer_data_.num_cells_z));
 
+    auto bricks = [](uint32_t cells) { return (cells + SDF_BRICK_SIZE - 1) / SDF_BRICK_SIZE; };
+    m_constant_buffer_data_.num_bricks_x = bricks(m_constant_buffer_data_.num_cells_x);
+    m_constant_buffer_data_.num_bricks_y = bricks(m_constant_buffer_data_.num_cells_y);
+    m_constant_buffer_data_.num_bricks_z = bricks(m_constant_buffer_data_.num_cells_z);
+    const uint32_t kNumBricks = m_constant_buffer_data_.num_bricks_x * m_constant_buffer_data_.num_bricks_y *
+                                m_constant_buffer_data_.num_bricks_z;
+    // the band follows the surface, twice the area of the grid faces in bricks covers a closed mesh in the grid
+    const uint32_t kSurfaceBricks = 2 * (m_constant_buffer_data_.num_bricks_x * m_constant_buffer_data_.num_bricks_y +
+                                         m_constant_buffer_data_.num_bricks_y * m_constant_buffer_data_.num_bricks_z +
+                                         m_constant_buffer_data_.num_bricks_z * m_constant_buffer_data_.num_bricks_x);
+    m_constant_buffer_data_.max_active_bricks = std::min(kNumBricks, kSurfaceBricks);
+
     m_constant_buffer_ = std::make_unique<core::Buffer>(
-            device, sizeof(SDFGridParams), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
-    m_signed_distance_field_ =
-            std::make_unique<core::Buffer>(device, sizeof(int) * m_num_total_cells_,
-                                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+            device, sizeof(SDFGridParams), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU);
+    m_brick_table_ = std::make_unique<core::Buffer>(device, sizeof(uint32_t) * kNumBricks,
+                                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+    m_brick_args_ = std::make_unique<core::Buffer>(device, sizeof(uint32_t) * 4,
+                                                   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                                           VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                                           VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                   VMA_MEMORY_USAGE_GPU_ONLY);
+    AllocateBrickPool();
+
+    m_shader_data_.SetBufferFunctor("ConstBuffer_SDF", [this]() -> core::Buffer* { return m_constant_buffer_.get(); });
+    m_shader_data_.SetBufferFunctor("g_SignedDistanceField",
+                                    [this]() -> core::Buffer* { return m_signed_distance_field_.get(); });
+    m_shader_data_.SetBufferFunctor("g_SdfBrickTable", [this]() -> core::Buffer* { return m_brick_table_.get(); });
+    m_shader_data_.SetBufferFunctor("g_SdfActiveBricks",
+                                    [this]() -> core::Buffer* { return m_active_bricks_.get(); });
+    m_shader_data_.SetBufferFunctor("g_SdfBrickArgs", [this]() -> core::Buffer* { return m_brick_args_.get(); });
+}
+
+void SdfGrid::AllocateBrickPool() {
+    const uint32_t kMaxActiveBricks = m_constant_buffer_data_.max_active_bricks;
+    m_active_bricks_ = std::make_unique<core::Buffer>(m_device_, sizeof(uint32_t) * kMaxActiveBricks,
+                                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                                              VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                      VMA_MEMORY_USAGE_GPU_ONLY);
+    m_signed_distance_field_ = std::make_unique<core::Buffer>(
+            m_device_, sizeof(uint32_t) * kMaxActiveBricks * SDF_BRICK_SIZE * SDF_BRICK_SIZE * SDF_BRICK_SIZE,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+    m_needs_rebuild_ = true;
+}
+
+void SdfGrid::SetMaxActiveBricks(uint32_t count) {
+    const uint32_t kNumBricks = m_constant_buffer_data_.num_bricks_x * m_constant_buffer_data_.num_bricks_y *
+                                m_constant_buffer_data_.num_bricks_z;
+    count = std::max(1u, std::min(count, kNumBricks));
+    if (count == m_constant_buffer_data_.max_active_bricks) return;
+
+    // the pool may still be read by the frames in flight
+    m_device_.WaitIdle();
+    m_constant_buffer_data_.max_active_bricks = count;
+    AllocateBrickPool();
+}
+
+void SdfGrid::SetTransform(const Matrix4x4F& world_from_mesh) {
+    if (world_from_mesh == m_constant_buffer_data_.world_from_sdf) return;
+
+    m_constant_buffer_data_.world_from_sdf = world_from_mesh;
+    m_constant_buffer_data_.sdf_from_world = world_from_mesh.inverse();
+    m_transform_dirty_ = true;
 }
 
 void SdfGrid::UpdateSdfGrid(const Point3F& tight_bbox_min, const Point3F& tight_bbox_max) {
     m_constant_buffer_data_.origin = tight_bbox_min - m_padding_boundary_;
 }
 
+void SdfGrid::AttachShaderData(SdfCollisionSystem& system) {
+    system.clear_sdf_bricks_pass->AttachShaderData(&m_shader_data_);
+    system.mark_sdf_bricks_pass->AttachShaderData(&m_shader_data_);
+    system.initialize_signed_distance_field_pass->AttachShaderData(&m_shader_data_);
+    system.construct_signed_distance_field_pass->AttachShaderData(&m_shader_data_);
+    system.finalize_signed_distance_field_pass->AttachShaderData(&m_shader_data_);
+}
+
+void SdfGrid::DetachShaderData(SdfCollisionSystem& system) {
+    system.clear_sdf_bricks_pass->DetachShaderData(&m_shader_data_);
+    system.mark_sdf_bricks_pass->DetachShaderData(&m_shader_data_);
+    system.initialize_signed_distance_field_pass->DetachShaderData(&m_shader_data_);
+    system.construct_signed_distance_field_pass->DetachShaderData(&m_shader_data_);
+    system.finalize_signed_distance_field_pass->DetachShaderData(&m_shader_data_);
+}
+
 void SdfGrid::Update(CommandBuffer& command_buffer, RenderTarget& render_target, SdfCollisionSystem& system) {
     if (!m_input_collision_mesh_) return;
 
-    // Update the grid data based on the current bounding box
-    auto lower_corner = m_input_collision_mesh_->bounds_.lower_corner;
-    auto upper_corner = m_input_collision_mesh_->bounds_.upper_corner;
-    UpdateSdfGrid(lower_corner, upper_corner);
+    // Update the grid data based on the current bounding box, moving the grid invalidates every cell
+    const auto& bounds = m_input_collision_mesh_->bounds_;
+    if (bounds.lower_corner != m_built_bounds_.lower_corner || bounds.upper_corner != m_built_bounds_.upper_corner) {
+        m_built_bounds_ = bounds;
+        m_needs_rebuild_ = true;
+    }
+    if (!m_needs_rebuild_) {
+        // a rigid motion of the mesh only moves the field
+        if (m_transform_dirty_) {
+            m_constant_buffer_->Update(&m_constant_buffer_data_, sizeof(SDFGridParams));
+            m_transform_dirty_ = false;
+        }
+        return;
+    }
+    m_needs_rebuild_ = false;
+    m_transform_dirty_ = false;
+    m_build_count_++;
+
+    UpdateSdfGrid(bounds.lower_corner, bounds.upper_corner);
     m_constant_buffer_->Update(&m_constant_buffer_data_, sizeof(SDFGridParams));
 
-    // Run InitializeSignedDistanceField. One thread per one cell.
+    const auto kNumTriangles = (uint32_t)m_input_collision_mesh_->SubMeshes()[0].Count() / 3;
+    // Run ClearSdfBricks. One thread per one brick of the grid.
     {
-        uint32_t num_dispatch_size = (int)std::ceil((float)m_num_total_cells_ / (float)SIM_THREAD_GROUP_SIZE);
-        system.initialize_signed_distance_field_pass->SetDispatchSize({num_dispatch_size, 1, 1});
+        const uint32_t kNumBricks = m_constant_buffer_data_.num_bricks_x * m_constant_buffer_data_.num_bricks_y *
+                                    m_constant_buffer_data_.num_bricks_z;
+        uint32_t num_dispatch_size = (kNumBricks + SIM_THREAD_GROUP_SIZE - 1) / SIM_THREAD_GROUP_SIZE;
+        system.clear_sdf_bricks_pass->SetDispatchSize({num_dispatch_size, 1, 1});
     }
+    // Run MarkSdfBricks. One thread per each triangle
+    {
+        uint32_t num_dispatch_size = (kNumTriangles + SIM_THREAD_GROUP_SIZE - 1) / SIM_THREAD_GROUP_SIZE;
+        system.mark_sdf_bricks_pass->SetDispatchSize({num_dispatch_size, 1, 1});
+    }
+    // Run InitializeSignedDistanceField. One thread per one cell of the active bricks, counted by MarkSdfBricks.
+    system.initialize_signed_distance_field_pass->SetIndirectDispatch(m_brick_args_.get());
     // Run ConstructSignedDistanceField. One thread per each triangle
     {
-        uint32_t num_dispatch_size = (int)std::ceil((float)m_input_collision_mesh_->SubMeshes()[0].Count() / 3 /
-                                                    (float)SIM_THREAD_GROUP_SIZE);
+        uint32_t num_dispatch_size = (kNumTriangles + SIM_THREAD_GROUP_SIZE - 1) / SIM_THREAD_GROUP_SIZE;
         system.construct_signed_distance_field_pass->SetDispatchSize({num_dispatch_size, 1, 1});
     }
-    // Run FinalizeSignedDistanceField. One thread per each triangle
+    // Run FinalizeSignedDistanceField. One thread per one cell of the active bricks
+    system.finalize_signed_distance_field_pass->SetIndirectDispatch(m_brick_args_.get());
+
+    // every pass reads what the previous one wrote, the dispatch of the active cells included
+    BufferMemoryBarrier barrier;
+    barrier.src_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    barrier.dst_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+    barrier.src_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dst_access_mask =
+            VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    auto pass_barrier = [&command_buffer, barrier]() { command_buffer.GlobalMemoryBarrier(barrier); };
+    system.clear_sdf_bricks_pass->SetPostDrawFunc(pass_barrier);
+    system.mark_sdf_bricks_pass->SetPostDrawFunc(pass_barrier);
+    system.initialize_signed_distance_field_pass->SetPostDrawFunc(pass_barrier);
+    system.construct_signed_distance_field_pass->SetPostDrawFunc(pass_barrier);
+    system.finalize_signed_distance_field_pass->SetPostDrawFunc(pass_barrier);
+
+    AttachShaderData(system);
+    system.signed_distance_field_pipeline->Draw(command_buffer, render_target);
+    DetachShaderData(system);
+}
+
+void SdfGrid::ReadDistances(SdfFieldData& data) {
+    data.origin = m_constant_buffer_data_.origin;
+    data.cell_size = m_constant_buffer_data_.cell_size;
+    data.num_cells_x = m_constant_buffer_data_.num_cells_x;
+    data.num_cells_y = m_constant_buffer_data_.num_cells_y;
+    data.num_cells_z = m_constant_buffer_data_.num_cells_z;
+    data.distances.assign((size_t)data.num_cells_x * data.num_cells_y * data.num_cells_z,
+                          SdfFieldData::initial_distance_);
+
+    std::vector<core::Buffer> stage_buffers;
     {
-        uint32_t num_dispatch_size = (int)std::ceil((float)m_num_total_cells_ / (float)SIM_THREAD_GROUP_SIZE);
-        system.finalize_signed_distance_field_pass->SetDispatchSize({num_dispatch_size, 1, 1});
+        m_device_.WaitIdle();
+        auto& queue = m_device_.GetQueueByFlags(VK_QUEUE_GRAPHICS_BIT, 0);
+        auto& command_buffer = m_device_.RequestCommandBuffer();
+        command_buffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        for (const core::Buffer* buffer :
+             {m_active_bricks_.get(), m_signed_distance_field_.get(), m_brick_args_.get()}) {
+            core::Buffer stage_buffer{m_device_, buffer->GetSize(), VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                      VMA_MEMORY_USAGE_GPU_TO_CPU};
+            command_buffer.CopyBuffer(*buffer, stage_buffer, buffer->GetSize());
+            stage_buffers.push_back(std::move(stage_buffer));
+        }
+        command_buffer.End();
+        queue.Submit(command_buffer, m_device_.RequestFence());
+        m_device_.GetFencePool().wait();
+        m_device_.GetFencePool().reset();
+        m_device_.GetCommandPool().ResetPool();
+    }
+
+    for (auto& stage_buffer : stage_buffers) {
+        stage_buffer.Invalidate();
+    }
+    const auto* active_bricks = reinterpret_cast<const uint32_t*>(stage_buffers[0].Map());
+    const auto* pool = reinterpret_cast<const float*>(stage_buffers[1].Map());
+    const auto* args = reinterpret_cast<const uint32_t*>(stage_buffers[2].Map());
+    const uint32_t kNumActiveBricks = std::min(args[3], m_constant_buffer_data_.max_active_bricks);
+    const uint32_t kBricksX = m_constant_buffer_data_.num_bricks_x;
+    const uint32_t kBricksY = m_constant_buffer_data_.num_bricks_y;
+    for (uint32_t slot = 0; slot < kNumActiveBricks; slot++) {
+        const uint32_t kBrick = active_bricks[slot];
+        const uint32_t kBrickX = kBrick % kBricksX * SDF_BRICK_SIZE;
+        const uint32_t kBrickY = kBrick / kBricksX % kBricksY * SDF_BRICK_SIZE;
+        const uint32_t kBrickZ = kBrick / (kBricksX * kBricksY) * SDF_BRICK_SIZE;
+        for (uint32_t local = 0; local < SDF_BRICK_SIZE * SDF_BRICK_SIZE * SDF_BRICK_SIZE; local++) {
+            const uint32_t kX = kBrickX + local % SDF_BRICK_SIZE;
+            const uint32_t kY = kBrickY + local / SDF_BRICK_SIZE % SDF_BRICK_SIZE;
+            const uint32_t kZ = kBrickZ + local / (SDF_BRICK_SIZE * SDF_BRICK_SIZE);
+            if (kX < data.num_cells_x && kY < data.num_cells_y && kZ < data.num_cells_z) {
+                data.distances[((size_t)kZ * data.num_cells_y + kY) * data.num_cells_x + kX] =
+                        pool[(size_t)slot * SDF_BRICK_SIZE * SDF_BRICK_SIZE * SDF_BRICK_SIZE + local];
+            }
+        }
+    }
+    for (auto& stage_buffer : stage_buffers) {
+        stage_buffer.Unmap();
     }
-    system.signed_distance_field_pipeline->Draw(command_buffer, render_target);
 }
 
 }  // namespace vox::compute
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "vox.compute/constant_buffers.h"
+#include "vox.compute/sdf_mc_cpu.h"
 #include "vox.math/matrix4x4.h"
 #include "vox.math/vector4.h"
 #include "vox.render/core/command_buffer.h"
@@ -28,12 +29,23 @@ struct SDFGridParams {
     float collision_margin;
     int num_hair_vertices_per_strand;
     int num_total_hair_vertices;
+
+    uint32_t num_bricks_x;
+    uint32_t num_bricks_y;
+    uint32_t num_bricks_z;
+    uint32_t max_active_bricks;
+
+    // the field is built in the space of the collision mesh
+    Matrix4x4F sdf_from_world;
+    Matrix4x4F world_from_sdf;
 };
 
 struct SdfCollisionSystem {
 public:
     void Initialize(Device& device, RenderContext& render_context);
 
+    PostProcessingComputePass* clear_sdf_bricks_pass{nullptr};
+    PostProcessingComputePass* mark_sdf_bricks_pass{nullptr};
     PostProcessingComputePass* initialize_signed_distance_field_pass{nullptr};
     PostProcessingComputePass* construct_signed_distance_field_pass{nullptr};
     PostProcessingComputePass* finalize_signed_distance_field_pass{nullptr};
@@ -43,6 +55,13 @@ public:
     std::unique_ptr<PostProcessingPipeline> collide_hair_vertices_with_sdf_pipeline{nullptr};
 };
 
+/**
+ * Narrow band signed distance field of a collision mesh.
+ * The grid is split in bricks of SDF_BRICK_SIZE^3 cells, only the bricks within the collision margin of a triangle
+ * are allocated and the initialize and finalize passes are dispatched indirectly over them. Cells outside of the
+ * band hold no distance and never collide.
+ * The field is rebuilt when the mesh deforms or its bounds change, a rigid motion only rewrites the transform.
+ */
 class SdfGrid {
 public:
     SdfGrid(Device& device,
@@ -51,11 +70,42 @@ public:
             int num_cells_in_x,
             float collision_margin);
 
-    // Update and animate the collision mesh
+    // Update and animate the collision mesh, nothing is dispatched when neither the mesh nor the transform changed
     void Update(CommandBuffer& command_buffer, RenderTarget& render_target, SdfCollisionSystem& system);
 
+    // World transform of the collision mesh, refits the field without rebuilding it
+    void SetTransform(const Matrix4x4F& world_from_mesh);
+
+    // Rebuild the field at the next update, the vertices of the collision mesh changed
+    void MarkDeformed() { m_needs_rebuild_ = true; }
+
+    // Capacity of the brick pool, bricks over it are dropped from the band. Estimated from the grid surface otherwise.
+    void SetMaxActiveBricks(uint32_t count);
+
     [[nodiscard]] const core::Buffer& GetSdfDataGpuBuffer() const { return *m_signed_distance_field_; }
     core::Buffer& GetSdfDataGpuBuffer() { return *m_signed_distance_field_; }
+    // Pool slot of each brick, 0xFFFFFFFF outside of the band
+    [[nodiscard]] const core::Buffer& GetBrickTableGpuBuffer() const { return *m_brick_table_; }
+    core::Buffer& GetBrickTableGpuBuffer() { return *m_brick_table_; }
+    [[nodiscard]] const core::Buffer& GetActiveBricksGpuBuffer() const { return *m_active_bricks_; }
+    core::Buffer& GetActiveBricksGpuBuffer() { return *m_active_bricks_; }
+    // Dispatch of one thread per cell of the active bricks, followed by the active brick count
+    [[nodiscard]] const core::Buffer& GetBrickArgsGpuBuffer() const { return *m_brick_args_; }
+    core::Buffer& GetBrickArgsGpuBuffer() { return *m_brick_args_; }
+    [[nodiscard]] uint32_t GetMaxActiveBricks() const { return m_constant_buffer_data_.max_active_bricks; }
+    // Incremented by each rebuild of the field
+    [[nodiscard]] uint32_t GetBuildCount() const { return m_build_count_; }
+
+    // Copy the field to the host, waits for the device to be idle
+    void ReadDistances(SdfFieldData& data);
+    void GetGridNumBricks(uint32_t& x, uint32_t& y, uint32_t& z) const {
+        x = m_constant_buffer_data_.num_bricks_x;
+        y = m_constant_buffer_data_.num_bricks_y;
+        z = m_constant_buffer_data_.num_bricks_z;
+    }
+    // The field buffers, the collision mesh ("g_TrimeshVertexIndices", "collMeshVertexPositions") and the hair
+    // vertices are bound by the owner
+    ShaderData& GetShaderData() { return m_shader_data_; }
 
     [[nodiscard]] float GetSdfCollisionMargin() const { return m_collision_margin_; }
     [[nodiscard]] float GetGridCellSize() const { return m_constant_buffer_data_.cell_size; }
@@ -73,7 +123,14 @@ private:
     std::unique_ptr<core::Buffer> m_constant_buffer_{nullptr};
 
     std::shared_ptr<Mesh> m_input_collision_mesh_;
+    // SDF_BRICK_SIZE^3 distances per active brick
     std::unique_ptr<core::Buffer> m_signed_distance_field_{nullptr};
+    std::unique_ptr<core::Buffer> m_brick_table_{nullptr};
+    std::unique_ptr<core::Buffer> m_active_bricks_{nullptr};
+    // dispatch of the passes over the active cells, followed by the active brick count
+    std::unique_ptr<core::Buffer> m_brick_args_{nullptr};
+    ShaderData m_shader_data_;
+    Device& m_device_;
 
     int m_num_total_cells_;
     Vector3F m_padding_boundary_;
@@ -83,7 +140,18 @@ private:
     // SDF collision margin.
     float m_collision_margin_;
 
+    bool m_needs_rebuild_{true};
+    bool m_transform_dirty_{false};
+    uint32_t m_build_count_{0};
+    BoundingBox3F m_built_bounds_;
+
     void UpdateSdfGrid(const Point3F& tight_bbox_min, const Point3F& tight_bbox_max);
+
+    void AllocateBrickPool();
+
+    void AttachShaderData(SdfCollisionSystem& system);
+
+    void DetachShaderData(SdfCollisionSystem& system);
 };
 
 }  // namespace vox::compute
@@ -6,9 +6,14 @@
 
 #include "vox.compute/sdf_mc.h"
 
+#include <algorithm>
+
 #include "vox.compute/marching_cubes_tables.h"
 #include "vox.compute/sdf_grid.h"
+#include "vox.render/mesh/mesh_manager.h"
+#include "vox.render/shader/shader_common.h"
 #include "vox.render/shader/shader_manager.h"
+#include "vox.render/vk_initializers.h"
 
 namespace vox::compute {
 SdfMarchingCube::SdfMarchingCube(Entity* entity) : Component(entity) {}
@@ -16,13 +21,17 @@ SdfMarchingCube::SdfMarchingCube(Entity* entity) : Component(entity) {}
 void SdfMarchingCube::Initialize(const char* name, Device& device, RenderContext& render_context) {
     const int kElementsEdgeTableLength = 256 * sizeof(int);
     const int kElementsTriTableLength = 256 * 16 * sizeof(int);
+    m_device_ = &device;
     uniform_buffer_ = std::make_unique<core::Buffer>(device, sizeof(MarchingCubesUniformBuffer),
-                                                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
-    mc_triangle_vertices_buffer_ =
-            std::make_unique<core::Buffer>(device, sizeof(VertexData) * m_max_marching_cubes_vertices_,
-                                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
-    num_mc_vertices_ = std::make_unique<core::Buffer>(device, sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                                                      VMA_MEMORY_USAGE_GPU_ONLY);
+                                                     VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+    mc_counters_ = std::make_unique<core::Buffer>(device, sizeof(uint32_t) * 4, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                  VMA_MEMORY_USAGE_GPU_TO_CPU);
+    uint32_t zero_counters[4] = {};
+    mc_counters_->Update(zero_counters, sizeof(zero_counters));
+    mc_args_ = std::make_unique<core::Buffer>(device, sizeof(uint32_t) * 3 + sizeof(VkDrawIndexedIndirectCommand),
+                                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                                      VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                              VMA_MEMORY_USAGE_GPU_ONLY);
     mc_edge_table_ = std::make_unique<core::Buffer>(device, kElementsEdgeTableLength,
                                                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
     mc_triangle_table_ = std::make_unique<core::Buffer>(device, kElementsTriTableLength,
@@ -47,6 +56,9 @@ void SdfMarchingCube::Initialize(const char* name, Device& device, RenderContext
             command_buffer.CopyBuffer(stage_buffer, *mc_triangle_table_, kElementsTriTableLength);
             transient_buffers.push_back(std::move(stage_buffer));
         }
+        // no extraction yet, nothing drawn
+        const std::vector<uint8_t> kZeros(mc_args_->GetSize(), 0);
+        command_buffer.UpdateBuffer(*mc_args_, 0, kZeros);
         command_buffer.End();
         queue.Submit(command_buffer, device.RequestFence());
         device.GetFencePool().wait();
@@ -54,35 +66,189 @@ void SdfMarchingCube::Initialize(const char* name, Device& device, RenderContext
         device.GetCommandPool().ResetPool();
     }
 
+
+    // vertices are a position and a normal, one vec4 each
+    m_mesh_ = MeshManager::GetSingleton().LoadBufferMesh();
+    std::vector<VkVertexInputAttributeDescription> vertex_input_attributes(2);
+    vertex_input_attributes[0] = initializers::VertexInputAttributeDescription(0, (uint32_t)Attributes::POSITION,
+                                                                               VK_FORMAT_R32G32B32_SFLOAT, 0);
+    vertex_input_attributes[1] = initializers::VertexInputAttributeDescription(0, (uint32_t)Attributes::NORMAL,
+                                                                               VK_FORMAT_R32G32B32_SFLOAT, 16);
+    std::vector<VkVertexInputBindingDescription> vertex_input_bindings(1);
+    vertex_input_bindings[0] =
+            initializers::VertexInputBindingDescription(0, sizeof(VertexData), VK_VERTEX_INPUT_RATE_VERTEX);
+    m_mesh_->SetVertexInputState(vertex_input_bindings, vertex_input_attributes);
+    m_mesh_->AddSubMesh(0, 0);
+    m_mesh_->SetIndirectBuffer(mc_args_.get(), sizeof(uint32_t) * 3);
+    AllocateMeshBuffers(m_initial_vertex_capacity_, 6 * m_initial_vertex_capacity_);
+
+    shader_data_ = std::make_unique<ShaderData>(device);
+    shader_data_->SetBufferFunctor("ConstBuffer_MC", [this]() -> core::Buffer* { return uniform_buffer_.get(); });
+    shader_data_->SetBufferFunctor("g_MarchingCubesVertices",
+                                   [this]() -> core::Buffer* { return mc_vertices_buffer_.get(); });
+    shader_data_->SetBufferFunctor("g_MarchingCubesIndices",
+                                   [this]() -> core::Buffer* { return &mc_index_binding_->Buffer(); });
+    shader_data_->SetBufferFunctor("g_MarchingCubesCounters", [this]() -> core::Buffer* { return mc_counters_.get(); });
+    shader_data_->SetBufferFunctor("g_MarchingCubesArgs", [this]() -> core::Buffer* { return mc_args_.get(); });
+    shader_data_->SetBufferFunctor("g_MarchingCubesEdgeTable",
+                                   [this]() -> core::Buffer* { return mc_edge_table_.get(); });
+    shader_data_->SetBufferFunctor("g_MarchingCubesTriangleTable",
+                                   [this]() -> core::Buffer* { return mc_triangle_table_.get(); });
+    shader_data_->SetBufferFunctor("g_MarchingCubesCellCases",
+                                   [this]() -> core::Buffer* { return mc_cell_cases_.get(); });
+    shader_data_->SetBufferFunctor("g_MarchingCubesGroupSums",
+                                   [this]() -> core::Buffer* { return mc_group_sums_.get(); });
+    shader_data_->SetBufferFunctor("g_MarchingCubesActiveCells",
+                                   [this]() -> core::Buffer* { return mc_active_cells_.get(); });
+    shader_data_->SetBufferFunctor("g_MarchingCubesCellVertexBase",
+                                   [this]() -> core::Buffer* { return mc_cell_vertex_base_.get(); });
+    shader_data_->SetBufferFunctor("g_SignedDistanceField",
+                                   [this]() -> core::Buffer* { return &m_p_sdf_->GetSdfDataGpuBuffer(); });
+    shader_data_->SetBufferFunctor("g_SdfBrickTable",
+                                   [this]() -> core::Buffer* { return &m_p_sdf_->GetBrickTableGpuBuffer(); });
+    shader_data_->SetBufferFunctor("g_SdfActiveBricks",
+                                   [this]() -> core::Buffer* { return &m_p_sdf_->GetActiveBricksGpuBuffer(); });
+    shader_data_->SetBufferFunctor("g_SdfBrickArgs",
+                                   [this]() -> core::Buffer* { return &m_p_sdf_->GetBrickArgsGpuBuffer(); });
+
     marching_cubes_pipeline_ = std::make_unique<PostProcessingPipeline>(render_context, ShaderSource());
-    initialize_mc_vertices_pass_ = &marching_cubes_pipeline_->AddPass<PostProcessingComputePass>(
-            ShaderManager::GetSingleton().LoadShader("base/particle/particle_simulation.comp"));
-    run_marching_cubes_on_sdf_pass_ = &marching_cubes_pipeline_->AddPass<PostProcessingComputePass>(
-            ShaderManager::GetSingleton().LoadShader("base/particle/particle_simulation.comp"));
+    marching_cubes_pipeline_->SetGpuScope("Marching Cubes", StatIndex::GPU_COMPUTE_TIME);
+    classify_cells_pass_ = &marching_cubes_pipeline_->AddPass<PostProcessingComputePass>(
+            ShaderManager::GetSingleton().LoadShader("compute/mc_classify.comp"));
+    scan_groups_pass_ = &marching_cubes_pipeline_->AddPass<PostProcessingComputePass>(
+            ShaderManager::GetSingleton().LoadShader("compute/mc_scan_groups.comp"));
+    compact_cells_pass_ = &marching_cubes_pipeline_->AddPass<PostProcessingComputePass>(
+            ShaderManager::GetSingleton().LoadShader("compute/mc_compact.comp"));
+    generate_triangles_pass_ = &marching_cubes_pipeline_->AddPass<PostProcessingComputePass>(
+            ShaderManager::GetSingleton().LoadShader("compute/mc_generate.comp"));
+    classify_cells_pass_->SetDebugName("Classify MC Cells");
+    scan_groups_pass_->SetDebugName("Scan MC Groups");
+    compact_cells_pass_->SetDebugName("Compact MC Cells");
+    generate_triangles_pass_->SetDebugName("Generate MC Triangles");
+    for (auto* pass : {classify_cells_pass_, scan_groups_pass_, compact_cells_pass_, generate_triangles_pass_}) {
+        pass->AttachShaderData(shader_data_.get());
+    }
+    // a single workgroup scans the sums of the groups
+    scan_groups_pass_->SetDispatchSize({1, 1, 1});
+    generate_triangles_pass_->SetIndirectDispatch(mc_args_.get());
+}
+
+void SdfMarchingCube::AllocateMeshBuffers(uint32_t vertex_capacity, uint32_t index_capacity) {
+    m_vertex_capacity_ = vertex_capacity;
+    m_index_capacity_ = index_capacity;
+    mc_vertices_buffer_ = std::make_unique<core::Buffer>(
+            *m_device_, sizeof(VertexData) * vertex_capacity,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+    m_mesh_->SetVertexBufferBinding(0, mc_vertices_buffer_.get());
+
+    core::Buffer index_buffer{*m_device_, sizeof(uint32_t) * index_capacity,
+                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                              VMA_MEMORY_USAGE_GPU_ONLY};
+    auto index_binding = std::make_unique<IndexBufferBinding>(std::move(index_buffer), VK_INDEX_TYPE_UINT32);
+    mc_index_binding_ = index_binding.get();
+    m_mesh_->SetIndexBufferBinding(std::move(index_binding));
+}
+
+void SdfMarchingCube::AllocateCellBuffers(uint32_t pool_cells) {
+    m_pool_cells_ = pool_cells;
+    mc_cell_cases_ = std::make_unique<core::Buffer>(*m_device_, sizeof(uint32_t) * pool_cells,
+                                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+    mc_group_sums_ = std::make_unique<core::Buffer>(*m_device_,
+                                                    sizeof(uint32_t) * 4 * (pool_cells / SIM_THREAD_GROUP_SIZE),
+                                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+    mc_active_cells_ = std::make_unique<core::Buffer>(*m_device_, sizeof(uint32_t) * 2 * pool_cells,
+                                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+    mc_cell_vertex_base_ = std::make_unique<core::Buffer>(*m_device_, sizeof(uint32_t) * pool_cells,
+                                                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                          VMA_MEMORY_USAGE_GPU_ONLY);
+}
+
+bool SdfMarchingCube::GrowFromCounters() {
+    mc_counters_->Invalidate();
+    const auto* counters = reinterpret_cast<const uint32_t*>(mc_counters_->Map());
+    const uint32_t kNumVertices = counters[1];
+    const uint32_t kNumIndices = counters[2];
+    mc_counters_->Unmap();
+    if (kNumVertices <= m_vertex_capacity_ && kNumIndices <= m_index_capacity_) {
+        return false;
+    }
+
+    // the buffers may still be drawn by the frames in flight
+    m_device_->WaitIdle();
+    AllocateMeshBuffers(std::max(m_vertex_capacity_, kNumVertices + kNumVertices / 4),
+                        std::max(m_index_capacity_, kNumIndices + kNumIndices / 4));
+    return true;
 }
 
 void SdfMarchingCube::Update(CommandBuffer& command_buffer, RenderTarget& render_target) {
+    const bool kGrown = GrowFromCounters();
+    const float kCellSize = m_p_sdf_->GetGridCellSize();
+    if (!kGrown && m_extracted_build_count_ == m_p_sdf_->GetBuildCount() &&
+        m_extracted_iso_level_ == m_sdf_iso_level_) {
+        return;
+    }
+    m_extracted_build_count_ = m_p_sdf_->GetBuildCount();
+    m_extracted_iso_level_ = m_sdf_iso_level_;
+
+    const uint32_t kPoolCells =
+            m_p_sdf_->GetMaxActiveBricks() * SDF_BRICK_SIZE * SDF_BRICK_SIZE * SDF_BRICK_SIZE;
+    if (kPoolCells != m_pool_cells_) {
+        m_device_->WaitIdle();
+        AllocateCellBuffers(kPoolCells);
+    }
+
     m_uniform_buffer_data_.origin = m_p_sdf_->GetGridOrigin();
-    m_uniform_buffer_data_.cell_size = m_p_sdf_->GetGridCellSize();
-    m_uniform_buffer_data_.max_marching_cubes_vertices = m_max_marching_cubes_vertices_;
-    m_uniform_buffer_data_.marching_cubes_iso_level = m_uniform_buffer_data_.cell_size * m_sdf_iso_level_;
+    m_uniform_buffer_data_.cell_size = kCellSize;
+    m_uniform_buffer_data_.max_marching_cubes_vertices = m_vertex_capacity_;
+    m_uniform_buffer_data_.max_marching_cubes_indices = m_index_capacity_;
+    m_uniform_buffer_data_.marching_cubes_iso_level = kCellSize * m_sdf_iso_level_;
     m_p_sdf_->GetGridNumCells(m_uniform_buffer_data_.num_cells_x, m_uniform_buffer_data_.num_cells_y,
                               m_uniform_buffer_data_.num_cells_z);
-    m_num_total_cells_ = m_p_sdf_->GetGridNumTotalCells();
+    m_p_sdf_->GetGridNumBricks(m_uniform_buffer_data_.num_bricks_x, m_uniform_buffer_data_.num_bricks_y,
+                               m_uniform_buffer_data_.num_bricks_z);
+    m_uniform_buffer_data_.max_active_bricks = m_p_sdf_->GetMaxActiveBricks();
     uniform_buffer_->Update(&m_uniform_buffer_data_, sizeof(MarchingCubesUniformBuffer));
 
-    // Run InitializeMCVertices. One thread per each cell
-    {
-        auto num_dispatch_size =
-                (uint32_t)std::ceil((float)m_max_marching_cubes_vertices_ / (float)SIM_THREAD_GROUP_SIZE);
-        initialize_mc_vertices_pass_->SetDispatchSize({num_dispatch_size, 1, 1});
-    }
-    // Run RunMarchingCubesOnSdf. One thread per each cell
-    {
-        auto num_dispatch_size = (uint32_t)std::ceil((float)m_num_total_cells_ / (float)SIM_THREAD_GROUP_SIZE);
-        run_marching_cubes_on_sdf_pass_->SetDispatchSize({num_dispatch_size, 1, 1});
-    }
+    m_mesh_->bounds_.lower_corner = m_uniform_buffer_data_.origin;
+    m_mesh_->bounds_.upper_corner =
+            m_uniform_buffer_data_.origin + Vector3F((float)m_uniform_buffer_data_.num_cells_x * kCellSize,
+                                                     (float)m_uniform_buffer_data_.num_cells_y * kCellSize,
+                                                     (float)m_uniform_buffer_data_.num_cells_z * kCellSize);
+
+    // Run ClassifyCells and CompactCells. One thread per cell of the active bricks
+    classify_cells_pass_->SetIndirectDispatch(&m_p_sdf_->GetBrickArgsGpuBuffer());
+    compact_cells_pass_->SetIndirectDispatch(&m_p_sdf_->GetBrickArgsGpuBuffer());
+
+    // every pass reads what the previous one wrote, the dispatch over the active cells included
+    BufferMemoryBarrier barrier;
+    barrier.src_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    barrier.dst_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+    barrier.src_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dst_access_mask =
+            VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    auto pass_barrier = [&command_buffer, barrier]() { command_buffer.GlobalMemoryBarrier(barrier); };
+    classify_cells_pass_->SetPostDrawFunc(pass_barrier);
+    scan_groups_pass_->SetPostDrawFunc(pass_barrier);
+    compact_cells_pass_->SetPostDrawFunc(pass_barrier);
+
+    // the mesh is drawn indirectly and the counters are read back by the next update
+    BufferMemoryBarrier draw_barrier;
+    draw_barrier.src_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    draw_barrier.dst_stage_mask =
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_HOST_BIT;
+    draw_barrier.src_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+    draw_barrier.dst_access_mask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                                   VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+    generate_triangles_pass_->SetPostDrawFunc(
+            [&command_buffer, draw_barrier]() { command_buffer.GlobalMemoryBarrier(draw_barrier); });
+
     marching_cubes_pipeline_->Draw(command_buffer, render_target);
 }
 
+void SdfMarchingCube::ExtractOnCpu(MarchingCubesMesh& mesh) {
+    SdfFieldData field;
+    m_p_sdf_->ReadDistances(field);
+    ExtractMarchingCubes(field, field.cell_size * m_sdf_iso_level_, mesh);
+}
+
 }  // namespace vox::compute
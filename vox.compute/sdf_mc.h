@@ -7,10 +7,13 @@
 #pragma once
 
 #include "vox.compute/constant_buffers.h"
+#include "vox.compute/sdf_mc_cpu.h"
 #include "vox.math/matrix4x4.h"
 #include "vox.math/vector4.h"
 #include "vox.render/component.h"
 #include "vox.render/core/command_buffer.h"
+#include "vox.render/mesh/buffer_mesh.h"
+#include "vox.render/mesh/index_buffer_binding.h"
 #include "vox.render/rendering/postprocessing_computepass.h"
 #include "vox.render/rendering/postprocessing_pipeline.h"
 
@@ -27,49 +30,93 @@ struct MarchingCubesUniformBuffer {
     uint32_t max_marching_cubes_vertices;
 
     float marching_cubes_iso_level;
+    uint32_t num_bricks_x;
+    uint32_t num_bricks_y;
+
+    uint32_t num_bricks_z;
+    uint32_t max_active_bricks;
+    uint32_t max_marching_cubes_indices;
 };
 
+// Marching cubes over the active bricks of an SdfGrid in two phases.
+// The cells are classified and the crossed ones compacted with a prefix sum of their vertex and index counts, then
+// each active cell writes the vertices of the edges leaving its first corner, shared with its neighbours, and the
+// indices of its triangles. The mesh is drawn with the indexed indirect arguments written by the extraction.
+// The vertex and index buffers grow from the counts read back after an extraction overflowed them.
 class SdfMarchingCube : public Component {
 public:
-    static constexpr int m_max_marching_cubes_vertices_ = 128 * 1024;
+    static constexpr uint32_t m_initial_vertex_capacity_ = 16 * 1024;
 
     explicit SdfMarchingCube(Entity* entity);
 
     void Initialize(const char* name, Device& device, RenderContext& render_context);
 
-    // Update mesh by running marching cubes
+    // Update mesh by running marching cubes, when the field was rebuilt or the iso level changed
     void Update(CommandBuffer& command_buffer, RenderTarget& render_target);
 
     void SetSdf(SdfGrid* sdf) {
         assert(sdf);
         m_p_sdf_ = sdf;
+        m_extracted_build_count_ = 0;
     }
 
     // Setting the SDF ISO level for drawing.
     inline void SetSdfIsoLevel(float iso_level) { m_sdf_iso_level_ = iso_level; }
 
+    // Mesh in the space of the field, empty until the first extraction
+    [[nodiscard]] const std::shared_ptr<BufferMesh>& GetMesh() const { return m_mesh_; }
+
+    // Same extraction on the host over the field read back from the grid, for export and testing
+    void ExtractOnCpu(MarchingCubesMesh& mesh);
+
 private:
     // SDF grid
     SdfGrid* m_p_sdf_{};
-    MarchingCubesUniformBuffer m_uniform_buffer_data_;
+    MarchingCubesUniformBuffer m_uniform_buffer_data_{};
     std::unique_ptr<core::Buffer> uniform_buffer_{nullptr};
     // SDF ISO level. This value will be multiplied with the cell size before be passed to the compute shader.
     float m_sdf_iso_level_{};
-    int m_num_total_cells_{};
+    float m_extracted_iso_level_{};
+    uint32_t m_extracted_build_count_{0};
 
     struct VertexData {
         Vector4F position;
         Vector4F normal;
     };
-    std::unique_ptr<core::Buffer> mc_triangle_vertices_buffer_{nullptr};
-    std::unique_ptr<core::Buffer> num_mc_vertices_{nullptr};
+    Device* m_device_{nullptr};
+    uint32_t m_vertex_capacity_{0};
+    uint32_t m_index_capacity_{0};
+    std::unique_ptr<core::Buffer> mc_vertices_buffer_{nullptr};
+    IndexBufferBinding* mc_index_binding_{nullptr};
+    std::shared_ptr<BufferMesh> m_mesh_{nullptr};
+    // active cells, vertices, indices and overflow of the last extraction
+    std::unique_ptr<core::Buffer> mc_counters_{nullptr};
+    // dispatch over the active cells followed by the draw
+    std::unique_ptr<core::Buffer> mc_args_{nullptr};
     std::unique_ptr<core::Buffer> mc_edge_table_{nullptr};
     std::unique_ptr<core::Buffer> mc_triangle_table_{nullptr};
 
+    // sized by the cells of the brick pool of the grid
+    uint32_t m_pool_cells_{0};
+    std::unique_ptr<core::Buffer> mc_cell_cases_{nullptr};
+    std::unique_ptr<core::Buffer> mc_group_sums_{nullptr};
+    std::unique_ptr<core::Buffer> mc_active_cells_{nullptr};
+    std::unique_ptr<core::Buffer> mc_cell_vertex_base_{nullptr};
+    std::unique_ptr<ShaderData> shader_data_{nullptr};
+
     // compute shader
-    PostProcessingComputePass* initialize_mc_vertices_pass_{nullptr};
-    PostProcessingComputePass* run_marching_cubes_on_sdf_pass_{nullptr};
+    PostProcessingComputePass* classify_cells_pass_{nullptr};
+    PostProcessingComputePass* scan_groups_pass_{nullptr};
+    PostProcessingComputePass* compact_cells_pass_{nullptr};
+    PostProcessingComputePass* generate_triangles_pass_{nullptr};
     std::unique_ptr<PostProcessingPipeline> marching_cubes_pipeline_{nullptr};
+
+    void AllocateMeshBuffers(uint32_t vertex_capacity, uint32_t index_capacity);
+
+    void AllocateCellBuffers(uint32_t pool_cells);
+
+    // Grow the mesh buffers when the last extraction did not fit, true when they were reallocated
+    bool GrowFromCounters();
 };
 
 }  // namespace vox::compute
@@ -0,0 +1,211 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.compute/sdf_mc_cpu.h"
+
+#include <bitset>
+
+#include "vox.base/parallel.h"
+#include "vox.compute/marching_cubes_tables.h"
+
+namespace vox::compute {
+namespace {
+// same corner and edge numbering as shaders/compute/mc_common.comp
+constexpr int kCornerOffsets[8][3] = {{0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1},
+                                      {0, 1, 0}, {1, 1, 0}, {1, 1, 1}, {0, 1, 1}};
+constexpr int kEdgeStarts[12][3] = {{0, 0, 0}, {1, 0, 0}, {0, 0, 1}, {0, 0, 0}, {0, 1, 0}, {1, 1, 0},
+                                    {0, 1, 1}, {0, 1, 0}, {0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1}};
+constexpr int kEdgeAxes[12] = {0, 2, 0, 2, 0, 2, 0, 2, 1, 1, 1, 1};
+
+struct CellCounts {
+    uint32_t active{0};
+    uint32_t vertices{0};
+    uint32_t indices{0};
+
+    CellCounts operator+(const CellCounts& other) const {
+        return {active + other.active, vertices + other.vertices, indices + other.indices};
+    }
+};
+
+class FieldSampler {
+public:
+    explicit FieldSampler(const SdfFieldData& field) : field_(field) {}
+
+    [[nodiscard]] bool Contains(int x, int y, int z) const {
+        return x >= 0 && y >= 0 && z >= 0 && x < (int)field_.num_cells_x && y < (int)field_.num_cells_y &&
+               z < (int)field_.num_cells_z;
+    }
+
+    [[nodiscard]] size_t Index(int x, int y, int z) const {
+        return ((size_t)z * field_.num_cells_y + y) * field_.num_cells_x + x;
+    }
+
+    // False outside of the grid or of the band
+    bool Distance(int x, int y, int z, float& distance) const {
+        distance = Contains(x, y, z) ? field_.distances[Index(x, y, z)] : SdfFieldData::initial_distance_;
+        return distance < SdfFieldData::initial_distance_;
+    }
+
+    [[nodiscard]] Point3F Position(int x, int y, int z) const {
+        return {field_.origin.x + (float)x * field_.cell_size, field_.origin.y + (float)y * field_.cell_size,
+                field_.origin.z + (float)z * field_.cell_size};
+    }
+
+    // central differences, one sided at the border of the band
+    [[nodiscard]] Vector3F Gradient(int x, int y, int z, float center) const {
+        Vector3F gradient;
+        for (int axis = 0; axis < 3; axis++) {
+            const int kDx = axis == 0, kDy = axis == 1, kDz = axis == 2;
+            float next, previous;
+            const bool kHasNext = Distance(x + kDx, y + kDy, z + kDz, next);
+            const bool kHasPrevious = Distance(x - kDx, y - kDy, z - kDz, previous);
+            if (kHasNext && kHasPrevious) {
+                gradient[axis] = 0.5f * (next - previous);
+            } else if (kHasNext) {
+                gradient[axis] = next - center;
+            } else if (kHasPrevious) {
+                gradient[axis] = center - previous;
+            } else {
+                gradient[axis] = 0.f;
+            }
+        }
+        return gradient;
+    }
+
+private:
+    const SdfFieldData& field_;
+};
+
+uint32_t NumTriangleVertices(uint32_t cube_index) {
+    uint32_t count = 0;
+    while (count < 16 && MARCHING_CUBES_TRIANGLE_TABLE[cube_index * 16 + count] != -1) {
+        count++;
+    }
+    return count;
+}
+
+// cube index and, shifted by 8, the owned edges crossing the surface
+uint32_t ClassifyCell(const FieldSampler& sampler, int x, int y, int z, float iso_level) {
+    float scalars[8];
+    bool complete = true;
+    for (int i = 0; i < 8; i++) {
+        complete = sampler.Distance(x + kCornerOffsets[i][0], y + kCornerOffsets[i][1], z + kCornerOffsets[i][2],
+                                    scalars[i]) &&
+                   complete;
+    }
+
+    uint32_t cube_index = 0;
+    if (complete) {
+        for (int i = 0; i < 8; i++) {
+            if (scalars[i] < iso_level) cube_index |= 1u << i;
+        }
+        if (MARCHING_CUBES_EDGE_TABLE[cube_index] == 0) {
+            cube_index = 0;
+        }
+    }
+
+    uint32_t edges = 0;
+    if (scalars[0] < SdfFieldData::initial_distance_) {
+        const bool kInside = scalars[0] < iso_level;
+        for (int axis = 0; axis < 3; axis++) {
+            float other;
+            if (sampler.Distance(x + (axis == 0), y + (axis == 1), z + (axis == 2), other) &&
+                (other < iso_level) != kInside) {
+                edges |= 1u << axis;
+            }
+        }
+    }
+    return cube_index | (edges << 8);
+}
+
+CellCounts CaseCounts(uint32_t cell_case) {
+    const uint32_t kCubeIndex = cell_case & 0xFFu;
+    return {cell_case != 0 ? 1u : 0u, (uint32_t)std::bitset<3>(cell_case >> 8).count(),
+            kCubeIndex != 0 ? NumTriangleVertices(kCubeIndex) : 0u};
+}
+
+}  // namespace
+
+void ExtractMarchingCubes(const SdfFieldData& field, float iso_level, MarchingCubesMesh& mesh) {
+    mesh.positions.clear();
+    mesh.normals.clear();
+    mesh.indices.clear();
+    const size_t kNumCells = (size_t)field.num_cells_x * field.num_cells_y * field.num_cells_z;
+    if (kNumCells == 0 || field.distances.size() < kNumCells) {
+        return;
+    }
+
+    const FieldSampler kSampler(field);
+    const auto kNx = (size_t)field.num_cells_x;
+    const auto kNxy = kNx * field.num_cells_y;
+
+    // classify
+    std::vector<uint32_t> cases(kNumCells);
+    std::vector<CellCounts> offsets(kNumCells);
+    utility::ParallelFor(0, kNumCells, [&](size_t i) {
+        cases[i] = ClassifyCell(kSampler, int(i % kNx), int(i / kNx % field.num_cells_y), int(i / kNxy), iso_level);
+        offsets[i] = CaseCounts(cases[i]);
+    });
+
+    // compact
+    const CellCounts kTotal = utility::ParallelExclusiveScan(offsets.begin(), offsets.end(), offsets.begin(),
+                                                              CellCounts());
+    std::vector<uint32_t> active_cells(kTotal.active);
+    utility::ParallelFor(0, kNumCells, [&](size_t i) {
+        if (cases[i] != 0) {
+            active_cells[offsets[i].active] = (uint32_t)i;
+        }
+    });
+
+    // generate
+    mesh.positions.resize(kTotal.vertices);
+    mesh.normals.resize(kTotal.vertices);
+    mesh.indices.resize(kTotal.indices);
+    utility::ParallelFor(0, active_cells.size(), [&](size_t a) {
+        const size_t kCell = active_cells[a];
+        const int kX = int(kCell % kNx), kY = int(kCell / kNx % field.num_cells_y), kZ = int(kCell / kNxy);
+        const uint32_t kCase = cases[kCell];
+
+        const uint32_t kEdges = kCase >> 8;
+        if (kEdges != 0) {
+            uint32_t vertex = offsets[kCell].vertices;
+            float scalar0;
+            kSampler.Distance(kX, kY, kZ, scalar0);
+            const Point3F kP0 = kSampler.Position(kX, kY, kZ);
+            const Vector3F kN0 = kSampler.Gradient(kX, kY, kZ, scalar0);
+            for (int axis = 0; axis < 3; axis++) {
+                if ((kEdges & (1u << axis)) == 0) {
+                    continue;
+                }
+
+                const int kOx = kX + (axis == 0), kOy = kY + (axis == 1), kOz = kZ + (axis == 2);
+                float scalar1;
+                kSampler.Distance(kOx, kOy, kOz, scalar1);
+                const float kInterp = (iso_level - scalar0) / (scalar1 - scalar0);
+                mesh.positions[vertex] = kP0 + (kSampler.Position(kOx, kOy, kOz) - kP0) * kInterp;
+                mesh.normals[vertex] = (kN0 + (kSampler.Gradient(kOx, kOy, kOz, scalar1) - kN0) * kInterp).normalized();
+                vertex++;
+            }
+        }
+
+        const uint32_t kCubeIndex = kCase & 0xFFu;
+        if (kCubeIndex == 0) {
+            return;
+        }
+        const uint32_t kFirstIndex = offsets[kCell].indices;
+        const uint32_t kNumTriangleVertices = NumTriangleVertices(kCubeIndex);
+        for (uint32_t i = 0; i < kNumTriangleVertices; i++) {
+            const int kEdge = MARCHING_CUBES_TRIANGLE_TABLE[kCubeIndex * 16 + i];
+            const size_t kOwner =
+                    kSampler.Index(kX + kEdgeStarts[kEdge][0], kY + kEdgeStarts[kEdge][1], kZ + kEdgeStarts[kEdge][2]);
+            const uint32_t kOwnerEdges = cases[kOwner] >> 8;
+            const auto kSlot = (uint32_t)std::bitset<3>(kOwnerEdges & ((1u << kEdgeAxes[kEdge]) - 1u)).count();
+            mesh.indices[kFirstIndex + i] = offsets[kOwner].vertices + kSlot;
+        }
+    });
+}
+
+}  // namespace vox::compute
@@ -0,0 +1,42 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "vox.math/point3.h"
+#include "vox.math/vector3.h"
+
+namespace vox::compute {
+// Distances of an SdfGrid read back to the host, INITIAL_DISTANCE outside of the narrow band
+struct SdfFieldData {
+    Point3F origin;
+    float cell_size{1.f};
+    uint32_t num_cells_x{0};
+    uint32_t num_cells_y{0};
+    uint32_t num_cells_z{0};
+    // one distance per cell, x first
+    std::vector<float> distances;
+
+    static constexpr float initial_distance_ = 1e10f;
+};
+
+struct MarchingCubesMesh {
+    std::vector<Point3F> positions;
+    std::vector<Vector3F> normals;
+    // triangle list
+    std::vector<uint32_t> indices;
+};
+
+// Marching cubes on the host with the algorithm of SdfMarchingCube, run on the thread pool:
+// the cells are classified, the crossed ones compacted with a prefix sum of their vertex and index counts, then
+// each cell writes the vertices of the edges leaving its first corner and the indices of its triangles.
+// Vertices are shared by the cells around an edge. Cells with a corner outside of the band produce no triangle.
+void ExtractMarchingCubes(const SdfFieldData& field, float iso_level, MarchingCubesMesh& mesh);
+
+}  // namespace vox::compute
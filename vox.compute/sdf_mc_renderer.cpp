@@ -36,9 +36,26 @@ void SdfMarchingCubeRenderer::LineMode(bool flag) {
 
 void SdfMarchingCubeRenderer::Render(std::vector<RenderElement> &opaque_queue,
                                      std::vector<RenderElement> &alpha_test_queue,
-                                     std::vector<RenderElement> &transparent_queue) {}
+                                     std::vector<RenderElement> &transparent_queue) {
+    // the index count is written by the extraction
+    if (sdf_mc_ && sdf_mc_->GetMesh()) {
+        const auto &mesh = sdf_mc_->GetMesh();
+        if (is_line_mode_) {
+            opaque_queue.emplace_back(this, mesh, mesh->FirstSubMesh(), line_material_);
+        } else {
+            opaque_queue.emplace_back(this, mesh, mesh->FirstSubMesh(), material_);
+        }
+    }
+}
 
-void SdfMarchingCubeRenderer::UpdateBounds(BoundingBox3F &world_bounds) {}
+void SdfMarchingCubeRenderer::UpdateBounds(BoundingBox3F &world_bounds) {
+    if (sdf_mc_ && sdf_mc_->GetMesh()) {
+        world_bounds = sdf_mc_->GetMesh()->bounds_.transform(entity_->transform->WorldMatrix());
+    } else {
+        world_bounds.lower_corner = Point3F(0, 0, 0);
+        world_bounds.upper_corner = Point3F(0, 0, 0);
+    }
+}
 
 void SdfMarchingCubeRenderer::OnEnable() {}
 
@@ -0,0 +1,376 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.editor/asset_database.h"
+
+#include <stb_image.h>
+#include <stb_image_resize.h>
+#include <stb_image_write.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+#include "vox.base/logging.h"
+
+namespace vox::editor {
+namespace {
+constexpr uint32_t kIndexVersion = 1;
+
+std::string ToGenericPath(const std::filesystem::path &path) { return path.generic_string(); }
+
+std::string NormalizeFolder(const std::string &folder) {
+    auto path = ToGenericPath(std::filesystem::path(folder));
+    while (path.size() > 1 && path.back() == '/') {
+        path.pop_back();
+    }
+    return path;
+}
+
+int64_t Timestamp(const std::filesystem::file_time_type &time) {
+    return static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+bool TextureThumbnail(const std::string &source, const std::string &thumbnail, uint32_t size) {
+    int width, height, components;
+    stbi_uc *pixels = stbi_load(source.c_str(), &width, &height, &components, 4);
+    if (!pixels) {
+        return false;
+    }
+    const float kScale = static_cast<float>(size) / static_cast<float>(std::max(width, height));
+    const int kWidth = std::max(1, static_cast<int>(static_cast<float>(width) * std::min(kScale, 1.f)));
+    const int kHeight = std::max(1, static_cast<int>(static_cast<float>(height) * std::min(kScale, 1.f)));
+    std::vector<uint8_t> resized(kWidth * kHeight * 4);
+    bool result = stbir_resize_uint8(pixels, width, height, 0, resized.data(), kWidth, kHeight, 0, 4) != 0;
+    stbi_image_free(pixels);
+    if (result) {
+        result = stbi_write_png(thumbnail.c_str(), kWidth, kHeight, 4, resized.data(), kWidth * 4) != 0;
+    }
+    return result;
+}
+
+}  // namespace
+
+AssetDatabase::AssetDatabase(std::string engine_asset_folder,
+                             std::string project_asset_folder,
+                             std::string cache_folder)
+    : engine_asset_folder_(NormalizeFolder(engine_asset_folder)),
+      project_asset_folder_(NormalizeFolder(project_asset_folder)),
+      cache_folder_(std::move(cache_folder)) {
+    RegisterThumbnailGenerator(fs::FileType::TEXTURE, TextureThumbnail);
+}
+
+AssetDatabase::~AssetDatabase() {
+    {
+        std::lock_guard<std::mutex> lock(scan_mutex_);
+        stop_ = true;
+    }
+    scan_condition_.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(thumbnail_mutex_);
+    }
+    thumbnail_condition_.notify_all();
+
+    if (scan_thread_.joinable()) {
+        scan_thread_.join();
+    }
+    if (thumbnail_thread_.joinable()) {
+        thumbnail_thread_.join();
+    }
+}
+
+void AssetDatabase::RegisterThumbnailGenerator(fs::FileType type, ThumbnailGenerator generator) {
+    std::lock_guard<std::mutex> lock(thumbnail_mutex_);
+    thumbnail_generators_[type] = std::move(generator);
+}
+
+void AssetDatabase::Start() {
+    if (scan_thread_.joinable()) {
+        Rescan();
+        return;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(cache_folder_) / "thumbnails", error);
+
+    scanning_ = true;
+    scan_thread_ = std::thread(&AssetDatabase::ScanWorker, this);
+    thumbnail_thread_ = std::thread(&AssetDatabase::ThumbnailWorker, this);
+}
+
+void AssetDatabase::Rescan() {
+    {
+        std::lock_guard<std::mutex> lock(scan_mutex_);
+        rescan_requested_ = true;
+    }
+    scan_condition_.notify_one();
+}
+
+std::shared_ptr<const AssetDatabase::Snapshot> AssetDatabase::CurrentSnapshot() const {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    return snapshot_;
+}
+
+bool AssetDatabase::IsScanning() const { return scanning_; }
+
+std::string AssetDatabase::ThumbnailFile(uint64_t hash) const {
+    return fmt::format("{}/thumbnails/{:016x}.png", cache_folder_, hash);
+}
+
+std::string AssetDatabase::ThumbnailPath(const Asset &asset) const {
+    std::lock_guard<std::mutex> lock(thumbnail_mutex_);
+    if (asset.hash != 0 && thumbnails_.count(asset.hash)) {
+        return ThumbnailFile(asset.hash);
+    }
+    return "";
+}
+
+uint64_t AssetDatabase::HashFile(const std::string &path) {
+    // FNV-1a, read in large chunks
+    uint64_t hash = 0xcbf29ce484222325ull;
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> chunk(1 << 16);
+    while (file) {
+        file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        const auto kCount = file.gcount();
+        for (std::streamsize i = 0; i < kCount; i++) {
+            hash ^= static_cast<uint8_t>(chunk[i]);
+            hash *= 0x100000001b3ull;
+        }
+    }
+    // 0 means not hashed
+    return hash == 0 ? 1 : hash;
+}
+
+// MARK: - Scan
+void AssetDatabase::ScanWorker() {
+    LoadIndex();
+    if (!known_assets_.empty()) {
+        std::vector<Asset> assets;
+        assets.reserve(known_assets_.size());
+        for (auto &[path, asset] : known_assets_) {
+            assets.push_back(asset);
+        }
+        Publish(std::move(assets));
+    }
+
+    while (!stop_) {
+        scanning_ = true;
+        std::vector<Asset> assets;
+        auto changed = Walk(assets);
+        // the tree is shown before the changed files are hashed
+        if (!changed.empty()) {
+            Publish(assets);
+        }
+        for (auto index : changed) {
+            if (stop_) {
+                return;
+            }
+            assets[index].hash = HashFile(assets[index].path);
+        }
+
+        known_assets_.clear();
+        for (const auto &asset : assets) {
+            known_assets_[asset.path] = asset;
+        }
+        SaveIndex(assets);
+
+        // thumbnails of the assets without one in the cache
+        {
+            std::unordered_set<fs::FileType> thumbnail_types;
+            {
+                std::lock_guard<std::mutex> lock(thumbnail_mutex_);
+                for (const auto &[type, generator] : thumbnail_generators_) {
+                    thumbnail_types.insert(type);
+                }
+            }
+            std::vector<ThumbnailRequest> requests;
+            for (const auto &asset : assets) {
+                if (asset.hash != 0 && thumbnail_types.count(asset.type)) {
+                    requests.push_back({asset.path, asset.hash, asset.type});
+                }
+            }
+            std::vector<uint64_t> cached;
+            std::vector<ThumbnailRequest> missing;
+            for (auto &request : requests) {
+                if (std::filesystem::exists(ThumbnailFile(request.hash))) {
+                    cached.push_back(request.hash);
+                } else {
+                    missing.push_back(std::move(request));
+                }
+            }
+            std::lock_guard<std::mutex> lock(thumbnail_mutex_);
+            thumbnails_.insert(cached.begin(), cached.end());
+            for (auto &request : missing) {
+                if (thumbnails_queued_.insert(request.hash).second) {
+                    thumbnail_requests_.push_back(std::move(request));
+                }
+            }
+        }
+        thumbnail_condition_.notify_one();
+
+        Publish(std::move(assets));
+        scanning_ = false;
+
+        std::unique_lock<std::mutex> lock(scan_mutex_);
+        scan_condition_.wait(lock, [this] { return rescan_requested_ || stop_; });
+        rescan_requested_ = false;
+    }
+}
+
+std::vector<size_t> AssetDatabase::Walk(std::vector<Asset> &assets) {
+    std::vector<size_t> changed;
+    auto walk = [&](const std::string &folder, bool is_engine) {
+        std::error_code error;
+        if (folder.empty() || !std::filesystem::is_directory(folder, error)) {
+            return;
+        }
+        Asset root;
+        root.path = folder;
+        root.is_engine = is_engine;
+        root.is_directory = true;
+        assets.push_back(root);
+
+        std::filesystem::recursive_directory_iterator iter(
+                folder, std::filesystem::directory_options::skip_permission_denied, error);
+        for (; !error && iter != std::filesystem::recursive_directory_iterator(); iter.increment(error)) {
+            const auto &entry = *iter;
+            const auto kName = entry.path().filename().string();
+            if (!kName.empty() && kName[0] == '.') {
+                if (entry.is_directory(error)) {
+                    iter.disable_recursion_pending();
+                }
+                continue;
+            }
+
+            Asset asset;
+            asset.path = ToGenericPath(entry.path());
+            asset.is_engine = is_engine;
+            asset.is_directory = entry.is_directory(error);
+            if (!asset.is_directory) {
+                asset.type = fs::ExtraFileType(asset.path);
+                asset.size = entry.file_size(error);
+                asset.timestamp = Timestamp(entry.last_write_time(error));
+
+                auto known = known_assets_.find(asset.path);
+                if (known != known_assets_.end() && known->second.size == asset.size &&
+                    known->second.timestamp == asset.timestamp && known->second.hash != 0) {
+                    asset.hash = known->second.hash;
+                } else {
+                    changed.push_back(assets.size());
+                }
+            }
+            assets.push_back(std::move(asset));
+        }
+    };
+    walk(engine_asset_folder_, true);
+    walk(project_asset_folder_, false);
+    return changed;
+}
+
+void AssetDatabase::Publish(std::vector<Asset> assets) {
+    auto snapshot = std::make_shared<Snapshot>();
+    std::sort(assets.begin(), assets.end(), [](const Asset &a, const Asset &b) { return a.path < b.path; });
+    snapshot->assets = std::move(assets);
+
+    std::unordered_set<std::string> folders{engine_asset_folder_, project_asset_folder_};
+    for (size_t i = 0; i < snapshot->assets.size(); i++) {
+        const auto &path = snapshot->assets[i].path;
+        if (folders.count(path)) {
+            snapshot->children[""].push_back(i);
+        } else {
+            snapshot->children[path.substr(0, path.find_last_of('/'))].push_back(i);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    snapshot->version = snapshot_ ? snapshot_->version + 1 : 1;
+    snapshot_ = std::move(snapshot);
+}
+
+// MARK: - Index
+void AssetDatabase::LoadIndex() {
+    std::ifstream file(cache_folder_ + "/asset_index.json");
+    if (!file) {
+        return;
+    }
+    auto data = nlohmann::json::parse(file, nullptr, false);
+    if (data.is_discarded() || !data.is_object() || !data.contains("version") ||
+        data["version"] != kIndexVersion) {
+        LOGW("Asset index of {} is invalid, every asset is hashed again", cache_folder_)
+        return;
+    }
+
+    try {
+        for (const auto &item : data.at("assets")) {
+            Asset asset;
+            asset.path = item.at(0).get<std::string>();
+            asset.is_engine = item.at(1).get<bool>();
+            asset.is_directory = item.at(2).get<bool>();
+            asset.size = item.at(3).get<uint64_t>();
+            asset.timestamp = item.at(4).get<int64_t>();
+            asset.hash = item.at(5).get<uint64_t>();
+            asset.type = asset.is_directory ? fs::FileType::UNKNOWN : fs::ExtraFileType(asset.path);
+            known_assets_[asset.path] = std::move(asset);
+        }
+    } catch (const nlohmann::json::exception &error) {
+        // a malformed index is rebuilt by the scan
+        LOGW("Asset index of {} is malformed, every asset is hashed again: {}", cache_folder_, error.what())
+        known_assets_.clear();
+    }
+}
+
+void AssetDatabase::SaveIndex(const std::vector<Asset> &assets) const {
+    nlohmann::json data;
+    data["version"] = kIndexVersion;
+    auto &items = data["assets"] = nlohmann::json::array();
+    for (const auto &asset : assets) {
+        items.push_back({asset.path, asset.is_engine, asset.is_directory, asset.size, asset.timestamp, asset.hash});
+    }
+
+    // written aside and renamed, an interrupted save keeps the previous index
+    const auto kPath = cache_folder_ + "/asset_index.json";
+    {
+        std::ofstream file(kPath + ".tmp");
+        file << data.dump();
+    }
+    std::error_code error;
+    std::filesystem::rename(kPath + ".tmp", kPath, error);
+    if (error) {
+        LOGW("Failed to save the asset index {}: {}", kPath, error.message())
+    }
+}
+
+// MARK: - Thumbnail
+void AssetDatabase::ThumbnailWorker() {
+    while (true) {
+        ThumbnailRequest request;
+        ThumbnailGenerator generator;
+        {
+            std::unique_lock<std::mutex> lock(thumbnail_mutex_);
+            thumbnail_condition_.wait(lock, [this] { return !thumbnail_requests_.empty() || stop_; });
+            if (stop_) {
+                return;
+            }
+            request = std::move(thumbnail_requests_.front());
+            thumbnail_requests_.pop_front();
+            // generators are only added, the type of a request has one
+            generator = thumbnail_generators_.at(request.type);
+        }
+
+        const auto kFile = ThumbnailFile(request.hash);
+        const bool kGenerated = generator(request.source, kFile, thumbnail_size_);
+
+        // a failed request stays queued, it is not retried by the next scans
+        if (kGenerated) {
+            std::lock_guard<std::mutex> lock(thumbnail_mutex_);
+            thumbnails_queued_.erase(request.hash);
+            thumbnails_.insert(request.hash);
+        }
+    }
+}
+
+}  // namespace vox::editor
@@ -0,0 +1,147 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "vox.render/platform/filesystem.h"
+
+namespace vox::editor {
+/**
+ * Index of the engine and project asset folders, maintained on background threads.
+ * The index is saved with the size, timestamp and content hash of every file, so a restart only hashes the files
+ * whose size or timestamp changed. Thumbnails are generated into a disk cache named by content hash, a renamed or
+ * copied asset keeps its thumbnail.
+ * Readers take the last published snapshot and never wait on a scan.
+ */
+class AssetDatabase {
+public:
+    struct Asset {
+        // absolute, '/' separated
+        std::string path;
+        fs::FileType type{fs::FileType::UNKNOWN};
+        bool is_engine{false};
+        bool is_directory{false};
+        uint64_t size{0};
+        int64_t timestamp{0};
+        // content hash, 0 for directories and files not hashed yet
+        uint64_t hash{0};
+    };
+
+    struct Snapshot {
+        uint64_t version{0};
+        // sorted by path
+        std::vector<Asset> assets;
+        // indices of the assets in each directory, the asset folders are the children of ""
+        std::unordered_map<std::string, std::vector<size_t>> children;
+    };
+
+    /**
+     * Writes a PNG thumbnail of source fitting in a square of size pixels, returns false when it can not.
+     * Called on the thumbnail thread.
+     */
+    using ThumbnailGenerator =
+            std::function<bool(const std::string &source, const std::string &thumbnail, uint32_t size)>;
+
+    static constexpr uint32_t thumbnail_size_ = 128;
+
+    /**
+     * @param cache_folder Folder of the index and thumbnails, names starting with '.' are not indexed
+     */
+    AssetDatabase(std::string engine_asset_folder, std::string project_asset_folder, std::string cache_folder);
+
+    ~AssetDatabase();
+
+    /**
+     * Textures have a generator by default. A generator registered after Start is used from the next scan on.
+     */
+    void RegisterThumbnailGenerator(fs::FileType type, ThumbnailGenerator generator);
+
+    /**
+     * Publish the saved index, then scan the folders on the background.
+     */
+    void Start();
+
+    /**
+     * Scan the folders again, the snapshot is republished when the scan finishes.
+     */
+    void Rescan();
+
+    [[nodiscard]] std::shared_ptr<const Snapshot> CurrentSnapshot() const;
+
+    [[nodiscard]] bool IsScanning() const;
+
+    /**
+     * Path of the thumbnail of the asset, empty while it is not generated.
+     */
+    [[nodiscard]] std::string ThumbnailPath(const Asset &asset) const;
+
+    static uint64_t HashFile(const std::string &path);
+
+private:
+    struct ThumbnailRequest {
+        std::string source;
+        uint64_t hash;
+        fs::FileType type;
+    };
+
+    void ScanWorker();
+
+    void ThumbnailWorker();
+
+    /**
+     * Walk the folders, with the hashes of unchanged files taken from the known assets.
+     * @return the files to hash
+     */
+    std::vector<size_t> Walk(std::vector<Asset> &assets);
+
+    void Publish(std::vector<Asset> assets);
+
+    void LoadIndex();
+
+    void SaveIndex(const std::vector<Asset> &assets) const;
+
+    [[nodiscard]] std::string ThumbnailFile(uint64_t hash) const;
+
+    const std::string engine_asset_folder_;
+    const std::string project_asset_folder_;
+    const std::string cache_folder_;
+    // guarded by the thumbnail mutex
+    std::unordered_map<fs::FileType, ThumbnailGenerator> thumbnail_generators_{};
+
+    // assets of the last scan, by path, only touched by the scan thread
+    std::unordered_map<std::string, Asset> known_assets_{};
+
+    mutable std::mutex snapshot_mutex_;
+    std::shared_ptr<const Snapshot> snapshot_{nullptr};
+    std::atomic<bool> scanning_{false};
+
+    std::mutex scan_mutex_;
+    std::condition_variable scan_condition_;
+    bool rescan_requested_{false};
+    std::atomic<bool> stop_{false};
+    std::thread scan_thread_;
+
+    mutable std::mutex thumbnail_mutex_;
+    std::condition_variable thumbnail_condition_;
+    std::deque<ThumbnailRequest> thumbnail_requests_{};
+    std::unordered_set<uint64_t> thumbnails_{};
+    std::unordered_set<uint64_t> thumbnails_queued_{};
+    std::thread thumbnail_thread_;
+};
+
+}  // namespace vox::editor
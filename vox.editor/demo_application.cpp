@@ -27,6 +27,7 @@ DemoApplication::~DemoApplication() {
     light_manager_.reset();
     shadow_manager_.reset();
     particle_manager_.reset();
+    skinning_manager_.reset();
 
     texture_manager_->CollectGarbage();
     texture_manager_.reset();
@@ -60,6 +61,7 @@ bool DemoApplication::Prepare(Platform &platform) {
     auto scene = scene_manager_->CurrentScene();
 
     particle_manager_ = std::make_unique<ParticleManager>(*device_, *render_context_);
+    skinning_manager_ = std::make_unique<SkinningManager>(*device_, *render_context_);
     light_manager_ = std::make_unique<LightManager>(scene, *render_context_);
     {
         auto extent = platform.GetWindow().GetExtent();
@@ -68,6 +70,7 @@ bool DemoApplication::Prepare(Platform &platform) {
                                               factor * extent.height);
     }
     light_manager_->SetCamera(main_camera_);
+    particle_manager_->SetCamera(main_camera_);
 
     // internal manager
     shadow_manager_ = std::make_unique<ShadowManager>(*device_, *render_context_, scene, main_camera_);
@@ -132,6 +135,7 @@ void DemoApplication::Render(CommandBuffer &command_buffer, RenderTarget &render
 }
 
 void DemoApplication::UpdateGpuTask(CommandBuffer &command_buffer, RenderTarget &render_target) {
+    skinning_manager_->Draw(command_buffer, render_target);
     shadow_manager_->Draw(command_buffer);
     light_manager_->Draw(command_buffer, render_target);
     particle_manager_->Draw(command_buffer, render_target);
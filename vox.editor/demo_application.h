@@ -14,6 +14,7 @@
 #include "vox.render/lighting/light_manager.h"
 #include "vox.render/lua/script_interpreter.h"
 #include "vox.render/mesh/mesh_manager.h"
+#include "vox.render/mesh/skinning_manager.h"
 #include "vox.render/particle/particle_manager.h"
 #include "vox.render/physics/physics_manager.h"
 #include "vox.render/scene_manager.h"
@@ -44,7 +45,7 @@ public:
 
     void Render(CommandBuffer &command_buffer, RenderTarget &render_target) override;
 
-    void UpdateGpuTask(CommandBuffer &command_buffer, RenderTarget &render_target);
+    virtual void UpdateGpuTask(CommandBuffer &command_buffer, RenderTarget &render_target);
 
     /**
      * Render every views (Scene View, Game View, Asset View)
@@ -86,6 +87,7 @@ protected:
     std::unique_ptr<ShadowManager> shadow_manager_{nullptr};
     std::unique_ptr<LightManager> light_manager_{nullptr};
     std::unique_ptr<ParticleManager> particle_manager_{nullptr};
+    std::unique_ptr<SkinningManager> skinning_manager_{nullptr};
 };
 
 }  // namespace vox::editor
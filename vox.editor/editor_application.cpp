@@ -43,6 +43,7 @@ EditorApplication::~EditorApplication() {
     light_manager_.reset();
     shadow_manager_.reset();
     particle_manager_.reset();
+    skinning_manager_.reset();
 
     texture_manager_->CollectGarbage();
     texture_manager_.reset();
@@ -76,6 +77,7 @@ bool EditorApplication::Prepare(Platform &platform) {
     auto scene = scene_manager_->CurrentScene();
 
     particle_manager_ = std::make_unique<ParticleManager>(*device_, *render_context_);
+    skinning_manager_ = std::make_unique<SkinningManager>(*device_, *render_context_);
     light_manager_ = std::make_unique<LightManager>(scene, *render_context_);
     {
         auto extent = platform.GetWindow().GetExtent();
@@ -84,6 +86,7 @@ bool EditorApplication::Prepare(Platform &platform) {
                                               factor * extent.height);
     }
     light_manager_->SetCamera(main_camera_);
+    particle_manager_->SetCamera(main_camera_);
 
     // internal manager
     shadow_manager_ = std::make_unique<ShadowManager>(*device_, *render_context_, scene, main_camera_);
@@ -168,6 +171,7 @@ void EditorApplication::Render(CommandBuffer &command_buffer, RenderTarget &rend
 }
 
 void EditorApplication::UpdateGpuTask(CommandBuffer &command_buffer, RenderTarget &render_target) {
+    skinning_manager_->Draw(command_buffer, render_target);
     shadow_manager_->Draw(command_buffer);
     light_manager_->Draw(command_buffer, render_target);
     particle_manager_->Draw(command_buffer, render_target);
@@ -14,6 +14,7 @@
 #include "vox.render/lighting/light_manager.h"
 #include "vox.render/lua/script_interpreter.h"
 #include "vox.render/mesh/mesh_manager.h"
+#include "vox.render/mesh/skinning_manager.h"
 #include "vox.render/particle/particle_manager.h"
 #include "vox.render/physics/physics_manager.h"
 #include "vox.render/scene_manager.h"
@@ -94,6 +95,7 @@ private:
     std::unique_ptr<ShadowManager> shadow_manager_{nullptr};
     std::unique_ptr<LightManager> light_manager_{nullptr};
     std::unique_ptr<ParticleManager> particle_manager_{nullptr};
+    std::unique_ptr<SkinningManager> skinning_manager_{nullptr};
 };
 
 }  // namespace vox::editor
@@ -6,91 +6,67 @@
 
 #include "vox.editor/profiling/profiler.h"
 
-#include <map>
-
-#include "vox.editor/profiling/profiler_spy.h"
+#include "vox.base/tracer.h"
 
 namespace vox {
-bool Profiler::enabled_;
-std::mutex Profiler::save_mutex_;
-std::unordered_map<std::string, double> Profiler::elapsed_history_;
-std::unordered_map<std::string, uint64_t> Profiler::calls_counter_;
-std::vector<std::thread::id> Profiler::working_threads_;
-uint32_t Profiler::elapsed_frames_;
-
 Profiler::Profiler() {
-    last_time_ = std::chrono::high_resolution_clock::now();
-    enabled_ = false;
+    last_time_ = std::chrono::steady_clock::now();
+    utility::Tracer::Disable();
 }
 
 ProfilerReport Profiler::GenerateReport() {
     ProfilerReport report;
 
-    if (elapsed_frames_ == 0) return report;
+    utility::Tracer::Flush();
+    const uint32_t elapsed_frames = utility::Tracer::ElapsedFrames();
+    if (elapsed_frames == 0) return report;
 
-    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - last_time_;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - last_time_;
 
-    report.working_threads = static_cast<uint16_t>((working_threads_.size() - 1) / elapsed_frames_);
-    report.elapsed_frames = elapsed_frames_;
+    /* The main thread is not counted as a working thread */
+    const uint32_t threads = utility::Tracer::WorkingThreads();
+    report.working_threads = static_cast<uint16_t>(threads > 0 ? threads - 1 : 0);
+    report.elapsed_frames = elapsed_frames;
     report.elapsed_time = elapsed.count();
 
-    std::multimap<double, std::string, std::greater<>> sorted_history;
-
-    /* Fill the sorted history with the current history (Auto sort) */
-    for (auto &data : elapsed_history_) sorted_history.insert(std::pair<double, std::string>(data.second, data.first));
-
-    /* Add every action to the report */
-    for (auto &data : sorted_history)
-        report.actions.push_back(
-                {data.second, data.first, (data.first / elapsed.count()) * 100.0, calls_counter_[data.second]});
+    /* Statistics are already sorted by decreasing duration */
+    for (auto &statistics : utility::Tracer::Statistics())
+        report.actions.push_back({statistics.name, statistics.duration,
+                                  (statistics.duration / elapsed.count()) * 100.0, statistics.calls});
 
     return report;
 }
 
 void Profiler::ClearHistory() {
-    elapsed_history_.clear();
-    calls_counter_.clear();
-    working_threads_.clear();
-    elapsed_frames_ = 0;
+    utility::Tracer::Flush();
+    utility::Tracer::ClearStatistics();
 
-    last_time_ = std::chrono::high_resolution_clock::now();
+    last_time_ = std::chrono::steady_clock::now();
 }
 
 void Profiler::Update(float delta_time) {
     if (IsEnabled()) {
-        ++elapsed_frames_;
+        utility::Tracer::Flush();
     }
 }
 
-void Profiler::Save(ProfilerSpy &spy) {
-    save_mutex_.lock();
-
-    /* Check if this thread is already registered */
-    if (std::find(working_threads_.begin(), working_threads_.end(), std::this_thread::get_id()) ==
-        working_threads_.end())
-        working_threads_.push_back(std::this_thread::get_id());
+bool Profiler::IsEnabled() { return utility::Tracer::IsEnabled(); }
 
-    if (elapsed_history_.find(spy.name) != elapsed_history_.end()) {
-        elapsed_history_[spy.name] += std::chrono::duration<double>(spy.end - spy.start).count();
-    } else {
-        elapsed_history_[spy.name] = std::chrono::duration<double>(spy.end - spy.start).count();
-    }
-
-    if (calls_counter_.find(spy.name) != calls_counter_.end()) {
-        ++calls_counter_[spy.name];
-    } else {
-        calls_counter_[spy.name] = 1;
-    }
-
-    save_mutex_.unlock();
+void Profiler::ToggleEnable() {
+    if (IsEnabled())
+        Disable();
+    else
+        Enable();
 }
 
-bool Profiler::IsEnabled() { return enabled_; }
+void Profiler::Enable() { utility::Tracer::Enable(); }
+
+void Profiler::Disable() { utility::Tracer::Disable(); }
 
-void Profiler::ToggleEnable() { enabled_ = !enabled_; }
+void Profiler::StartTrace() { utility::Tracer::BeginCapture(); }
 
-void Profiler::Enable() { enabled_ = true; }
+bool Profiler::StopTrace(const std::string &path) { return utility::Tracer::EndCapture(path); }
 
-void Profiler::Disable() { enabled_ = false; }
+bool Profiler::IsTracing() { return utility::Tracer::IsCapturing(); }
 
 }  // namespace vox
@@ -7,18 +7,14 @@
 #pragma once
 
 #include <chrono>
-#include <mutex>
-#include <thread>
-#include <unordered_map>
+#include <string>
 
 #include "vox.editor/profiling/profiler_report.h"
 
 namespace vox {
-/* Forward declaration of the profiler spy structure */
-struct ProfilerSpy;
-
 /**
- * The profiler collect data about the running program
+ * The profiler collect data about the running program.
+ * Spies are recorded by the per-thread utility::Tracer, the profiler aggregates them into reports.
  */
 class Profiler final {
 public:
@@ -38,16 +34,10 @@ public:
     void ClearHistory();
 
     /**
-     * Update the profiler
+     * Update the profiler, drain the recorded spies
      */
     static void Update(float delta_time);
 
-    /**
-     * Save the given spy collected data to the profiler history
-     * @param spy (Spy to collect data from)
-     */
-    static void Save(ProfilerSpy &spy);
-
     /**
      * Verify if the profiler is currently enabled
      */
@@ -68,19 +58,24 @@ public:
      */
     static void Disable();
 
+    /**
+     * Start recording a trace which can be opened in chrome://tracing or ui.perfetto.dev
+     */
+    static void StartTrace();
+
+    /**
+     * Stop recording the trace and write it to the given path
+     */
+    static bool StopTrace(const std::string &path);
+
+    /**
+     * Verify if a trace is currently recorded
+     */
+    static bool IsTracing();
+
 private:
     /* Time relatives */
     std::chrono::steady_clock::time_point last_time_;
-
-    /* Profiler settings */
-    static bool enabled_;
-
-    /* Collected data */
-    static std::mutex save_mutex_;
-    static std::unordered_map<std::string, double> elapsed_history_;
-    static std::unordered_map<std::string, uint64_t> calls_counter_;
-    static std::vector<std::thread::id> working_threads_;
-    static uint32_t elapsed_frames_;
 };
 
 }  // namespace vox
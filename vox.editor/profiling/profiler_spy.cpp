@@ -6,14 +6,12 @@
 
 #include "vox.editor/profiling/profiler_spy.h"
 
-#include <utility>
-
 namespace vox {
-ProfilerSpy::ProfilerSpy(std::string name) : name(std::move(name)), start(std::chrono::steady_clock::now()) {}
+ProfilerSpy::ProfilerSpy(const char *name)
+    : active(utility::Tracer::IsEnabled() && utility::Tracer::Begin(name)) {}
 
 ProfilerSpy::~ProfilerSpy() {
-    end = std::chrono::steady_clock::now();
-    Profiler::Save(*this);
+    if (active) utility::Tracer::End();
 }
 
 }  // namespace vox
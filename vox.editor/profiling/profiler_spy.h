@@ -6,9 +6,7 @@
 
 #pragma once
 
-#include <chrono>
-#include <string>
-
+#include "vox.base/tracer.h"
 #include "vox.editor/profiling/profiler.h"
 
 namespace vox {
@@ -17,20 +15,20 @@ namespace vox {
  * Any spy will die and send data to the profiler at
  * the end of the scope where this macro get called
  */
-#define PROFILER_SPY(name)                          \
-    std::unique_ptr<ProfilerSpy> __profiler_spy__ = \
-            Profiler::IsEnabled() ? std::make_unique<ProfilerSpy>(name) : nullptr
+#define PROFILER_SPY(name) ::vox::ProfilerSpy __profiler_spy__(name)
 
 /**
  * A little informer that is created when PROFILER_SPY(name) is written.
  * It helps collecting information about methods durations for debugging
- * event in release
+ * event in release. Nothing is allocated: the spy records begin/end events
+ * in the calling thread tracer buffer.
+ * @note name must outlive the profiler (string literal or utility::Tracer::Intern)
  */
 struct ProfilerSpy final {
     /**
      * Create the profiler spy with the given name.
      */
-    explicit ProfilerSpy(std::string name);
+    explicit ProfilerSpy(const char *name);
 
     /**
      * Destroy the profiler spy.
@@ -38,9 +36,11 @@ struct ProfilerSpy final {
      */
     ~ProfilerSpy();
 
-    const std::string name;
-    const std::chrono::steady_clock::time_point start;
-    std::chrono::steady_clock::time_point end;
+    ProfilerSpy(const ProfilerSpy &) = delete;
+
+    ProfilerSpy &operator=(const ProfilerSpy &) = delete;
+
+    const bool active;
 };
 
 }  // namespace vox
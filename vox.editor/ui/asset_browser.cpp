@@ -6,29 +6,118 @@
 
 #include "vox.editor/ui/asset_browser.h"
 
+#include "vox.render/ui/widgets/buttons/button_simple.h"
+#include "vox.render/ui/widgets/texts/text.h"
+#include "vox.render/ui/widgets/visual/separator.h"
+
 namespace vox::editor::ui {
 AssetBrowser::AssetBrowser(const std::string &title,
                            bool opened,
                            const ::vox::ui::PanelWindowSettings &window_settings,
                            const std::string &engine_asset_folder,
                            const std::string &project_asset_folder,
-                           const std::string &project_script_folder) {}
+                           const std::string &project_script_folder)
+    : PanelWindow(title, opened, window_settings),
+      engine_asset_folder_(engine_asset_folder),
+      project_asset_folder_(project_asset_folder),
+      project_script_folder_(project_script_folder) {
+    const auto &cache_root = project_asset_folder_.empty() ? engine_asset_folder_ : project_asset_folder_;
+    database_ = std::make_unique<AssetDatabase>(engine_asset_folder_, project_asset_folder_, cache_root + "/.cache");
+
+    auto &refresh_button = CreateWidget<::vox::ui::ButtonSimple>("Rescan");
+    refresh_button.clicked_event_ += [this] { database_->Rescan(); };
+    CreateWidget<::vox::ui::Separator>();
+    asset_list_ = &CreateWidget<::vox::ui::Group>();
+
+    database_->Start();
+    Fill();
+}
+
+AssetDatabase &AssetBrowser::Database() { return *database_; }
 
-void AssetBrowser::Fill() {}
+void AssetBrowser::DrawImpl() {
+    // the tree is rebuilt when the database publishes, never waiting on a scan
+    auto snapshot = database_->CurrentSnapshot();
+    if (snapshot != snapshot_) {
+        Refresh();
+    }
+    PanelWindow::DrawImpl();
+}
 
-void AssetBrowser::Clear() {}
+void AssetBrowser::Fill() {
+    snapshot_ = database_->CurrentSnapshot();
+    if (!snapshot_) {
+        asset_list_->CreateWidget<::vox::ui::Text>("Indexing assets...");
+        return;
+    }
 
-void AssetBrowser::Refresh() {}
+    auto roots = snapshot_->children.find("");
+    if (roots != snapshot_->children.end()) {
+        for (auto index : roots->second) {
+            const auto &asset = snapshot_->assets[index];
+            ConsiderItem(nullptr, asset, asset.is_engine, true, asset.path == project_script_folder_);
+        }
+    }
+}
+
+void AssetBrowser::Clear() {
+    asset_list_->RemoveAllWidgets();
+    path_update_.clear();
+}
+
+void AssetBrowser::Refresh() {
+    Clear();
+    Fill();
+}
 
 void AssetBrowser::ParseFolder(::vox::ui::TreeNode &root,
-                               const std::filesystem::directory_entry &directory,
+                               const AssetDatabase::Asset &directory,
                                bool is_engine_item,
-                               bool script_folder) {}
+                               bool script_folder) {
+    auto children = snapshot_->children.find(directory.path);
+    if (children == snapshot_->children.end()) {
+        return;
+    }
+    // folders first
+    for (auto index : children->second) {
+        if (snapshot_->assets[index].is_directory) {
+            ConsiderItem(&root, snapshot_->assets[index], is_engine_item, false, script_folder);
+        }
+    }
+    for (auto index : children->second) {
+        if (!snapshot_->assets[index].is_directory) {
+            ConsiderItem(&root, snapshot_->assets[index], is_engine_item, false, script_folder);
+        }
+    }
+}
 
 void AssetBrowser::ConsiderItem(::vox::ui::TreeNode *root,
-                                const std::filesystem::directory_entry &entry,
+                                const AssetDatabase::Asset &entry,
                                 bool is_engine_item,
                                 bool auto_open,
-                                bool script_folder) {}
+                                bool script_folder) {
+    const auto kName = fs::ExtraElementName(entry.path);
+    auto &item = root ? root->CreateWidget<::vox::ui::TreeNode>(kName, true)
+                      : asset_list_->CreateWidget<::vox::ui::TreeNode>(kName, true);
+    path_update_[&item] = entry.path;
+
+    if (entry.is_directory) {
+        // the content of a folder is only created when it is opened, the snapshot owns the assets
+        item.opened_event_ += [this, &item, &entry, is_engine_item, script_folder] {
+            folder_opened_[entry.path] = true;
+            if (item.Widgets().empty()) {
+                ParseFolder(item, entry, is_engine_item, script_folder);
+            }
+        };
+        item.closed_event_ += [this, &entry] { folder_opened_[entry.path] = false; };
+
+        auto state = folder_opened_.find(entry.path);
+        if (state != folder_opened_.end() ? state->second : auto_open) {
+            item.Open();
+        }
+    } else {
+        item.leaf_ = true;
+    }
+}
 
 }  // namespace vox::editor::ui
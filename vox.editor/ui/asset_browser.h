@@ -6,17 +6,19 @@
 
 #pragma once
 
-#include <filesystem>
-#include <queue>
+#include <memory>
 #include <unordered_map>
 
+#include "vox.editor/asset_database.h"
 #include "vox.render/ui/widgets/layout/group.h"
 #include "vox.render/ui/widgets/layout/tree_node.h"
 #include "vox.render/ui/widgets/panel_transformables/panel_window.h"
 
 namespace vox::editor::ui {
 /**
- * A panel that handle asset management
+ * A panel that handle asset management.
+ * The tree is built from the snapshots of the asset database, folders are filled when they are first opened.
+ * The folders opened or closed by the user keep their state when a new snapshot rebuilds the tree.
  */
 class AssetBrowser : public ::vox::ui::PanelWindow {
 public:
@@ -42,14 +44,19 @@ public:
      */
     void Refresh();
 
+    [[nodiscard]] AssetDatabase &Database();
+
+protected:
+    void DrawImpl() override;
+
 private:
     void ParseFolder(::vox::ui::TreeNode &root,
-                     const std::filesystem::directory_entry &directory,
+                     const AssetDatabase::Asset &directory,
                      bool is_engine_item,
                      bool script_folder = false);
 
     void ConsiderItem(::vox::ui::TreeNode *root,
-                      const std::filesystem::directory_entry &entry,
+                      const AssetDatabase::Asset &entry,
                       bool is_engine_item,
                       bool auto_open = false,
                       bool script_folder = false);
@@ -63,6 +70,12 @@ private:
     std::string project_script_folder_;
     ::vox::ui::Group *asset_list_;
     std::unordered_map<::vox::ui::TreeNode *, std::string> path_update_;
+    // open state of the folders the user toggled, by path
+    std::unordered_map<std::string, bool> folder_opened_;
+
+    std::unique_ptr<AssetDatabase> database_{nullptr};
+    // snapshot the widgets are built from
+    std::shared_ptr<const AssetDatabase::Snapshot> snapshot_{nullptr};
 };
 
 }  // namespace vox::editor::ui
@@ -28,6 +28,17 @@ ProfilerWindow::ProfilerWindow(const std::string &title,
         profiling_mode_ = profiling_mode_ == ProfilingMode::CAPTURE ? ProfilingMode::DEFAULT : ProfilingMode::CAPTURE;
         capture_resume_button_->label_ = profiling_mode_ == ProfilingMode::CAPTURE ? "Resume" : "Capture";
     };
+    trace_button_ = &CreateWidget<ButtonSimple>("Record Trace");
+    trace_button_->idle_background_color_ = {0.5f, 0.5f, 0.7f};
+    trace_button_->clicked_event_ += [this] {
+        if (Profiler::IsTracing()) {
+            if (Profiler::StopTrace("profiler_trace.json")) LOGI("Trace saved to profiler_trace.json")
+            trace_button_->label_ = "Record Trace";
+        } else {
+            Profiler::StartTrace();
+            trace_button_->label_ = "Stop Trace";
+        }
+    };
     elapsed_frames_text_ = &CreateWidget<TextColored>("", Color(1.f, 0.8f, 0.01f, 1));
     elapsed_time_text_ = &CreateWidget<TextColored>("", Color(1.f, 0.8f, 0.01f, 1));
     separator_ = &CreateWidget<::vox::ui::Separator>();
@@ -87,11 +98,16 @@ void ProfilerWindow::Enable(bool value, bool disable_log) {
     } else {
         if (!disable_log) LOGI("Profiling stop!")
         vox::Profiler::Disable();
+        if (Profiler::IsTracing()) {
+            Profiler::StopTrace("profiler_trace.json");
+            trace_button_->label_ = "Record Trace";
+        }
         profiler_.ClearHistory();
         action_list_->RemoveAllWidgets();
     }
 
     capture_resume_button_->enabled_ = value;
+    trace_button_->enabled_ = value;
     elapsed_frames_text_->enabled_ = value;
     elapsed_time_text_->enabled_ = value;
     separator_->enabled_ = value;
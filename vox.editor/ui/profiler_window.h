@@ -52,6 +52,7 @@ private:
 
     Widget *separator_;
     ButtonSimple *capture_resume_button_;
+    ButtonSimple *trace_button_;
     TextColored *fps_text_;
     TextColored *elapsed_frames_text_;
     TextColored *elapsed_time_text_;
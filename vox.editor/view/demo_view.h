@@ -7,13 +7,12 @@
 #pragma once
 
 #include "vox.render/controls/orbit_control.h"
-#include "vox.render/rendering/subpasses/color_picker_subpass.h"
+#include "vox.render/rendering/framebuffer_picker.h"
 #include "vox.editor/imgui/imgui_zmo.h"
 #include "vox.editor/view/view.h"
 
 namespace vox {
 using namespace ui;
-class ColorPickerSubpass;
 namespace editor {
 class DemoApplication;
 namespace ui {
@@ -64,21 +63,8 @@ private:
     control::OrbitControl *camera_control_{nullptr};
 
 private:
-    bool need_pick_{};
-    Vector2F pick_pos_;
-
-    std::unique_ptr<RenderTarget> color_picker_render_target_{nullptr};
-    std::unique_ptr<RenderPipeline> color_picker_render_pipeline_{nullptr};
-    ColorPickerSubpass *color_picker_subpass_{nullptr};
+    std::unique_ptr<FramebufferPicker> picker_{nullptr};
     std::pair<Renderer *, MeshPtr> pick_result_;
-
-    std::array<uint8_t, 4> pixel_{};
-    std::unique_ptr<core::Buffer> stage_buffer_;
-
-    std::vector<VkBufferImageCopy> regions_;
-
-    void CopyRenderTargetToBuffer(CommandBuffer &command_buffer);
-    void ReadColorFromRenderTarget();
 };
 
 }  // namespace ui
@@ -13,7 +13,6 @@
 #include "vox.render/material/unlit_material.h"
 #include "vox.render/mesh/mesh_renderer.h"
 #include "vox.render/mesh/primitive_mesh.h"
-#include "vox.render/rendering/subpasses/color_picker_subpass.h"
 #include "vox.render/rendering/subpasses/geometry_subpass.h"
 
 namespace vox::editor::ui {
@@ -40,28 +39,10 @@ SceneView::SceneView(const std::string &title,
         render_pipeline_->SetClearValue(clear_value);
     }
 
-    // color picker render target
-    {
-        auto subpass = std::make_unique<ColorPickerSubpass>(render_context, scene, main_camera_);
-        color_picker_subpass_ = subpass.get();
-        color_picker_render_pipeline_ = std::make_unique<RenderPipeline>();
-        color_picker_render_pipeline_->AddSubpass(std::move(subpass));
-        auto clear_value = color_picker_render_pipeline_->GetClearValue();
-        clear_value[0].color = {1.0f, 1.0f, 1.0f, 1.0f};
-        color_picker_render_pipeline_->SetClearValue(clear_value);
-
-        // dont't render grid when pick
-        color_picker_subpass_->AddExclusiveRenderer(editor_root->GetComponent<MeshRenderer>());
-    }
-
-    stage_buffer_ = std::make_unique<core::Buffer>(render_context.GetDevice(), 4, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                                   VMA_MEMORY_USAGE_GPU_TO_CPU);
-
-    regions_.resize(1);
-    regions_[0].imageSubresource.layerCount = 1;
-    regions_[0].imageExtent.width = 1;
-    regions_[0].imageExtent.height = 1;
-    regions_[0].imageExtent.depth = 1;
+    // color picker
+    picker_ = std::make_unique<FramebufferPicker>(render_context, scene, main_camera_);
+    // dont't render grid when pick
+    picker_->Subpass().AddExclusiveRenderer(editor_root->GetComponent<MeshRenderer>());
 }
 
 void SceneView::LoadScene(Entity *root_entity) {
@@ -95,11 +76,10 @@ void SceneView::Update(float delta_time) {
     View::Update(delta_time);
 
     auto [win_width, win_height] = SafeSize();
-    if (win_width > 0 &&
-        (!color_picker_render_target_ || color_picker_render_target_->GetExtent().width != win_width * 2)) {
+    if (win_width > 0 && (main_camera_->FramebufferWidth() != win_width * 2 ||
+                          main_camera_->FramebufferHeight() != win_height * 2)) {
         main_camera_->SetAspectRatio(float(win_width) / float(win_height));
         main_camera_->Resize(win_width, win_height, win_width * 2, win_height * 2);
-        color_picker_render_target_ = CreateRenderTarget(win_width * 2, win_height * 2, VK_FORMAT_R8G8B8A8_UNORM);
     }
 }
 
@@ -118,18 +98,8 @@ void SceneView::Render(CommandBuffer &command_buffer) {
     if (render_target_ && IsFocused()) {
         elapsed_frames_ = false;
 
-        if (need_pick_) {
-            color_picker_render_pipeline_->Draw(command_buffer, *color_picker_render_target_);
-            command_buffer.EndRenderPass();
-            CopyRenderTargetToBuffer(command_buffer);
-        }
-
+        picker_->Draw(command_buffer);
         render_pipeline_->Draw(command_buffer, *render_target_);
-
-        if (need_pick_) {
-            ReadColorFromRenderTarget();
-            need_pick_ = false;
-        }
     }
 }
 
@@ -180,44 +150,11 @@ void SceneView::DrawImpl() {
 }
 
 void SceneView::Pick(float offset_x, float offset_y) {
-    need_pick_ = true;
-    pick_pos_ = Vector2F(offset_x, offset_y);
-}
-
-void SceneView::CopyRenderTargetToBuffer(CommandBuffer &command_buffer) {
-    uint32_t client_width = main_camera_->Width();
-    uint32_t client_height = main_camera_->Height();
-    uint32_t canvas_width = main_camera_->FramebufferWidth();
-    uint32_t canvas_height = main_camera_->FramebufferHeight();
-
-    const float kPx = (pick_pos_.x / static_cast<float>(client_width)) * static_cast<float>(canvas_width);
-    const float kPy = (pick_pos_.y / static_cast<float>(client_height)) * static_cast<float>(canvas_height);
-
-    const auto kViewport = main_camera_->Viewport();
-    const auto kViewWidth = (kViewport.z - kViewport.x) * static_cast<float>(canvas_width);
-    const auto kViewHeight = (kViewport.w - kViewport.y) * static_cast<float>(canvas_height);
-
-    const float kNx = (kPx - kViewport.x) / kViewWidth;
-    const float kNy = (kPy - kViewport.y) / kViewHeight;
-    const uint32_t kLeft = std::floor(kNx * static_cast<float>(canvas_width - 1));
-    const uint32_t kBottom = std::floor((1 - kNy) * static_cast<float>(canvas_height - 1));
-
-    regions_[0].imageOffset.x = static_cast<int32_t>(kLeft);
-    regions_[0].imageOffset.y = static_cast<int32_t>(canvas_height - kBottom);
-    command_buffer.CopyImageToBuffer(color_picker_render_target_->GetViews().at(0).GetImage(),
-                                     VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, *stage_buffer_, regions_);
-}
-
-void SceneView::ReadColorFromRenderTarget() {
-    uint8_t *raw = stage_buffer_->Map();
-    if (raw) {
-        memcpy(pixel_.data(), raw, 4);
-        auto result = color_picker_subpass_->GetObjectByColor(pixel_);
-        if (result.first) {
-            pick_result_ = result;
+    picker_->Pick(Vector2F(offset_x, offset_y), [this](const std::vector<FramebufferPicker::PickResult> &results) {
+        if (!results.empty()) {
+            pick_result_ = results.front();
         }
-    }
-    stage_buffer_->Unmap();
+    });
 }
 
 void SceneView::InputEvent(const vox::InputEvent &input_event) {
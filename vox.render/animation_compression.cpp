@@ -0,0 +1,275 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.render/animation_compression.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace vox {
+namespace {
+constexpr float kTimeQuanta = 65535.0f;
+constexpr float kValueQuanta = 65535.0f;
+constexpr float kComponentQuanta = 32767.0f;
+// the three smallest components of a unit quaternion lie in [-1/sqrt(2), 1/sqrt(2)]
+constexpr float kSmallestThreeRange = 0.70710678f;
+// bounds the cost of the key reduction, which checks every source key of a segment each time it grows
+constexpr uint32_t kMaxSegmentKeys = 1024;
+
+float DefaultErrorMetric(const Vector4F &reference, const Vector4F &approximation, bool is_rotation) {
+    if (is_rotation) {
+        const float length = reference.length() * approximation.length();
+        const float cos_half_angle = length > 0.0f ? std::fabs(reference.dot(approximation)) / length : 1.0f;
+        return 2.0f * std::acos(std::min(cos_half_angle, 1.0f));
+    }
+    const float dx = reference.x - approximation.x;
+    const float dy = reference.y - approximation.y;
+    const float dz = reference.z - approximation.z;
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+Vector4F Interpolate(const Vector4F &a, const Vector4F &b, float t, bool is_rotation) {
+    if (!is_rotation) {
+        return a * (1.0f - t) + b * t;
+    }
+    // nlerp along the shortest path, its error against the source keys is bounded when compressing
+    const float sign = a.dot(b) < 0.0f ? -1.0f : 1.0f;
+    const Vector4F q = a * (1.0f - t) + b * (t * sign);
+    const float length = q.length();
+    return length > 0.0f ? q * (1.0f / length) : a;
+}
+
+void EncodeQuaternion(const Vector4F &value, uint16_t *packed) {
+    const float length = value.length();
+    const Vector4F q = length > 0.0f ? value * (1.0f / length) : Vector4F(0, 0, 0, 1);
+
+    uint32_t largest = 0;
+    for (uint32_t i = 1; i < 4; i++) {
+        if (std::fabs(q[i]) > std::fabs(q[largest])) largest = i;
+    }
+    // q and -q are the same rotation, keep the dropped component positive
+    const float sign = q[largest] < 0.0f ? -1.0f : 1.0f;
+
+    uint32_t j = 0;
+    for (uint32_t i = 0; i < 4; i++) {
+        if (i == largest) continue;
+        const float normalized = std::clamp(q[i] * sign / kSmallestThreeRange, -1.0f, 1.0f);
+        packed[j++] = static_cast<uint16_t>(std::lround((normalized * 0.5f + 0.5f) * kComponentQuanta));
+    }
+    // the index of the largest component goes in the free high bits
+    packed[0] |= static_cast<uint16_t>((largest & 1) << 15);
+    packed[1] |= static_cast<uint16_t>((largest >> 1) << 15);
+}
+
+Vector4F DecodeQuaternion(const uint16_t *packed) {
+    const uint32_t largest = (packed[0] >> 15) | ((packed[1] >> 15) << 1);
+
+    Vector4F q;
+    float sum = 0.0f;
+    uint32_t j = 0;
+    for (uint32_t i = 0; i < 4; i++) {
+        if (i == largest) continue;
+        const float value =
+                (static_cast<float>(packed[j++] & 0x7fff) / kComponentQuanta * 2.0f - 1.0f) * kSmallestThreeRange;
+        q[i] = value;
+        sum += value * value;
+    }
+    q[largest] = std::sqrt(std::max(0.0f, 1.0f - sum));
+    return q;
+}
+
+}  // namespace
+
+CompressedAnimationTrack CompressedAnimationTrack::Compress(const std::vector<float> &times,
+                                                            const std::vector<Vector4F> &values,
+                                                            bool is_step,
+                                                            bool is_rotation,
+                                                            float tolerance,
+                                                            const AnimationCompressionSettings::ErrorMetric &error_metric) {
+    CompressedAnimationTrack track;
+    const size_t count = std::min(times.size(), values.size());
+    if (count == 0) {
+        return track;
+    }
+
+    auto metric = [&](const Vector4F &reference, const Vector4F &approximation) {
+        return error_metric ? error_metric(reference, approximation, is_rotation)
+                            : DefaultErrorMetric(reference, approximation, is_rotation);
+    };
+
+    track.is_step_ = is_step;
+    const float duration = times[count - 1] - times[0];
+    bool is_constant = duration <= 0.0f;
+    if (!is_constant) {
+        is_constant = std::all_of(values.begin(), values.begin() + count,
+                                  [&](const Vector4F &value) { return metric(value, values[0]) <= tolerance; });
+    }
+    if (is_constant) {
+        track.type_ = Type::CONSTANT;
+        track.value_ = is_rotation ? values[0].normalized() : values[0];
+        return track;
+    }
+
+    track.type_ = is_rotation ? Type::ROTATION : Type::VECTOR;
+    track.start_time_ = times[0];
+    track.inv_time_scale_ = kTimeQuanta / duration;
+    if (!is_rotation) {
+        Vector4F min_value = values[0];
+        Vector4F max_value = values[0];
+        for (size_t i = 1; i < count; i++) {
+            for (size_t c = 0; c < 3; c++) {
+                min_value[c] = std::min(min_value[c], values[i][c]);
+                max_value[c] = std::max(max_value[c], values[i][c]);
+            }
+        }
+        track.value_ = Vector4F(min_value.x, min_value.y, min_value.z, 0.0f);
+        track.extent_ = Vector4F(max_value.x - min_value.x, max_value.y - min_value.y, max_value.z - min_value.z, 0.0f);
+    }
+
+    // quantize every key first, the reduction measures the error of what the runtime decodes
+    std::vector<uint16_t> quantized_times(count);
+    std::vector<uint16_t> encoded(count * 3);
+    for (size_t i = 0; i < count; i++) {
+        // a step key rounded up would only switch after its source time, so step times are rounded down
+        const float time = std::clamp(track.QuantizedTime(times[i]), 0.0f, kTimeQuanta);
+        quantized_times[i] = static_cast<uint16_t>(is_step ? std::floor(time) : std::round(time));
+        if (is_rotation) {
+            EncodeQuaternion(values[i], &encoded[i * 3]);
+        } else {
+            for (size_t c = 0; c < 3; c++) {
+                const float normalized = track.extent_[c] > 0.0f
+                                                 ? std::clamp((values[i][c] - track.value_[c]) / track.extent_[c],
+                                                              0.0f, 1.0f)
+                                                 : 0.0f;
+                encoded[i * 3 + c] = static_cast<uint16_t>(std::lround(normalized * kValueQuanta));
+            }
+        }
+    }
+
+    // keys sharing a quantized time collapse to the last one, which is still checked against all of them
+    std::vector<uint32_t> candidates;
+    candidates.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        if (!candidates.empty() && quantized_times[candidates.back()] == quantized_times[i]) {
+            candidates.back() = i;
+        } else {
+            candidates.push_back(i);
+        }
+    }
+
+    auto segment_fits = [&](uint32_t first, uint32_t last) {
+        const Vector4F first_value = track.Decode(&encoded[first * 3]);
+        const Vector4F last_value = track.Decode(&encoded[last * 3]);
+        const auto first_time = static_cast<float>(quantized_times[first]);
+        const auto last_time = static_cast<float>(quantized_times[last]);
+        for (uint32_t i = first; i <= last; i++) {
+            const float time = track.QuantizedTime(times[i]);
+            Vector4F approximation;
+            if (is_step) {
+                approximation = time >= last_time ? last_value : first_value;
+            } else {
+                const float t = std::clamp((time - first_time) / (last_time - first_time), 0.0f, 1.0f);
+                approximation = Interpolate(first_value, last_value, t, is_rotation);
+            }
+            if (metric(values[i], approximation) > tolerance) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // greedy reduction: extend each segment while every source key it spans stays within the tolerance
+    std::vector<uint32_t> kept{candidates[0]};
+    size_t anchor = 0;
+    while (anchor + 1 < candidates.size()) {
+        size_t end = anchor + 1;
+        while (end + 1 < candidates.size() && candidates[end + 1] - candidates[anchor] <= kMaxSegmentKeys &&
+               segment_fits(candidates[anchor], candidates[end + 1])) {
+            end++;
+        }
+        kept.push_back(candidates[end]);
+        anchor = end;
+    }
+
+    track.times_.reserve(kept.size());
+    track.values_.reserve(kept.size() * 3);
+    for (auto key : kept) {
+        track.times_.push_back(quantized_times[key]);
+        track.values_.insert(track.values_.end(), &encoded[key * 3], &encoded[key * 3] + 3);
+    }
+    return track;
+}
+
+bool CompressedAnimationTrack::IsEmpty() const { return type_ == Type::EMPTY; }
+
+bool CompressedAnimationTrack::IsConstant() const { return type_ == Type::CONSTANT; }
+
+uint32_t CompressedAnimationTrack::KeyCount() const {
+    switch (type_) {
+        case Type::EMPTY:
+            return 0;
+        case Type::CONSTANT:
+            return 1;
+        default:
+            return static_cast<uint32_t>(times_.size());
+    }
+}
+
+float CompressedAnimationTrack::QuantizedTime(float time) const { return (time - start_time_) * inv_time_scale_; }
+
+Vector4F CompressedAnimationTrack::Decode(const uint16_t *packed) const {
+    if (type_ == Type::ROTATION) {
+        return DecodeQuaternion(packed);
+    }
+    return {value_.x + static_cast<float>(packed[0]) / kValueQuanta * extent_.x,
+            value_.y + static_cast<float>(packed[1]) / kValueQuanta * extent_.y,
+            value_.z + static_cast<float>(packed[2]) / kValueQuanta * extent_.z, 0.0f};
+}
+
+uint32_t CompressedAnimationTrack::FindKey(float time, uint32_t cursor) const {
+    if (times_.size() < 2) return 0;
+
+    const auto last = static_cast<uint32_t>(times_.size() - 1);
+    const float q = QuantizedTime(time);
+    cursor = std::min(cursor, last - 1);
+    if (q >= static_cast<float>(times_[cursor])) {
+        for (int step = 0; step < 2 && cursor + 1 < last && q >= static_cast<float>(times_[cursor + 1]); step++) {
+            cursor++;
+        }
+        if (cursor + 1 == last || q < static_cast<float>(times_[cursor + 1])) {
+            return cursor;
+        }
+    }
+
+    const auto iter = std::upper_bound(times_.begin(), times_.begin() + last, q,
+                                       [](float value, uint16_t key_time) { return value < key_time; });
+    return iter == times_.begin() ? 0 : static_cast<uint32_t>(iter - times_.begin() - 1);
+}
+
+Vector4F CompressedAnimationTrack::Sample(float time, uint32_t key) const {
+    if (type_ == Type::EMPTY || type_ == Type::CONSTANT) {
+        return value_;
+    }
+
+    const auto last = static_cast<uint32_t>(times_.size() - 1);
+    const float q = QuantizedTime(time);
+    if (last == 0 || q <= static_cast<float>(times_[0])) return Decode(&values_[0]);
+    if (q >= static_cast<float>(times_[last])) return Decode(&values_[last * 3]);
+
+    key = std::min(key, last - 1);
+    if (is_step_) {
+        return Decode(&values_[key * 3]);
+    }
+    const auto first_time = static_cast<float>(times_[key]);
+    const float t = (q - first_time) / (static_cast<float>(times_[key + 1]) - first_time);
+    return Interpolate(Decode(&values_[key * 3]), Decode(&values_[(key + 1) * 3]), t, type_ == Type::ROTATION);
+}
+
+size_t CompressedAnimationTrack::MemorySize() const {
+    return sizeof(CompressedAnimationTrack) + (times_.capacity() + values_.capacity()) * sizeof(uint16_t);
+}
+
+}  // namespace vox
@@ -0,0 +1,97 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "vox.math/vector4.h"
+
+namespace vox {
+struct AnimationCompressionSettings {
+    /**
+     * Distance between a reference value and its approximation.
+     */
+    using ErrorMetric =
+            std::function<float(const Vector4F &reference, const Vector4F &approximation, bool is_rotation)>;
+
+    // maximum error of translation tracks, in scene units
+    float translation_tolerance = 1e-4f;
+    // maximum error of rotation tracks, in radians
+    float rotation_tolerance = 1e-3f;
+    // maximum error of scale tracks
+    float scale_tolerance = 1e-4f;
+    // cubic spline tracks are resampled at this rate, in keys per second, at least 1
+    float sample_rate = 30.0f;
+    // nullptr uses the euclidean distance for vectors and the rotation angle for quaternions
+    ErrorMetric error_metric = nullptr;
+};
+
+/**
+ * @brief A linearly interpolated (or stepped) animation track in 6 bytes per key plus 2 bytes per key time.
+ *        - Constant tracks are stored as a single value.
+ *        - Rotations are stored as smallest-three quaternions, 15 bits per component.
+ *        - Translations and scales are quantized to 16 bits per component in the range of the track.
+ *        - Key times are quantized to 16 bits in the range of the track.
+ *        - Keys are removed while the reconstruction stays within the tolerance of every source key.
+ *          The tolerance can not go below the error of the 16 bits time and value quantization, a fast
+ *          track quantized over a long range keeps all its keys and still exceeds a tolerance below it.
+ */
+class CompressedAnimationTrack {
+public:
+    /**
+     * @param times Key times, increasing
+     * @param values Key values, quaternions stored as (x, y, z, w)
+     * @param is_step Step interpolation, linear otherwise
+     */
+    static CompressedAnimationTrack Compress(const std::vector<float> &times,
+                                             const std::vector<Vector4F> &values,
+                                             bool is_step,
+                                             bool is_rotation,
+                                             float tolerance,
+                                             const AnimationCompressionSettings::ErrorMetric &error_metric);
+
+    [[nodiscard]] bool IsEmpty() const;
+
+    [[nodiscard]] bool IsConstant() const;
+
+    [[nodiscard]] uint32_t KeyCount() const;
+
+    /**
+     * @brief Key segment containing the time, starting from the cursor of the previous evaluation.
+     */
+    [[nodiscard]] uint32_t FindKey(float time, uint32_t cursor) const;
+
+    [[nodiscard]] Vector4F Sample(float time, uint32_t key) const;
+
+    /**
+     * @brief Heap and inline memory used by the track, in bytes.
+     */
+    [[nodiscard]] size_t MemorySize() const;
+
+private:
+    enum class Type : uint8_t { EMPTY, CONSTANT, ROTATION, VECTOR };
+
+    [[nodiscard]] float QuantizedTime(float time) const;
+
+    [[nodiscard]] Vector4F Decode(const uint16_t *packed) const;
+
+    Type type_{Type::EMPTY};
+    bool is_step_{false};
+
+    float start_time_{0.0f};
+    float inv_time_scale_{0.0f};
+
+    // constant value, or minimum of the quantization range
+    Vector4F value_;
+    Vector4F extent_;
+
+    std::vector<uint16_t> times_;
+    std::vector<uint16_t> values_;
+};
+
+}  // namespace vox
@@ -132,6 +132,13 @@ void AssimpParser::ProcessMesh(Entity *root, aiMesh *mesh, const aiScene *scene)
     }
     model_mesh->SetIndices(indices);
     model_mesh->AddSubMesh(0, static_cast<uint32_t>(indices.size()));
+    if (optimize_mesh_) {
+        model_mesh->Optimize();
+    }
+    if (generate_lods_) {
+        model_mesh->GenerateLods();
+    }
+    model_mesh->SetCompressVertices(compress_vertices_);
     model_mesh->UploadData(true);
 
     const auto &min = mesh->mAABB.mMin;
@@ -266,6 +273,12 @@ std::shared_ptr<Texture> AssimpParser::ProcessTextures(aiMaterial *mat, aiTextur
     return nullptr;
 }
 
+void AssimpParser::SetOptimizeMesh(bool value) { optimize_mesh_ = value; }
+
+void AssimpParser::SetCompressVertices(bool value) { compress_vertices_ = value; }
+
+void AssimpParser::SetGenerateLods(bool value) { generate_lods_ = value; }
+
 std::string AssimpParser::ToString(aiShadingMode mode) {
     switch (mode) {
         case aiShadingMode_Flat:
@@ -37,11 +37,29 @@ public:
 
     std::shared_ptr<Texture> ProcessTextures(aiMaterial *mat, aiTextureType type);
 
+    /**
+     * Whether to reorder indices and vertices of imported meshes for vertex cache, overdraw and fetch locality.
+     */
+    void SetOptimizeMesh(bool value);
+
+    /**
+     * Whether to upload imported meshes with quantized normals, tangents, colors and uv, off by default as it is lossy.
+     */
+    void SetCompressVertices(bool value);
+
+    /**
+     * Whether to generate simplified levels of detail for imported meshes.
+     */
+    void SetGenerateLods(bool value);
+
 private:
     static std::string ToString(aiShadingMode mode);
 
     std::string directory_;
     Device &device_;
+    bool optimize_mesh_ = true;
+    bool compress_vertices_ = false;
+    bool generate_lods_ = true;
 };
 
 }  // namespace vox
@@ -7,6 +7,7 @@
 #include "vox.render/camera.h"
 
 #include "vox.math/matrix_utils.h"
+#include "vox.render/components_manager.h"
 #include "vox.render/entity.h"
 #include "vox.render/scene.h"
 
@@ -22,6 +23,12 @@ Camera::Camera(Entity *entity)
     frustum_view_change_flag_ = transform->RegisterWorldChangeFlag();
 }
 
+Camera::~Camera() {
+    if (auto *manager = ComponentsManager::GetSingletonPtr()) {
+        manager->CallRendererOnCameraDestroy(this);
+    }
+}
+
 const BoundingFrustum &Camera::Frustum() const { return frustum_; }
 
 float Camera::NearClipPlane() const { return near_clip_plane_; }
@@ -73,6 +73,8 @@ public:
      */
     explicit Camera(Entity *entity);
 
+    ~Camera() override;
+
     [[nodiscard]] const BoundingFrustum &Frustum() const;
 
     /**
@@ -273,7 +275,7 @@ private:
     Matrix4x4F InvViewProjMat();
 
     CameraData camera_data_;
-    const std::string camera_property_;
+    const ShaderProperty camera_property_;
 
     BoundingFrustum frustum_ = BoundingFrustum();
 
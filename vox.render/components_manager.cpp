@@ -6,11 +6,14 @@
 
 #include "vox.render/components_manager.h"
 
+#include "vox.math/math_utils.h"
 #include "vox.render/camera.h"
 #include "vox.render/renderer.h"
 #include "vox.render/script.h"
 //#include "vox.render/animator.h"
 #include "vox.base/logging.h"
+#include "vox.base/parallel.h"
+#include "vox.base/tracer.h"
 #include "vox.render/scene_animator.h"
 
 namespace vox {
@@ -127,16 +130,29 @@ void ComponentsManager::RemoveRenderer(Renderer *renderer) {
     }
 }
 
+Renderer *ComponentsManager::FindRenderer(uint64_t instance_id) const {
+    auto iter = std::find_if(renderers_.begin(), renderers_.end(),
+                             [instance_id](const Renderer *renderer) { return renderer->InstanceId() == instance_id; });
+    return iter == renderers_.end() ? nullptr : *iter;
+}
+
 void ComponentsManager::CallRendererOnUpdate(float delta_time) {
     for (auto &renderer : renderers_) {
         renderer->Update(delta_time);
     }
 }
 
+void ComponentsManager::CallRendererOnCameraDestroy(const Camera *camera) {
+    for (auto &renderer : renderers_) {
+        renderer->OnCameraDestroy(camera);
+    }
+}
+
 void ComponentsManager::CallRender(Camera *camera,
                                    std::vector<RenderElement> &opaque_queue,
                                    std::vector<RenderElement> &alpha_test_queue,
                                    std::vector<RenderElement> &transparent_queue) {
+    VOX_TRACE_SCOPE("Culling");
     for (auto &element : renderers_) {
         // filter by camera culling mask.
         if (!(camera->culling_mask_ & element->entity_->layer)) {
@@ -162,6 +178,7 @@ void ComponentsManager::CallRender(Camera *camera,
             element->SetDistanceForSort(center.distanceSquaredTo(kPosition));
         }
 
+        element->UpdateLod(camera, ScreenSize(camera, element->Bounds()), 0, Renderer::LodPass::MAIN);
         element->Render(opaque_queue, alpha_test_queue, transparent_queue);
     }
 }
@@ -169,15 +186,37 @@ void ComponentsManager::CallRender(Camera *camera,
 void ComponentsManager::CallRender(const BoundingFrustum &frustum,
                                    std::vector<RenderElement> &opaque_queue,
                                    std::vector<RenderElement> &alpha_test_queue,
-                                   std::vector<RenderElement> &transparent_queue) {
+                                   std::vector<RenderElement> &transparent_queue,
+                                   Camera *lod_camera,
+                                   uint32_t lod_bias,
+                                   Renderer::LodPass lod_pass) {
+    VOX_TRACE_SCOPE("Culling");
     for (auto &renderer : renderers_) {
         // filter by renderer castShadow and frustum cull
         if (frustum.intersectsBox(renderer->Bounds())) {
+            if (lod_camera) {
+                renderer->UpdateLod(lod_camera, ScreenSize(lod_camera, renderer->Bounds()), lod_bias, lod_pass);
+            } else {
+                renderer->UpdateLod(nullptr, 1.f, 0, lod_pass);
+            }
             renderer->Render(opaque_queue, alpha_test_queue, transparent_queue);
         }
     }
 }
 
+float ComponentsManager::ScreenSize(Camera *camera, const BoundingBox3F &bounds) {
+    const float kRadius = bounds.diagonalLength() * 0.5f;
+    if (camera->IsOrthographic()) {
+        return kRadius / camera->OrthographicSize();
+    }
+
+    const auto kDistance = bounds.midPoint().distanceTo(camera->GetEntity()->transform->WorldPosition());
+    if (kDistance <= kRadius) {
+        return 1.f;
+    }
+    return kRadius / (kDistance * std::tan(degreesToRadians(camera->FieldOfView()) * 0.5f));
+}
+
 // MARK: - Camera
 void ComponentsManager::CallCameraOnBeginRender(Camera *camera) {
     const auto &cam_comps = camera->GetEntity()->Scripts();
@@ -243,9 +282,21 @@ void ComponentsManager::RemoveOnUpdateSceneAnimators(SceneAnimator *animator) {
 }
 
 void ComponentsManager::CallSceneAnimatorUpdate(float delta_time) {
+    CallSceneAnimatorEvaluate(delta_time);
+    CallSceneAnimatorApply();
+}
+
+void ComponentsManager::CallSceneAnimatorEvaluate(float delta_time) {
     const auto &elements = on_update_scene_animators_;
-    for (size_t i = 0; i < on_update_scene_animators_.size(); i++) {
-        elements[i]->update(delta_time);
+    // sampling only touches the clips, animators are independent
+    utility::ParallelFor(
+            0, elements.size(), [&](size_t i) { elements[i]->evaluate(delta_time); }, 16);
+}
+
+void ComponentsManager::CallSceneAnimatorApply() {
+    // animated hierarchies may overlap, the transform dirty flags are written serially
+    for (const auto &element : on_update_scene_animators_) {
+        element->apply_pose();
     }
 }
 
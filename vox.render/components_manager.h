@@ -13,6 +13,7 @@
 #include "vox.math/bounding_frustum.h"
 #include "vox.math/matrix4x4.h"
 #include "vox.render/platform/input_events.h"
+#include "vox.render/renderer.h"
 #include "vox.render/rendering/render_element.h"
 #include "vox.render/scene_forward.h"
 
@@ -53,17 +54,33 @@ public:
 
     void RemoveRenderer(Renderer *renderer);
 
+    /**
+     * Enabled renderer with the instance id, null when it was disabled or destroyed since.
+     */
+    [[nodiscard]] Renderer *FindRenderer(uint64_t instance_id) const;
+
     void CallRendererOnUpdate(float delta_time);
 
+    void CallRendererOnCameraDestroy(const Camera *camera);
+
     void CallRender(Camera *camera,
                     std::vector<RenderElement> &opaque_queue,
                     std::vector<RenderElement> &alpha_test_queue,
                     std::vector<RenderElement> &transparent_queue);
 
+    /**
+     * Collect render elements inside a frustum.
+     * @param lod_camera - Camera used to select the level of detail, full detail when null
+     * @param lod_bias - Extra levels of detail on top of the camera selection
+     * @param lod_pass - Pass whose level of detail history is used
+     */
     void CallRender(const BoundingFrustum &frustum,
                     std::vector<RenderElement> &opaque_queue,
                     std::vector<RenderElement> &alpha_test_queue,
-                    std::vector<RenderElement> &transparent_queue);
+                    std::vector<RenderElement> &transparent_queue,
+                    Camera *lod_camera = nullptr,
+                    uint32_t lod_bias = 0,
+                    Renderer::LodPass lod_pass = Renderer::LodPass::MAIN);
 
 public:
     //    void addOnUpdateAnimators(Animator *animator);
@@ -78,6 +95,16 @@ public:
 
     void CallSceneAnimatorUpdate(float delta_time);
 
+    /**
+     * Sample the animators, only touches their clips and may run beside the other update phases.
+     */
+    void CallSceneAnimatorEvaluate(float delta_time);
+
+    /**
+     * Write the sampled poses to the entities.
+     */
+    void CallSceneAnimatorApply();
+
 public:
     static void CallCameraOnBeginRender(Camera *camera);
 
@@ -88,6 +115,11 @@ public:
     void PutActiveChangedTempList(std::vector<Component *> &component_container);
 
 private:
+    /**
+     * Projected height of bounds, as a fraction of the camera viewport height.
+     */
+    static float ScreenSize(Camera *camera, const BoundingBox3F &bounds);
+
     // Script
     std::vector<Script *> on_start_scripts_;
     std::vector<Script *> on_update_scripts_;
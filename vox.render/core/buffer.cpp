@@ -99,6 +99,8 @@ void Buffer::Unmap() {
 
 void Buffer::Flush() const { vmaFlushAllocation(device_->GetMemoryAllocator(), allocation_, 0, size_); }
 
+void Buffer::Invalidate() const { vmaInvalidateAllocation(device_->GetMemoryAllocator(), allocation_, 0, size_); }
+
 void Buffer::Update(const std::vector<uint8_t> &data, size_t offset) { Update(data.data(), data.size(), offset); }
 
 uint64_t Buffer::GetDeviceAddress() {
@@ -75,6 +75,12 @@ public:
      */
     void Flush() const;
 
+    /**
+     * @brief Invalidates memory if it is HOST_VISIBLE and not HOST_COHERENT, to be called before reading data written
+     *        by the device
+     */
+    void Invalidate() const;
+
     /**
      * @brief Maps vulkan memory if it isn't already mapped to an host visible address
      * @return Pointer to host visible memory
@@ -81,6 +81,8 @@ VkResult CommandBuffer::Begin(VkCommandBufferUsageFlags flags,
     pipeline_state_.Reset();
     resource_binding_state_.Reset();
     descriptor_set_layout_binding_state_.clear();
+    bound_descriptor_sets_.clear();
+    last_pipeline_layout_ = VK_NULL_HANDLE;
     stored_push_constants_.clear();
 
     VkCommandBufferBeginInfo begin_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
@@ -135,6 +137,8 @@ void CommandBuffer::BeginRenderPass(const RenderTarget &render_target,
     pipeline_state_.Reset();
     resource_binding_state_.Reset();
     descriptor_set_layout_binding_state_.clear();
+    bound_descriptor_sets_.clear();
+    last_pipeline_layout_ = VK_NULL_HANDLE;
 
     auto &render_pass = GetRenderPass(render_target, load_store_infos, subpasses);
     auto &framebuffer = GetDevice().GetResourceCache().RequestFramebuffer(render_target, render_pass);
@@ -197,6 +201,8 @@ void CommandBuffer::NextSubpass() {
     // Reset descriptor sets
     resource_binding_state_.Reset();
     descriptor_set_layout_binding_state_.clear();
+    bound_descriptor_sets_.clear();
+    last_pipeline_layout_ = VK_NULL_HANDLE;
 
     // Clear stored push constants
     stored_push_constants_.clear();
@@ -351,6 +357,15 @@ void CommandBuffer::DrawIndexed(uint32_t index_count,
     vkCmdDrawIndexed(GetHandle(), index_count, instance_count, first_index, vertex_offset, first_instance);
 }
 
+void CommandBuffer::DrawIndirect(const core::Buffer &buffer,
+                                 VkDeviceSize offset,
+                                 uint32_t draw_count,
+                                 uint32_t stride) {
+    Flush(VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+    vkCmdDrawIndirect(GetHandle(), buffer.GetHandle(), offset, draw_count, stride);
+}
+
 void CommandBuffer::DrawIndexedIndirect(const core::Buffer &buffer,
                                         VkDeviceSize offset,
                                         uint32_t draw_count,
@@ -465,6 +480,24 @@ void CommandBuffer::BufferMemoryBarrier(const core::Buffer &buffer,
                          nullptr);
 }
 
+void CommandBuffer::GlobalMemoryBarrier(const vox::BufferMemoryBarrier &memory_barrier) {
+    VkMemoryBarrier global_memory_barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    global_memory_barrier.srcAccessMask = memory_barrier.src_access_mask;
+    global_memory_barrier.dstAccessMask = memory_barrier.dst_access_mask;
+
+    vkCmdPipelineBarrier(GetHandle(), memory_barrier.src_stage_mask, memory_barrier.dst_stage_mask, 0, 1,
+                         &global_memory_barrier, 0, nullptr, 0, nullptr);
+}
+
+void CommandBuffer::PipelineBarrier(VkPipelineStageFlags src_stage_mask,
+                                    VkPipelineStageFlags dst_stage_mask,
+                                    const std::vector<VkBufferMemoryBarrier> &buffer_barriers,
+                                    const std::vector<VkImageMemoryBarrier> &image_barriers) {
+    vkCmdPipelineBarrier(GetHandle(), src_stage_mask, dst_stage_mask, 0, 0, nullptr,
+                         utility::ToU32(buffer_barriers.size()), buffer_barriers.data(),
+                         utility::ToU32(image_barriers.size()), image_barriers.data());
+}
+
 void CommandBuffer::FlushPipelineState(VkPipelineBindPoint pipeline_bind_point) {
     // Create a new pipeline only if the graphics state changed
     if (!pipeline_state_.IsDirty()) {
@@ -520,8 +553,14 @@ void CommandBuffer::FlushDescriptorState(VkPipelineBindPoint pipeline_bind_point
         }
     }
 
+    // Binding a pipeline with another layout may disturb the sets bound before, they are bound again
+    const bool kPipelineLayoutChanged =
+            pipeline_layout.GetHandle() != last_pipeline_layout_ || pipeline_bind_point != last_pipeline_bind_point_;
+    last_pipeline_layout_ = pipeline_layout.GetHandle();
+    last_pipeline_bind_point_ = pipeline_bind_point;
+
     // Check if a descriptor set needs to be created
-    if (resource_binding_state_.IsDirty() || !update_descriptor_sets.empty()) {
+    if (resource_binding_state_.IsDirty() || !update_descriptor_sets.empty() || kPipelineLayoutChanged) {
         resource_binding_state_.ClearDirty();
 
         // Iterate over all the resource sets bound by the command buffer
@@ -530,16 +569,14 @@ void CommandBuffer::FlushDescriptorState(VkPipelineBindPoint pipeline_bind_point
             auto &resource_set = resource_set_it.second;
 
             // Don't update resource set if it's not in the update list OR its state hasn't changed
-            if (!resource_set.IsDirty() &&
+            if (!resource_set.IsDirty() && !resource_set.IsOffsetDirty() && !kPipelineLayoutChanged &&
                 (update_descriptor_sets.find(descriptor_set_id) == update_descriptor_sets.end())) {
                 continue;
             }
 
-            // Clear dirty flag for resource set
-            resource_binding_state_.ClearDirty(descriptor_set_id);
-
             // Skip resource set if a descriptor set layout doesn't exist for it
             if (!pipeline_layout.HasDescriptorSetLayout(descriptor_set_id)) {
+                resource_binding_state_.ClearDirty(descriptor_set_id);
                 continue;
             }
 
@@ -548,6 +585,24 @@ void CommandBuffer::FlushDescriptorState(VkPipelineBindPoint pipeline_bind_point
             // Make descriptor set layout bound for current set
             descriptor_set_layout_binding_state_[descriptor_set_id] = &descriptor_set_layout;
 
+            // Same resources as the descriptor set bound last for this layout, at most at other dynamic offsets:
+            // bind it again without building and hashing the descriptor infos
+            auto &bound_descriptor_set = bound_descriptor_sets_[descriptor_set_id];
+            if (!resource_set.IsDirty() && bound_descriptor_set.second != VK_NULL_HANDLE &&
+                bound_descriptor_set.first == descriptor_set_layout.GetHandle()) {
+                std::vector<uint32_t> dynamic_offsets;
+                if (CollectDynamicOffsets(descriptor_set_layout, resource_set, dynamic_offsets)) {
+                    resource_binding_state_.ClearDirty(descriptor_set_id);
+                    vkCmdBindDescriptorSets(GetHandle(), pipeline_bind_point, pipeline_layout.GetHandle(),
+                                            descriptor_set_id, 1, &bound_descriptor_set.second,
+                                            utility::ToU32(dynamic_offsets.size()), dynamic_offsets.data());
+                    continue;
+                }
+            }
+
+            // Clear dirty flag for resource set
+            resource_binding_state_.ClearDirty(descriptor_set_id);
+
             BindingMap<VkDescriptorBufferInfo> buffer_infos;
             BindingMap<VkDescriptorImageInfo> image_infos;
 
@@ -639,6 +694,7 @@ void CommandBuffer::FlushDescriptorState(VkPipelineBindPoint pipeline_bind_point
             descriptor_set.Update(bindings_to_update);
 
             VkDescriptorSet descriptor_set_handle = descriptor_set.GetHandle();
+            bound_descriptor_set = {descriptor_set_layout.GetHandle(), descriptor_set_handle};
 
             // Bind descriptor set
             vkCmdBindDescriptorSets(GetHandle(), pipeline_bind_point, pipeline_layout.GetHandle(), descriptor_set_id, 1,
@@ -648,6 +704,33 @@ void CommandBuffer::FlushDescriptorState(VkPipelineBindPoint pipeline_bind_point
     }
 }
 
+bool CommandBuffer::CollectDynamicOffsets(const DescriptorSetLayout &descriptor_set_layout,
+                                          const ResourceSet &resource_set,
+                                          std::vector<uint32_t> &dynamic_offsets) {
+    // Offsets are ordered by binding, as the descriptor infos are
+    for (auto &binding_it : resource_set.GetResourceBindings()) {
+        auto binding_info = descriptor_set_layout.GetLayoutBinding(binding_it.first);
+        if (!binding_info || !IsBufferDescriptorType(binding_info->descriptorType)) {
+            continue;
+        }
+
+        const bool kDynamic = IsDynamicBufferDescriptorType(binding_info->descriptorType);
+        for (auto &element_it : binding_it.second) {
+            auto &resource_info = element_it.second;
+            if (resource_info.buffer == nullptr) {
+                continue;
+            }
+            if (kDynamic) {
+                dynamic_offsets.push_back(utility::ToU32(resource_info.offset));
+            } else if (resource_info.dirty) {
+                // the offset of a static binding is written in the descriptor set
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 void CommandBuffer::FlushPushConstants() {
     if (stored_push_constants_.empty()) {
         return;
@@ -670,6 +753,8 @@ void CommandBuffer::FlushPushConstants() {
 
 CommandBuffer::State CommandBuffer::GetState() const { return state_; }
 
+CommandPool &CommandBuffer::GetCommandPool() { return command_pool_; }
+
 void CommandBuffer::SetUpdateAfterBind(bool update_after_bind) { update_after_bind_ = update_after_bind; }
 
 const CommandBuffer::RenderPassBinding &CommandBuffer::GetCurrentRenderPass() const { return current_render_pass_; }
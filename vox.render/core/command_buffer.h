@@ -219,6 +219,8 @@ public:
                      int32_t vertex_offset,
                      uint32_t first_instance);
 
+    void DrawIndirect(const core::Buffer &buffer, VkDeviceSize offset, uint32_t draw_count, uint32_t stride);
+
     void DrawIndexedIndirect(const core::Buffer &buffer, VkDeviceSize offset, uint32_t draw_count, uint32_t stride);
 
     void Dispatch(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z);
@@ -253,8 +255,26 @@ public:
                              VkDeviceSize size,
                              const BufferMemoryBarrier &memory_barrier);
 
+    /**
+     * @brief Memory barrier on every buffer accessed by the given stages, one call instead of a barrier per buffer.
+     */
+    void GlobalMemoryBarrier(const BufferMemoryBarrier &memory_barrier);
+
+    /**
+     * @brief Buffer and image barriers recorded together, the stage masks cover all of them.
+     */
+    void PipelineBarrier(VkPipelineStageFlags src_stage_mask,
+                         VkPipelineStageFlags dst_stage_mask,
+                         const std::vector<VkBufferMemoryBarrier> &buffer_barriers,
+                         const std::vector<VkImageMemoryBarrier> &image_barriers);
+
     [[nodiscard]] State GetState() const;
 
+    /**
+     * @brief The pool the command buffer was allocated from, and through it the render frame being recorded
+     */
+    CommandPool &GetCommandPool();
+
     void SetUpdateAfterBind(bool update_after_bind);
 
     void ResetQueryPool(const QueryPool &query_pool, uint32_t first_query, uint32_t query_count);
@@ -302,6 +322,13 @@ private:
 
     std::unordered_map<uint32_t, DescriptorSetLayout *> descriptor_set_layout_binding_state_;
 
+    // Layout and handle of the descriptor set last bound at each set index
+    std::unordered_map<uint32_t, std::pair<VkDescriptorSetLayout, VkDescriptorSet>> bound_descriptor_sets_;
+
+    VkPipelineLayout last_pipeline_layout_{VK_NULL_HANDLE};
+
+    VkPipelineBindPoint last_pipeline_bind_point_{VK_PIPELINE_BIND_POINT_GRAPHICS};
+
     [[nodiscard]] const RenderPassBinding &GetCurrentRenderPass() const;
 
     [[nodiscard]] uint32_t GetCurrentSubpassIndex() const;
@@ -311,6 +338,14 @@ private:
      */
     [[nodiscard]] bool IsRenderSizeOptimal(const VkExtent2D &extent, const VkRect2D &render_area) const;
 
+    /**
+     * @brief Dynamic offsets of a resource set to bind the descriptor set bound last again
+     * @return false if a static buffer binding changed its offset, the descriptor set must be written
+     */
+    static bool CollectDynamicOffsets(const DescriptorSetLayout &descriptor_set_layout,
+                                      const ResourceSet &resource_set,
+                                      std::vector<uint32_t> &dynamic_offsets);
+
     /**
      * @brief Flush the pipelines state
      */
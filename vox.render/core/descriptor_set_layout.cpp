@@ -6,14 +6,18 @@
 
 #include "vox.render/core/descriptor_set_layout.h"
 
+#include <atomic>
 #include <utility>
 
 #include "vox.render/core/device.h"
 #include "vox.render/core/physical_device.h"
 #include "vox.render/shader/shader_module.h"
+#include "vox.render/shader/shader_property.h"
 
 namespace vox {
 namespace {
+std::atomic<uint64_t> layout_serial{0};
+
 inline VkDescriptorType find_descriptor_type(ShaderResourceType resource_type, bool dynamic) {
     switch (resource_type) {
         case ShaderResourceType::INPUT_ATTACHMENT:
@@ -72,7 +76,10 @@ DescriptorSetLayout::DescriptorSetLayout(Device &device,
                                          const uint32_t set_index,
                                          std::vector<ShaderModule *> shader_modules,
                                          const std::vector<ShaderResource> &resource_set)
-    : device_{device}, set_index_{set_index}, shader_modules_{std::move(shader_modules)} {
+    : device_{device},
+      set_index_{set_index},
+      shader_modules_{std::move(shader_modules)},
+      unique_id_{layout_serial.fetch_add(1, std::memory_order_relaxed)} {
     // NOTE: `shader_modules` is passed in mainly for hashing their handles in `request_resource`.
     //        This way, different pipelines (with different shaders / shader variants) will get
     //        different descriptor set layouts (incl. appropriate name -> binding lookups)
@@ -88,7 +95,11 @@ DescriptorSetLayout::DescriptorSetLayout(Device &device,
         // Convert from ShaderResourceType to VkDescriptorType.
         auto descriptor_type = find_descriptor_type(resource.type, resource.mode == ShaderResourceMode::DYNAMIC);
 
-        if (resource.mode == ShaderResourceMode::UPDATE_AFTER_BIND) {
+        if (resource.mode == ShaderResourceMode::UPDATE_AFTER_BIND && resource.array_size == 0) {
+            binding_flags_.push_back(VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+                                     VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+                                     VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT);
+        } else if (resource.mode == ShaderResourceMode::UPDATE_AFTER_BIND) {
             binding_flags_.push_back(VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT);
         } else {
             // When creating a descriptor set layout, if we give a structure to create_info.pNext, each binding needs to
@@ -101,7 +112,7 @@ DescriptorSetLayout::DescriptorSetLayout(Device &device,
         VkDescriptorSetLayoutBinding layout_binding{};
 
         layout_binding.binding = resource.binding;
-        layout_binding.descriptorCount = resource.array_size;
+        layout_binding.descriptorCount = resource.array_size != 0 ? resource.array_size : max_unsized_array_size_;
         layout_binding.descriptorType = descriptor_type;
         layout_binding.stageFlags = static_cast<VkShaderStageFlags>(resource.stages);
 
@@ -113,6 +124,8 @@ DescriptorSetLayout::DescriptorSetLayout(Device &device,
         binding_flags_lookup_.emplace(resource.binding, binding_flags_.back());
 
         resources_lookup_.emplace(resource.name, resource.binding);
+
+        properties_lookup_.emplace(ShaderProperty::GetPropertyId(resource.name), bindings_.size() - 1);
     }
 
     VkDescriptorSetLayoutCreateInfo create_info{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
@@ -166,7 +179,9 @@ DescriptorSetLayout::DescriptorSetLayout(DescriptorSetLayout &&other) noexcept
       binding_flags_{std::move(other.binding_flags_)},
       bindings_lookup_{std::move(other.bindings_lookup_)},
       binding_flags_lookup_{std::move(other.binding_flags_lookup_)},
-      resources_lookup_{std::move(other.resources_lookup_)} {
+      resources_lookup_{std::move(other.resources_lookup_)},
+      properties_lookup_{std::move(other.properties_lookup_)},
+      unique_id_{other.unique_id_} {
     other.handle_ = VK_NULL_HANDLE;
 }
 
@@ -187,6 +202,8 @@ const std::vector<VkDescriptorBindingFlagsEXT> &DescriptorSetLayout::GetBindingF
 
 const std::vector<ShaderModule *> &DescriptorSetLayout::GetShaderModules() const { return shader_modules_; }
 
+uint64_t DescriptorSetLayout::GetUniqueId() const { return unique_id_; }
+
 // MARK: -
 std::unique_ptr<VkDescriptorSetLayoutBinding> DescriptorSetLayout::GetLayoutBinding(uint32_t binding_index) const {
     auto it = bindings_lookup_.find(binding_index);
@@ -208,6 +225,16 @@ std::unique_ptr<VkDescriptorSetLayoutBinding> DescriptorSetLayout::GetLayoutBind
     return GetLayoutBinding(it->second);
 }
 
+const VkDescriptorSetLayoutBinding *DescriptorSetLayout::GetLayoutBinding(const ShaderProperty &property) const {
+    auto it = properties_lookup_.find(property.UniqueId());
+
+    if (it == properties_lookup_.end()) {
+        return nullptr;
+    }
+
+    return &bindings_[it->second];
+}
+
 VkDescriptorBindingFlagsEXT DescriptorSetLayout::GetLayoutBindingFlag(uint32_t binding_index) const {
     auto it = binding_flags_lookup_.find(binding_index);
 
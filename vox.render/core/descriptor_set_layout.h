@@ -16,6 +16,8 @@ class Device;
 
 class ShaderModule;
 
+class ShaderProperty;
+
 struct ShaderResource;
 
 /**
@@ -24,6 +26,12 @@ struct ShaderResource;
  */
 class DescriptorSetLayout {
 public:
+    /**
+     * @brief Descriptor count of an unsized array, e.g. the bindless texture array. Such arrays are partially bound
+     *        and update-after-bind
+     */
+    static constexpr uint32_t max_unsized_array_size_ = 4096;
+
     /**
      * @brief Creates a descriptor set layout from a set of resources
      * @param device A valid Vulkan device
@@ -56,11 +64,21 @@ public:
 
     [[nodiscard]] const std::vector<ShaderModule *> &GetShaderModules() const;
 
+    /**
+     * @brief Serial number of the layout, never reused, unlike the handle
+     */
+    [[nodiscard]] uint64_t GetUniqueId() const;
+
 public:
     [[nodiscard]] std::unique_ptr<VkDescriptorSetLayoutBinding> GetLayoutBinding(uint32_t binding_index) const;
 
     [[nodiscard]] std::unique_ptr<VkDescriptorSetLayoutBinding> GetLayoutBinding(const std::string &name) const;
 
+    /**
+     * @brief Binding of an interned property, nullptr if the layout does not use it. Does not allocate.
+     */
+    [[nodiscard]] const VkDescriptorSetLayoutBinding *GetLayoutBinding(const ShaderProperty &property) const;
+
     [[nodiscard]] VkDescriptorBindingFlagsEXT GetLayoutBindingFlag(uint32_t binding_index) const;
 
 private:
@@ -81,6 +99,11 @@ private:
     std::unordered_map<uint32_t, VkDescriptorBindingFlagsEXT> binding_flags_lookup_;
 
     std::unordered_map<std::string, uint32_t> resources_lookup_;
+
+    // property id to index in bindings_
+    std::unordered_map<uint32_t, size_t> properties_lookup_;
+
+    uint64_t unique_id_;
 };
 
 }  // namespace vox
@@ -6,11 +6,54 @@
 
 #include "vox.render/core/pipeline_layout.h"
 
+#include <algorithm>
+#include <unordered_set>
+
 #include "vox.render/core/descriptor_set_layout.h"
 #include "vox.render/core/device.h"
 #include "vox.render/shader/shader_module.h"
 
 namespace vox {
+namespace {
+/**
+ * Uniform buffers are bound with dynamic offsets when the device allows it, so data sub-allocated per frame keeps
+ * the same descriptor set across draws and only the offsets change.
+ * Sets with update-after-bind resources can not have dynamic ones and are left as they are.
+ */
+void make_uniform_buffers_dynamic(std::unordered_map<std::string, ShaderResource> &shader_resources,
+                                  uint32_t max_dynamic_uniform_buffers) {
+    std::unordered_set<uint32_t> update_after_bind_sets;
+    std::vector<ShaderResource *> uniform_buffers;
+    uint32_t dynamic_count = 0;
+    for (auto &it : shader_resources) {
+        auto &shader_resource = it.second;
+        if (shader_resource.mode == ShaderResourceMode::UPDATE_AFTER_BIND) {
+            update_after_bind_sets.insert(shader_resource.set);
+        } else if (shader_resource.type == ShaderResourceType::BUFFER_UNIFORM) {
+            if (shader_resource.mode == ShaderResourceMode::DYNAMIC) {
+                dynamic_count += shader_resource.array_size;
+            } else {
+                uniform_buffers.push_back(&shader_resource);
+            }
+        }
+    }
+
+    // Deterministic choice when the limit is reached
+    std::sort(uniform_buffers.begin(), uniform_buffers.end(), [](const ShaderResource *a, const ShaderResource *b) {
+        return a->set < b->set || (a->set == b->set && a->binding < b->binding);
+    });
+
+    for (auto *shader_resource : uniform_buffers) {
+        if (update_after_bind_sets.count(shader_resource->set) == 0 &&
+            dynamic_count + shader_resource->array_size <= max_dynamic_uniform_buffers) {
+            shader_resource->mode = ShaderResourceMode::DYNAMIC;
+            dynamic_count += shader_resource->array_size;
+        }
+    }
+}
+
+}  // namespace
+
 PipelineLayout::PipelineLayout(Device &device, const std::vector<ShaderModule *> &shader_modules)
     : device_{device}, shader_modules_{shader_modules} {
     // Collect and combine all the shader resources from each of the shader modules
@@ -37,6 +80,19 @@ PipelineLayout::PipelineLayout(Device &device, const std::vector<ShaderModule *>
         }
     }
 
+    // Unsized descriptor arrays are bindless tables, written while in use
+    for (auto &it : shader_resources_) {
+        auto &shader_resource = it.second;
+        if (shader_resource.array_size == 0 && (shader_resource.type == ShaderResourceType::IMAGE ||
+                                                shader_resource.type == ShaderResourceType::IMAGE_SAMPLER ||
+                                                shader_resource.type == ShaderResourceType::SAMPLER)) {
+            shader_resource.mode = ShaderResourceMode::UPDATE_AFTER_BIND;
+        }
+    }
+
+    make_uniform_buffers_dynamic(shader_resources_,
+                                 device.GetGpu().GetProperties().limits.maxDescriptorSetUniformBuffersDynamic);
+
     // Sift through the map of name indexed shader resources
     // Separate them into their respective sets
     for (auto &it : shader_resources_) {
@@ -54,10 +110,17 @@ PipelineLayout::PipelineLayout(Device &device, const std::vector<ShaderModule *>
         }
     }
 
-    // Create a descriptor set layout for each shader set in the shader modules
+    // Create a descriptor set layout for each shader set in the shader modules, in set order. A set index the shaders
+    // skip, e.g. a frequency set with nothing in it, gets an empty layout so the layouts stay indexed by set
+    uint32_t set_count = 0;
     for (auto &shader_set_it : shader_sets_) {
+        set_count = std::max(set_count, shader_set_it.first + 1);
+    }
+    for (uint32_t set_index = 0; set_index < set_count; ++set_index) {
+        auto shader_set_it = shader_sets_.find(set_index);
         descriptor_set_layouts_.emplace_back(&device.GetResourceCache().RequestDescriptorSetLayout(
-                shader_set_it.first, shader_modules, shader_set_it.second));
+                set_index, shader_modules,
+                shader_set_it != shader_sets_.end() ? shader_set_it->second : std::vector<ShaderResource>{}));
     }
 
     // Collect all the descriptor set layout handles, maintaining set order
@@ -139,10 +202,8 @@ bool PipelineLayout::HasDescriptorSetLayout(uint32_t set_index) const {
 }
 
 DescriptorSetLayout &PipelineLayout::GetDescriptorSetLayout(uint32_t set_index) const {
-    for (auto &descriptor_set_layout : descriptor_set_layouts_) {
-        if (descriptor_set_layout->GetIndex() == set_index) {
-            return *descriptor_set_layout;
-        }
+    if (set_index < descriptor_set_layouts_.size()) {
+        return *descriptor_set_layouts_[set_index];
     }
     throw std::runtime_error("Couldn't find descriptor set layout at set index " + vox::ToString(set_index));
 }
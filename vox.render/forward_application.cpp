@@ -6,13 +6,21 @@
 
 #include "vox.render/forward_application.h"
 
+#include "vox.base/logging.h"
+#include "vox.base/tracer.h"
 #include "vox.render/camera.h"
 #include "vox.render/platform/platform.h"
 #include "vox.render/rendering/subpasses/geometry_subpass.h"
 
 namespace vox {
 ForwardApplication::~ForwardApplication() {
+    // a pipelined step may still run on the PhysX threads
+    if (physics_manager_ && physics_manager_->IsSimulating()) {
+        physics_manager_->FetchResults();
+    }
+
     // release first
+    batch_renderer_.reset();
     scene_manager_.reset();
 
     components_manager_.reset();
@@ -20,6 +28,7 @@ ForwardApplication::~ForwardApplication() {
     light_manager_.reset();
     shadow_manager_.reset();
     particle_manager_.reset();
+    skinning_manager_.reset();
 
     texture_manager_->CollectGarbage();
     texture_manager_.reset();
@@ -27,6 +36,22 @@ ForwardApplication::~ForwardApplication() {
     shader_manager_.reset();
     mesh_manager_->CollectGarbage();
     mesh_manager_.reset();
+    bindless_texture_table_.reset();
+}
+
+void ForwardApplication::PrepareRenderContext() {
+    if (GetSurface() == VK_NULL_HANDLE) {
+        render_context_->SetHeadlessFrameCount(batch_frames_in_flight_);
+    }
+    GraphicsApplication::PrepareRenderContext();
+}
+
+void ForwardApplication::RequestGpuFeatures(PhysicalDevice &gpu) {
+    GraphicsApplication::RequestGpuFeatures(gpu);
+    if (bindless_textures_ && BindlessTextureTable::RequestFeatures(gpu)) {
+        AddDeviceExtension(VK_KHR_MAINTENANCE3_EXTENSION_NAME, true);
+        AddDeviceExtension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME, true);
+    }
 }
 
 bool ForwardApplication::Prepare(Platform &platform) {
@@ -36,6 +61,10 @@ bool ForwardApplication::Prepare(Platform &platform) {
     texture_manager_ = std::make_unique<TextureManager>(*device_);
     shader_manager_ = std::make_unique<ShaderManager>();
     mesh_manager_ = std::make_unique<MeshManager>(*device_);
+    if (bindless_textures_ && BindlessTextureTable::IsSupported(*device_)) {
+        bindless_texture_table_ = std::make_unique<BindlessTextureTable>(
+                *device_, static_cast<uint32_t>(render_context_->GetRenderFrames().size()));
+    }
 
     // logic system
     components_manager_ = std::make_unique<ComponentsManager>();
@@ -44,6 +73,7 @@ bool ForwardApplication::Prepare(Platform &platform) {
     auto scene = scene_manager_->CurrentScene();
 
     particle_manager_ = std::make_unique<ParticleManager>(*device_, *render_context_);
+    skinning_manager_ = std::make_unique<SkinningManager>(*device_, *render_context_);
     light_manager_ = std::make_unique<LightManager>(scene, *render_context_);
     {
         LoadScene();
@@ -54,6 +84,7 @@ bool ForwardApplication::Prepare(Platform &platform) {
         main_camera_->Resize(extent.width, extent.height, factor * extent.width, factor * extent.height);
     }
     light_manager_->SetCamera(main_camera_);
+    particle_manager_->SetCamera(main_camera_);
 
     // internal manager
     shadow_manager_ = std::make_unique<ShadowManager>(*device_, *render_context_, scene, main_camera_);
@@ -67,19 +98,94 @@ bool ForwardApplication::Prepare(Platform &platform) {
 }
 
 void ForwardApplication::Update(float delta_time) {
-    {
-        components_manager_->CallScriptOnStart();
-
-        physics_manager_->Update(delta_time);
-
-        components_manager_->CallScriptOnUpdate(delta_time);
-        //        _componentsManager->callAnimatorUpdate(deltaTime);
-        components_manager_->CallSceneAnimatorUpdate(delta_time);
-        components_manager_->CallScriptOnLateUpdate(delta_time);
+    using Affinity = utility::TaskGraph::Affinity;
 
-        components_manager_->CallRendererOnUpdate(delta_time);
-        scene_manager_->CurrentScene()->UpdateShaderData();
+    // main thread tasks keep the order of the phases: no script runs while a physics step is in flight, the step
+    // started by the previous frame in pipelined mode included. The clips are sampled on the workers while the main
+    // thread waits for the physics step.
+    update_graph_.Clear();
+    UpdatePhases phases;
+    auto physics_fetch = [&] {
+        VOX_TRACE_SCOPE("Physics");
+        physics_manager_->FetchResults();
+    };
+    // scripts drive the animators, so the sampling never runs beside them: a clip played by a script update is
+    // sampled from the next frame on
+    auto animators_evaluate = [&] {
+        VOX_TRACE_SCOPE("Animators");
+        components_manager_->CallSceneAnimatorEvaluate(delta_time);
+    };
+    if (pipelined_simulation_) {
+        phases.animators_evaluate = update_graph_.AddTask("Animators Evaluate", animators_evaluate, Affinity::ANY);
+        phases.physics_fetch = update_graph_.AddTask("Physics Fetch", physics_fetch, Affinity::MAIN_THREAD);
     }
+    phases.scripts_start = update_graph_.AddTask(
+            "Scripts Start",
+            [&] {
+                VOX_TRACE_SCOPE("Scripts");
+                components_manager_->CallScriptOnStart();
+            },
+            Affinity::MAIN_THREAD, {phases.physics_fetch, phases.animators_evaluate});
+    if (!pipelined_simulation_) {
+        phases.physics_start = update_graph_.AddTask(
+                "Physics Start",
+                [&] {
+                    VOX_TRACE_SCOPE("Physics");
+                    physics_manager_->StartSimulation(delta_time);
+                },
+                Affinity::MAIN_THREAD, {phases.scripts_start});
+        phases.animators_evaluate = update_graph_.AddTask("Animators Evaluate", animators_evaluate, Affinity::ANY,
+                                                          {phases.scripts_start});
+        phases.physics_fetch =
+                update_graph_.AddTask("Physics Fetch", physics_fetch, Affinity::MAIN_THREAD, {phases.physics_start});
+    }
+    phases.scripts_update = update_graph_.AddTask(
+            "Scripts Update",
+            [&] {
+                VOX_TRACE_SCOPE("Scripts");
+                components_manager_->CallScriptOnUpdate(delta_time);
+            },
+            Affinity::MAIN_THREAD, {phases.physics_fetch, phases.animators_evaluate});
+    phases.animators_apply = update_graph_.AddTask(
+            "Animators Apply",
+            [&] {
+                VOX_TRACE_SCOPE("Animators");
+                components_manager_->CallSceneAnimatorApply();
+            },
+            Affinity::MAIN_THREAD, {phases.scripts_update});
+    phases.scripts_late_update = update_graph_.AddTask(
+            "Scripts Late Update",
+            [&] {
+                VOX_TRACE_SCOPE("Scripts");
+                components_manager_->CallScriptOnLateUpdate(delta_time);
+            },
+            Affinity::MAIN_THREAD, {phases.animators_apply});
+    phases.renderers_update = update_graph_.AddTask(
+            "Renderers Update",
+            [&] {
+                VOX_TRACE_SCOPE("Renderers");
+                components_manager_->CallRendererOnUpdate(delta_time);
+            },
+            Affinity::MAIN_THREAD, {phases.scripts_late_update});
+    phases.shader_data = update_graph_.AddTask(
+            "Shader Data",
+            [&] {
+                VOX_TRACE_SCOPE("Renderers");
+                scene_manager_->CurrentScene()->UpdateShaderData();
+            },
+            Affinity::MAIN_THREAD, {phases.renderers_update});
+    if (pipelined_simulation_) {
+        // the entities keep the fetched poses until the next frame, they are what this frame renders
+        phases.next_simulation = update_graph_.AddTask(
+                "Next Simulation",
+                [&] {
+                    VOX_TRACE_SCOPE("Physics");
+                    physics_manager_->StartSimulation(delta_time);
+                },
+                Affinity::MAIN_THREAD, {phases.shader_data});
+    }
+    AddUpdateTasks(update_graph_, phases, delta_time);
+    update_graph_.Execute();
 
     GraphicsApplication::Update(delta_time);
 }
@@ -97,14 +203,78 @@ void ForwardApplication::InputEvent(const vox::InputEvent &input_event) {
 }
 
 void ForwardApplication::Render(CommandBuffer &command_buffer, RenderTarget &render_target) {
+    if (bindless_texture_table_) {
+        bindless_texture_table_->NextFrame();
+    }
     UpdateGpuTask(command_buffer, render_target);
     GraphicsApplication::Render(command_buffer, render_target);
 }
 
+void ForwardApplication::EnqueueBatchJob(BatchJob job) {
+    if (!job.camera) {
+        job.camera = main_camera_;
+    }
+    if (job.camera && job.camera->GetEntity()->Scene() != scene_manager_->CurrentScene()) {
+        LOGE("Batch job {} renders a camera outside of the current scene", job.filename)
+        return;
+    }
+    if (!batch_renderer_) {
+        batch_renderer_ = std::make_unique<BatchRenderer>(
+                *render_context_,
+                [this](CommandBuffer &command_buffer, RenderTarget &render_target, const BatchJob &job) {
+                    RecordBatchJob(command_buffer, render_target, job);
+                },
+                batch_hdr_);
+    }
+    batch_renderer_->Enqueue(std::move(job));
+}
+
+void ForwardApplication::FlushBatch() {
+    if (!batch_renderer_) {
+        return;
+    }
+    batch_simulation_pending_ = true;
+    batch_renderer_->Flush();
+    batch_simulation_pending_ = false;
+
+    SetRenderCamera(main_camera_);
+    const auto &kExtent = render_context_->GetSurfaceExtent();
+    main_camera_->Resize(kExtent.width, kExtent.height, kExtent.width, kExtent.height);
+}
+
+void ForwardApplication::RecordBatchJob(CommandBuffer &command_buffer,
+                                        RenderTarget &render_target,
+                                        const BatchJob &job) {
+    SetRenderCamera(job.camera);
+    job.camera->Resize(job.width, job.height, job.width, job.height);
+    scene_manager_->CurrentScene()->UpdateShaderData();
+    simulate_gpu_tasks_ = batch_simulation_pending_;
+    batch_simulation_pending_ = false;
+    Draw(command_buffer, render_target);
+    simulate_gpu_tasks_ = true;
+}
+
+void ForwardApplication::SetRenderCamera(Camera *camera) {
+    for (auto &subpass : GetRenderPipeline().GetSubpasses()) {
+        subpass->SetCamera(camera);
+    }
+    light_manager_->SetCamera(camera);
+    shadow_manager_->SetCamera(camera);
+    particle_manager_->SetCamera(camera);
+}
+
 void ForwardApplication::UpdateGpuTask(CommandBuffer &command_buffer, RenderTarget &render_target) {
+    VOX_TRACE_SCOPE("GPU Tasks");
+    if (simulate_gpu_tasks_) {
+        skinning_manager_->Draw(command_buffer, render_target);
+    }
     shadow_manager_->Draw(command_buffer);
     light_manager_->Draw(command_buffer, render_target);
-    particle_manager_->Draw(command_buffer, render_target);
+    if (simulate_gpu_tasks_) {
+        particle_manager_->Draw(command_buffer, render_target);
+    } else {
+        particle_manager_->SortForCamera(command_buffer, render_target);
+    }
 }
 
 }  // namespace vox
@@ -6,12 +6,16 @@
 
 #pragma once
 
+#include "vox.base/task_graph.h"
 #include "vox.render/components_manager.h"
 #include "vox.render/graphics_application.h"
 #include "vox.render/lighting/light_manager.h"
+#include "vox.render/material/bindless_texture_table.h"
 #include "vox.render/mesh/mesh_manager.h"
+#include "vox.render/mesh/skinning_manager.h"
 #include "vox.render/particle/particle_manager.h"
 #include "vox.render/physics/physics_manager.h"
+#include "vox.render/rendering/batch_renderer.h"
 #include "vox.render/scene_manager.h"
 #include "vox.render/shader/shader_manager.h"
 #include "vox.render/shadow/shadow_manager.h"
@@ -44,9 +48,84 @@ public:
 
     virtual void UpdateGpuTask(CommandBuffer &command_buffer, RenderTarget &render_target);
 
+    /**
+     * @brief Queue an offscreen image of the current scene, rendered by FlushBatch, a job without camera renders the
+     * main camera
+     */
+    void EnqueueBatchJob(BatchJob job);
+
+    /**
+     * @brief Render the queued jobs and wait for their images, the main camera is used again afterwards
+     */
+    void FlushBatch();
+
 protected:
+    /**
+     * @brief Tasks of the update graph, subclasses order their own tasks against them
+     */
+    struct UpdatePhases {
+        utility::TaskGraph::TaskId scripts_start{utility::TaskGraph::invalid_task_};
+        /** Invalid in pipelined mode, the step was started by the previous frame */
+        utility::TaskGraph::TaskId physics_start{utility::TaskGraph::invalid_task_};
+        utility::TaskGraph::TaskId physics_fetch{utility::TaskGraph::invalid_task_};
+        utility::TaskGraph::TaskId scripts_update{utility::TaskGraph::invalid_task_};
+        utility::TaskGraph::TaskId animators_evaluate{utility::TaskGraph::invalid_task_};
+        utility::TaskGraph::TaskId animators_apply{utility::TaskGraph::invalid_task_};
+        utility::TaskGraph::TaskId scripts_late_update{utility::TaskGraph::invalid_task_};
+        utility::TaskGraph::TaskId renderers_update{utility::TaskGraph::invalid_task_};
+        utility::TaskGraph::TaskId shader_data{utility::TaskGraph::invalid_task_};
+        /** Starts the physics step of the next frame, valid in pipelined mode only */
+        utility::TaskGraph::TaskId next_simulation{utility::TaskGraph::invalid_task_};
+    };
+
+    /**
+     * @brief Add the tasks of the subclass to the update graph of this frame
+     */
+    virtual void AddUpdateTasks(utility::TaskGraph &graph, const UpdatePhases &phases, float delta_time) {}
+
+    void RequestGpuFeatures(PhysicalDevice &gpu) override;
+
+    void PrepareRenderContext() override;
+
+    virtual void RecordBatchJob(CommandBuffer &command_buffer, RenderTarget &render_target, const BatchJob &job);
+
+    /**
+     * @brief Camera of the scene subpasses, the light clusters, the shadow cascades and the particle sort
+     */
+    void SetRenderCamera(Camera *camera);
+
     Camera *main_camera_{nullptr};
 
+    /**
+     * @brief Sample materials from one descriptor array when the device supports descriptor indexing,
+     * set before Prepare
+     */
+    bool bindless_textures_{false};
+    std::unique_ptr<BindlessTextureTable> bindless_texture_table_{nullptr};
+
+    /**
+     * @brief Start the simulation of the next frame once the render data of this frame is written, so it runs
+     * while the frame is recorded and submitted. The simulation lags the rendered frame by one step.
+     * The entities are the snapshot the frame renders: PhysX keeps the step to itself until it is fetched by the next
+     * Update. Only the physics step overlaps the recording, the scripts and animators of the next frame do not.
+     */
+    bool pipelined_simulation_{false};
+    utility::TaskGraph update_graph_;
+
+    /**
+     * @brief Frames recorded while the previous ones execute on a headless window, and float targets written as
+     * Radiance hdr for batch jobs, set before Prepare
+     */
+    uint32_t batch_frames_in_flight_{3};
+    bool batch_hdr_{false};
+    std::unique_ptr<BatchRenderer> batch_renderer_{nullptr};
+    /**
+     * @brief False while recording the batch jobs after the first of a flush, GPU tasks which advance a simulation
+     * must only run when set, the jobs of a flush render the same state
+     */
+    bool simulate_gpu_tasks_{true};
+    bool batch_simulation_pending_{false};
+
     /**
      * @brief Holds all scene information
      */
@@ -60,6 +139,7 @@ protected:
     std::unique_ptr<ShadowManager> shadow_manager_{nullptr};
     std::unique_ptr<LightManager> light_manager_{nullptr};
     std::unique_ptr<ParticleManager> particle_manager_{nullptr};
+    std::unique_ptr<SkinningManager> skinning_manager_{nullptr};
 };
 
 }  // namespace vox
@@ -16,6 +16,7 @@ VKBP_ENABLE_WARNINGS()
 
 #include "vox.base/helper.h"
 #include "vox.base/logging.h"
+#include "vox.base/tracer.h"
 #include "vox.render/platform/glfw_window.h"
 #include "vox.render/platform/platform.h"
 #include "vox.render/platform/window.h"
@@ -38,6 +39,7 @@ GraphicsApplication::~GraphicsApplication() {
         render_pipeline_.reset();
     }
     stats_.reset();
+    gpu_profiler_.reset();
     gui_.reset();
     render_context_.reset();
     device_.reset();
@@ -162,10 +164,15 @@ bool GraphicsApplication::Prepare(Platform &platform) {
     CreateRenderContext(platform);
     PrepareRenderContext();
 
-    gui_ = std::make_unique<ui::UiManager>(static_cast<GlfwWindow *>(&platform.GetWindow())->Handle(),
-                                           render_context_.get());
+    // headless windows (benchmark, offscreen) have no surface to draw the gui on
+    if (auto *glfw_window = dynamic_cast<GlfwWindow *>(&platform.GetWindow())) {
+        gui_ = std::make_unique<ui::UiManager>(glfw_window->Handle(), render_context_.get());
+    }
     stats_ = std::make_unique<vox::Stats>(*render_context_);
 
+    gpu_profiler_ =
+            std::make_unique<GpuProfiler>(*device_, static_cast<uint32_t>(render_context_->GetRenderFrames().size()));
+
     // Start the sample in the first GUI configuration
     configuration_.Reset();
 
@@ -209,18 +216,28 @@ void GraphicsApplication::Update(float delta_time) {
     // Collect the performance data for the sample graphs
     UpdateStats(delta_time);
 
-    command_buffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-    stats_->BeginSampling(command_buffer);
+    {
+        VOX_TRACE_SCOPE("Recording");
+        command_buffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        gpu_profiler_->BeginFrame(command_buffer, render_context_->GetActiveFrameIndex());
+        stats_->BeginSampling(command_buffer);
 
-    Draw(command_buffer, render_context_->GetActiveFrame().GetRenderTarget());
+        Draw(command_buffer, render_context_->GetActiveFrame().GetRenderTarget());
 
-    stats_->EndSampling(command_buffer);
-    command_buffer.End();
+        stats_->EndSampling(command_buffer);
+        gpu_profiler_->EndFrame(command_buffer);
+        command_buffer.End();
+    }
 
-    render_context_->Submit(command_buffer);
+    {
+        VOX_TRACE_SCOPE("Submit");
+        render_context_->Submit(command_buffer);
 
-    platform_->OnPostDraw(GetRenderContext());
-    device_->WaitIdle();  // sync cpu and gpu
+        platform_->OnPostDraw(GetRenderContext());
+        device_->WaitIdle();  // sync cpu and gpu
+    }
+
+    utility::Tracer::FrameMark();
 }
 
 void GraphicsApplication::Draw(CommandBuffer &command_buffer, RenderTarget &render_target) {
@@ -330,6 +347,10 @@ Device &GraphicsApplication::GetDevice() { return *device_; }
 
 Configuration &GraphicsApplication::GetConfiguration() { return configuration_; }
 
+float GraphicsApplication::GetGpuFrameTime() const {
+    return gpu_profiler_ ? gpu_profiler_->GetFrameTime() : 0.0f;
+}
+
 void GraphicsApplication::DrawGui() {}
 
 void GraphicsApplication::SetViewportAndScissor(vox::CommandBuffer &command_buffer, const VkExtent2D &extent) {
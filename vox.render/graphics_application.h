@@ -11,6 +11,7 @@
 #include "vox.render/platform/application.h"
 #include "vox.render/rendering/render_context.h"
 #include "vox.render/rendering/render_pipeline.h"
+#include "vox.render/stats/gpu_profiler.h"
 #include "vox.render/stats/stats.h"
 #include "vox.render/ui/ui_manager.h"
 #include "vox.render/utils.h"
@@ -131,6 +132,11 @@ public:
 
     Configuration &GetConfiguration();
 
+    /**
+     * @brief GPU execution time of the last frame in seconds, 0 when timestamp queries are not supported
+     */
+    [[nodiscard]] float GetGpuFrameTime() const;
+
 protected:
     /**
      * @brief The Vulkan instance
@@ -156,6 +162,11 @@ protected:
 
     std::unique_ptr<Stats> stats_{nullptr};
 
+    /**
+     * @brief Timestamp queries of the frame, subpasses and compute passes
+     */
+    std::unique_ptr<GpuProfiler> gpu_profiler_{nullptr};
+
     /**
      * @brief Update counter values
      * @param delta_time delta_time
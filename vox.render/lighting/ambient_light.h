@@ -10,6 +10,7 @@
 #include "vox.math/spherical_harmonics3.h"
 #include "vox.render/core/sampler.h"
 #include "vox.render/scene_forward.h"
+#include "vox.render/shader/shader_property.h"
 #include "vox.render/texture.h"
 
 namespace vox {
@@ -108,15 +109,15 @@ private:
     std::unique_ptr<core::Sampler> sampler_{nullptr};
 
     EnvMapLight env_map_light_;
-    const std::string env_map_property_;
+    const ShaderProperty env_map_property_;
 
     SphericalHarmonics3 diffuse_spherical_harmonics_;
     std::array<float, 27> sh_array_{};
-    const std::string diffuse_sh_property_;
+    const ShaderProperty diffuse_sh_property_;
 
     bool specular_texture_decode_rgbm_{false};
     std::shared_ptr<Texture> specular_reflection_{nullptr};
-    const std::string specular_texture_property_;
+    const ShaderProperty specular_texture_property_;
 
     Scene *scene_{nullptr};
     DiffuseMode diffuse_mode_ = DiffuseMode::SOLID_COLOR;
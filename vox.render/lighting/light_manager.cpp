@@ -6,11 +6,15 @@
 
 #include "vox.render/lighting/light_manager.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "vox.base/logging.h"
+#include "vox.math/math_utils.h"
 #include "vox.render/camera.h"
 #include "vox.render/scene.h"
-#include "vox.render/shader/internal_variant_name.h"
 #include "vox.render/shader/shader_manager.h"
+#include "vox.render/stats/gpu_profiler.h"
 
 namespace vox {
 LightManager *LightManager::GetSingletonPtr() { return ms_singleton; }
@@ -22,44 +26,109 @@ LightManager &LightManager::GetSingleton() {
 
 LightManager::LightManager(Scene *scene, RenderContext &render_context)
     : scene_(scene),
-      shader_data_(scene->Device()),
+      light_count_property_("lightCount"),
       point_light_property_("pointLight"),
       spot_light_property_("spotLight"),
       direct_light_property_("directLight"),
-      forward_plus_prop_("clusterUniform"),
+      cluster_uniform_prop_("clusterUniform"),
       clusters_prop_("u_clusters"),
-      cluster_lights_prop_("clusterLights") {
+      cluster_lights_prop_("clusterLights"),
+      cluster_light_indices_prop_("clusterLightIndices"),
+      cluster_counter_prop_("clusterCounter"),
+      render_context_(render_context),
+      shader_data_(scene->Device()),
+      cluster_graph_(scene->Device()) {
     auto &device = scene_->Device();
-    clusters_buffer_ = std::make_unique<core::Buffer>(device, sizeof(Clusters), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                                                      VMA_MEMORY_USAGE_GPU_ONLY);
-    shader_data_.SetBufferFunctor(clusters_prop_, [this]() -> core::Buffer * { return clusters_buffer_.get(); });
+    point_light_buffer_ =
+            std::make_unique<StorageBufferArray>(device, render_context, sizeof(PointLight::PointLightData));
+    spot_light_buffer_ = std::make_unique<StorageBufferArray>(device, render_context, sizeof(SpotLight::SpotLightData));
+    direct_light_buffer_ =
+            std::make_unique<StorageBufferArray>(device, render_context, sizeof(DirectLight::DirectLightData));
+    scene_->shader_data.SetBufferFunctor(point_light_property_,
+                                         [this]() -> core::Buffer * { return point_light_buffer_->Buffer(); });
+    scene_->shader_data.SetBufferFunctor(spot_light_property_,
+                                         [this]() -> core::Buffer * { return spot_light_buffer_->Buffer(); });
+    scene_->shader_data.SetBufferFunctor(direct_light_property_,
+                                         [this]() -> core::Buffer * { return direct_light_buffer_->Buffer(); });
+    scene_->shader_data.SetData(light_count_property_, light_count_);
 
-    cluster_lights_buffer_ = std::make_unique<core::Buffer>(
-            device, sizeof(ClusterLightGroup), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
-    scene_->shader_data.SetBufferFunctor(cluster_lights_prop_,
-                                         [this]() -> core::Buffer * { return cluster_lights_buffer_.get(); });
+    // cluster buffers grow with the grid and the light count, see AssignClusterLights
+    cluster_frames_.resize(std::max<size_t>(render_context.GetRenderFrames().size(), 1));
+    for (auto &frame : cluster_frames_) {
+        frame.bounds = std::make_unique<core::Buffer>(device, sizeof(ClusterBounds), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                      VMA_MEMORY_USAGE_GPU_ONLY);
+        frame.lights = std::make_unique<core::Buffer>(device, sizeof(ClusterLights), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                      VMA_MEMORY_USAGE_GPU_ONLY);
+        frame.index_capacity = 1024;
+        frame.indices = std::make_unique<core::Buffer>(device, frame.index_capacity * sizeof(uint32_t),
+                                                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+        frame.counter = std::make_unique<core::Buffer>(device, sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                       VMA_MEMORY_USAGE_GPU_TO_CPU);
+        *reinterpret_cast<uint32_t *>(frame.counter->Map()) = 0;
+    }
+    scene_->shader_data.SetData(cluster_uniform_prop_, cluster_uniform_);
+    shader_data_.SetBufferFunctor(clusters_prop_,
+                                  [this]() -> core::Buffer * { return cluster_frames_[cluster_frame_].bounds.get(); });
+    shader_data_.SetBufferFunctor(cluster_counter_prop_, [this]() -> core::Buffer * {
+        return cluster_frames_[cluster_frame_].counter.get();
+    });
+    scene_->shader_data.SetBufferFunctor(
+            cluster_lights_prop_, [this]() -> core::Buffer * { return cluster_frames_[cluster_frame_].lights.get(); });
+    scene_->shader_data.SetBufferFunctor(cluster_light_indices_prop_, [this]() -> core::Buffer * {
+        return cluster_frames_[cluster_frame_].indices.get();
+    });
 
     cluster_bounds_compute_ = std::make_unique<PostProcessingPipeline>(render_context, ShaderSource());
     bounds_pass_ = &cluster_bounds_compute_->AddPass<PostProcessingComputePass>(
             ShaderManager::GetSingleton().LoadShader("base/light/cluster_bounds.comp"));
-    bounds_pass_->SetDispatchSize(dispatch_size_);
+    bounds_pass_->SetDebugName("Cluster Bounds");
     bounds_pass_->AttachShaderData(&shader_data_);
     bounds_pass_->AttachShaderData(&scene_->shader_data);
 
+    cluster_count_compute_ = std::make_unique<PostProcessingPipeline>(render_context, ShaderSource());
+    count_pass_ = &cluster_count_compute_->AddPass<PostProcessingComputePass>(
+            ShaderManager::GetSingleton().LoadShader("base/light/cluster_count.comp"));
+    count_pass_->SetDebugName("Cluster Light Count");
+    count_pass_->AttachShaderData(&shader_data_);
+    count_pass_->AttachShaderData(&scene_->shader_data);
+
+    cluster_scan_compute_ = std::make_unique<PostProcessingPipeline>(render_context, ShaderSource());
+    scan_pass_ = &cluster_scan_compute_->AddPass<PostProcessingComputePass>(
+            ShaderManager::GetSingleton().LoadShader("base/light/cluster_scan.comp"));
+    scan_pass_->SetDispatchSize({1, 1, 1});
+    scan_pass_->SetDebugName("Cluster Light Scan");
+    scan_pass_->AttachShaderData(&shader_data_);
+    scan_pass_->AttachShaderData(&scene_->shader_data);
+
     cluster_lights_compute_ = std::make_unique<PostProcessingPipeline>(render_context, ShaderSource());
     lights_pass_ = &cluster_lights_compute_->AddPass<PostProcessingComputePass>(
             ShaderManager::GetSingleton().LoadShader("base/light/cluster_light.comp"));
-    lights_pass_->SetDispatchSize(dispatch_size_);
+    lights_pass_->SetDebugName("Cluster Lights");
     lights_pass_->AttachShaderData(&shader_data_);
     lights_pass_->AttachShaderData(&scene_->shader_data);
 }
 
 void LightManager::SetCamera(Camera *camera) {
+    if (camera_ == camera) {
+        return;
+    }
+    if (camera_) {
+        bounds_pass_->DetachShaderData(&camera_->shader_data_);
+        count_pass_->DetachShaderData(&camera_->shader_data_);
+        lights_pass_->DetachShaderData(&camera_->shader_data_);
+    }
     camera_ = camera;
     bounds_pass_->AttachShaderData(&camera_->shader_data_);
+    count_pass_->AttachShaderData(&camera_->shader_data_);
     lights_pass_->AttachShaderData(&camera_->shader_data_);
 }
 
+void LightManager::SetClusterTileSize(uint32_t pixels) { cluster_tile_size_ = std::max(pixels, 1u); }
+
+void LightManager::SetMaxClusterDepthSlices(uint32_t count) { max_cluster_depth_slices_ = std::max(count, 1u); }
+
+void LightManager::SetClusterMinLightCount(uint32_t count) { cluster_min_light_count_ = count; }
+
 // MARK: - Point Light
 void LightManager::AttachPointLight(PointLight *light) {
     auto iter = std::find(point_lights_.begin(), point_lights_.end(), light);
@@ -117,77 +186,191 @@ void LightManager::DetachDirectLight(DirectLight *light) {
 
 const std::vector<DirectLight *> &LightManager::DirectLights() const { return direct_lights_; }
 
+uint32_t LightManager::VisiblePointLightCount() const { return light_count_.point_light_count; }
+
+uint32_t LightManager::VisibleSpotLightCount() const { return light_count_.spot_light_count; }
+
 void LightManager::UpdateShaderData(ShaderData &shader_data) {
-    size_t point_light_count = point_lights_.size();
-    point_light_datas_.resize(point_light_count);
-    size_t spot_light_count = spot_lights_.size();
-    spot_light_datas_.resize(spot_light_count);
-    size_t direct_light_count = direct_lights_.size();
-    direct_light_datas_.resize(direct_light_count);
+    // lights whose range does not reach the view frustum are not uploaded,
+    // the frustum is only maintained by cameras with culling enabled
+    const bool kCull = camera_ && camera_->enable_frustum_culling_;
+    auto is_visible = [&](const Vector3F &position, float range) {
+        if (!kCull || range <= 0) return true;
+        return camera_->Frustum().intersectsBox(
+                BoundingBox3F(Point3F(position.x - range, position.y - range, position.z - range),
+                              Point3F(position.x + range, position.y + range, position.z + range)));
+    };
 
-    for (size_t i = 0; i < point_light_count; i++) {
-        point_lights_[i]->UpdateShaderData(point_light_datas_[i]);
+    size_t point_light_count = 0;
+    point_light_datas_.resize(point_lights_.size());
+    for (auto *light : point_lights_) {
+        auto &data = point_light_datas_[point_light_count];
+        light->UpdateShaderData(data);
+        if (is_visible(data.position, data.distance)) {
+            point_light_count++;
+        }
     }
 
-    for (size_t i = 0; i < spot_light_count; i++) {
-        spot_lights_[i]->UpdateShaderData(spot_light_datas_[i]);
+    size_t spot_light_count = 0;
+    spot_light_datas_.resize(spot_lights_.size());
+    for (auto *light : spot_lights_) {
+        auto &data = spot_light_datas_[spot_light_count];
+        light->UpdateShaderData(data);
+        if (is_visible(data.position, data.distance)) {
+            spot_light_count++;
+        }
     }
 
+    size_t direct_light_count = direct_lights_.size();
+    direct_light_datas_.resize(direct_light_count);
     for (size_t i = 0; i < direct_light_count; i++) {
         direct_lights_[i]->UpdateShaderData(direct_light_datas_[i]);
     }
 
-    if (direct_light_count) {
-        shader_data.AddDefine(DIRECT_LIGHT_COUNT + std::to_string(direct_light_count));
-        shader_data.SetData(LightManager::direct_light_property_, direct_light_datas_);
-    } else {
-        shader_data.RemoveDefine(DIRECT_LIGHT_COUNT);
-    }
+    // unchanged entries keep the content written when the frame buffer was last used
+    direct_light_buffer_->UpdateChanged(direct_light_datas_.data(), direct_light_count);
+    point_light_buffer_->UpdateChanged(point_light_datas_.data(), point_light_count);
+    spot_light_buffer_->UpdateChanged(spot_light_datas_.data(), spot_light_count);
 
-    if (point_light_count) {
-        shader_data.AddDefine(POINT_LIGHT_COUNT + std::to_string(point_light_count));
-        shader_data.SetData(LightManager::point_light_property_, point_light_datas_);
-    } else {
-        shader_data.RemoveDefine(POINT_LIGHT_COUNT);
-    }
-
-    if (spot_light_count) {
-        shader_data.AddDefine(SPOT_LIGHT_COUNT + std::to_string(spot_light_count));
-        shader_data.SetData(LightManager::spot_light_property_, spot_light_datas_);
-    } else {
-        shader_data.RemoveDefine(SPOT_LIGHT_COUNT);
-    }
+    light_count_.direct_light_count = static_cast<uint32_t>(direct_light_count);
+    light_count_.point_light_count = static_cast<uint32_t>(point_light_count);
+    light_count_.spot_light_count = static_cast<uint32_t>(spot_light_count);
+    shader_data.SetData(light_count_property_, light_count_);
 }
 
 // MARK: - Forward Plus
 void LightManager::Draw(CommandBuffer &command_buffer, RenderTarget &render_target) {
     UpdateShaderData(scene_->shader_data);
 
-    size_t point_light_count = point_lights_.size();
-    size_t spot_light_count = spot_lights_.size();
-    if (point_light_count + spot_light_count > forward_plus_enable_min_count_) {
+    if (light_count_.point_light_count + light_count_.spot_light_count > cluster_min_light_count_) {
         scene_->shader_data.AddDefine("NEED_FORWARD_PLUS");
+        AssignClusterLights(command_buffer, render_target);
+    } else {
+        scene_->shader_data.RemoveDefine("NEED_FORWARD_PLUS");
+    }
+}
 
-        bool update_bounds = false;
+void LightManager::UpdateClusterGrid() {
+    const auto kWidth = static_cast<float>(camera_->FramebufferWidth());
+    const auto kHeight = static_cast<float>(camera_->FramebufferHeight());
+    const float kNear = camera_->NearClipPlane();
+    const float kFar = camera_->FarClipPlane();
 
-        if (forward_plus_uniforms_.x != camera_->FramebufferWidth() ||
-            forward_plus_uniforms_.y != camera_->FramebufferHeight()) {
-            update_bounds = true;
-            forward_plus_uniforms_.x = camera_->FramebufferWidth();
-            forward_plus_uniforms_.y = camera_->FramebufferHeight();
-        }
-        forward_plus_uniforms_.z = camera_->NearClipPlane();
-        forward_plus_uniforms_.w = camera_->FarClipPlane();
-        scene_->shader_data.SetData(forward_plus_prop_, forward_plus_uniforms_);
-
-        // Reset the light offset counter to 0 before populating the light clusters.
-        uint32_t empty = 0;
-        cluster_lights_buffer_->Update(&empty, sizeof(uint32_t));
-        if (update_bounds) {
-            cluster_bounds_compute_->Draw(command_buffer, render_target);
+    const auto kTileCountX = static_cast<uint32_t>(std::ceil(kWidth / static_cast<float>(cluster_tile_size_)));
+    const auto kTileCountY = static_cast<uint32_t>(std::ceil(kHeight / static_cast<float>(cluster_tile_size_)));
+    // log slices whose depth matches the size of a tile, "Clustered Deferred and Forward Shading", Olsson et al.
+    const float kTileAngle = 2.f * std::tan(degreesToRadians(camera_->FieldOfView()) * 0.5f) /
+                             static_cast<float>(std::max(kTileCountY, 1u));
+    auto tile_count_z = static_cast<uint32_t>(std::ceil(std::log(kFar / kNear) / std::log(1.f + kTileAngle)));
+    tile_count_z = std::clamp(tile_count_z, 1u, max_cluster_depth_slices_);
+
+    cluster_uniform_.projection = Vector4F(kWidth, kHeight, kNear, kFar);
+    cluster_uniform_.grid = {std::max(kTileCountX, 1u), std::max(kTileCountY, 1u), tile_count_z, 0};
+    cluster_uniform_.grid[3] = cluster_uniform_.grid[0] * cluster_uniform_.grid[1] * cluster_uniform_.grid[2];
+
+    const float kLogDepthRange = std::log2(kFar / kNear);
+    cluster_uniform_.slice.x = static_cast<float>(tile_count_z) / kLogDepthRange;
+    cluster_uniform_.slice.y = -static_cast<float>(tile_count_z) * std::log2(kNear) / kLogDepthRange;
+    cluster_uniform_.slice.z = static_cast<float>(cluster_tile_size_);
+    cluster_uniform_.slice.w = static_cast<float>(cluster_tile_size_);
+}
+
+void LightManager::AssignClusterLights(CommandBuffer &command_buffer, RenderTarget &render_target) {
+    auto &device = scene_->Device();
+    cluster_frame_ = render_context_.GetActiveFrameIndex() % cluster_frames_.size();
+    auto &frame = cluster_frames_[cluster_frame_];
+
+    UpdateClusterGrid();
+    const uint32_t kClusterCount = cluster_uniform_.grid[3];
+    const VkDeviceSize kBoundsSize = kClusterCount * sizeof(ClusterBounds);
+    bool update_bounds = frame.bounds_projection != cluster_uniform_.projection ||
+                         frame.bounds_grid != cluster_uniform_.grid || frame.bounds_fov != camera_->FieldOfView();
+    if (frame.bounds->GetSize() < kBoundsSize) {
+        // the fence of the active frame has been waited on, its buffers are not in use anymore
+        frame.bounds = std::make_unique<core::Buffer>(device, kBoundsSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                      VMA_MEMORY_USAGE_GPU_ONLY);
+        frame.lights = std::make_unique<core::Buffer>(device, kClusterCount * sizeof(ClusterLights),
+                                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+        update_bounds = true;
+    }
+
+    // the total written by the last assignment of this frame sizes the index list,
+    // a growing scene overflows the list for at most one frame per frame in flight
+    frame.counter->Invalidate();
+    const uint32_t kRequired = std::max(*reinterpret_cast<const uint32_t *>(frame.counter->GetData()), kClusterCount);
+    if (frame.index_capacity < kRequired) {
+        uint32_t capacity = frame.index_capacity;
+        while (capacity < kRequired) {
+            capacity *= 2;
         }
-        cluster_lights_compute_->Draw(command_buffer, render_target);
+        frame.indices = std::make_unique<core::Buffer>(device, capacity * sizeof(uint32_t),
+                                                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+        frame.index_capacity = capacity;
+    }
+    cluster_uniform_.index_capacity = frame.index_capacity;
+    scene_->shader_data.SetData(cluster_uniform_prop_, cluster_uniform_);
+
+    const uint32_t kGroupCount = (kClusterCount + cluster_group_size_ - 1) / cluster_group_size_;
+    constexpr VkPipelineStageFlags kCompute = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    constexpr VkAccessFlags kReadWrite = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    cluster_graph_.Clear(cluster_frame_);
+    const auto kBounds = cluster_graph_.ImportBuffer("clusterBounds", *frame.bounds);
+    const auto kLights = cluster_graph_.ImportBuffer("clusterLights", *frame.lights);
+    const auto kIndices = cluster_graph_.ImportBuffer("clusterLightIndices", *frame.indices);
+    const auto kCounter = cluster_graph_.ImportBuffer("clusterCounter", *frame.counter);
+
+    if (update_bounds) {
+        cluster_graph_.AddPass(
+                "Cluster Bounds",
+                [&](RenderGraph::PassBuilder &builder) {
+                    builder.Write(kBounds, kCompute, VK_ACCESS_SHADER_WRITE_BIT);
+                },
+                [&](CommandBuffer &command_buffer) {
+                    bounds_pass_->SetDispatchSize({kGroupCount, 1, 1});
+                    cluster_bounds_compute_->Draw(command_buffer, render_target);
+                });
+        frame.bounds_projection = cluster_uniform_.projection;
+        frame.bounds_grid = cluster_uniform_.grid;
+        frame.bounds_fov = camera_->FieldOfView();
     }
+
+    cluster_graph_.AddPass(
+            "Cluster Light Count",
+            [&](RenderGraph::PassBuilder &builder) {
+                builder.Read(kBounds, kCompute, VK_ACCESS_SHADER_READ_BIT);
+                builder.Write(kLights, kCompute, VK_ACCESS_SHADER_WRITE_BIT);
+            },
+            [&](CommandBuffer &command_buffer) {
+                count_pass_->SetDispatchSize({kGroupCount, 1, 1});
+                cluster_count_compute_->Draw(command_buffer, render_target);
+            });
+
+    cluster_graph_.AddPass(
+            "Cluster Light Scan",
+            [&](RenderGraph::PassBuilder &builder) {
+                builder.Write(kLights, kCompute, kReadWrite);
+                builder.Write(kCounter, kCompute, VK_ACCESS_SHADER_WRITE_BIT);
+            },
+            [&](CommandBuffer &command_buffer) { cluster_scan_compute_->Draw(command_buffer, render_target); });
+
+    cluster_graph_.AddPass(
+            "Cluster Lights",
+            [&](RenderGraph::PassBuilder &builder) {
+                builder.Read(kBounds, kCompute, VK_ACCESS_SHADER_READ_BIT);
+                builder.Write(kLights, kCompute, kReadWrite);
+                builder.Write(kIndices, kCompute, VK_ACCESS_SHADER_WRITE_BIT);
+            },
+            [&](CommandBuffer &command_buffer) {
+                lights_pass_->SetDispatchSize({kGroupCount, 1, 1});
+                cluster_lights_compute_->Draw(command_buffer, render_target);
+            });
+
+    // the lists are read by the shading, the total is read back once the fence of this frame is signaled
+    cluster_graph_.Export(kLights, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+    cluster_graph_.Export(kIndices, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+    cluster_graph_.Export(kCounter, VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+    VOX_GPU_SCOPE(command_buffer, "Light Clusters", StatIndex::GPU_COMPUTE_TIME);
+    cluster_graph_.Execute(command_buffer);
 }
 
 }  // namespace vox
@@ -12,6 +12,8 @@
 #include "vox.render/lighting/spot_light.h"
 #include "vox.render/rendering/postprocessing_computepass.h"
 #include "vox.render/rendering/postprocessing_pipeline.h"
+#include "vox.render/rendering/render_graph.h"
+#include "vox.render/rendering/storage_buffer_array.h"
 #include "vox.render/shader/shader_data.h"
 
 namespace vox {
@@ -20,18 +22,7 @@ namespace vox {
  */
 class LightManager : public Singleton<LightManager> {
 public:
-    static constexpr uint32_t forward_plus_enable_min_count_ = 20;
-    static constexpr std::array<uint32_t, 3> tile_count_ = {32, 18, 48};
-    static constexpr uint32_t total_tiles_ = tile_count_[0] * tile_count_[1] * tile_count_[2];
-
-    static constexpr std::array<uint32_t, 3> workgroup_size_ = {4, 2, 4};
-    static constexpr std::array<uint32_t, 3> dispatch_size_ = {tile_count_[0] / workgroup_size_[0],
-                                                               tile_count_[1] / workgroup_size_[1],
-                                                               tile_count_[2] / workgroup_size_[2]};
-
-    // Each cluster tracks up to MAX_LIGHTS_PER_CLUSTER light indices (ints) and one light count.
-    // This limitation should be able to go away when we have atomic methods in Vulkan.
-    static constexpr uint32_t max_lights_per_cluster_ = 50;
+    static constexpr uint32_t cluster_group_size_ = 64;
 
     static LightManager &GetSingleton();
 
@@ -41,6 +32,19 @@ public:
 
     void SetCamera(Camera *camera);
 
+    /**
+     * Width and height of a cluster on screen, in pixels. The depth slices are derived from it so that clusters stay
+     * roughly cubic, up to the max depth slice count.
+     */
+    void SetClusterTileSize(uint32_t pixels);
+
+    void SetMaxClusterDepthSlices(uint32_t count);
+
+    /**
+     * Lights are assigned to clusters once more point and spot lights than the given count are visible.
+     */
+    void SetClusterMinLightCount(uint32_t count);
+
     /**
      * Register a light object to the current scene.
      * @param light render light
@@ -86,29 +90,61 @@ public:
     [[nodiscard]] const std::vector<DirectLight *> &DirectLights() const;
 
 public:
+    /**
+     * Number of point lights uploaded for the last frame, lights outside of the camera frustum are culled.
+     */
+    [[nodiscard]] uint32_t VisiblePointLightCount() const;
+
+    [[nodiscard]] uint32_t VisibleSpotLightCount() const;
+
     void Draw(CommandBuffer &command_buffer, RenderTarget &render_target);
 
 private:
     Scene *scene_{nullptr};
     Camera *camera_{nullptr};
 
+    // light arrays are runtime-sized storage buffers and their lengths live in a uniform,
+    // so adding or removing lights never changes the shader variants
+    struct LightCount {
+        uint32_t direct_light_count;
+        uint32_t point_light_count;
+        uint32_t spot_light_count;
+        uint32_t pad;
+    };
+    LightCount light_count_{};
+    const ShaderProperty light_count_property_;
+
     std::vector<PointLight *> point_lights_;
     std::vector<PointLight::PointLightData> point_light_datas_;
-    const std::string point_light_property_;
+    std::unique_ptr<StorageBufferArray> point_light_buffer_;
+    const ShaderProperty point_light_property_;
 
     std::vector<SpotLight *> spot_lights_;
     std::vector<SpotLight::SpotLightData> spot_light_datas_;
-    const std::string spot_light_property_;
+    std::unique_ptr<StorageBufferArray> spot_light_buffer_;
+    const ShaderProperty spot_light_property_;
 
     std::vector<DirectLight *> direct_lights_;
     std::vector<DirectLight::DirectLightData> direct_light_datas_;
-    const std::string direct_light_property_;
+    std::unique_ptr<StorageBufferArray> direct_light_buffer_;
+    const ShaderProperty direct_light_property_;
 
     void UpdateShaderData(ShaderData &shader_data);
 
 private:
-    Vector4F forward_plus_uniforms_;
-    const std::string forward_plus_prop_;
+    struct ClusterUniform {
+        Vector4F projection;
+        std::array<uint32_t, 4> grid;
+        Vector4F slice;
+        uint32_t index_capacity;
+        uint32_t pad[3];
+    };
+    ClusterUniform cluster_uniform_{};
+    const ShaderProperty cluster_uniform_prop_;
+
+    uint32_t cluster_tile_size_{64};
+    uint32_t max_cluster_depth_slices_{128};
+    uint32_t cluster_min_light_count_{8};
 
     struct ClusterBounds {
         Vector3F min_aabb;
@@ -116,30 +152,55 @@ private:
         Vector3F max_aabb;
         float pad_2;
     };
-    struct Clusters {
-        std::array<ClusterBounds, total_tiles_> bounds;
-    };
-    const std::string clusters_prop_;
-    std::unique_ptr<core::Buffer> clusters_buffer_;
-
     struct ClusterLights {
         uint32_t offset;
         uint32_t point_count;
         uint32_t spot_count;
     };
-    struct ClusterLightGroup {
-        uint32_t offset;
-        std::array<ClusterLights, total_tiles_> lights;
-        std::array<uint32_t, max_lights_per_cluster_ * total_tiles_> indices;
-    };
-    const std::string cluster_lights_prop_;
-    std::unique_ptr<core::Buffer> cluster_lights_buffer_;
 
+    /**
+     * Cluster buffers of a frame in flight, written by the assignment passes and read by the shading of the same
+     * frame, so a frame never waits for the previous one and buffers can grow as soon as its fence is signaled.
+     */
+    struct ClusterFrame {
+        // bounds are rebuilt when the grid or the projection differ from the ones they were built with
+        std::unique_ptr<core::Buffer> bounds;
+        Vector4F bounds_projection;
+        std::array<uint32_t, 4> bounds_grid{};
+        float bounds_fov{0};
+
+        std::unique_ptr<core::Buffer> lights;
+        std::unique_ptr<core::Buffer> indices;
+        uint32_t index_capacity{0};
+        // total count of light indices, read back from the last assignment of this frame
+        std::unique_ptr<core::Buffer> counter;
+    };
+    std::vector<ClusterFrame> cluster_frames_;
+    size_t cluster_frame_{0};
+    const ShaderProperty clusters_prop_;
+    const ShaderProperty cluster_lights_prop_;
+    const ShaderProperty cluster_light_indices_prop_;
+    const ShaderProperty cluster_counter_prop_;
+
+    RenderContext &render_context_;
     ShaderData shader_data_;
     PostProcessingComputePass *bounds_pass_{nullptr};
     std::unique_ptr<PostProcessingPipeline> cluster_bounds_compute_{nullptr};
+    PostProcessingComputePass *count_pass_{nullptr};
+    std::unique_ptr<PostProcessingPipeline> cluster_count_compute_{nullptr};
+    PostProcessingComputePass *scan_pass_{nullptr};
+    std::unique_ptr<PostProcessingPipeline> cluster_scan_compute_{nullptr};
     PostProcessingComputePass *lights_pass_{nullptr};
     std::unique_ptr<PostProcessingPipeline> cluster_lights_compute_{nullptr};
+    // the assignment passes with the cluster buffers they access, rebuilt every frame
+    RenderGraph cluster_graph_;
+
+    void UpdateClusterGrid();
+
+    /**
+     * Build the per-cluster light lists with a count, prefix sum and fill pass, lists have no size limit.
+     */
+    void AssignClusterLights(CommandBuffer &command_buffer, RenderTarget &render_target);
 };
 
 template <>
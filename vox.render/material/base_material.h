@@ -67,10 +67,10 @@ protected:
 
 private:
     float alpha_cutoff_ = 0.0;
-    const std::string alpha_cutoff_prop_;
+    const ShaderProperty alpha_cutoff_prop_;
 
     Vector4F tiling_offset_ = Vector4F(1, 1, 0, 0);
-    const std::string tiling_offset_prop_;
+    const ShaderProperty tiling_offset_prop_;
 
     RenderFace render_face_ = RenderFace::BACK;
     BlendMode blend_mode_ = BlendMode::NORMAL;
@@ -0,0 +1,173 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.render/material/bindless_texture_table.h"
+
+#include <algorithm>
+
+#include "vox.render/core/command_buffer.h"
+#include "vox.render/core/device.h"
+#include "vox.render/core/pipeline_layout.h"
+#include "vox.render/shader/shader_common.h"
+
+namespace vox {
+BindlessTextureTable *BindlessTextureTable::GetSingletonPtr() { return ms_singleton; }
+
+BindlessTextureTable &BindlessTextureTable::GetSingleton() {
+    assert(ms_singleton);
+    return (*ms_singleton);
+}
+
+bool BindlessTextureTable::RequestFeatures(PhysicalDevice &gpu) {
+    // the queried struct is chained to the device creation, enabling what the device supports
+    const auto &features = gpu.RequestExtensionFeatures<VkPhysicalDeviceDescriptorIndexingFeaturesEXT>(
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT);
+    return features.runtimeDescriptorArray && features.shaderSampledImageArrayNonUniformIndexing &&
+           features.descriptorBindingPartiallyBound && features.descriptorBindingSampledImageUpdateAfterBind &&
+           features.descriptorBindingUpdateUnusedWhilePending;
+}
+
+bool BindlessTextureTable::IsSupported(Device &device) {
+    return device.IsEnabled(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+}
+
+BindlessTextureTable::BindlessTextureTable(Device &device, uint32_t frames_in_flight)
+    : device_(device), frames_in_flight_(frames_in_flight) {
+    VkDescriptorPoolSize pool_size{};
+    pool_size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    pool_size.descriptorCount = max_layouts_ * DescriptorSetLayout::max_unsized_array_size_;
+
+    VkDescriptorPoolCreateInfo create_info{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    create_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+    create_info.maxSets = max_layouts_;
+    create_info.poolSizeCount = 1;
+    create_info.pPoolSizes = &pool_size;
+
+    VK_CHECK(vkCreateDescriptorPool(device_.GetHandle(), &create_info, nullptr, &descriptor_pool_));
+}
+
+BindlessTextureTable::~BindlessTextureTable() {
+    if (descriptor_pool_ != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device_.GetHandle(), descriptor_pool_, nullptr);
+    }
+}
+
+uint32_t BindlessTextureTable::Register(const core::ImageView &image_view, const core::Sampler &sampler) {
+    auto iter = indices_.find({&image_view, &sampler});
+    if (iter != indices_.end()) {
+        slots_[iter->second].ref_count++;
+        return iter->second;
+    }
+
+    uint32_t index;
+    if (!free_indices_.empty()) {
+        index = free_indices_.back();
+        free_indices_.pop_back();
+    } else if (slots_.size() < DescriptorSetLayout::max_unsized_array_size_) {
+        index = static_cast<uint32_t>(slots_.size());
+        slots_.emplace_back();
+    } else {
+        LOGE("Bindless texture table is full ({} textures)", DescriptorSetLayout::max_unsized_array_size_)
+        throw std::runtime_error("Couldn't register bindless texture.");
+    }
+
+    slots_[index] = {&image_view, &sampler, 1};
+    indices_.emplace(std::make_pair(&image_view, &sampler), index);
+    // the index is new to the frames in flight, it can be written while they are pending
+    for (const auto &layout_set : layout_sets_) {
+        Write(layout_set, index);
+    }
+    return index;
+}
+
+void BindlessTextureTable::Unregister(uint32_t index) {
+    auto &slot = slots_.at(index);
+    if (slot.ref_count == 0 || --slot.ref_count > 0) {
+        return;
+    }
+
+    indices_.erase({slot.image_view, slot.sampler});
+    slot = {};
+    retired_indices_.emplace_back(index, frame_ + frames_in_flight_);
+}
+
+void BindlessTextureTable::NextFrame() {
+    ++frame_;
+    while (!retired_indices_.empty() && retired_indices_.front().second <= frame_) {
+        free_indices_.push_back(retired_indices_.front().first);
+        retired_indices_.pop_front();
+    }
+}
+
+void BindlessTextureTable::Bind(CommandBuffer &command_buffer,
+                                const PipelineLayout &pipeline_layout,
+                                VkPipelineBindPoint pipeline_bind_point) {
+    const auto kSetIndex = static_cast<uint32_t>(DescriptorSetFrequency::BINDLESS);
+    if (!pipeline_layout.HasDescriptorSetLayout(kSetIndex)) {
+        return;
+    }
+
+    if (auto layout_set = RequestSet(pipeline_layout.GetDescriptorSetLayout(kSetIndex))) {
+        vkCmdBindDescriptorSets(command_buffer.GetHandle(), pipeline_bind_point, pipeline_layout.GetHandle(),
+                                kSetIndex, 1, &layout_set->set, 0, nullptr);
+    }
+}
+
+const BindlessTextureTable::LayoutSet *BindlessTextureTable::RequestSet(
+        const DescriptorSetLayout &descriptor_set_layout) {
+    for (const auto &layout_set : layout_sets_) {
+        if (layout_set.layout == descriptor_set_layout.GetHandle()) {
+            return &layout_set;
+        }
+    }
+
+    auto &bindings = descriptor_set_layout.GetBindings();
+    auto binding = std::find_if(bindings.begin(), bindings.end(), [](const VkDescriptorSetLayoutBinding &binding) {
+        return binding.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER &&
+               binding.descriptorCount == DescriptorSetLayout::max_unsized_array_size_;
+    });
+    if (binding == bindings.end()) {
+        return nullptr;
+    }
+    if (layout_sets_.size() == max_layouts_) {
+        LOGE("Bindless texture table is bound with more than {} layouts", max_layouts_)
+        return nullptr;
+    }
+
+    LayoutSet layout_set{descriptor_set_layout.GetHandle(), binding->binding, VK_NULL_HANDLE};
+    VkDescriptorSetLayout layout_handle = layout_set.layout;
+    VkDescriptorSetAllocateInfo allocate_info{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+    allocate_info.descriptorPool = descriptor_pool_;
+    allocate_info.descriptorSetCount = 1;
+    allocate_info.pSetLayouts = &layout_handle;
+    VK_CHECK(vkAllocateDescriptorSets(device_.GetHandle(), &allocate_info, &layout_set.set));
+
+    for (uint32_t index = 0; index < slots_.size(); ++index) {
+        if (slots_[index].image_view != nullptr) {
+            Write(layout_set, index);
+        }
+    }
+    layout_sets_.push_back(layout_set);
+    return &layout_sets_.back();
+}
+
+void BindlessTextureTable::Write(const LayoutSet &layout_set, uint32_t index) const {
+    VkDescriptorImageInfo image_info{};
+    image_info.sampler = slots_[index].sampler->GetHandle();
+    image_info.imageView = slots_[index].image_view->GetHandle();
+    image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet write{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+    write.dstSet = layout_set.set;
+    write.dstBinding = layout_set.binding;
+    write.dstArrayElement = index;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &image_info;
+    vkUpdateDescriptorSets(device_.GetHandle(), 1, &write, 0, nullptr);
+}
+
+}  // namespace vox
@@ -0,0 +1,112 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "vox.base/singleton.h"
+#include "vox.render/core/image_view.h"
+#include "vox.render/core/sampler.h"
+#include "vox.render/vk_common.h"
+
+namespace vox {
+class CommandBuffer;
+class DescriptorSetLayout;
+class Device;
+class PhysicalDevice;
+class PipelineLayout;
+
+/**
+ * Material textures in one descriptor array, indexed by the material data instead of bound per material.
+ * Shaders include base/bindless.h, which declares the unsized array in the bindless set; materials register their
+ * textures and write the indices in their data with the HAS_BINDLESS_TEXTURES macro.
+ * Needs VK_EXT_descriptor_indexing: request the features and the extension before the device is created.
+ */
+class BindlessTextureTable : public Singleton<BindlessTextureTable> {
+public:
+    static BindlessTextureTable &GetSingleton();
+
+    static BindlessTextureTable *GetSingletonPtr();
+
+    /**
+     * Request the descriptor indexing features, from GraphicsApplication::RequestGpuFeatures.
+     * @return whether the table can be used, the extension has to be added then
+     */
+    static bool RequestFeatures(PhysicalDevice &gpu);
+
+    /**
+     * Whether the device was created with the extension.
+     */
+    static bool IsSupported(Device &device);
+
+    /**
+     * @param frames_in_flight Frames a released index is kept for, the frames still recording may sample it
+     */
+    BindlessTextureTable(Device &device, uint32_t frames_in_flight);
+
+    ~BindlessTextureTable();
+
+    /**
+     * Index of the texture in the array. The same view and sampler get the same index, each call is released with
+     * Unregister.
+     */
+    uint32_t Register(const core::ImageView &image_view, const core::Sampler &sampler);
+
+    void Unregister(uint32_t index);
+
+    /**
+     * Recycle the indices released frames_in_flight frames ago, once per frame.
+     */
+    void NextFrame();
+
+    /**
+     * Bind the array if the pipeline layout declares the bindless set.
+     */
+    void Bind(CommandBuffer &command_buffer,
+              const PipelineLayout &pipeline_layout,
+              VkPipelineBindPoint pipeline_bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+private:
+    static constexpr uint32_t max_layouts_ = 16;
+
+    struct Slot {
+        const core::ImageView *image_view{nullptr};
+        const core::Sampler *sampler{nullptr};
+        uint32_t ref_count{0};
+    };
+
+    // one descriptor set per layout declaring the array, e.g. with other stage flags
+    struct LayoutSet {
+        VkDescriptorSetLayout layout{VK_NULL_HANDLE};
+        uint32_t binding{0};
+        VkDescriptorSet set{VK_NULL_HANDLE};
+    };
+
+    const LayoutSet *RequestSet(const DescriptorSetLayout &descriptor_set_layout);
+
+    void Write(const LayoutSet &layout_set, uint32_t index) const;
+
+    Device &device_;
+    const uint32_t frames_in_flight_;
+    uint64_t frame_{0};
+
+    VkDescriptorPool descriptor_pool_{VK_NULL_HANDLE};
+    std::vector<LayoutSet> layout_sets_{};
+
+    std::vector<Slot> slots_{};
+    std::map<std::pair<const core::ImageView *, const core::Sampler *>, uint32_t> indices_{};
+    std::vector<uint32_t> free_indices_{};
+    // released indices with the frame they can be reused
+    std::deque<std::pair<uint32_t, uint64_t>> retired_indices_{};
+};
+
+template <>
+inline BindlessTextureTable *Singleton<BindlessTextureTable>::ms_singleton{nullptr};
+
+}  // namespace vox
@@ -101,19 +101,19 @@ public:
 
 private:
     BlinnPhongData blinn_phong_data_;
-    const std::string blinn_phong_prop_;
+    const ShaderProperty blinn_phong_prop_;
 
     std::shared_ptr<Texture> base_texture_{nullptr};
-    const std::string base_texture_prop_;
+    const ShaderProperty base_texture_prop_;
 
     std::shared_ptr<Texture> specular_texture_{nullptr};
-    const std::string specular_texture_prop_;
+    const ShaderProperty specular_texture_prop_;
 
     std::shared_ptr<Texture> emissive_texture_{nullptr};
-    const std::string emissive_texture_prop_;
+    const ShaderProperty emissive_texture_prop_;
 
     std::shared_ptr<Texture> normal_texture_{nullptr};
-    const std::string normal_texture_prop_;
+    const ShaderProperty normal_texture_prop_;
 };
 
 }  // namespace vox
@@ -96,19 +96,19 @@ protected:
 
 private:
     PBRBaseData pbr_base_data_;
-    const std::string pbr_base_prop_;
+    const ShaderProperty pbr_base_prop_;
 
     std::shared_ptr<Texture> base_texture_{nullptr};
-    const std::string base_texture_prop_;
+    const ShaderProperty base_texture_prop_;
 
     std::shared_ptr<Texture> normal_texture_{nullptr};
-    const std::string normal_texture_prop_;
+    const ShaderProperty normal_texture_prop_;
 
     std::shared_ptr<Texture> emissive_texture_{nullptr};
-    const std::string emissive_texture_prop_;
+    const ShaderProperty emissive_texture_prop_;
 
     std::shared_ptr<Texture> occlusion_texture_{nullptr};
-    const std::string occlusion_texture_prop_;
+    const ShaderProperty occlusion_texture_prop_;
 };
 
 }  // namespace vox
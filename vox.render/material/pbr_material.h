@@ -50,10 +50,10 @@ public:
 
 private:
     PBRData pbr_data_;
-    const std::string pbr_prop_;
+    const ShaderProperty pbr_prop_;
 
     std::shared_ptr<Texture> metallic_roughness_texture_{nullptr};
-    const std::string metallic_roughness_texture_prop_;
+    const ShaderProperty metallic_roughness_texture_prop_;
 };
 
 }  // namespace vox
@@ -51,10 +51,10 @@ public:
 
 private:
     PBRSpecularData pbr_specular_data_;
-    const std::string pbr_specular_prop_;
+    const ShaderProperty pbr_specular_prop_;
 
     std::shared_ptr<Texture> specular_glossiness_texture_{nullptr};
-    const std::string specular_glossiness_texture_prop_;
+    const ShaderProperty specular_glossiness_texture_prop_;
 };
 
 }  // namespace vox
@@ -6,6 +6,7 @@
 
 #include "vox.render/material/unlit_material.h"
 
+#include "vox.render/material/bindless_texture_table.h"
 #include "vox.render/shader/internal_variant_name.h"
 #include "vox.render/shader/shader_manager.h"
 
@@ -28,17 +29,38 @@ void UnlitMaterial::SetBaseTexture(const std::shared_ptr<Texture> &new_value) {
 
 void UnlitMaterial::SetBaseTexture(const std::shared_ptr<Texture> &new_value, const VkSamplerCreateInfo &info) {
     base_texture_ = new_value;
+    ReleaseTextureIndex();
     if (new_value) {
-        shader_data_.SetSampledTexture(base_texture_prop_, new_value->GetVkImageView(),
-                                       &device_.GetResourceCache().RequestSampler(info));
+        auto &sampler = device_.GetResourceCache().RequestSampler(info);
+        if (auto bindless_texture_table = BindlessTextureTable::GetSingletonPtr()) {
+            texture_indices_[0] = bindless_texture_table->Register(new_value->GetVkImageView(), sampler);
+            has_texture_index_ = true;
+            shader_data_.SetData(texture_indices_prop_, texture_indices_);
+            shader_data_.AddDefine(HAS_BINDLESS_TEXTURES);
+        } else {
+            shader_data_.SetSampledTexture(base_texture_prop_, new_value->GetVkImageView(), &sampler);
+        }
         shader_data_.AddDefine(HAS_BASE_TEXTURE);
     } else {
         shader_data_.RemoveDefine(HAS_BASE_TEXTURE);
+        shader_data_.RemoveDefine(HAS_BINDLESS_TEXTURES);
+    }
+}
+
+void UnlitMaterial::ReleaseTextureIndex() {
+    if (has_texture_index_) {
+        if (auto bindless_texture_table = BindlessTextureTable::GetSingletonPtr()) {
+            bindless_texture_table->Unregister(texture_indices_[0]);
+        }
+        has_texture_index_ = false;
     }
 }
 
 UnlitMaterial::UnlitMaterial(Device &device, const std::string &name)
-    : BaseMaterial(device, name), base_color_prop_("baseColor"), base_texture_prop_("baseTexture") {
+    : BaseMaterial(device, name),
+      base_color_prop_("baseColor"),
+      base_texture_prop_("baseTexture"),
+      texture_indices_prop_("materialTextureIndices") {
     vertex_source_ = ShaderManager::GetSingleton().LoadShader("base/unlit.vert");
     fragment_source_ = ShaderManager::GetSingleton().LoadShader("base/unlit.frag");
 
@@ -47,4 +69,6 @@ UnlitMaterial::UnlitMaterial(Device &device, const std::string &name)
     shader_data_.SetData(base_color_prop_, base_color_);
 }
 
+UnlitMaterial::~UnlitMaterial() { ReleaseTextureIndex(); }
+
 }  // namespace vox
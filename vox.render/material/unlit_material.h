@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <array>
+
 #include "vox.math/color.h"
 #include "vox.render/material/base_material.h"
 #include "vox.render/texture.h"
@@ -37,12 +39,21 @@ public:
      */
     UnlitMaterial(Device &device, const std::string &name = "");
 
+    ~UnlitMaterial() override;
+
 private:
+    void ReleaseTextureIndex();
+
     Color base_color_ = Color(1, 1, 1, 1);
-    const std::string base_color_prop_;
+    const ShaderProperty base_color_prop_;
 
     std::shared_ptr<Texture> base_texture_{nullptr};
-    const std::string base_texture_prop_;
+    const ShaderProperty base_texture_prop_;
+
+    // indices in the bindless texture table, x is the base texture
+    std::array<uint32_t, 4> texture_indices_{};
+    bool has_texture_index_{false};
+    const ShaderProperty texture_indices_prop_;
 };
 
 }  // namespace vox
@@ -7,43 +7,82 @@
 #include "vox.render/mesh/gpu_skinned_mesh_renderer.h"
 
 #include "vox.render/entity.h"
+#include "vox.render/mesh/skinning_manager.h"
 #include "vox.render/scene.h"
-#include "vox.render/shader/internal_variant_name.h"
 
 namespace vox {
 std::string GpuSkinnedMeshRenderer::name() { return "GPUSkinnedMeshRenderer"; }
 
 GpuSkinnedMeshRenderer::GpuSkinnedMeshRenderer(Entity *entity)
-    : MeshRenderer(entity), joint_matrix_property_("jointMatrix") {}
+    : MeshRenderer(entity),
+      skin_instance_property_("skinInstance"),
+      skin_vertices_property_("skinVertices"),
+      skinned_vertices_property_("skinnedVertices") {
+    shader_data_.SetBufferFunctor(skin_vertices_property_, [this]() -> core::Buffer * {
+        return skinned_mesh_ ? skinned_mesh_->Source()->SkinBuffer() : nullptr;
+    });
+    shader_data_.SetBufferFunctor(skinned_vertices_property_, [this]() -> core::Buffer * {
+        return skinned_mesh_ ? &skinned_mesh_->SkinnedBuffer() : nullptr;
+    });
+}
 
 GpuSkinnedMeshRenderer::SkinPtr GpuSkinnedMeshRenderer::Skin() { return skin_; }
 
 void GpuSkinnedMeshRenderer::SetSkin(const SkinPtr &skin) { skin_ = skin; }
 
-void GpuSkinnedMeshRenderer::Update(float delta_time) {
-    if (skin_) {
-        if (!has_init_joints_) {
-            InitJoints();
-            has_init_joints_ = true;
-        }
-
-        // Update join matrices
-        auto m = GetEntity()->transform->WorldMatrix();
-        auto inverse_transform = m.inverse();
-        for (size_t i = 0; i < skin_->joints.size(); i++) {
-            auto joint_node = skin_->joints[i];
-            auto joint_mat = joint_node->transform->WorldMatrix() * skin_->inverse_bind_matrices[i];
-            joint_mat = inverse_transform * joint_mat;
-            std::copy(joint_mat.data(), joint_mat.data() + 16, joint_matrix_.data() + i * 16);
-        }
-        shader_data_.SetData(joint_matrix_property_, joint_matrix_);
-        shader_data_.AddDefine(JOINTS_COUNT + std::to_string(skin_->joints.size()));
+size_t GpuSkinnedMeshRenderer::JointCount() const { return skin_ ? skin_->joints.size() : 0; }
+
+SkinnedMesh *GpuSkinnedMeshRenderer::PrepareSkinnedMesh() {
+    auto model_mesh = std::dynamic_pointer_cast<ModelMesh>(Mesh());
+    if (!skin_ || !model_mesh || !model_mesh->SkinBuffer()) {
+        skinned_mesh_.reset();
+        return nullptr;
     }
+
+    if (!skinned_mesh_ || skinned_mesh_->Source() != model_mesh) {
+        skinned_mesh_ = std::make_shared<SkinnedMesh>(entity_->Scene()->Device(), model_mesh);
+    }
+    skin_instance_.vertex_count = static_cast<uint32_t>(skinned_mesh_->VertexCount());
+    return skinned_mesh_.get();
+}
+
+void GpuSkinnedMeshRenderer::UpdateJointTransforms() {
+    entity_->transform->WorldMatrix();
+    for (auto joint : skin_->joints) {
+        joint->transform->WorldMatrix();
+    }
+}
+
+void GpuSkinnedMeshRenderer::WritePalette(float *palette) const {
+    const auto kInverseTransform = entity_->transform->WorldMatrix().inverse();
+    for (size_t i = 0; i < skin_->joints.size(); i++) {
+        const auto kJointMat =
+                kInverseTransform * skin_->joints[i]->transform->WorldMatrix() * skin_->inverse_bind_matrices[i];
+        std::copy(kJointMat.data(), kJointMat.data() + 16, palette + i * 16);
+    }
+}
+
+void GpuSkinnedMeshRenderer::SetJointOffset(uint32_t offset) {
+    skin_instance_.joint_offset = offset;
+    shader_data_.SetData(skin_instance_property_, skin_instance_);
+}
+
+MeshPtr GpuSkinnedMeshRenderer::DrawnMesh() {
+    // the skinned mesh is only drawn once the skinning pass owns it
+    if (skinned_mesh_ && skinned_mesh_->Source() == Mesh()) {
+        return skinned_mesh_;
+    }
+    return Mesh();
+}
+
+void GpuSkinnedMeshRenderer::OnEnable() {
+    MeshRenderer::OnEnable();
+    SkinningManager::GetSingleton().AddRenderer(this);
 }
 
-void GpuSkinnedMeshRenderer::InitJoints() {
-    joint_matrix_.resize(skin_->joints.size() * 16);
-    shader_data_.AddDefine(HAS_SKIN);
+void GpuSkinnedMeshRenderer::OnDisable() {
+    MeshRenderer::OnDisable();
+    SkinningManager::GetSingleton().RemoveRenderer(this);
 }
 
 // MARK: - Reflection
@@ -7,9 +7,15 @@
 #pragma once
 
 #include "vox.render/mesh/mesh_renderer.h"
+#include "vox.render/mesh/skinned_mesh.h"
 
 namespace vox {
 
+/**
+ * Renderer of a mesh skinned by the SkinningManager compute pass.
+ * Joint matrices live in the shared palette buffer of the manager, the renderer only stores its offset in it,
+ * so shader variants do not depend on the joint count.
+ */
 class GpuSkinnedMeshRenderer : public MeshRenderer {
 public:
     /**
@@ -24,6 +30,12 @@ public:
     };
     using SkinPtr = std::shared_ptr<Skin>;
 
+    struct SkinInstance {
+        uint32_t joint_offset;
+        uint32_t vertex_count;
+        uint32_t padding[2];
+    };
+
 public:
     explicit GpuSkinnedMeshRenderer(Entity *entity);
 
@@ -34,7 +46,36 @@ public:
 
     void SetSkin(const SkinPtr &skin);
 
-    void Update(float delta_time) override;
+    [[nodiscard]] size_t JointCount() const;
+
+    /**
+     * Skinned output of the assigned mesh, created on first use.
+     * @return nullptr if the renderer has no skin or the mesh has no uploaded bone data.
+     */
+    SkinnedMesh *PrepareSkinnedMesh();
+
+    /**
+     * Resolve the world matrices of the entity and joints, must be called before WritePalette.
+     */
+    void UpdateJointTransforms();
+
+    /**
+     * Write the joint matrices, relative to the entity, to the palette.
+     * @remarks Only reads resolved transforms, renderers can write their palettes concurrently.
+     */
+    void WritePalette(float *palette) const;
+
+    /**
+     * Position of the first joint of the renderer in the palette buffer.
+     */
+    void SetJointOffset(uint32_t offset);
+
+protected:
+    MeshPtr DrawnMesh() override;
+
+    void OnEnable() override;
+
+    void OnDisable() override;
 
 public:
     /**
@@ -54,13 +95,12 @@ public:
 
 private:
     SkinPtr skin_;
+    std::shared_ptr<SkinnedMesh> skinned_mesh_{nullptr};
 
-    void InitJoints();
-
-    bool has_init_joints_ = false;
-
-    std::vector<float> joint_matrix_{};
-    const std::string joint_matrix_property_;
+    SkinInstance skin_instance_{};
+    const ShaderProperty skin_instance_property_;
+    const ShaderProperty skin_vertices_property_;
+    const ShaderProperty skinned_vertices_property_;
 };
 
 }  // namespace vox
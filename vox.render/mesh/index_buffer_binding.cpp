@@ -12,6 +12,8 @@ IndexBufferBinding::IndexBufferBinding(core::Buffer&& buffer, VkIndexType index_
 
 const core::Buffer& IndexBufferBinding::Buffer() const { return buffer_; }
 
+core::Buffer& IndexBufferBinding::Buffer() { return buffer_; }
+
 VkIndexType IndexBufferBinding::IndexType() const { return index_type_; }
 
 }  // namespace vox
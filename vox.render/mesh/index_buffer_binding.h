@@ -26,6 +26,11 @@ public:
      */
     [[nodiscard]] const core::Buffer& Buffer() const;
 
+    /**
+     * Index buffer, for indices written on the GPU.
+     */
+    core::Buffer& Buffer();
+
     /**
      * Index buffer format.
      */
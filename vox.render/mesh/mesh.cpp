@@ -6,11 +6,22 @@
 
 #include "vox.render/mesh/mesh.h"
 
+#include <cassert>
+
 namespace vox {
 uint32_t Mesh::InstanceCount() const { return instance_count_; }
 
 void Mesh::SetInstanceCount(uint32_t value) { instance_count_ = value; }
 
+const core::Buffer *Mesh::IndirectBuffer() const { return indirect_buffer_; }
+
+VkDeviceSize Mesh::IndirectOffset() const { return indirect_offset_; }
+
+void Mesh::SetIndirectBuffer(const core::Buffer *buffer, VkDeviceSize offset) {
+    indirect_buffer_ = buffer;
+    indirect_offset_ = offset;
+}
+
 const SubMesh *Mesh::FirstSubMesh() const {
     if (!sub_meshes_.empty()) {
         return &sub_meshes_[0];
@@ -26,6 +37,36 @@ void Mesh::AddSubMesh(uint32_t start, uint32_t count) { sub_meshes_.emplace_back
 
 void Mesh::ClearSubMesh() { sub_meshes_.clear(); }
 
+size_t Mesh::LodCount() const { return lods_.size() + 1; }
+
+const std::vector<SubMesh> &Mesh::LodSubMeshes(size_t lod) const {
+    if (lod == 0) {
+        return sub_meshes_;
+    }
+    return lods_[lod - 1].sub_meshes;
+}
+
+void Mesh::AddLod(const std::vector<SubMesh> &sub_meshes, float screen_size) {
+    lods_.push_back({sub_meshes, screen_size});
+}
+
+float Mesh::LodScreenSize(size_t lod) const {
+    if (lod == 0) {
+        return 1.f;
+    }
+    return lods_[lod - 1].screen_size;
+}
+
+void Mesh::SetLodScreenSize(size_t lod, float value) {
+    if (lod == 0) {
+        assert(false && "Level 0 is always used above the first threshold.");
+        return;
+    }
+    lods_[lod - 1].screen_size = value;
+}
+
+void Mesh::ClearLod() { lods_.clear(); }
+
 std::unique_ptr<UpdateFlag> Mesh::RegisterUpdateFlag() { return update_flag_manager_.Registration(); }
 
 void Mesh::SetVertexInputState(const std::vector<VkVertexInputBindingDescription> &vertex_input_bindings,
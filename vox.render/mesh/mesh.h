@@ -30,6 +30,16 @@ public:
 
     void SetInstanceCount(uint32_t value);
 
+    /**
+     * Buffer holding the draw parameters, written on the GPU. When set, sub-meshes are drawn with
+     * vkCmdDrawIndirect or vkCmdDrawIndexedIndirect and their count and the instance count are ignored.
+     */
+    [[nodiscard]] const core::Buffer *IndirectBuffer() const;
+
+    [[nodiscard]] VkDeviceSize IndirectOffset() const;
+
+    void SetIndirectBuffer(const core::Buffer *buffer, VkDeviceSize offset = 0);
+
     /**
      * First sub-mesh. Rendered using the first material.
      */
@@ -63,6 +73,37 @@ public:
      */
     void ClearSubMesh();
 
+    /**
+     * Level of detail count, including the full detail level 0.
+     */
+    [[nodiscard]] size_t LodCount() const;
+
+    /**
+     * Sub-meshes of a level of detail, level 0 is SubMeshes().
+     * @param lod - Level of detail, in [0, LodCount()) range
+     */
+    [[nodiscard]] const std::vector<SubMesh> &LodSubMeshes(size_t lod) const;
+
+    /**
+     * Add a coarser level of detail sharing the vertex and index buffer of the mesh.
+     * @param sub_meshes - Sub-meshes of the level, one for each sub-mesh of level 0
+     * @param screen_size - Projected height of the bounds, as a fraction of the viewport height,
+     * under which the level is selected
+     */
+    void AddLod(const std::vector<SubMesh> &sub_meshes, float screen_size);
+
+    /**
+     * Screen size threshold of a level of detail, level 0 always returns 1.
+     */
+    [[nodiscard]] float LodScreenSize(size_t lod) const;
+
+    void SetLodScreenSize(size_t lod, float value);
+
+    /**
+     * Clear all coarser levels of detail.
+     */
+    void ClearLod();
+
     /**
      * Register update flag, update flag will be true if the vertex element changes.
      * @returns Update flag
@@ -83,7 +124,7 @@ public:
     /**
      * Index buffer binding.
      */
-    [[nodiscard]] const IndexBufferBinding *IndexBufferBinding() const;
+    [[nodiscard]] virtual const IndexBufferBinding *IndexBufferBinding() const;
 
     void SetIndexBufferBinding(std::unique_ptr<vox::IndexBufferBinding> &&binding);
 
@@ -93,10 +134,18 @@ public:
 
 protected:
     uint32_t instance_count_ = 1;
+    const core::Buffer *indirect_buffer_{nullptr};
+    VkDeviceSize indirect_offset_{0};
     std::unique_ptr<vox::IndexBufferBinding> index_buffer_binding_{nullptr};
     vox::VertexInputState vertex_input_state_;
 
     std::vector<SubMesh> sub_meshes_{};
+
+    struct Lod {
+        std::vector<SubMesh> sub_meshes;
+        float screen_size;
+    };
+    std::vector<Lod> lods_{};
     UpdateFlagManager update_flag_manager_;
 };
 
@@ -0,0 +1,624 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.render/mesh/mesh_optimizer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <tuple>
+
+namespace vox {
+namespace {
+// cache size used by the Forsyth scoring function
+constexpr int32_t kCacheSize = 32;
+// FIFO cache size used to detect cluster boundaries, close to real hardware
+constexpr uint32_t kClusterCacheSize = 16;
+
+float VertexScore(int32_t cache_position, uint32_t remaining) {
+    if (remaining == 0) {
+        return -1.f;
+    }
+
+    float score = 0.f;
+    if (cache_position >= 0) {
+        if (cache_position < 3) {
+            // the last triangle's vertices get a fixed score, so no triangle is preferred for reusing them
+            score = 0.75f;
+        } else {
+            const float kScaler = 1.f / static_cast<float>(kCacheSize - 3);
+            score = std::pow(1.f - static_cast<float>(cache_position - 3) * kScaler, 1.5f);
+        }
+    }
+    // boost vertices with few remaining triangles, so lone triangles are not left behind
+    score += 2.f * std::pow(static_cast<float>(remaining), -0.5f);
+    return score;
+}
+
+/**
+ * FIFO cache simulation based on timestamps, which avoids clearing the cache on reset.
+ */
+struct FifoCache {
+    std::vector<uint32_t> timestamps;
+    uint32_t timestamp;
+
+    explicit FifoCache(size_t vertex_count) : timestamps(vertex_count, 0), timestamp(kClusterCacheSize + 1) {}
+
+    uint32_t Touch(uint32_t vertex) {
+        if (timestamp - timestamps[vertex] > kClusterCacheSize) {
+            timestamps[vertex] = timestamp++;
+            return 1;
+        }
+        return 0;
+    }
+
+    void Reset() { timestamp += kClusterCacheSize + 1; }
+};
+
+/**
+ * Symmetric 4x4 quadric [A b; b^T c] accumulated from weighted planes.
+ */
+struct Quadric {
+    float a00 = 0, a11 = 0, a22 = 0, a10 = 0, a20 = 0, a21 = 0;
+    float b0 = 0, b1 = 0, b2 = 0;
+    float c = 0;
+
+    void AddPlane(const Vector3F &normal, float distance, float weight) {
+        a00 += weight * normal.x * normal.x;
+        a11 += weight * normal.y * normal.y;
+        a22 += weight * normal.z * normal.z;
+        a10 += weight * normal.y * normal.x;
+        a20 += weight * normal.z * normal.x;
+        a21 += weight * normal.z * normal.y;
+        b0 += weight * normal.x * distance;
+        b1 += weight * normal.y * distance;
+        b2 += weight * normal.z * distance;
+        c += weight * distance * distance;
+    }
+
+    void Add(const Quadric &other) {
+        a00 += other.a00;
+        a11 += other.a11;
+        a22 += other.a22;
+        a10 += other.a10;
+        a20 += other.a20;
+        a21 += other.a21;
+        b0 += other.b0;
+        b1 += other.b1;
+        b2 += other.b2;
+        c += other.c;
+    }
+
+    [[nodiscard]] float Error(const Vector3F &p) const {
+        const float kRx = a00 * p.x + a10 * p.y + a20 * p.z + b0;
+        const float kRy = a10 * p.x + a11 * p.y + a21 * p.z + b1;
+        const float kRz = a20 * p.x + a21 * p.y + a22 * p.z + b2;
+        const float kError = kRx * p.x + kRy * p.y + kRz * p.z + b0 * p.x + b1 * p.y + b2 * p.z + c;
+        return std::fabs(kError);
+    }
+};
+
+}  // namespace
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t *indices, size_t index_count, size_t vertex_count) {
+    assert(index_count % 3 == 0);
+    const size_t kFaceCount = index_count / 3;
+    if (kFaceCount == 0) {
+        return;
+    }
+
+    // vertex -> triangle adjacency, the first `remaining[v]` entries of each range are the live triangles
+    std::vector<uint32_t> adjacency_offsets(vertex_count + 1, 0);
+    for (size_t i = 0; i < index_count; i++) {
+        assert(indices[i] < vertex_count);
+        adjacency_offsets[indices[i] + 1]++;
+    }
+    std::partial_sum(adjacency_offsets.begin(), adjacency_offsets.end(), adjacency_offsets.begin());
+
+    std::vector<uint32_t> adjacency(index_count);
+    std::vector<uint32_t> remaining(vertex_count, 0);
+    for (size_t f = 0; f < kFaceCount; f++) {
+        for (size_t k = 0; k < 3; k++) {
+            const auto kVertex = indices[f * 3 + k];
+            adjacency[adjacency_offsets[kVertex] + remaining[kVertex]++] = static_cast<uint32_t>(f);
+        }
+    }
+
+    std::vector<int32_t> cache_position(vertex_count, -1);
+    std::vector<float> vertex_score(vertex_count);
+    for (size_t v = 0; v < vertex_count; v++) {
+        vertex_score[v] = VertexScore(-1, remaining[v]);
+    }
+
+    std::vector<float> triangle_score(kFaceCount);
+    uint32_t best_triangle = 0;
+    for (size_t f = 0; f < kFaceCount; f++) {
+        triangle_score[f] = vertex_score[indices[f * 3]] + vertex_score[indices[f * 3 + 1]] +
+                            vertex_score[indices[f * 3 + 2]];
+        if (triangle_score[f] > triangle_score[best_triangle]) {
+            best_triangle = static_cast<uint32_t>(f);
+        }
+    }
+
+    std::vector<bool> emitted(kFaceCount, false);
+    std::vector<uint32_t> result;
+    result.reserve(index_count);
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> new_cache;
+    cache.reserve(kCacheSize + 3);
+    new_cache.reserve(kCacheSize + 3);
+    size_t scan_cursor = 0;
+
+    while (true) {
+        emitted[best_triangle] = true;
+        const uint32_t kTriangle[3] = {indices[best_triangle * 3], indices[best_triangle * 3 + 1],
+                                       indices[best_triangle * 3 + 2]};
+        result.insert(result.end(), kTriangle, kTriangle + 3);
+        if (result.size() == index_count) {
+            break;
+        }
+
+        // remove the emitted triangle from the live adjacency of its vertices
+        for (auto vertex : kTriangle) {
+            auto begin = adjacency.begin() + adjacency_offsets[vertex];
+            auto end = begin + remaining[vertex];
+            auto iter = std::find(begin, end, best_triangle);
+            assert(iter != end);
+            std::iter_swap(iter, end - 1);
+            remaining[vertex]--;
+        }
+
+        // emitted vertices move to the front of the LRU cache
+        new_cache.clear();
+        for (auto vertex : kTriangle) {
+            if (std::find(new_cache.begin(), new_cache.end(), vertex) == new_cache.end()) {
+                new_cache.push_back(vertex);
+            }
+        }
+        for (auto vertex : cache) {
+            if (vertex != kTriangle[0] && vertex != kTriangle[1] && vertex != kTriangle[2]) {
+                new_cache.push_back(vertex);
+            }
+        }
+
+        // refresh scores of cached and evicted vertices and propagate the delta to their live triangles
+        for (size_t i = 0; i < new_cache.size(); i++) {
+            const auto kVertex = new_cache[i];
+            cache_position[kVertex] = i < kCacheSize ? static_cast<int32_t>(i) : -1;
+
+            const float kScore = VertexScore(cache_position[kVertex], remaining[kVertex]);
+            const float kDelta = kScore - vertex_score[kVertex];
+            vertex_score[kVertex] = kScore;
+
+            const auto kBegin = adjacency_offsets[kVertex];
+            for (uint32_t j = kBegin; j < kBegin + remaining[kVertex]; j++) {
+                triangle_score[adjacency[j]] += kDelta;
+            }
+        }
+        new_cache.resize(std::min<size_t>(new_cache.size(), kCacheSize));
+        cache.swap(new_cache);
+
+        // the next triangle is picked among triangles touching the cache
+        float best_score = -1.f;
+        best_triangle = ~0u;
+        for (auto vertex : cache) {
+            const auto kBegin = adjacency_offsets[vertex];
+            for (uint32_t j = kBegin; j < kBegin + remaining[vertex]; j++) {
+                const auto kFace = adjacency[j];
+                if (triangle_score[kFace] > best_score) {
+                    best_score = triangle_score[kFace];
+                    best_triangle = kFace;
+                }
+            }
+        }
+
+        // dead end: restart from the first triangle not yet emitted
+        if (best_triangle == ~0u) {
+            while (emitted[scan_cursor]) {
+                scan_cursor++;
+            }
+            best_triangle = static_cast<uint32_t>(scan_cursor);
+        }
+    }
+
+    std::copy(result.begin(), result.end(), indices);
+}
+
+void MeshOptimizer::OptimizeOverdraw(
+        uint32_t *indices, size_t index_count, const Vector3F *positions, size_t vertex_count, float threshold) {
+    assert(index_count % 3 == 0);
+    const size_t kFaceCount = index_count / 3;
+    if (kFaceCount == 0) {
+        return;
+    }
+
+    // hard boundaries: triangles which miss the cache on all three vertices start a new cluster for free
+    std::vector<uint32_t> hard_clusters;
+    {
+        FifoCache cache(vertex_count);
+        for (size_t f = 0; f < kFaceCount; f++) {
+            uint32_t misses = cache.Touch(indices[f * 3]) + cache.Touch(indices[f * 3 + 1]) +
+                              cache.Touch(indices[f * 3 + 2]);
+            if (misses == 3 || f == 0) {
+                hard_clusters.push_back(static_cast<uint32_t>(f));
+            }
+        }
+    }
+    hard_clusters.push_back(static_cast<uint32_t>(kFaceCount));
+
+    // soft boundaries: split hard clusters where the sub-cluster's cache efficiency stays within the threshold
+    std::vector<uint32_t> clusters;
+    {
+        FifoCache cache(vertex_count);
+        for (size_t c = 0; c + 1 < hard_clusters.size(); c++) {
+            const auto kStart = hard_clusters[c];
+            const auto kEnd = hard_clusters[c + 1];
+
+            cache.Reset();
+            uint32_t cluster_misses = 0;
+            for (uint32_t f = kStart; f < kEnd; f++) {
+                cluster_misses += cache.Touch(indices[f * 3]) + cache.Touch(indices[f * 3 + 1]) +
+                                  cache.Touch(indices[f * 3 + 2]);
+            }
+            const float kClusterThreshold =
+                    threshold * static_cast<float>(cluster_misses) / static_cast<float>(kEnd - kStart);
+
+            clusters.push_back(kStart);
+            cache.Reset();
+            uint32_t running_misses = 0;
+            uint32_t running_start = kStart;
+            for (uint32_t f = kStart; f < kEnd; f++) {
+                running_misses += cache.Touch(indices[f * 3]) + cache.Touch(indices[f * 3 + 1]) +
+                                  cache.Touch(indices[f * 3 + 2]);
+                const float kRunningAcmr =
+                        static_cast<float>(running_misses) / static_cast<float>(f + 1 - running_start);
+                if (f + 1 < kEnd && kRunningAcmr <= kClusterThreshold) {
+                    clusters.push_back(f + 1);
+                    cache.Reset();
+                    running_misses = 0;
+                    running_start = f + 1;
+                }
+            }
+        }
+    }
+    clusters.push_back(static_cast<uint32_t>(kFaceCount));
+    const size_t kClusterCount = clusters.size() - 1;
+
+    // mesh centroid, weighted by triangle corners
+    Vector3F mesh_centroid;
+    for (size_t i = 0; i < index_count; i++) {
+        mesh_centroid += positions[indices[i]];
+    }
+    mesh_centroid /= static_cast<float>(index_count);
+
+    // clusters facing away from the centroid are more likely to occlude others, so they are drawn first
+    std::vector<float> sort_keys(kClusterCount);
+    for (size_t c = 0; c < kClusterCount; c++) {
+        Vector3F centroid;
+        Vector3F normal;
+        float area = 0.f;
+        for (uint32_t f = clusters[c]; f < clusters[c + 1]; f++) {
+            const auto &kP0 = positions[indices[f * 3]];
+            const auto &kP1 = positions[indices[f * 3 + 1]];
+            const auto &kP2 = positions[indices[f * 3 + 2]];
+            const auto kCross = (kP1 - kP0).cross(kP2 - kP0);
+            const float kArea = kCross.length();
+
+            centroid += (kP0 + kP1 + kP2) * (kArea / 3.f);
+            normal += kCross;
+            area += kArea;
+        }
+
+        if (area > 0.f && normal.lengthSquared() > 0.f) {
+            centroid /= area;
+            sort_keys[c] = (centroid - mesh_centroid).dot(normal.normalized());
+        } else {
+            sort_keys[c] = 0.f;
+        }
+    }
+
+    std::vector<uint32_t> cluster_order(kClusterCount);
+    std::iota(cluster_order.begin(), cluster_order.end(), 0);
+    std::stable_sort(cluster_order.begin(), cluster_order.end(),
+                     [&](uint32_t a, uint32_t b) { return sort_keys[a] > sort_keys[b]; });
+
+    std::vector<uint32_t> result;
+    result.reserve(index_count);
+    for (auto cluster : cluster_order) {
+        result.insert(result.end(), indices + clusters[cluster] * 3, indices + clusters[cluster + 1] * 3);
+    }
+    std::copy(result.begin(), result.end(), indices);
+}
+
+size_t MeshOptimizer::OptimizeVertexFetchRemap(uint32_t *indices,
+                                               size_t index_count,
+                                               size_t vertex_count,
+                                               std::vector<uint32_t> &remap) {
+    remap.assign(vertex_count, ~0u);
+
+    uint32_t next_vertex = 0;
+    for (size_t i = 0; i < index_count; i++) {
+        auto &index = indices[i];
+        assert(index < vertex_count);
+        if (remap[index] == ~0u) {
+            remap[index] = next_vertex++;
+        }
+        index = remap[index];
+    }
+    return next_vertex;
+}
+
+std::vector<uint32_t> MeshOptimizer::Simplify(const uint32_t *indices,
+                                              size_t index_count,
+                                              const Vector3F *positions,
+                                              size_t vertex_count,
+                                              size_t target_index_count,
+                                              float target_error,
+                                              float *result_error) {
+    assert(index_count % 3 == 0);
+    std::vector<uint32_t> result(indices, indices + index_count);
+    if (result_error) {
+        *result_error = 0.f;
+    }
+    if (index_count <= target_index_count || vertex_count == 0) {
+        return result;
+    }
+
+    // vertices sharing a position are attribute seams (wedges), they map to a canonical vertex
+    std::vector<uint32_t> canonical(vertex_count);
+    std::vector<uint32_t> wedge_count(vertex_count, 0);
+    {
+        std::vector<uint32_t> order(vertex_count);
+        std::iota(order.begin(), order.end(), 0);
+        auto less = [&](uint32_t a, uint32_t b) {
+            const auto &kA = positions[a];
+            const auto &kB = positions[b];
+            return std::tie(kA.x, kA.y, kA.z) < std::tie(kB.x, kB.y, kB.z);
+        };
+        std::sort(order.begin(), order.end(), less);
+        for (size_t i = 0; i < vertex_count;) {
+            size_t j = i;
+            while (j < vertex_count && !less(order[i], order[j]) && !less(order[j], order[i])) {
+                canonical[order[j]] = order[i];
+                j++;
+            }
+            wedge_count[order[i]] = static_cast<uint32_t>(j - i);
+            i = j;
+        }
+    }
+
+    // seam vertices and vertices on open or non-manifold edges are never collapsed
+    std::vector<uint8_t> vertex_locked(vertex_count, 0);
+    for (size_t v = 0; v < vertex_count; v++) {
+        vertex_locked[v] = wedge_count[canonical[v]] > 1 ? 1 : 0;
+    }
+    {
+        std::vector<uint64_t> edges;
+        edges.reserve(index_count);
+        for (size_t i = 0; i < index_count; i += 3) {
+            for (size_t k = 0; k < 3; k++) {
+                const uint64_t kA = canonical[indices[i + k]];
+                const uint64_t kB = canonical[indices[i + (k + 1) % 3]];
+                edges.push_back((kA << 32) | kB);
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        for (size_t i = 0; i < edges.size(); i++) {
+            const auto kA = static_cast<uint32_t>(edges[i] >> 32);
+            const auto kB = static_cast<uint32_t>(edges[i] & 0xffffffff);
+            const uint64_t kReverse = (static_cast<uint64_t>(kB) << 32) | kA;
+            const bool kDuplicated = (i > 0 && edges[i - 1] == edges[i]) ||
+                                     (i + 1 < edges.size() && edges[i + 1] == edges[i]);
+            if (kDuplicated || !std::binary_search(edges.begin(), edges.end(), kReverse)) {
+                vertex_locked[kA] = 1;
+                vertex_locked[kB] = 1;
+            }
+        }
+        for (size_t v = 0; v < vertex_count; v++) {
+            vertex_locked[v] |= vertex_locked[canonical[v]];
+        }
+    }
+
+    // errors are measured relative to the mesh extent
+    Vector3F lower_corner = positions[0];
+    Vector3F upper_corner = positions[0];
+    for (size_t v = 1; v < vertex_count; v++) {
+        lower_corner = Vector3F(std::min(lower_corner.x, positions[v].x), std::min(lower_corner.y, positions[v].y),
+                                std::min(lower_corner.z, positions[v].z));
+        upper_corner = Vector3F(std::max(upper_corner.x, positions[v].x), std::max(upper_corner.y, positions[v].y),
+                                std::max(upper_corner.z, positions[v].z));
+    }
+    const float kExtent = std::max((upper_corner - lower_corner).max(), 1e-6f);
+    const float kMaxError = target_error * kExtent * target_error * kExtent;
+
+    std::vector<Quadric> quadrics(vertex_count);
+    for (size_t i = 0; i < index_count; i += 3) {
+        const auto &kP0 = positions[indices[i]];
+        auto normal = (positions[indices[i + 1]] - kP0).cross(positions[indices[i + 2]] - kP0);
+        const float kArea = normal.length();
+        if (kArea > 0.f) {
+            normal /= kArea;
+            const float kDistance = -normal.dot(kP0);
+            for (size_t k = 0; k < 3; k++) {
+                quadrics[canonical[indices[i + k]]].AddPlane(normal, kDistance, kArea);
+            }
+        }
+    }
+
+    struct Collapse {
+        uint32_t source;
+        uint32_t target;
+        float error;
+    };
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> adjacency_offsets;
+    std::vector<uint32_t> adjacency;
+    std::vector<uint8_t> pass_locked(vertex_count);
+    std::vector<uint32_t> remap(vertex_count);
+    float max_error = 0.f;
+
+    // each pass applies a set of independent collapses, cheapest first
+    while (result.size() > target_index_count) {
+        const size_t kFaceCount = result.size() / 3;
+
+        adjacency_offsets.assign(vertex_count + 1, 0);
+        for (auto index : result) {
+            adjacency_offsets[index + 1]++;
+        }
+        std::partial_sum(adjacency_offsets.begin(), adjacency_offsets.end(), adjacency_offsets.begin());
+        adjacency.resize(result.size());
+        {
+            std::vector<uint32_t> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+            for (size_t f = 0; f < kFaceCount; f++) {
+                for (size_t k = 0; k < 3; k++) {
+                    adjacency[fill[result[f * 3 + k]]++] = static_cast<uint32_t>(f);
+                }
+            }
+        }
+
+        collapses.clear();
+        for (size_t f = 0; f < kFaceCount; f++) {
+            for (size_t k = 0; k < 3; k++) {
+                const auto kSource = result[f * 3 + k];
+                const auto kTarget = result[f * 3 + (k + 1) % 3];
+                for (const auto &kEdge : {std::make_pair(kSource, kTarget), std::make_pair(kTarget, kSource)}) {
+                    if (vertex_locked[kEdge.first]) {
+                        continue;
+                    }
+                    Quadric quadric = quadrics[canonical[kEdge.first]];
+                    quadric.Add(quadrics[canonical[kEdge.second]]);
+                    collapses.push_back({kEdge.first, kEdge.second, quadric.Error(positions[kEdge.second])});
+                }
+            }
+        }
+        if (collapses.empty()) {
+            break;
+        }
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const Collapse &a, const Collapse &b) { return a.error < b.error; });
+
+        const size_t kTrianglesToRemove = (result.size() - target_index_count) / 3;
+        size_t triangles_removed = 0;
+        std::fill(pass_locked.begin(), pass_locked.end(), 0);
+        std::iota(remap.begin(), remap.end(), 0);
+
+        for (const auto &kCollapse : collapses) {
+            if (kCollapse.error > kMaxError || triangles_removed >= kTrianglesToRemove) {
+                break;
+            }
+            const auto kSourceCanonical = canonical[kCollapse.source];
+            const auto kTargetCanonical = canonical[kCollapse.target];
+            if (pass_locked[kSourceCanonical] || pass_locked[kTargetCanonical]) {
+                continue;
+            }
+
+            // reject collapses which flip a remaining triangle around the source vertex
+            bool flipped = false;
+            const auto kBegin = adjacency_offsets[kCollapse.source];
+            const auto kEnd = adjacency_offsets[kCollapse.source + 1];
+            for (uint32_t j = kBegin; j < kEnd && !flipped; j++) {
+                const uint32_t *kTriangle = &result[adjacency[j] * 3];
+                if (kTriangle[0] == kCollapse.target || kTriangle[1] == kCollapse.target ||
+                    kTriangle[2] == kCollapse.target) {
+                    continue;
+                }
+                Vector3F corners[3] = {positions[kTriangle[0]], positions[kTriangle[1]], positions[kTriangle[2]]};
+                const auto kBefore = (corners[1] - corners[0]).cross(corners[2] - corners[0]);
+                for (size_t k = 0; k < 3; k++) {
+                    if (kTriangle[k] == kCollapse.source) {
+                        corners[k] = positions[kCollapse.target];
+                    }
+                }
+                const auto kAfter = (corners[1] - corners[0]).cross(corners[2] - corners[0]);
+                flipped = kBefore.dot(kAfter) <= 0.f;
+            }
+            if (flipped) {
+                continue;
+            }
+
+            remap[kCollapse.source] = kCollapse.target;
+            quadrics[kTargetCanonical].Add(quadrics[kSourceCanonical]);
+            max_error = std::max(max_error, kCollapse.error);
+            for (uint32_t j = kBegin; j < kEnd; j++) {
+                for (size_t k = 0; k < 3; k++) {
+                    pass_locked[canonical[result[adjacency[j] * 3 + k]]] = 1;
+                }
+            }
+            // an interior edge collapse removes the two triangles sharing the edge
+            triangles_removed += 2;
+        }
+        if (triangles_removed == 0) {
+            break;
+        }
+
+        size_t write = 0;
+        for (size_t f = 0; f < kFaceCount; f++) {
+            const auto kA = remap[result[f * 3]];
+            const auto kB = remap[result[f * 3 + 1]];
+            const auto kC = remap[result[f * 3 + 2]];
+            if (kA != kB && kB != kC && kA != kC) {
+                result[write * 3] = kA;
+                result[write * 3 + 1] = kB;
+                result[write * 3 + 2] = kC;
+                write++;
+            }
+        }
+        result.resize(write * 3);
+    }
+
+    if (result_error) {
+        *result_error = std::sqrt(max_error) / kExtent;
+    }
+    return result;
+}
+
+float MeshOptimizer::AnalyzeVertexCache(const uint32_t *indices,
+                                        size_t index_count,
+                                        size_t vertex_count,
+                                        uint32_t cache_size) {
+    if (index_count < 3) {
+        return 0.f;
+    }
+
+    std::vector<uint32_t> timestamps(vertex_count, 0);
+    uint32_t timestamp = cache_size + 1;
+    size_t misses = 0;
+    for (size_t i = 0; i < index_count; i++) {
+        if (timestamp - timestamps[indices[i]] > cache_size) {
+            timestamps[indices[i]] = timestamp++;
+            misses++;
+        }
+    }
+    return static_cast<float>(misses) / static_cast<float>(index_count / 3);
+}
+
+uint16_t MeshOptimizer::QuantizeHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(float));
+
+    const auto kSign = static_cast<int32_t>((bits >> 16) & 0x8000);
+    const auto kMagnitude = static_cast<int32_t>(bits & 0x7fffffff);
+
+    // re-bias exponent (127 - 15 = 112) and round to nearest
+    int32_t half = (kMagnitude - (112 << 23) + (1 << 12)) >> 13;
+    // underflow flushes to zero
+    half = kMagnitude < (113 << 23) ? 0 : half;
+    // overflow saturates to infinity
+    half = kMagnitude >= (143 << 23) ? 0x7c00 : half;
+    // all NaNs map to a quiet NaN
+    half = kMagnitude > (255 << 23) ? 0x7e00 : half;
+
+    return static_cast<uint16_t>(kSign | half);
+}
+
+int16_t MeshOptimizer::QuantizeSnorm16(float value) {
+    const float kClamped = std::clamp(value, -1.f, 1.f);
+    return static_cast<int16_t>(std::lround(kClamped * 32767.f));
+}
+
+}  // namespace vox
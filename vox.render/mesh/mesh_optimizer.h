@@ -0,0 +1,116 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "vox.math/vector3.h"
+
+namespace vox {
+/**
+ * Import-time mesh processing: index reordering for the post-transform vertex cache and overdraw,
+ * vertex reordering for fetch locality, and attribute quantization helpers.
+ */
+class MeshOptimizer {
+public:
+    /**
+     * Reorder triangles to improve post-transform vertex cache hit rate (Forsyth's linear-speed algorithm).
+     * @param indices - Triangle list indices, reordered in place
+     * @param index_count - Index count, must be a multiple of 3
+     * @param vertex_count - Vertex count referenced by indices
+     */
+    static void OptimizeVertexCache(uint32_t *indices, size_t index_count, size_t vertex_count);
+
+    /**
+     * Reorder clusters of triangles to reduce overdraw while keeping most of the vertex cache efficiency.
+     * Should run after OptimizeVertexCache.
+     * @param indices - Triangle list indices, reordered in place
+     * @param index_count - Index count, must be a multiple of 3
+     * @param positions - Vertex positions
+     * @param vertex_count - Vertex count
+     * @param threshold - Allowed cache efficiency degradation, 1.05 means up to 5% worse ACMR
+     */
+    static void OptimizeOverdraw(uint32_t *indices,
+                                 size_t index_count,
+                                 const Vector3F *positions,
+                                 size_t vertex_count,
+                                 float threshold = 1.05f);
+
+    /**
+     * Generate a vertex remap table that orders vertices by first use in the index buffer, and rewrite indices.
+     * Unreferenced vertices are dropped.
+     * @param indices - Triangle list indices, rewritten in place
+     * @param index_count - Index count
+     * @param vertex_count - Vertex count
+     * @param remap - Output table, remap[old_index] = new_index or ~0u for unreferenced vertices
+     * @returns Vertex count after remapping
+     */
+    static size_t OptimizeVertexFetchRemap(uint32_t *indices,
+                                           size_t index_count,
+                                           size_t vertex_count,
+                                           std::vector<uint32_t> &remap);
+
+    /**
+     * Apply a remap table generated by OptimizeVertexFetchRemap to a vertex attribute stream.
+     */
+    template <typename T>
+    static void RemapVertexBuffer(std::vector<T> &attribute, const std::vector<uint32_t> &remap, size_t vertex_count) {
+        if (attribute.empty()) {
+            return;
+        }
+
+        std::vector<T> result(vertex_count);
+        for (size_t i = 0; i < remap.size(); i++) {
+            if (remap[i] != ~0u) {
+                result[remap[i]] = attribute[i];
+            }
+        }
+        attribute = std::move(result);
+    }
+
+    /**
+     * Reduce triangle count with quadric error metric edge collapses. Vertices are never moved, so the result
+     * indexes the original vertex buffer. Border and attribute seam vertices are kept in place.
+     * @param indices - Triangle list indices
+     * @param index_count - Index count, must be a multiple of 3
+     * @param positions - Vertex positions
+     * @param vertex_count - Vertex count
+     * @param target_index_count - Index count to reach
+     * @param target_error - Maximum deviation, relative to the mesh extent
+     * @param result_error - Optional output of the deviation reached, relative to the mesh extent
+     * @returns Simplified indices
+     */
+    static std::vector<uint32_t> Simplify(const uint32_t *indices,
+                                          size_t index_count,
+                                          const Vector3F *positions,
+                                          size_t vertex_count,
+                                          size_t target_index_count,
+                                          float target_error,
+                                          float *result_error = nullptr);
+
+    /**
+     * Average cache miss ratio of a triangle list under a FIFO cache model, mainly for diagnostics.
+     */
+    static float AnalyzeVertexCache(const uint32_t *indices,
+                                    size_t index_count,
+                                    size_t vertex_count,
+                                    uint32_t cache_size = 16);
+
+public:
+    /**
+     * Convert float to IEEE half precision, rounding to nearest.
+     */
+    static uint16_t QuantizeHalf(float value);
+
+    /**
+     * Convert float in [-1, 1] to signed normalized 16-bit integer.
+     */
+    static int16_t QuantizeSnorm16(float value);
+};
+
+}  // namespace vox
@@ -31,6 +31,51 @@ void MeshRenderer::SetMesh(const MeshPtr &mesh) {
 
 MeshPtr MeshRenderer::Mesh() { return mesh_; }
 
+MeshPtr MeshRenderer::DrawnMesh() { return mesh_; }
+
+size_t MeshRenderer::ActiveLod() const { return active_lod_; }
+
+void MeshRenderer::UpdateLod(const Camera *camera, float screen_size, uint32_t lod_bias, LodPass pass) {
+    active_lod_ = 0;
+    if (mesh_ == nullptr || mesh_->LodCount() == 1) {
+        return;
+    }
+
+    const auto kLodCount = mesh_->LodCount();
+    if (forced_lod_ >= 0) {
+        active_lod_ = std::min(static_cast<size_t>(forced_lod_), kLodCount - 1);
+        return;
+    }
+    // passes without a camera draw the full detail
+    if (camera == nullptr) {
+        return;
+    }
+
+    // move from the level of the last frame only when the size crosses a threshold by the hysteresis margin,
+    // the shadow casters have their own history: they are selected with a bias and outside of the camera frustum
+    auto &lod = (pass == LodPass::SHADOW ? shadow_camera_lods_ : camera_lods_)[camera];
+    lod = std::min(lod, kLodCount - 1);
+    while (lod + 1 < kLodCount && screen_size < mesh_->LodScreenSize(lod + 1) * (1.f - lod_hysteresis_)) {
+        lod++;
+    }
+    while (lod > 0 && screen_size > mesh_->LodScreenSize(lod) * (1.f + lod_hysteresis_)) {
+        lod--;
+    }
+    active_lod_ = std::min(lod + lod_bias, kLodCount - 1);
+}
+
+void MeshRenderer::OnCameraDestroy(const Camera *camera) {
+    camera_lods_.erase(camera);
+    shadow_camera_lods_.erase(camera);
+}
+
+void MeshRenderer::OnDisable() {
+    Renderer::OnDisable();
+    // a disabled renderer is not told about destroyed cameras
+    camera_lods_.clear();
+    shadow_camera_lods_.clear();
+}
+
 void MeshRenderer::Render(std::vector<RenderElement> &opaque_queue,
                           std::vector<RenderElement> &alpha_test_queue,
                           std::vector<RenderElement> &transparent_queue) {
@@ -60,7 +105,8 @@ void MeshRenderer::Render(std::vector<RenderElement> &opaque_queue,
             mesh_update_flag_->flag_ = false;
         }
 
-        auto &sub_meshes = mesh_->SubMeshes();
+        auto drawn_mesh = DrawnMesh();
+        auto &sub_meshes = drawn_mesh->LodSubMeshes(std::min(active_lod_, drawn_mesh->LodCount() - 1));
         for (size_t i = 0; i < sub_meshes.size(); i++) {
             MaterialPtr material;
             if (i < materials_.size()) {
@@ -69,7 +115,7 @@ void MeshRenderer::Render(std::vector<RenderElement> &opaque_queue,
                 material = nullptr;
             }
             if (material != nullptr) {
-                RenderElement element(this, mesh_, &sub_meshes[i], material);
+                RenderElement element(this, drawn_mesh, &sub_meshes[i], material);
                 PushPrimitive(element, opaque_queue, alpha_test_queue, transparent_queue);
             }
         }
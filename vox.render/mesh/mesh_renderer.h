@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <unordered_map>
+
 #include "vox.render/renderer.h"
 
 namespace vox {
@@ -25,6 +27,27 @@ public:
 
     MeshPtr Mesh();
 
+    /**
+     * Level of detail used by the last rendered pass.
+     */
+    [[nodiscard]] size_t ActiveLod() const;
+
+    /**
+     * Relative margin around the screen size thresholds, which avoids popping between two levels.
+     */
+    float lod_hysteresis_ = 0.1f;
+
+    /**
+     * Force a level of detail, -1 means automatic selection.
+     */
+    int forced_lod_ = -1;
+
+protected:
+    /**
+     * Mesh pushed to the render queues, the assigned mesh by default.
+     */
+    virtual MeshPtr DrawnMesh();
+
 private:
     void Render(std::vector<RenderElement> &opaque_queue,
                 std::vector<RenderElement> &alpha_test_queue,
@@ -32,6 +55,12 @@ private:
 
     void UpdateBounds(BoundingBox3F &world_bounds) override;
 
+    void UpdateLod(const Camera *camera, float screen_size, uint32_t lod_bias, LodPass pass) override;
+
+    void OnCameraDestroy(const Camera *camera) override;
+
+    void OnDisable() override;
+
 public:
     /**
      * Called when the serialization is asked
@@ -51,6 +80,11 @@ public:
 private:
     MeshPtr mesh_;
     std::unique_ptr<UpdateFlag> mesh_update_flag_;
+
+    size_t active_lod_ = 0;
+    // level of detail of the last frame per camera, erased when the camera is destroyed
+    std::unordered_map<const Camera *, size_t> camera_lods_;
+    std::unordered_map<const Camera *, size_t> shadow_camera_lods_;
 };
 
 }  // namespace vox
@@ -6,7 +6,12 @@
 
 #include "vox.render/mesh/model_mesh.h"
 
+#include <cmath>
+#include <cstring>
+#include <limits>
+
 #include "vox.render/core/device.h"
+#include "vox.render/mesh/mesh_optimizer.h"
 #include "vox.render/shader/shader_common.h"
 
 namespace vox {
@@ -114,6 +119,48 @@ const std::vector<Vector4F> &ModelMesh::Tangents() {
     return tangents_;
 }
 
+void ModelMesh::SetBoneWeights(const std::vector<Vector4F> &weights) {
+    if (!accessible_) {
+        assert(false && "Not allowed to access data while accessible is false.");
+    }
+
+    if (weights.size() != vertex_count_) {
+        assert(false && "The array provided needs to be the same size as vertex count.");
+    }
+
+    vertex_change_flag_ |= ValueChanged::BONE_WEIGHT;
+    bone_weights_ = weights;
+}
+
+const std::vector<Vector4F> &ModelMesh::BoneWeights() {
+    if (!accessible_) {
+        assert(false && "Not allowed to access data while accessible is false.");
+    }
+    return bone_weights_;
+}
+
+void ModelMesh::SetBoneIndices(const std::vector<Vector4F> &indices) {
+    if (!accessible_) {
+        assert(false && "Not allowed to access data while accessible is false.");
+    }
+
+    if (indices.size() != vertex_count_) {
+        assert(false && "The array provided needs to be the same size as vertex count.");
+    }
+
+    vertex_change_flag_ |= ValueChanged::BONE_INDEX;
+    bone_indices_ = indices;
+}
+
+const std::vector<Vector4F> &ModelMesh::BoneIndices() {
+    if (!accessible_) {
+        assert(false && "Not allowed to access data while accessible is false.");
+    }
+    return bone_indices_;
+}
+
+core::Buffer *ModelMesh::SkinBuffer() { return skin_buffer_.get(); }
+
 void ModelMesh::SetUvs(const std::vector<Vector2F> &uv, int channel_index) {
     if (!accessible_) {
         assert(false && "Not allowed to access data while accessible is false.");
@@ -165,27 +212,7 @@ const std::vector<Vector2F> &ModelMesh::Uvs(int channel_index) {
     if (!accessible_) {
         assert(false && "Not allowed to access data while accessible is false.");
     }
-    switch (channel_index) {
-        case 0:
-            return uv_;
-        case 1:
-            return uv_1_;
-        case 2:
-            return uv_2_;
-        case 3:
-            return uv_3_;
-        case 4:
-            return uv_4_;
-        case 5:
-            return uv_5_;
-        case 6:
-            return uv_6_;
-        case 7:
-            return uv_7_;
-        default:
-            assert(false && "The index of channel needs to be in range [0 - 7].");
-            throw std::exception();
-    }
+    return UvChannel(channel_index);
 }
 
 void ModelMesh::SetIndices(const std::vector<uint32_t> &indices) {
@@ -204,6 +231,95 @@ void ModelMesh::SetIndices(const std::vector<uint16_t> &indices) {
     indices_16_ = indices;
 }
 
+bool ModelMesh::CompressVertices() const { return compress_vertices_; }
+
+void ModelMesh::SetCompressVertices(bool value) {
+    if (!accessible_) {
+        assert(false && "Not allowed to access data while accessible is false.");
+    }
+    compress_vertices_ = value;
+}
+
+void ModelMesh::Optimize() {
+    if (!accessible_) {
+        assert(false && "Not allowed to access data while accessible is false.");
+    }
+
+    if (indices_32_.empty() && indices_16_.empty()) {
+        return;
+    }
+    PromoteIndices();
+
+    auto optimize_range = [&](size_t start, size_t count) {
+        count = count / 3 * 3;
+        MeshOptimizer::OptimizeVertexCache(indices_32_.data() + start, count, vertex_count_);
+        MeshOptimizer::OptimizeOverdraw(indices_32_.data() + start, count, positions_.data(), vertex_count_);
+    };
+    if (sub_meshes_.empty()) {
+        optimize_range(0, indices_32_.size());
+    } else {
+        for (const auto &sub_mesh : sub_meshes_) {
+            optimize_range(sub_mesh.Start(), sub_mesh.Count());
+        }
+    }
+
+    std::vector<uint32_t> remap;
+    auto new_vertex_count =
+            MeshOptimizer::OptimizeVertexFetchRemap(indices_32_.data(), indices_32_.size(), vertex_count_, remap);
+    MeshOptimizer::RemapVertexBuffer(positions_, remap, new_vertex_count);
+    MeshOptimizer::RemapVertexBuffer(normals_, remap, new_vertex_count);
+    MeshOptimizer::RemapVertexBuffer(colors_, remap, new_vertex_count);
+    MeshOptimizer::RemapVertexBuffer(tangents_, remap, new_vertex_count);
+    for (int i = 0; i < kMaxUvChannel; i++) {
+        MeshOptimizer::RemapVertexBuffer(UvChannel(i), remap, new_vertex_count);
+    }
+    MeshOptimizer::RemapVertexBuffer(bone_weights_, remap, new_vertex_count);
+    MeshOptimizer::RemapVertexBuffer(bone_indices_, remap, new_vertex_count);
+
+    vertex_count_ = new_vertex_count;
+    vertex_change_flag_ = ValueChanged::ALL;
+}
+
+void ModelMesh::GenerateLods(size_t max_lod_count, float reduction, float target_error) {
+    if (!accessible_) {
+        assert(false && "Not allowed to access data while accessible is false.");
+    }
+
+    ClearLod();
+    if (sub_meshes_.empty() || (indices_32_.empty() && indices_16_.empty())) {
+        return;
+    }
+    PromoteIndices();
+
+    auto level = sub_meshes_;
+    for (size_t lod = 1; lod < max_lod_count; lod++) {
+        const auto kIndexCount = indices_32_.size();
+        std::vector<SubMesh> next_level;
+        bool reduced = false;
+        for (const auto &sub_mesh : level) {
+            const auto kTargetCount = static_cast<size_t>(static_cast<float>(sub_mesh.Count()) * reduction) / 3 * 3;
+            auto indices = MeshOptimizer::Simplify(indices_32_.data() + sub_mesh.Start(), sub_mesh.Count(),
+                                                   positions_.data(), vertex_count_, kTargetCount, target_error);
+            // levels which barely change are not worth the memory
+            if (static_cast<float>(indices.size()) < 0.9f * static_cast<float>(sub_mesh.Count())) {
+                reduced = true;
+            }
+            MeshOptimizer::OptimizeVertexCache(indices.data(), indices.size(), vertex_count_);
+
+            next_level.emplace_back(static_cast<uint32_t>(indices_32_.size()), static_cast<uint32_t>(indices.size()));
+            indices_32_.insert(indices_32_.end(), indices.begin(), indices.end());
+        }
+
+        if (!reduced) {
+            indices_32_.resize(kIndexCount);
+            break;
+        }
+        // each level halves the screen size at which it kicks in
+        AddLod(next_level, std::pow(0.5f, static_cast<float>(lod)));
+        level = std::move(next_level);
+    }
+}
+
 void ModelMesh::UploadData(bool no_longer_accessible) {
     if (!accessible_) {
         assert(false && "Not allowed to access data while accessible is false.");
@@ -212,10 +328,17 @@ void ModelMesh::UploadData(bool no_longer_accessible) {
     UpdateVertexState();
     vertex_change_flag_ = ValueChanged::ALL;
 
-    auto vertex_float_count = element_count_ * vertex_count_;
-    auto vertices = std::vector<float>(vertex_float_count);
+    auto vertices = std::vector<uint8_t>(vertex_stride_ * vertex_count_);
     UpdateVertices(vertices);
 
+    // small meshes don't need 32-bit indices, 0xffff is kept free for primitive restart
+    if (indices_type_ == VkIndexType::VK_INDEX_TYPE_UINT32 &&
+        vertex_count_ < std::numeric_limits<uint16_t>::max()) {
+        indices_16_.assign(indices_32_.begin(), indices_32_.end());
+        indices_32_.clear();
+        indices_type_ = VkIndexType::VK_INDEX_TYPE_UINT16;
+    }
+
     auto &queue = device_.GetQueueByFlags(VK_QUEUE_GRAPHICS_BIT, 0);
 
     // keep stage buffer alive until submit finish
@@ -224,19 +347,36 @@ void ModelMesh::UploadData(bool no_longer_accessible) {
 
     command_buffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 
-    core::Buffer stage_buffer{device_, vertices.size() * sizeof(float), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                              VMA_MEMORY_USAGE_CPU_ONLY};
+    core::Buffer stage_buffer{device_, vertices.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY};
 
-    stage_buffer.Update(vertices.data(), vertices.size() * sizeof(float));
+    stage_buffer.Update(vertices);
 
     auto new_vertex_buffer = std::make_unique<core::Buffer>(
-            device_, vertices.size() * sizeof(float),
-            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+            device_, vertices.size(), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY);
 
-    command_buffer.CopyBuffer(stage_buffer, *new_vertex_buffer, vertices.size() * sizeof(float));
+    command_buffer.CopyBuffer(stage_buffer, *new_vertex_buffer, vertices.size());
     SetVertexBufferBinding(0, std::move(new_vertex_buffer));
     transient_buffers.push_back(std::move(stage_buffer));
 
+    if (!bone_weights_.empty() && !bone_indices_.empty()) {
+        auto skin_vertices = std::vector<Vector4F>(5 * vertex_count_);
+        UpdateSkinVertices(skin_vertices);
+        const auto kSkinSize = skin_vertices.size() * sizeof(Vector4F);
+
+        core::Buffer skin_stage_buffer{device_, kSkinSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                       VMA_MEMORY_USAGE_CPU_ONLY};
+        skin_stage_buffer.Update(reinterpret_cast<const uint8_t *>(skin_vertices.data()), kSkinSize);
+
+        skin_buffer_ = std::make_unique<core::Buffer>(
+                device_, kSkinSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VMA_MEMORY_USAGE_GPU_ONLY);
+        command_buffer.CopyBuffer(skin_stage_buffer, *skin_buffer_, kSkinSize);
+        transient_buffers.push_back(std::move(skin_stage_buffer));
+    } else {
+        skin_buffer_.reset();
+    }
+
     if (indices_type_ == VkIndexType::VK_INDEX_TYPE_UINT16) {
         core::Buffer stage_buffer{device_, indices_16_.size() * sizeof(uint16_t), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                                   VMA_MEMORY_USAGE_CPU_ONLY};
@@ -279,230 +419,197 @@ void ModelMesh::UploadData(bool no_longer_accessible) {
     }
 }
 
+std::vector<Vector2F> &ModelMesh::UvChannel(int channel_index) {
+    switch (channel_index) {
+        case 0:
+            return uv_;
+        case 1:
+            return uv_1_;
+        case 2:
+            return uv_2_;
+        case 3:
+            return uv_3_;
+        case 4:
+            return uv_4_;
+        case 5:
+            return uv_5_;
+        case 6:
+            return uv_6_;
+        case 7:
+            return uv_7_;
+        default:
+            assert(false && "The index of channel needs to be in range [0 - 7].");
+            throw std::exception();
+    }
+}
+
+void ModelMesh::PromoteIndices() {
+    if (indices_type_ == VkIndexType::VK_INDEX_TYPE_UINT16) {
+        indices_32_.assign(indices_16_.begin(), indices_16_.end());
+        indices_16_.clear();
+        indices_type_ = VkIndexType::VK_INDEX_TYPE_UINT32;
+    }
+}
+
 void ModelMesh::UpdateVertexState() {
+    static constexpr Attributes kUvAttributes[kMaxUvChannel] = {Attributes::UV_0, Attributes::UV_1, Attributes::UV_2,
+                                                                Attributes::UV_3, Attributes::UV_4, Attributes::UV_5,
+                                                                Attributes::UV_6, Attributes::UV_7};
+
     auto &vertex_input_attributes = vertex_input_state_.attributes;
     vertex_input_attributes.resize(1);
     vertex_input_attributes[0] = initializers::VertexInputAttributeDescription(0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0);
 
+    // half float keeps about three decimal digits, enough for uv within two repeats of the texture
+    compress_uvs_ = compress_vertices_;
+    for (int i = 0; i < kMaxUvChannel && compress_uvs_; i++) {
+        for (const auto &uv : UvChannel(i)) {
+            if (!(std::fabs(uv.x) <= 2.f && std::fabs(uv.y) <= 2.f)) {
+                compress_uvs_ = false;
+                break;
+            }
+        }
+    }
+
+    // normalized and half formats are expanded to float by the vertex fetch, so shaders are unchanged
     uint32_t offset = 12;
-    uint32_t element_count = 3;
     if (!normals_.empty()) {
         vertex_input_attributes.push_back(initializers::VertexInputAttributeDescription(
-                0, (uint32_t)Attributes::NORMAL, VK_FORMAT_R32G32B32_SFLOAT, offset));
-        offset += 12;
-        element_count += 3;
+                0, (uint32_t)Attributes::NORMAL,
+                compress_vertices_ ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R32G32B32_SFLOAT, offset));
+        offset += compress_vertices_ ? 8 : 12;
     }
     if (!colors_.empty()) {
         vertex_input_attributes.push_back(initializers::VertexInputAttributeDescription(
-                0, (uint32_t)Attributes::COLOR_0, VK_FORMAT_R32G32B32A32_SFLOAT, offset));
-        offset += 16;
-        element_count += 4;
+                0, (uint32_t)Attributes::COLOR_0,
+                compress_vertices_ ? VK_FORMAT_R16G16B16A16_SFLOAT : VK_FORMAT_R32G32B32A32_SFLOAT, offset));
+        offset += compress_vertices_ ? 8 : 16;
     }
     if (!tangents_.empty()) {
         vertex_input_attributes.push_back(initializers::VertexInputAttributeDescription(
-                0, (uint32_t)Attributes::TANGENT, VK_FORMAT_R32G32B32A32_SFLOAT, offset));
-        offset += 16;
-        element_count += 4;
-    }
-    if (!uv_.empty()) {
-        vertex_input_attributes.push_back(initializers::VertexInputAttributeDescription(
-                0, (uint32_t)Attributes::UV_0, VK_FORMAT_R32G32_SFLOAT, offset));
-        offset += 8;
-        element_count += 2;
-    }
-    if (!uv_1_.empty()) {
-        vertex_input_attributes.push_back(initializers::VertexInputAttributeDescription(
-                0, (uint32_t)Attributes::UV_1, VK_FORMAT_R32G32_SFLOAT, offset));
-        offset += 8;
-        element_count += 2;
-    }
-    if (!uv_2_.empty()) {
-        vertex_input_attributes.push_back(initializers::VertexInputAttributeDescription(
-                0, (uint32_t)Attributes::UV_2, VK_FORMAT_R32G32_SFLOAT, offset));
-        offset += 8;
-        element_count += 2;
-    }
-    if (!uv_3_.empty()) {
-        vertex_input_attributes.push_back(initializers::VertexInputAttributeDescription(
-                0, (uint32_t)Attributes::UV_3, VK_FORMAT_R32G32_SFLOAT, offset));
-        offset += 8;
-        element_count += 2;
-    }
-    if (!uv_4_.empty()) {
-        vertex_input_attributes.push_back(initializers::VertexInputAttributeDescription(
-                0, (uint32_t)Attributes::UV_4, VK_FORMAT_R32G32_SFLOAT, offset));
-        offset += 8;
-        element_count += 2;
-    }
-    if (!uv_5_.empty()) {
-        vertex_input_attributes.push_back(initializers::VertexInputAttributeDescription(
-                0, (uint32_t)Attributes::UV_5, VK_FORMAT_R32G32_SFLOAT, offset));
-        offset += 8;
-        element_count += 2;
-    }
-    if (!uv_6_.empty()) {
-        vertex_input_attributes.push_back(initializers::VertexInputAttributeDescription(
-                0, (uint32_t)Attributes::UV_6, VK_FORMAT_R32G32_SFLOAT, offset));
-        offset += 8;
-        element_count += 2;
-    }
-    if (!uv_7_.empty()) {
-        vertex_input_attributes.push_back(initializers::VertexInputAttributeDescription(
-                0, (uint32_t)Attributes::UV_7, VK_FORMAT_R32G32_SFLOAT, offset));
-        offset += 8;
-        element_count += 2;
+                0, (uint32_t)Attributes::TANGENT,
+                compress_vertices_ ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R32G32B32A32_SFLOAT, offset));
+        offset += compress_vertices_ ? 8 : 16;
+    }
+    for (int i = 0; i < kMaxUvChannel; i++) {
+        if (!UvChannel(i).empty()) {
+            vertex_input_attributes.push_back(initializers::VertexInputAttributeDescription(
+                    0, (uint32_t)kUvAttributes[i], compress_uvs_ ? VK_FORMAT_R16G16_SFLOAT : VK_FORMAT_R32G32_SFLOAT,
+                    offset));
+            offset += compress_uvs_ ? 4 : 8;
+        }
     }
 
     auto &vertex_input_bindings = vertex_input_state_.bindings;
     vertex_input_bindings.resize(1);
-    vertex_input_bindings[0] =
-            vox::initializers::VertexInputBindingDescription(0, element_count * 4, VK_VERTEX_INPUT_RATE_VERTEX);
+    vertex_input_bindings[0] = vox::initializers::VertexInputBindingDescription(0, offset, VK_VERTEX_INPUT_RATE_VERTEX);
+
+    vertex_stride_ = offset;
+}
+
+namespace {
+void WriteFloat(uint8_t *dst, const float *src, size_t count) { std::memcpy(dst, src, count * sizeof(float)); }
+
+void WriteSnorm16(uint8_t *dst, const float *src, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        auto value = MeshOptimizer::QuantizeSnorm16(src[i]);
+        std::memcpy(dst + i * sizeof(int16_t), &value, sizeof(int16_t));
+    }
+}
 
-    element_count_ = element_count;
+void WriteHalf(uint8_t *dst, const float *src, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        auto value = MeshOptimizer::QuantizeHalf(src[i]);
+        std::memcpy(dst + i * sizeof(uint16_t), &value, sizeof(uint16_t));
+    }
 }
 
-void ModelMesh::UpdateVertices(std::vector<float> &vertices) {
+}  // namespace
+
+void ModelMesh::UpdateVertices(std::vector<uint8_t> &vertices) {
     if ((vertex_change_flag_ & ValueChanged::POSITION) != 0) {
         for (size_t i = 0; i < vertex_count_; i++) {
-            auto start = element_count_ * i;
             const auto &position = positions_[i];
-            vertices[start] = position.x;
-            vertices[start + 1] = position.y;
-            vertices[start + 2] = position.z;
+            const float kValue[3] = {position.x, position.y, position.z};
+            WriteFloat(&vertices[vertex_stride_ * i], kValue, 3);
         }
     }
 
-    size_t offset = 3;
+    size_t offset = 12;
 
     if (!normals_.empty()) {
         if ((vertex_change_flag_ & ValueChanged::NORMAL) != 0) {
             for (size_t i = 0; i < vertex_count_; i++) {
-                auto start = element_count_ * i + offset;
+                auto start = vertex_stride_ * i + offset;
                 const auto &normal = normals_[i];
-                vertices[start] = normal.x;
-                vertices[start + 1] = normal.y;
-                vertices[start + 2] = normal.z;
+                const float kValue[4] = {normal.x, normal.y, normal.z, 0.f};
+                compress_vertices_ ? WriteSnorm16(&vertices[start], kValue, 4)
+                                   : WriteFloat(&vertices[start], kValue, 3);
             }
         }
-        offset += 3;
+        offset += compress_vertices_ ? 8 : 12;
     }
 
     if (!colors_.empty()) {
         if ((vertex_change_flag_ & ValueChanged::COLOR) != 0) {
             for (size_t i = 0; i < vertex_count_; i++) {
-                auto start = element_count_ * i + offset;
+                auto start = vertex_stride_ * i + offset;
                 const auto &color = colors_[i];
-                vertices[start] = color.r;
-                vertices[start + 1] = color.g;
-                vertices[start + 2] = color.b;
-                vertices[start + 3] = color.a;
+                const float kValue[4] = {color.r, color.g, color.b, color.a};
+                compress_vertices_ ? WriteHalf(&vertices[start], kValue, 4) : WriteFloat(&vertices[start], kValue, 4);
             }
         }
-        offset += 4;
+        offset += compress_vertices_ ? 8 : 16;
     }
 
     if (!tangents_.empty()) {
         if ((vertex_change_flag_ & ValueChanged::TANGENT) != 0) {
             for (size_t i = 0; i < vertex_count_; i++) {
-                auto start = element_count_ * i + offset;
+                auto start = vertex_stride_ * i + offset;
                 const auto &tangent = tangents_[i];
-                vertices[start] = tangent.x;
-                vertices[start + 1] = tangent.y;
-                vertices[start + 2] = tangent.z;
-            }
-        }
-        offset += 4;
-    }
-    if (!uv_.empty()) {
-        if ((vertex_change_flag_ & ValueChanged::UV) != 0) {
-            for (size_t i = 0; i < vertex_count_; i++) {
-                auto start = element_count_ * i + offset;
-                const auto &uv = uv_[i];
-                vertices[start] = uv.x;
-                vertices[start + 1] = uv.y;
+                const float kValue[4] = {tangent.x, tangent.y, tangent.z, tangent.w};
+                compress_vertices_ ? WriteSnorm16(&vertices[start], kValue, 4)
+                                   : WriteFloat(&vertices[start], kValue, 4);
             }
         }
-        offset += 2;
+        offset += compress_vertices_ ? 8 : 16;
     }
-    if (!uv_1_.empty()) {
-        if ((vertex_change_flag_ & ValueChanged::UV_1) != 0) {
-            for (size_t i = 0; i < vertex_count_; i++) {
-                auto start = element_count_ * i + offset;
-                const auto &uv = uv_1_[i];
-                vertices[start] = uv.x;
-                vertices[start + 1] = uv.y;
-            }
-        }
-        offset += 2;
-    }
-    if (!uv_2_.empty()) {
-        if ((vertex_change_flag_ & ValueChanged::UV_2) != 0) {
-            for (size_t i = 0; i < vertex_count_; i++) {
-                auto start = element_count_ * i + offset;
-                const auto &uv = uv_2_[i];
-                vertices[start] = uv.x;
-                vertices[start + 1] = uv.y;
-            }
-        }
-        offset += 2;
-    }
-    if (!uv_3_.empty()) {
-        if ((vertex_change_flag_ & ValueChanged::UV_3) != 0) {
-            for (size_t i = 0; i < vertex_count_; i++) {
-                auto start = element_count_ * i + offset;
-                const auto &uv = uv_3_[i];
-                vertices[start] = uv.x;
-                vertices[start + 1] = uv.y;
-            }
-        }
-        offset += 2;
-    }
-    if (!uv_4_.empty()) {
-        if ((vertex_change_flag_ & ValueChanged::UV_4) != 0) {
-            for (size_t i = 0; i < vertex_count_; i++) {
-                auto start = element_count_ * i + offset;
-                const auto &uv = uv_4_[i];
-                vertices[start] = uv.x;
-                vertices[start + 1] = uv.y;
-            }
+
+    for (int channel = 0; channel < kMaxUvChannel; channel++) {
+        const auto &uvs = UvChannel(channel);
+        if (uvs.empty()) {
+            continue;
         }
-        offset += 2;
-    }
-    if (!uv_5_.empty()) {
-        if ((vertex_change_flag_ & ValueChanged::UV_5) != 0) {
+
+        if ((vertex_change_flag_ & (ValueChanged::UV << channel)) != 0) {
             for (size_t i = 0; i < vertex_count_; i++) {
-                auto start = element_count_ * i + offset;
-                const auto &uv = uv_5_[i];
-                vertices[start] = uv.x;
-                vertices[start + 1] = uv.y;
+                auto start = vertex_stride_ * i + offset;
+                const auto &uv = uvs[i];
+                const float kValue[2] = {uv.x, uv.y};
+                compress_uvs_ ? WriteHalf(&vertices[start], kValue, 2) : WriteFloat(&vertices[start], kValue, 2);
             }
         }
-        offset += 2;
+        offset += compress_uvs_ ? 4 : 8;
     }
-    if (!uv_6_.empty()) {
-        if ((vertex_change_flag_ & ValueChanged::UV_6) != 0) {
-            for (size_t i = 0; i < vertex_count_; i++) {
-                auto start = element_count_ * i + offset;
-                const auto &uv = uv_6_[i];
-                vertices[start] = uv.x;
-                vertices[start + 1] = uv.y;
-            }
+
+    vertex_change_flag_ = 0;
+}
+
+void ModelMesh::UpdateSkinVertices(std::vector<Vector4F> &vertices) {
+    for (size_t i = 0; i < vertex_count_; i++) {
+        auto *vertex = &vertices[i * 5];
+        const auto &position = positions_[i];
+        vertex[0] = Vector4F(position.x, position.y, position.z, 1.f);
+        if (!normals_.empty()) {
+            const auto &normal = normals_[i];
+            vertex[1] = Vector4F(normal.x, normal.y, normal.z, 0.f);
         }
-        offset += 2;
-    }
-    if (!uv_7_.empty()) {
-        if ((vertex_change_flag_ & ValueChanged::UV_7) != 0) {
-            for (size_t i = 0; i < vertex_count_; i++) {
-                auto start = element_count_ * i + offset;
-                const auto &uv = uv_7_[i];
-                vertices[start] = uv.x;
-                vertices[start + 1] = uv.y;
-            }
+        if (!tangents_.empty()) {
+            vertex[2] = tangents_[i];
         }
-        offset += 2;
+        vertex[3] = bone_weights_[i];
+        vertex[4] = bone_indices_[i];
     }
-
-    vertex_change_flag_ = 0;
 }
 
 void ModelMesh::ReleaseCache() {
@@ -519,6 +626,8 @@ void ModelMesh::ReleaseCache() {
     uv_5_.clear();
     uv_6_.clear();
     uv_7_.clear();
+    bone_weights_.clear();
+    bone_indices_.clear();
 }
 
 }  // namespace vox
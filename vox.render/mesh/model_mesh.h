@@ -126,6 +126,38 @@ public:
      */
     const std::vector<Vector2F> &Uvs(int channel_index = 0);
 
+    /**
+     * Set per-vertex bone weights for the mesh.
+     * @param weights - The weights of the four joints influencing each vertex.
+     */
+    void SetBoneWeights(const std::vector<Vector4F> &weights);
+
+    /**
+     * Get bone weights for the mesh.
+     * @remarks Please call the SetBoneWeights() method after modification to ensure that the modification takes
+     * effect.
+     */
+    const std::vector<Vector4F> &BoneWeights();
+
+    /**
+     * Set per-vertex bone indices for the mesh.
+     * @param indices - The indices in the skin of the four joints influencing each vertex.
+     */
+    void SetBoneIndices(const std::vector<Vector4F> &indices);
+
+    /**
+     * Get bone indices for the mesh.
+     * @remarks Please call the SetBoneIndices() method after modification to ensure that the modification takes
+     * effect.
+     */
+    const std::vector<Vector4F> &BoneIndices();
+
+    /**
+     * Rest pose vertices of a skinned mesh, read by the skinning compute pass, nullptr if the mesh has no bones.
+     * @remarks Each vertex is laid out as position, normal, tangent, weights and joints, one vec4 each.
+     */
+    [[nodiscard]] core::Buffer *SkinBuffer();
+
     /**
      * Set indices for the mesh.
      * @param indices - The indices for the mesh.
@@ -138,6 +170,31 @@ public:
      */
     void SetIndices(const std::vector<uint16_t> &indices);
 
+    /**
+     * Whether to quantize normals, tangents and colors to 16-bit and uv to half float when uploading.
+     * Uv stay float when a coordinate leaves [-2, 2], where tiled and atlas coordinates would lose too much precision.
+     */
+    [[nodiscard]] bool CompressVertices() const;
+
+    void SetCompressVertices(bool value);
+
+    /**
+     * Reorder triangles of each sub-mesh for vertex cache and overdraw, then reorder vertices for fetch locality.
+     * @remarks Must be called after indices and sub-meshes are set, and before UploadData().
+     */
+    void Optimize();
+
+    /**
+     * Generate coarser levels of detail for each sub-mesh by simplification. Levels share the vertex buffer and are
+     * appended to the index buffer.
+     * @param max_lod_count - Maximum level count, including level 0
+     * @param reduction - Triangle ratio between two successive levels
+     * @param target_error - Maximum deviation allowed, relative to the mesh extent
+     * @remarks Must be called after indices and sub-meshes are set, and before UploadData(). Generation stops as soon
+     * as a level can't be reduced any more within the error.
+     */
+    void GenerateLods(size_t max_lod_count = 4, float reduction = 0.5f, float target_error = 0.01f);
+
     /**
      * Upload Mesh Data to the graphics API.
      * @param no_longer_accessible - Whether to access data later. If true, you'll never access data anymore (free
@@ -146,12 +203,21 @@ public:
     void UploadData(bool no_longer_accessible);
 
 private:
+    static constexpr int kMaxUvChannel = 8;
+
     Device &device_;
     std::vector<std::unique_ptr<core::Buffer>> vertex_buffer_bindings_{};
+    std::unique_ptr<core::Buffer> skin_buffer_{nullptr};
 
     void UpdateVertexState();
 
-    void UpdateVertices(std::vector<float> &vertices);
+    std::vector<Vector2F> &UvChannel(int channel_index);
+
+    void PromoteIndices();
+
+    void UpdateVertices(std::vector<uint8_t> &vertices);
+
+    void UpdateSkinVertices(std::vector<Vector4F> &vertices);
 
     void ReleaseCache();
 
@@ -166,7 +232,9 @@ private:
     std::vector<uint16_t> indices_16_{};
     VkIndexType indices_type_;
     int vertex_change_flag_{};
-    size_t element_count_{};
+    uint32_t vertex_stride_{};
+    bool compress_vertices_ = false;
+    bool compress_uvs_ = false;
 
     std::vector<Vector3F> positions_;
     std::vector<Vector3F> normals_;
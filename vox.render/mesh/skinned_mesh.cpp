@@ -0,0 +1,66 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.render/mesh/skinned_mesh.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "vox.render/shader/shader_common.h"
+
+namespace vox {
+SkinnedMesh::SkinnedMesh(Device &device, ModelMeshPtr source) : source_(std::move(source)) {
+    name_ = source_->name_;
+    bounds_ = source_->bounds_;
+    instance_count_ = source_->InstanceCount();
+
+    for (const auto &sub_mesh : source_->SubMeshes()) {
+        AddSubMesh(sub_mesh);
+    }
+    for (size_t lod = 1; lod < source_->LodCount(); lod++) {
+        AddLod(source_->LodSubMeshes(lod), source_->LodScreenSize(lod));
+    }
+
+    // skinned attributes move to binding 1, the others keep reading the source vertices
+    auto vertex_input_bindings = source_->VertexInputState().bindings;
+    auto vertex_input_attributes = source_->VertexInputState().attributes;
+    for (auto &attribute : vertex_input_attributes) {
+        if (attribute.location == (uint32_t)Attributes::POSITION) {
+            attribute = initializers::VertexInputAttributeDescription(1, attribute.location,
+                                                                      VK_FORMAT_R32G32B32A32_SFLOAT, 0);
+        } else if (attribute.location == (uint32_t)Attributes::NORMAL) {
+            attribute = initializers::VertexInputAttributeDescription(1, attribute.location,
+                                                                      VK_FORMAT_R32G32B32A32_SFLOAT, 16);
+        } else if (attribute.location == (uint32_t)Attributes::TANGENT) {
+            attribute = initializers::VertexInputAttributeDescription(1, attribute.location,
+                                                                      VK_FORMAT_R32G32B32A32_SFLOAT, 32);
+        }
+    }
+    vertex_input_bindings.resize(1);
+    vertex_input_bindings.push_back(
+            initializers::VertexInputBindingDescription(1, skinned_vertex_stride_, VK_VERTEX_INPUT_RATE_VERTEX));
+    SetVertexInputState(vertex_input_bindings, vertex_input_attributes);
+
+    skinned_buffer_ = std::make_unique<core::Buffer>(
+            device, std::max<size_t>(source_->VertexCount(), 1) * skinned_vertex_stride_,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+}
+
+const ModelMeshPtr &SkinnedMesh::Source() const { return source_; }
+
+size_t SkinnedMesh::VertexCount() const { return source_->VertexCount(); }
+
+core::Buffer &SkinnedMesh::SkinnedBuffer() { return *skinned_buffer_; }
+
+size_t SkinnedMesh::VertexBufferCount() const { return 2; }
+
+const core::Buffer *SkinnedMesh::VertexBuffer(size_t index) const {
+    return index == 0 ? source_->VertexBuffer(0) : skinned_buffer_.get();
+}
+
+const IndexBufferBinding *SkinnedMesh::IndexBufferBinding() const { return source_->IndexBufferBinding(); }
+
+}  // namespace vox
@@ -0,0 +1,46 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include "vox.render/mesh/model_mesh.h"
+
+namespace vox {
+/**
+ * Mesh drawn with the output of the skinning compute pass.
+ * Position, normal and tangent are read from the skinned buffer at binding 1, the other attributes and the indices
+ * are shared with the source mesh, so every pass of the frame draws the same skinned vertices.
+ */
+class SkinnedMesh : public Mesh {
+public:
+    /**
+     * Size of a skinned vertex: position, normal and tangent, one vec4 each.
+     */
+    static constexpr uint32_t skinned_vertex_stride_ = 48;
+
+    SkinnedMesh(Device &device, ModelMeshPtr source);
+
+    [[nodiscard]] const ModelMeshPtr &Source() const;
+
+    [[nodiscard]] size_t VertexCount() const;
+
+    /**
+     * Vertices written by the skinning compute pass.
+     */
+    [[nodiscard]] core::Buffer &SkinnedBuffer();
+
+    [[nodiscard]] size_t VertexBufferCount() const override;
+
+    [[nodiscard]] const core::Buffer *VertexBuffer(size_t index) const override;
+
+    [[nodiscard]] const vox::IndexBufferBinding *IndexBufferBinding() const override;
+
+private:
+    ModelMeshPtr source_;
+    std::unique_ptr<core::Buffer> skinned_buffer_{nullptr};
+};
+
+}  // namespace vox
@@ -0,0 +1,111 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.render/mesh/skinning_manager.h"
+
+#include "vox.base/logging.h"
+#include "vox.base/parallel.h"
+#include "vox.base/tracer.h"
+#include "vox.render/shader/shader_manager.h"
+#include "vox.render/stats/gpu_profiler.h"
+
+namespace vox {
+SkinningManager *SkinningManager::GetSingletonPtr() { return ms_singleton; }
+
+SkinningManager &SkinningManager::GetSingleton() {
+    assert(ms_singleton);
+    return (*ms_singleton);
+}
+
+SkinningManager::SkinningManager(Device &device, RenderContext &render_context)
+    : shader_data_(device), palette_property_("jointPalette") {
+    palette_buffer_ = std::make_unique<StorageBufferArray>(device, render_context, 16 * sizeof(float), 64);
+    shader_data_.SetBufferFunctor(palette_property_, [this]() -> core::Buffer * { return palette_buffer_->Buffer(); });
+
+    skinning_pipeline_ = std::make_unique<PostProcessingPipeline>(render_context, ShaderSource());
+    skinning_pass_ = &skinning_pipeline_->AddPass<PostProcessingComputePass>(
+            ShaderManager::GetSingleton().LoadShader("base/skinning/skinning.comp"));
+    skinning_pass_->SetDebugName("Skinning");
+    skinning_pass_->AttachShaderData(&shader_data_);
+}
+
+const std::vector<GpuSkinnedMeshRenderer *> &SkinningManager::Renderers() const { return renderers_; }
+
+void SkinningManager::AddRenderer(GpuSkinnedMeshRenderer *renderer) {
+    auto iter = std::find(renderers_.begin(), renderers_.end(), renderer);
+    if (iter == renderers_.end()) {
+        renderers_.push_back(renderer);
+    } else {
+        LOGE("Skinned renderer already attached.")
+    }
+}
+
+void SkinningManager::RemoveRenderer(GpuSkinnedMeshRenderer *renderer) {
+    auto iter = std::find(renderers_.begin(), renderers_.end(), renderer);
+    if (iter != renderers_.end()) {
+        renderers_.erase(iter);
+    }
+}
+
+void SkinningManager::Draw(CommandBuffer &command_buffer, RenderTarget &render_target) {
+    VOX_TRACE_SCOPE("Skinning");
+    VOX_GPU_SCOPE(command_buffer, "Skinning", StatIndex::GPU_COMPUTE_TIME);
+
+    active_renderers_.clear();
+    joint_offsets_.clear();
+    uint32_t joint_count = 0;
+    for (auto &renderer : renderers_) {
+        if (renderer->PrepareSkinnedMesh() && renderer->JointCount() > 0) {
+            active_renderers_.push_back(renderer);
+            joint_offsets_.push_back(joint_count);
+            joint_count += static_cast<uint32_t>(renderer->JointCount());
+        }
+    }
+    if (active_renderers_.empty()) {
+        return;
+    }
+
+    // transforms resolve their world matrices lazily through shared parents, which is not thread safe
+    for (auto &renderer : active_renderers_) {
+        renderer->UpdateJointTransforms();
+    }
+
+    auto *palette = reinterpret_cast<float *>(palette_buffer_->Map(joint_count));
+    utility::ParallelFor(
+            0, active_renderers_.size(),
+            [&](size_t i) { active_renderers_[i]->WritePalette(palette + joint_offsets_[i] * 16); }, 4);
+    palette_buffer_->Flush();
+
+    // the skinned buffers may still be read by the vertex fetch of the previous frame
+    BufferMemoryBarrier barrier{};
+    barrier.src_stage_mask = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    barrier.dst_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    barrier.src_access_mask = 0;
+    barrier.dst_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+    command_buffer.GlobalMemoryBarrier(barrier);
+
+    for (size_t i = 0; i < active_renderers_.size(); i++) {
+        auto *renderer = active_renderers_[i];
+        auto *skinned_mesh = renderer->PrepareSkinnedMesh();
+        renderer->SetJointOffset(joint_offsets_[i]);
+
+        skinning_pass_->AttachShaderData(&renderer->shader_data_);
+        skinning_pass_->SetDispatchSize(
+                {(static_cast<uint32_t>(skinned_mesh->VertexCount()) + skinning_group_size_ - 1) / skinning_group_size_,
+                 1, 1});
+        skinning_pipeline_->Draw(command_buffer, render_target);
+        skinning_pass_->DetachShaderData(&renderer->shader_data_);
+    }
+
+    // dispatches write disjoint buffers, a single barrier makes them visible to every following pass
+    barrier.src_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    barrier.dst_stage_mask = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    barrier.src_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dst_access_mask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+    command_buffer.GlobalMemoryBarrier(barrier);
+}
+
+}  // namespace vox
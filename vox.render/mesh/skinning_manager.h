@@ -0,0 +1,61 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include "vox.base/singleton.h"
+#include "vox.render/mesh/gpu_skinned_mesh_renderer.h"
+#include "vox.render/rendering/postprocessing_computepass.h"
+#include "vox.render/rendering/postprocessing_pipeline.h"
+#include "vox.render/rendering/storage_buffer_array.h"
+#include "vox.render/shader/shader_data.h"
+
+namespace vox {
+/**
+ * Skin every GpuSkinnedMeshRenderer once per frame, before the passes which draw them.
+ * The joint matrices of all renderers are packed in one palette buffer per frame in flight, and each renderer is
+ * skinned by a dispatch reading its range of the palette.
+ */
+class SkinningManager : public Singleton<SkinningManager> {
+public:
+    static constexpr uint32_t skinning_group_size_ = 64;
+
+    static SkinningManager &GetSingleton();
+
+    static SkinningManager *GetSingletonPtr();
+
+    SkinningManager(Device &device, RenderContext &render_context);
+
+    [[nodiscard]] const std::vector<GpuSkinnedMeshRenderer *> &Renderers() const;
+
+    void AddRenderer(GpuSkinnedMeshRenderer *renderer);
+
+    void RemoveRenderer(GpuSkinnedMeshRenderer *renderer);
+
+    /**
+     * Build the joint palette and record the skinning dispatches, outside a render pass.
+     */
+    void Draw(CommandBuffer &command_buffer, RenderTarget &render_target);
+
+private:
+    std::vector<GpuSkinnedMeshRenderer *> renderers_{};
+    std::vector<GpuSkinnedMeshRenderer *> active_renderers_{};
+    std::vector<uint32_t> joint_offsets_{};
+
+    // one palette per frame in flight, the CPU writes one while the GPU reads the others
+    std::unique_ptr<StorageBufferArray> palette_buffer_{nullptr};
+
+    ShaderData shader_data_;
+    const ShaderProperty palette_property_;
+
+    PostProcessingComputePass *skinning_pass_{nullptr};
+    std::unique_ptr<PostProcessingPipeline> skinning_pipeline_{nullptr};
+};
+
+template <>
+inline SkinningManager *Singleton<SkinningManager>::ms_singleton{nullptr};
+
+}  // namespace vox
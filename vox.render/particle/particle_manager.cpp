@@ -6,10 +6,57 @@
 
 #include "vox.render/particle/particle_manager.h"
 
+#include <algorithm>
+
 #include "vox.base/logging.h"
+#include "vox.render/camera.h"
+#include "vox.render/shader/internal_variant_name.h"
 #include "vox.render/shader/shader_manager.h"
+#include "vox.render/stats/gpu_profiler.h"
 
 namespace vox {
+namespace {
+uint32_t ClosestPowerOfTwo(uint32_t const n) {
+    uint32_t r = 1u;
+    while (r < n) r <<= 1u;
+    return r;
+}
+
+struct EmissionConstants {
+    uint32_t emitter_count;
+    uint32_t total_emit_count;
+};
+
+struct PrepareConstants {
+    uint32_t emitter_count;
+    uint32_t batch_count;
+};
+
+struct SimulationConstants {
+    uint32_t first_emitter;
+    uint32_t emitter_count;
+};
+
+struct SortConstants {
+    uint32_t emitter_index;
+    uint32_t sort_base;
+    uint32_t sort_count;
+};
+
+struct SortStepConstants {
+    uint32_t dp_base;
+    uint32_t read_base;
+    uint32_t write_base;
+    uint32_t pair_count;
+    uint32_t block_width;
+    uint32_t max_block_width;
+};
+
+// 16 bytes per emitter and per batch: TCounter, VkDispatchIndirectCommand padded, VkDrawIndirectCommand
+constexpr uint32_t kCounterSize = 4 * sizeof(uint32_t);
+
+}  // namespace
+
 ParticleManager *ParticleManager::GetSingletonPtr() { return ms_singleton; }
 
 ParticleManager &ParticleManager::GetSingleton() {
@@ -17,14 +64,109 @@ ParticleManager &ParticleManager::GetSingleton() {
     return (*ms_singleton);
 }
 //-----------------------------------------------------------------------
-ParticleManager::ParticleManager(Device &device, RenderContext &render_context) {
+ParticleManager::ParticleManager(Device &device, RenderContext &render_context)
+    : device_(device),
+      render_context_(render_context),
+      shader_data_(device),
+      mt_(std::random_device{}()),
+      emitter_buffer_prop_("particleEmitters"),
+      batch_buffer_prop_("particleBatches"),
+      read_particle_buffer_prop_("readConsumeBuffer"),
+      write_particle_buffer_prop_("writeConsumeBuffer"),
+      counter_buffer_prop_("particleCounters"),
+      dispatch_args_buffer_prop_("particleDispatchArgs"),
+      draw_args_buffer_prop_("particleDrawArgs"),
+      readback_buffer_prop_("particleReadback"),
+      dp_buffer_prop_("dpBuffer"),
+      sort_indices_buffer_prop_("sortIndicesBuffer") {
+    static_assert(sizeof(EmitterData) == 96, "EmitterData must match TEmitter");
+    emitter_buffer_ = std::make_unique<StorageBufferArray>(device, render_context, sizeof(EmitterData));
+    batch_buffer_ = std::make_unique<StorageBufferArray>(device, render_context, 2 * sizeof(uint32_t));
+    // buffers are sized by UpdateLayout, they exist beforehand since the functors are dereferenced when binding
+    for (auto &buffer : particle_buffers_) {
+        buffer = std::make_unique<core::Buffer>(device, sizeof(ParticleRenderer::TParticle),
+                                                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+    }
+    counter_buffer_ = std::make_unique<core::Buffer>(device, kCounterSize,
+                                                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                                             VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                     VMA_MEMORY_USAGE_GPU_ONLY);
+    dispatch_args_buffer_ = std::make_unique<core::Buffer>(
+            device, kCounterSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY);
+    draw_args_buffer_ = std::make_unique<core::Buffer>(device, kCounterSize,
+                                                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                                               VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                                               VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                       VMA_MEMORY_USAGE_GPU_ONLY);
+    readback_buffers_.resize(std::max<size_t>(render_context.GetRenderFrames().size(), 1));
+    for (auto &buffer : readback_buffers_) {
+        buffer = std::make_unique<core::Buffer>(device, sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                VMA_MEMORY_USAGE_GPU_TO_CPU);
+    }
+    dp_buffer_ = std::make_unique<core::Buffer>(device, sizeof(float), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                VMA_MEMORY_USAGE_GPU_ONLY);
+    sort_indices_buffer_ = std::make_unique<core::Buffer>(device, 2 * sizeof(uint32_t),
+                                                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+
+    shader_data_.SetBufferFunctor(emitter_buffer_prop_, [this]() -> core::Buffer * { return EmitterBuffer(); });
+    shader_data_.SetBufferFunctor(batch_buffer_prop_, [this]() -> core::Buffer * { return batch_buffer_->Buffer(); });
+    shader_data_.SetBufferFunctor(read_particle_buffer_prop_,
+                                  [this]() -> core::Buffer * { return particle_buffers_[read_].get(); });
+    shader_data_.SetBufferFunctor(write_particle_buffer_prop_,
+                                  [this]() -> core::Buffer * { return particle_buffers_[1 - read_].get(); });
+    shader_data_.SetBufferFunctor(counter_buffer_prop_, [this]() -> core::Buffer * { return counter_buffer_.get(); });
+    shader_data_.SetBufferFunctor(dispatch_args_buffer_prop_,
+                                  [this]() -> core::Buffer * { return dispatch_args_buffer_.get(); });
+    shader_data_.SetBufferFunctor(draw_args_buffer_prop_,
+                                  [this]() -> core::Buffer * { return draw_args_buffer_.get(); });
+    shader_data_.SetBufferFunctor(readback_buffer_prop_,
+                                  [this]() -> core::Buffer * { return readback_buffers_[readback_frame_].get(); });
+    shader_data_.SetBufferFunctor(dp_buffer_prop_, [this]() -> core::Buffer * { return dp_buffer_.get(); });
+    shader_data_.SetBufferFunctor(sort_indices_buffer_prop_,
+                                  [this]() -> core::Buffer * { return sort_indices_buffer_.get(); });
+
     emitter_pipeline_ = std::make_unique<PostProcessingPipeline>(render_context, ShaderSource());
     emitter_pass_ = &emitter_pipeline_->AddPass<PostProcessingComputePass>(
             ShaderManager::GetSingleton().LoadShader("base/particle/particle_emission.comp"));
+    emitter_pass_->SetDebugName("Particle Emission");
+    emitter_pass_->AttachShaderData(&shader_data_);
+
+    prepare_pipeline_ = std::make_unique<PostProcessingPipeline>(render_context, ShaderSource());
+    prepare_pass_ = &prepare_pipeline_->AddPass<PostProcessingComputePass>(
+            ShaderManager::GetSingleton().LoadShader("base/particle/particle_prepare.comp"));
+    prepare_pass_->SetDebugName("Particle Prepare");
+    prepare_pass_->AttachShaderData(&shader_data_);
 
     simulation_pipeline_ = std::make_unique<PostProcessingPipeline>(render_context, ShaderSource());
     simulation_pass_ = &simulation_pipeline_->AddPass<PostProcessingComputePass>(
             ShaderManager::GetSingleton().LoadShader("base/particle/particle_simulation.comp"));
+    simulation_pass_->SetDebugName("Particle Simulation");
+    simulation_pass_->AttachShaderData(&shader_data_);
+
+    finalize_pipeline_ = std::make_unique<PostProcessingPipeline>(render_context, ShaderSource());
+    finalize_pass_ = &finalize_pipeline_->AddPass<PostProcessingComputePass>(
+            ShaderManager::GetSingleton().LoadShader("base/particle/particle_finalize.comp"));
+    finalize_pass_->SetDebugName("Particle Finalize");
+    finalize_pass_->AttachShaderData(&shader_data_);
+
+    dp_pipeline_ = std::make_unique<PostProcessingPipeline>(render_context, ShaderSource());
+    dp_pass_ = &dp_pipeline_->AddPass<PostProcessingComputePass>(
+            ShaderManager::GetSingleton().LoadShader("base/particle/particle_calculate_dp.comp"));
+    dp_pass_->SetDebugName("Particle Depth");
+    dp_pass_->AttachShaderData(&shader_data_);
+
+    fill_indices_pipeline_ = std::make_unique<PostProcessingPipeline>(render_context, ShaderSource());
+    fill_indices_pass_ = &fill_indices_pipeline_->AddPass<PostProcessingComputePass>(
+            ShaderManager::GetSingleton().LoadShader("base/particle/particle_fill_indices.comp"));
+    fill_indices_pass_->SetDebugName("Particle Fill Indices");
+    fill_indices_pass_->AttachShaderData(&shader_data_);
+
+    sort_step_pipeline_ = std::make_unique<PostProcessingPipeline>(render_context, ShaderSource());
+    sort_step_pass_ = &sort_step_pipeline_->AddPass<PostProcessingComputePass>(
+            ShaderManager::GetSingleton().LoadShader("base/particle/particle_sort_step.comp"));
+    sort_step_pass_->SetDebugName("Particle Sort Step");
+    sort_step_pass_->AttachShaderData(&shader_data_);
 }
 
 const std::vector<ParticleRenderer *> &ParticleManager::Particles() const { return particles_; }
@@ -33,6 +175,7 @@ void ParticleManager::AddParticle(ParticleRenderer *particle) {
     auto iter = std::find(particles_.begin(), particles_.end(), particle);
     if (iter == particles_.end()) {
         particles_.push_back(particle);
+        layout_dirty_ = true;
     } else {
         LOGE("Particle already attached.")
     }
@@ -42,6 +185,17 @@ void ParticleManager::RemoveParticle(ParticleRenderer *particle) {
     auto iter = std::find(particles_.begin(), particles_.end(), particle);
     if (iter != particles_.end()) {
         particles_.erase(iter);
+        layout_dirty_ = true;
+    }
+}
+
+void ParticleManager::SetCamera(Camera *camera) {
+    if (camera_) {
+        dp_pass_->DetachShaderData(&camera_->shader_data_);
+    }
+    camera_ = camera;
+    if (camera_) {
+        dp_pass_->AttachShaderData(&camera_->shader_data_);
     }
 }
 
@@ -49,49 +203,275 @@ float ParticleManager::TimeStepFactor() const { return time_step_factor_; }
 
 void ParticleManager::SetTimeStepFactor(float factor) { time_step_factor_ = factor; }
 
-void ParticleManager::Draw(CommandBuffer &command_buffer, RenderTarget &render_target) {
-    for (auto &particle : particles_) {
-        /* Max number of particles able to be spawned. */
-        uint32_t const kNumDeadParticles = ParticleRenderer::k_max_particle_count_ - particle->NumAliveParticles();
-        /* Number of particles to be emitted. */
-        uint32_t const kEmitCount = std::min(ParticleRenderer::k_batch_emit_count_, kNumDeadParticles);  //
-        Emission(kEmitCount, particle, command_buffer, render_target);
-        Simulation(particle, command_buffer, render_target);
+core::Buffer *ParticleManager::ParticleBuffer() { return particle_buffers_[read_].get(); }
+
+core::Buffer *ParticleManager::EmitterBuffer() { return emitter_buffer_->Buffer(); }
+
+core::Buffer *ParticleManager::SortIndicesBuffer() { return sort_indices_buffer_.get(); }
+
+core::Buffer *ParticleManager::DrawArgsBuffer() { return draw_args_buffer_.get(); }
+
+void ParticleManager::SetLayoutDirty() { layout_dirty_ = true; }
+
+void ParticleManager::UpdateLayout(CommandBuffer &command_buffer) {
+    layout_dirty_ = false;
+    // the buffers are shared by the frames in flight
+    device_.WaitIdle();
+
+    // emitters sharing a vector field are consecutive, and simulated by the same dispatch
+    std::stable_sort(particles_.begin(), particles_.end(), [](ParticleRenderer *a, ParticleRenderer *b) {
+        return a->VectorFieldTexture().get() < b->VectorFieldTexture().get();
+    });
+
+    batches_.clear();
+    emitters_.resize(particles_.size());
+    uint32_t particle_count = 0;
+    uint32_t sort_count = 0;
+    for (uint32_t i = 0; i < particles_.size(); i++) {
+        auto *particle = particles_[i];
+        if (batches_.empty() || batches_.back().vector_field != particle->VectorFieldTexture()) {
+            Batch batch{i, 0, particle->VectorFieldTexture(), std::make_unique<ShaderData>(device_)};
+            if (batch.vector_field) {
+                batch.shader_data->AddDefine(NEED_PARTICLE_VECTOR_FIELD);
+                batch.shader_data->SetSampledTexture(
+                        "vectorFieldSampler", batch.vector_field->GetVkImageView(VK_IMAGE_VIEW_TYPE_3D), nullptr);
+            }
+            batches_.push_back(std::move(batch));
+        }
+        batches_.back().emitter_count++;
+
+        auto &emitter = emitters_[i];
+        emitter.particle_base = particle_count;
+        emitter.capacity = particle->Capacity();
+        emitter.sort_base = sort_count;
+        particle_count += emitter.capacity;
+        if (particle->IsSorted()) {
+            // both halves of the ping-pong sort
+            sort_count += 2 * ClosestPowerOfTwo(emitter.capacity);
+        }
+    }
+
+    batch_ranges_.clear();
+    for (const auto &batch : batches_) {
+        batch_ranges_.push_back(batch.first_emitter);
+        batch_ranges_.push_back(batch.emitter_count);
+    }
+
+    const size_t kEmitterCount = std::max<size_t>(particles_.size(), 1);
+    for (auto &buffer : particle_buffers_) {
+        buffer = std::make_unique<core::Buffer>(
+                device_, std::max(particle_count, 1u) * sizeof(ParticleRenderer::TParticle),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+    }
+    read_ = 0;
+    counter_buffer_ = std::make_unique<core::Buffer>(
+            device_, kEmitterCount * kCounterSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY);
+    dispatch_args_buffer_ = std::make_unique<core::Buffer>(
+            device_, std::max<size_t>(batches_.size(), 1) * kCounterSize,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+    draw_args_buffer_ = std::make_unique<core::Buffer>(device_, kEmitterCount * kCounterSize,
+                                                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                                               VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                                               VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                       VMA_MEMORY_USAGE_GPU_ONLY);
+    for (auto &buffer : readback_buffers_) {
+        buffer = std::make_unique<core::Buffer>(device_, kEmitterCount * sizeof(uint32_t),
+                                                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU);
+        std::fill_n(reinterpret_cast<uint32_t *>(buffer->Map()), kEmitterCount, 0u);
+    }
+    dp_buffer_ = std::make_unique<core::Buffer>(device_, std::max(sort_count, 1u) * sizeof(float),
+                                                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+    sort_indices_buffer_ = std::make_unique<core::Buffer>(device_, std::max(sort_count, 2u) * sizeof(uint32_t),
+                                                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                          VMA_MEMORY_USAGE_GPU_ONLY);
+
+    // no particle alive, no instance drawn
+    const std::vector<uint8_t> kZeros(kEmitterCount * kCounterSize, 0);
+    command_buffer.UpdateBuffer(*counter_buffer_, 0, kZeros);
+    command_buffer.UpdateBuffer(*draw_args_buffer_, 0, kZeros);
+    BufferMemoryBarrier barrier;
+    barrier.src_stage_mask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    barrier.dst_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+    barrier.src_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dst_access_mask =
+            VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    command_buffer.GlobalMemoryBarrier(barrier);
+
+    for (uint32_t i = 0; i < particles_.size(); i++) {
+        particles_[i]->num_alive_particles_ = 0;
+        particles_[i]->SetEmitterIndex(i);
     }
 }
 
-void ParticleManager::Emission(const uint32_t count,
-                               ParticleRenderer *particle,
-                               CommandBuffer &command_buffer,
-                               RenderTarget &render_target) {
-    /* Emit only if a minimum count is reached. */
-    if (!count) {
+void ParticleManager::Draw(CommandBuffer &command_buffer, RenderTarget &render_target) {
+    if (layout_dirty_) {
+        UpdateLayout(command_buffer);
+    }
+    if (particles_.empty()) {
         return;
     }
-    if (count < ParticleRenderer::k_batch_emit_count_) {
-        // return;
+    VOX_GPU_SCOPE(command_buffer, "Particles", StatIndex::GPU_COMPUTE_TIME);
+
+    // the readback of this frame slot was written by the frame whose fence was just waited on
+    readback_frame_ = render_context_.GetActiveFrameIndex() % readback_buffers_.size();
+    auto &readback = *readback_buffers_[readback_frame_];
+    readback.Invalidate();
+    const auto *kAliveCounts = reinterpret_cast<const uint32_t *>(readback.GetData());
+
+    const auto kEmitterCount = static_cast<uint32_t>(particles_.size());
+    uint32_t total_emit_count = 0;
+    for (uint32_t i = 0; i < kEmitterCount; i++) {
+        auto *particle = particles_[i];
+        auto &emitter = emitters_[i];
+        particle->num_alive_particles_ = kAliveCounts[i];
+
+        emitter.emission = particle->emitter_data_;
+        emitter.simulation = particle->simulation_data_;
+        emitter.flags = particle->flags_;
+        emitter.seed = mt_();
+
+        // the count read back is late, particles emitted over the capacity are dropped by the shader
+        const uint32_t kDeadCount = emitter.capacity - std::min(kAliveCounts[i], emitter.capacity);
+        emitter.emission.emit_count = std::min(particle->EmitCount(), kDeadCount);
+        emitter.emission.emit_offset = total_emit_count;
+        total_emit_count += emitter.emission.emit_count;
+
+        // the sort covers the particles alive a few frames ago, the others are drawn after them unsorted
+        emitter.sort_count = 0;
+        if (particle->IsSorted() && camera_) {
+            emitter.sort_count = std::min(ClosestPowerOfTwo(std::max(kAliveCounts[i], 1u)),
+                                          ClosestPowerOfTwo(emitter.capacity));
+            uint32_t log2 = 0;
+            while ((1u << log2) < emitter.sort_count) log2++;
+            // the bitonic sort runs log2 * (log2 + 1) / 2 steps, the last one writes the second half if odd
+            if ((log2 * (log2 + 1) / 2) & 1u) {
+                emitter.flags |= ParticleRenderer::SORTED_SECOND;
+            }
+        }
+    }
+    emitter_buffer_->Update(emitters_);
+    batch_buffer_->UpdateChanged(batch_ranges_.data(), batches_.size());
+
+    BufferMemoryBarrier barrier;
+    // the particles and the draw arguments of the previous frame are still read by its draws
+    barrier.src_stage_mask = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+    barrier.dst_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    barrier.src_access_mask = 0;
+    barrier.dst_access_mask = 0;
+    command_buffer.GlobalMemoryBarrier(barrier);
+
+    barrier.src_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    barrier.src_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    if (total_emit_count > 0) {
+        emitter_pass_->SetPushConstants(EmissionConstants{kEmitterCount, total_emit_count});
+        emitter_pass_->SetDispatchSize({ThreadsGroupCount(total_emit_count), 1, 1});
+        emitter_pipeline_->Draw(command_buffer, render_target);
+        command_buffer.GlobalMemoryBarrier(barrier);
+    }
+
+    const auto kBatchCount = static_cast<uint32_t>(batches_.size());
+    prepare_pass_->SetPushConstants(PrepareConstants{kEmitterCount, kBatchCount});
+    prepare_pass_->SetDispatchSize({(kBatchCount + 63) / 64, 1, 1});
+    prepare_pipeline_->Draw(command_buffer, render_target);
+    barrier.dst_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+    barrier.dst_access_mask =
+            VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    command_buffer.GlobalMemoryBarrier(barrier);
+
+    // one indirect dispatch per vector field, sized by the particles alive on the GPU
+    for (uint32_t i = 0; i < kBatchCount; i++) {
+        auto &batch = batches_[i];
+        simulation_pass_->AttachShaderData(batch.shader_data.get());
+        simulation_pass_->SetPushConstants(SimulationConstants{batch.first_emitter, batch.emitter_count});
+        simulation_pass_->SetIndirectDispatch(dispatch_args_buffer_.get(), i * kCounterSize);
+        simulation_pipeline_->Draw(command_buffer, render_target);
+        simulation_pass_->DetachShaderData(batch.shader_data.get());
+    }
+    barrier.dst_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    command_buffer.GlobalMemoryBarrier(barrier);
+
+    finalize_pass_->SetPushConstants(kEmitterCount);
+    finalize_pass_->SetDispatchSize({ThreadsGroupCount(kEmitterCount), 1, 1});
+    finalize_pipeline_->Draw(command_buffer, render_target);
+    // the particles written are read by the sort and the draws
+    read_ = 1 - read_;
+    barrier.dst_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_HOST_BIT;
+    barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_HOST_READ_BIT;
+    command_buffer.GlobalMemoryBarrier(barrier);
+
+    for (uint32_t i = 0; i < kEmitterCount; i++) {
+        if (emitters_[i].sort_count > 0) {
+            Sort(i, command_buffer, render_target);
+        }
     }
-    particle->SetEmitCount(count);
 
-    emitter_pass_->AttachShaderData(&particle->shader_data_);
-    auto n_groups = ThreadsGroupCount(count);
-    emitter_pass_->SetDispatchSize({n_groups, 1, 1});
-    emitter_pipeline_->Draw(command_buffer, render_target);
-    emitter_pass_->DetachShaderData(&particle->shader_data_);
+    barrier.dst_stage_mask = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+    barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    command_buffer.GlobalMemoryBarrier(barrier);
 }
 
-void ParticleManager::Simulation(ParticleRenderer *particle,
-                                 CommandBuffer &command_buffer,
-                                 RenderTarget &render_target) {
-    if (particle->NumAliveParticles() == 0u) {
+void ParticleManager::SortForCamera(CommandBuffer &command_buffer, RenderTarget &render_target) {
+    if (particles_.empty() || !camera_) {
         return;
     }
+    VOX_GPU_SCOPE(command_buffer, "Particle Sort", StatIndex::GPU_COMPUTE_TIME);
+
+    // the indices are still read by the draws recorded for the previous camera
+    BufferMemoryBarrier barrier;
+    barrier.src_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+    barrier.dst_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    barrier.src_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    command_buffer.GlobalMemoryBarrier(barrier);
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(emitters_.size()); i++) {
+        if (emitters_[i].sort_count > 0) {
+            Sort(i, command_buffer, render_target);
+        }
+    }
+
+    barrier.src_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    barrier.dst_stage_mask = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+    barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT;
+    command_buffer.GlobalMemoryBarrier(barrier);
+}
 
-    simulation_pass_->AttachShaderData(&particle->shader_data_);
-    auto n_groups = ThreadsGroupCount(particle->NumAliveParticles());
-    simulation_pass_->SetDispatchSize({n_groups, 1, 1});
-    simulation_pipeline_->Draw(command_buffer, render_target);
-    simulation_pass_->DetachShaderData(&particle->shader_data_);
+void ParticleManager::Sort(uint32_t emitter_index, CommandBuffer &command_buffer, RenderTarget &render_target) {
+    const auto &emitter = emitters_[emitter_index];
+    const uint32_t kSortCount = emitter.sort_count;
+    const uint32_t kGroupCount = ThreadsGroupCount(kSortCount);
+
+    BufferMemoryBarrier barrier;
+    barrier.src_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    barrier.dst_stage_mask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    barrier.src_access_mask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dst_access_mask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    const SortConstants kConstants{emitter_index, emitter.sort_base, kSortCount};
+    dp_pass_->SetPushConstants(kConstants);
+    dp_pass_->SetDispatchSize({kGroupCount, 1, 1});
+    dp_pipeline_->Draw(command_buffer, render_target);
+    fill_indices_pass_->SetPushConstants(kConstants);
+    fill_indices_pass_->SetDispatchSize({kGroupCount, 1, 1});
+    fill_indices_pipeline_->Draw(command_buffer, render_target);
+    command_buffer.GlobalMemoryBarrier(barrier);
+
+    // bitonic sort, every step swaps the halves of the index range
+    SortStepConstants step{emitter.sort_base, emitter.sort_base, emitter.sort_base + kSortCount, kSortCount / 2, 0, 0};
+    sort_step_pass_->SetDispatchSize({ThreadsGroupCount(step.pair_count), 1, 1});
+    for (uint32_t max_block_width = 2; max_block_width <= kSortCount; max_block_width <<= 1u) {
+        for (uint32_t block_width = max_block_width; block_width >= 2; block_width >>= 1u) {
+            step.block_width = block_width;
+            step.max_block_width = max_block_width;
+            sort_step_pass_->SetPushConstants(step);
+            sort_step_pipeline_->Draw(command_buffer, render_target);
+            command_buffer.GlobalMemoryBarrier(barrier);
+            std::swap(step.read_base, step.write_base);
+        }
+    }
 }
 
 }  // namespace vox
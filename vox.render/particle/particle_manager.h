@@ -6,12 +6,25 @@
 
 #pragma once
 
+#include <random>
+
 #include "vox.base/singleton.h"
 #include "vox.render/particle/particle_renderer.h"
 #include "vox.render/rendering/postprocessing_computepass.h"
 #include "vox.render/rendering/postprocessing_pipeline.h"
+#include "vox.render/rendering/storage_buffer_array.h"
+#include "vox.render/shader/shader_data.h"
 
 namespace vox {
+class Camera;
+
+/**
+ * Simulates the particles of every emitter on the GPU.
+ * The particles of all emitters live in a single pair of buffers, each emitter owning a range of its capacity, so a
+ * frame records a fixed number of dispatches: one emission, one simulation per vector field and one finalization.
+ * The simulation is dispatched indirectly with the particle counts left on the GPU, which also write the indirect draw
+ * of each emitter. Sorted emitters are sorted back to front with a bitonic sort sized by the alive count read back.
+ */
 class ParticleManager : public Singleton<ParticleManager> {
 public:
     static constexpr uint32_t particles_kernel_group_width_ = 256;
@@ -36,29 +49,131 @@ public:
 
     void RemoveParticle(ParticleRenderer *particle);
 
+    /**
+     * Camera the sorted emitters are sorted for.
+     */
+    void SetCamera(Camera *camera);
+
     void Draw(CommandBuffer &command_buffer, RenderTarget &render_target);
 
+    /**
+     * Sort the particles of the last Draw again for the current camera, without simulating them.
+     */
+    void SortForCamera(CommandBuffer &command_buffer, RenderTarget &render_target);
+
 public:
     [[nodiscard]] float TimeStepFactor() const;
 
     void SetTimeStepFactor(float factor);
 
-private:
-    void Emission(uint32_t count,
-                  ParticleRenderer *particle,
-                  CommandBuffer &command_buffer,
-                  RenderTarget &render_target);
+public:
+    /**
+     * Particles of every emitter, written by the last simulation.
+     */
+    [[nodiscard]] core::Buffer *ParticleBuffer();
+
+    [[nodiscard]] core::Buffer *EmitterBuffer();
 
-    void Simulation(ParticleRenderer *particle, CommandBuffer &command_buffer, RenderTarget &render_target);
+    [[nodiscard]] core::Buffer *SortIndicesBuffer();
+
+    /**
+     * One VkDrawIndirectCommand per emitter.
+     */
+    [[nodiscard]] core::Buffer *DrawArgsBuffer();
+
+    /**
+     * The emitter ranges are laid out again before the next simulation, the particles alive are discarded.
+     */
+    void SetLayoutDirty();
+
+private:
+    /**
+     * Matches TEmitter of particle_config.h.
+     */
+    struct EmitterData {
+        ParticleRenderer::ParticleEmitterData emission;
+        ParticleRenderer::ParticleSimulationData simulation;
+        uint32_t flags;
+        uint32_t particle_base;
+        uint32_t capacity;
+        uint32_t sort_base;
+        uint32_t sort_count;
+        uint32_t seed;
+        uint32_t pad[2];
+    };
+
+    /**
+     * Emitters simulated by the same dispatch, they share a vector field.
+     */
+    struct Batch {
+        uint32_t first_emitter;
+        uint32_t emitter_count;
+        std::shared_ptr<Texture> vector_field;
+        std::unique_ptr<ShaderData> shader_data;
+    };
+
+    void UpdateLayout(CommandBuffer &command_buffer);
+
+    void Sort(uint32_t emitter_index, CommandBuffer &command_buffer, RenderTarget &render_target);
 
 private:
+    Device &device_;
+    RenderContext &render_context_;
+    Camera *camera_{nullptr};
+
     std::vector<ParticleRenderer *> particles_{};
     float time_step_factor_ = 1.0f;
 
+    ShaderData shader_data_;
+    std::mt19937 mt_;
+
+    // layout
+    bool layout_dirty_ = true;
+    std::vector<Batch> batches_{};
+    std::vector<uint32_t> batch_ranges_{};
+    std::vector<EmitterData> emitters_{};
+    std::unique_ptr<StorageBufferArray> emitter_buffer_{nullptr};
+    const ShaderProperty emitter_buffer_prop_;
+    std::unique_ptr<StorageBufferArray> batch_buffer_{nullptr};
+    const ShaderProperty batch_buffer_prop_;
+
+    uint32_t read_ = 0;
+    std::unique_ptr<core::Buffer> particle_buffers_[2] = {nullptr, nullptr};
+    const ShaderProperty read_particle_buffer_prop_;
+    const ShaderProperty write_particle_buffer_prop_;
+    std::unique_ptr<core::Buffer> counter_buffer_{nullptr};
+    const ShaderProperty counter_buffer_prop_;
+    std::unique_ptr<core::Buffer> dispatch_args_buffer_{nullptr};
+    const ShaderProperty dispatch_args_buffer_prop_;
+    std::unique_ptr<core::Buffer> draw_args_buffer_{nullptr};
+    const ShaderProperty draw_args_buffer_prop_;
+
+    // alive counts, read back once the fence of the frame is signaled
+    uint32_t readback_frame_ = 0;
+    std::vector<std::unique_ptr<core::Buffer>> readback_buffers_{};
+    const ShaderProperty readback_buffer_prop_;
+
+    // sort
+    std::unique_ptr<core::Buffer> dp_buffer_{nullptr};
+    const ShaderProperty dp_buffer_prop_;
+    std::unique_ptr<core::Buffer> sort_indices_buffer_{nullptr};
+    const ShaderProperty sort_indices_buffer_prop_;
+
     PostProcessingComputePass *emitter_pass_{nullptr};
     std::unique_ptr<PostProcessingPipeline> emitter_pipeline_{nullptr};
+    PostProcessingComputePass *prepare_pass_{nullptr};
+    std::unique_ptr<PostProcessingPipeline> prepare_pipeline_{nullptr};
     PostProcessingComputePass *simulation_pass_{nullptr};
     std::unique_ptr<PostProcessingPipeline> simulation_pipeline_{nullptr};
+    PostProcessingComputePass *finalize_pass_{nullptr};
+    std::unique_ptr<PostProcessingPipeline> finalize_pipeline_{nullptr};
+
+    PostProcessingComputePass *dp_pass_{nullptr};
+    std::unique_ptr<PostProcessingPipeline> dp_pipeline_{nullptr};
+    PostProcessingComputePass *fill_indices_pass_{nullptr};
+    std::unique_ptr<PostProcessingPipeline> fill_indices_pipeline_{nullptr};
+    PostProcessingComputePass *sort_step_pass_{nullptr};
+    std::unique_ptr<PostProcessingPipeline> sort_step_pipeline_{nullptr};
 };
 
 template <>
@@ -57,7 +57,7 @@ public:
 
 private:
     ParticleData particle_data_;
-    const std::string particle_data_prop_;
+    const ShaderProperty particle_data_prop_;
 };
 
 }  // namespace vox
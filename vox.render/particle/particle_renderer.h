@@ -6,8 +6,6 @@
 
 #pragma once
 
-#include <random>
-
 #include "vox.render/mesh/buffer_mesh.h"
 #include "vox.render/particle/particle_material.h"
 #include "vox.render/renderer.h"
@@ -22,8 +20,8 @@ public:
 
     // [USER DEFINED]
     static constexpr float k_default_simulation_volume_size_ = 32.0f;
-    static constexpr uint32_t k_max_particle_count_ = (1u << 15u);
-    static constexpr uint32_t k_batch_emit_count_ = std::max(256u, (k_max_particle_count_ >> 4u));
+    static constexpr uint32_t k_default_capacity_ = (1u << 15u);
+    static constexpr uint32_t k_min_emit_count_ = 256u;
 
     enum class EmitterType : uint32_t { POINT, DISK, SPHERE, BALL, K_NUM_EMITTER_TYPE };
 
@@ -46,7 +44,8 @@ public:
         float emitter_radius;
         float particle_min_age;
         float particle_max_age;
-        float pad;
+        // first emission thread, written by the manager
+        uint32_t emit_offset;
     };
 
     struct ParticleSimulationData {
@@ -64,8 +63,26 @@ public:
 
     ParticleMaterial &Material();
 
+    /**
+     * Particles alive at the end of the last simulation read back, a few frames late.
+     */
     [[nodiscard]] uint32_t NumAliveParticles() const;
 
+    /**
+     * Maximum number of particles, rounded up to the kernel group width.
+     * Changing it reallocates the particles of every emitter, which restart empty.
+     */
+    [[nodiscard]] uint32_t Capacity() const;
+
+    void SetCapacity(uint32_t capacity);
+
+    /**
+     * Sorted emitters are drawn back to front, the sort runs on the GPU every frame.
+     */
+    [[nodiscard]] bool IsSorted() const;
+
+    void SetSorted(bool sorted);
+
 public:
     void Render(std::vector<RenderElement> &opaque_queue,
                 std::vector<RenderElement> &alpha_test_queue,
@@ -113,6 +130,9 @@ public:
     void SetVelocityFactor(float factor);
 
 public:
+    /**
+     * Particles emitted by each simulation step, the emission stops once the capacity is reached.
+     */
     [[nodiscard]] uint32_t EmitCount() const;
 
     void SetEmitCount(uint32_t count);
@@ -146,9 +166,12 @@ private:
 
     void OnDisable() override;
 
-    void AllocBuffer();
+    /**
+     * Index of the emitter in the buffers of the manager, selects the draw arguments and the particle range.
+     */
+    void SetEmitterIndex(uint32_t index);
 
-    void GenerateRandomValues();
+    friend class ParticleManager;
 
 public:
     /**
@@ -168,40 +191,24 @@ public:
 
 private:
     uint32_t num_alive_particles_ = 0;
+    uint32_t capacity_ = k_default_capacity_;
+    bool is_sorted_ = false;
+    uint32_t emitter_index_ = 0;
+    const ShaderProperty emitter_index_prop_;
+    const ShaderProperty particle_buffer_prop_;
+    const ShaderProperty emitter_buffer_prop_;
+    const ShaderProperty sort_indices_buffer_prop_;
 
     std::shared_ptr<BufferMesh> mesh_{nullptr};
     std::shared_ptr<ParticleMaterial> material_{nullptr};
 
-    std::random_device random_device_;
-    std::mt19937 mt_;
-    float min_value_ = 0.0;
-    float max_value_ = 1.0;
-    std::vector<float> random_vec_{};
-    const std::string random_buffer_prop_;
-
     ParticleSimulationData simulation_data_{};
-    const std::string simulation_data_prop_;
+    ParticleEmitterData emitter_data_{};
 
-    ParticleEmitterData emitter_data_;
-    const std::string emitter_data_prop_;
+    // matches PARTICLE_FLAG_* of particle_config.h
+    enum EmitterFlag : uint32_t { SCATTERING = 0x1, CURL_NOISE = 0x2, VELOCITY_CONTROL = 0x4, SORTED_SECOND = 0x8 };
+    uint32_t flags_ = 0;
 
     std::shared_ptr<Texture> vector_field_texture_{nullptr};
-    const std::string vector_field_texture_prop_;
-
-private:
-    uint32_t read_ = 0;
-    uint32_t write_ = 1;
-    std::unique_ptr<core::Buffer> atomic_buffer_[2] = {nullptr, nullptr};
-    const std::string read_atomic_buffer_prop_;
-    const std::string write_atomic_buffer_prop_;
-
-    std::unique_ptr<core::Buffer> append_consume_buffer_[2] = {nullptr, nullptr};
-    const std::string read_consume_buffer_prop_;
-    const std::string write_consume_buffer_prop_;
-
-    std::unique_ptr<core::Buffer> dp_buffer_{nullptr};
-    const std::string dp_buffer_prop_;
-    std::unique_ptr<core::Buffer> sort_indices_buffer_{nullptr};
-    const std::string sort_indices_buffer_prop_;
 };
 }  // namespace vox
@@ -147,19 +147,51 @@ void PhysicsManager::SetGravity(const Vector3F &value) {
 }
 
 void PhysicsManager::Update(float delta_time) {
+    StartSimulation(delta_time);
+    FetchResults();
+}
+
+void PhysicsManager::StartSimulation(float delta_time) {
+    if (simulating_) {
+        FetchResults();
+    }
+
     auto simulate_time = delta_time + rest_time_;
     auto step = static_cast<uint32_t>(std::floor(std::min(max_sum_time_step_, simulate_time) / fixed_time_step_));
     rest_time_ = simulate_time - static_cast<float>(step) * fixed_time_step_;
-    for (uint32_t i = 0; i < step; i++) {
-        for (auto &script : on_physics_update_scripts_) {
-            script->OnPhysicsUpdate();
-        }
-        CallColliderOnUpdate();
-        native_physics_manager_->simulate(fixed_time_step_);
-        native_physics_manager_->fetchResults(true);
-        CallColliderOnLateUpdate();
-        CallCharacterControllerOnLateUpdate();
+    pending_steps_ = step;
+    if (pending_steps_ > 0) {
+        BeginStep();
+        simulating_ = true;
+    }
+}
+
+void PhysicsManager::FetchResults() {
+    if (simulating_) {
+        simulating_ = false;
+        EndStep();
+        pending_steps_--;
     }
+    for (; pending_steps_ > 0; pending_steps_--) {
+        BeginStep();
+        EndStep();
+    }
+}
+
+bool PhysicsManager::IsSimulating() const { return simulating_; }
+
+void PhysicsManager::BeginStep() {
+    for (auto &script : on_physics_update_scripts_) {
+        script->OnPhysicsUpdate();
+    }
+    CallColliderOnUpdate();
+    native_physics_manager_->simulate(fixed_time_step_);
+}
+
+void PhysicsManager::EndStep() {
+    native_physics_manager_->fetchResults(true);
+    CallColliderOnLateUpdate();
+    CallCharacterControllerOnLateUpdate();
 }
 
 void PhysicsManager::CallColliderOnUpdate() {
@@ -99,6 +99,20 @@ public:
      */
     void Update(float delta_time);
 
+    /**
+     * Start the fixed steps covering delta_time. The first step is simulated on the PhysX threads until
+     * FetchResults, the poses of the entities stay the ones of the last fetch in the meantime and writes to the
+     * actors are buffered by PhysX.
+     */
+    void StartSimulation(float delta_time);
+
+    /**
+     * Wait for the step started by StartSimulation, write back its poses and run the remaining steps.
+     */
+    void FetchResults();
+
+    [[nodiscard]] bool IsSimulating() const;
+
     void CallColliderOnUpdate();
 
     void CallColliderOnLateUpdate();
@@ -167,6 +181,12 @@ private:
     std::vector<CharacterController *> controllers_;
     std::vector<Script *> on_physics_update_scripts_;
     float rest_time_ = 0;
+    uint32_t pending_steps_ = 0;
+    bool simulating_ = false;
+
+    void BeginStep();
+
+    void EndStep();
 
     std::function<void(PxShape *obj1, PxShape *obj2)> on_contact_enter_;
     std::function<void(PxShape *obj1, PxShape *obj2)> on_contact_exit_;
@@ -165,6 +165,10 @@ void WriteImage(const uint8_t *data,
                    row_stride);
 }
 
+void WriteImageHdr(const float *data, const std::string &filename, uint32_t width, uint32_t height, uint32_t components) {
+    stbi_write_hdr((path::Get(path::Type::SCREENSHOTS) + filename + ".hdr").c_str(), width, height, components, data);
+}
+
 bool WriteJson(nlohmann::json &data, const std::string &filename) {
     std::stringstream json;
 
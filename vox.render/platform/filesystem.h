@@ -138,6 +138,17 @@ void WriteImage(const uint8_t *data,
                 uint32_t components,
                 uint32_t row_stride);
 
+/**
+ * @brief Helper to write to a Radiance hdr image in permanent storage
+ *
+ * @param data       A vector filled with float pixel data to write in (R, G, B, A) format
+ * @param filename   The name of the image file without an extension
+ * @param width      The width of the image
+ * @param height     The height of the image
+ * @param components The number of floats per element
+ */
+void WriteImageHdr(const float *data, const std::string &filename, uint32_t width, uint32_t height, uint32_t components);
+
 /**
  * @brief Helper to output a json graph
  *
@@ -6,12 +6,22 @@
 
 #include "vox.render/renderer.h"
 
+#include <atomic>
+
 #include "vox.render/components_manager.h"
 #include "vox.render/entity.h"
 #include "vox.render/material/material.h"
 #include "vox.render/scene.h"
 
 namespace vox {
+namespace {
+uint64_t NextInstanceId() {
+    static std::atomic<uint64_t> next_id{1};
+    return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
 size_t Renderer::MaterialCount() { return materials_.size(); }
 
 BoundingBox3F Renderer::Bounds() {
@@ -27,8 +37,18 @@ Renderer::Renderer(Entity *entity)
     : Component(entity),
       shader_data_(entity->Scene()->Device()),
       transform_change_flag_(entity->transform->RegisterWorldChangeFlag()),
+      instance_id_(NextInstanceId()),
       renderer_property_("rendererData") {}
 
+Renderer::~Renderer() {
+    // the component destructor does not reach OnDisable of the renderer
+    if (auto *manager = ComponentsManager::GetSingletonPtr()) {
+        manager->RemoveRenderer(this);
+    }
+}
+
+uint64_t Renderer::InstanceId() const { return instance_id_; }
+
 void Renderer::OnEnable() { ComponentsManager::GetSingleton().AddRenderer(this); }
 
 void Renderer::OnDisable() { ComponentsManager::GetSingleton().RemoveRenderer(this); }
@@ -25,6 +25,11 @@ public:
         Matrix4x4F normal_mat;
     };
 
+    /**
+     * Passes selecting a level of detail, each one keeps its own hysteresis history per camera.
+     */
+    enum class LodPass { MAIN, SHADOW };
+
     /** ShaderData related to renderer. */
     ShaderData shader_data_;
     /** Whether it is clipped by the frustum, needs to be turned on camera.enableFrustumCulling. */
@@ -47,6 +52,13 @@ public:
 
     explicit Renderer(Entity *entity);
 
+    ~Renderer() override;
+
+    /**
+     * Identifier unique over the run, unlike the address of a destroyed renderer which may be reused.
+     */
+    [[nodiscard]] uint64_t InstanceId() const;
+
 public:
     /**
      * Get the first instance material by index.
@@ -119,6 +131,20 @@ protected:
 
     virtual void UpdateBounds(BoundingBox3F &world_bounds) {}
 
+    /**
+     * Select the level of detail used by the following Render call.
+     * @param camera - Camera the level of detail is tracked for
+     * @param screen_size - Projected height of the bounds, as a fraction of the viewport height
+     * @param lod_bias - Extra levels added to the selection, used by passes which tolerate coarser geometry
+     * @param pass - Pass the level of detail is selected for
+     */
+    virtual void UpdateLod(const Camera *camera, float screen_size, uint32_t lod_bias, LodPass pass) {}
+
+    /**
+     * Drop the state tracked for a camera which is destroyed.
+     */
+    virtual void OnCameraDestroy(const Camera *camera) {}
+
     virtual void Update(float delta_time) {}
 
 protected:
@@ -131,9 +157,10 @@ private:
 
     float distance_for_sort_ = 0;
     ssize_t renderer_index_ = -1;
+    const uint64_t instance_id_;
 
     RendererData renderer_data_;
-    const std::string renderer_property_;
+    const ShaderProperty renderer_property_;
 
     std::unique_ptr<UpdateFlag> transform_change_flag_;
     BoundingBox3F bounds_ = BoundingBox3F();
@@ -0,0 +1,185 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.render/rendering/batch_renderer.h"
+
+#include <chrono>
+#include <utility>
+
+#include "vox.base/logging.h"
+#include "vox.base/thread_pool.h"
+#include "vox.render/platform/filesystem.h"
+
+namespace vox {
+BatchRenderer::BatchRenderer(RenderContext &render_context, RecordFunc record, bool hdr)
+    : render_context_(render_context), record_(std::move(record)), hdr_(hdr) {}
+
+BatchRenderer::~BatchRenderer() {
+    // the jobs in flight still write into the pooled targets
+    render_context_.GetDevice().WaitIdle();
+    WaitForEncoding();
+}
+
+void BatchRenderer::Enqueue(BatchJob job) {
+    if (job.camera == nullptr || job.width == 0 || job.height == 0) {
+        LOGE("Batch job {} needs a camera and a resolution", job.filename)
+        return;
+    }
+    jobs_.push_back(std::move(job));
+}
+
+size_t BatchRenderer::PendingCount() const { return jobs_.size(); }
+
+float BatchRenderer::ImagesPerSecond() const { return images_per_second_; }
+
+void BatchRenderer::ReleaseTargets() { free_targets_.clear(); }
+
+void BatchRenderer::Flush() {
+    const auto kStart = std::chrono::steady_clock::now();
+    const auto kCount = jobs_.size();
+    if (slots_.size() != render_context_.GetRenderFrames().size()) {
+        render_context_.GetDevice().WaitIdle();
+        for (auto &slot : slots_) {
+            if (slot.pending) {
+                Retire(slot);
+            }
+        }
+        slots_.resize(render_context_.GetRenderFrames().size());
+    }
+
+    const VkDeviceSize kPixelSize = hdr_ ? 4 * sizeof(float) : 4;
+    while (!jobs_.empty()) {
+        // waits for the fence of the frame reused, the copy of its previous job is done
+        auto &command_buffer = render_context_.Begin();
+        auto &slot = slots_[render_context_.GetActiveFrameIndex() % slots_.size()];
+        if (slot.pending) {
+            Retire(slot);
+        }
+
+        slot.job = std::move(jobs_.front());
+        jobs_.pop_front();
+        slot.render_target = AcquireTarget(slot.job.width, slot.job.height);
+        const VkDeviceSize kSize = VkDeviceSize(slot.job.width) * slot.job.height * kPixelSize;
+        if (!slot.staging || slot.staging->GetSize() < kSize) {
+            slot.staging = std::make_unique<core::Buffer>(render_context_.GetDevice(), kSize,
+                                                          VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                          VMA_MEMORY_USAGE_GPU_TO_CPU);
+        }
+
+        command_buffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        record_(command_buffer, *slot.render_target, slot.job);
+        RecordReadback(command_buffer, slot);
+        command_buffer.End();
+
+        render_context_.Submit(command_buffer);
+        slot.pending = true;
+    }
+
+    render_context_.GetDevice().WaitIdle();
+    for (auto &slot : slots_) {
+        if (slot.pending) {
+            Retire(slot);
+        }
+    }
+    WaitForEncoding();
+
+    const float kSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - kStart).count();
+    images_per_second_ = kSeconds > 0.f ? static_cast<float>(kCount) / kSeconds : 0.f;
+}
+
+std::unique_ptr<RenderTarget> BatchRenderer::AcquireTarget(uint32_t width, uint32_t height) {
+    auto &free_targets = free_targets_[{width, height}];
+    if (!free_targets.empty()) {
+        // the same target keeps its framebuffer in the resource cache
+        auto render_target = std::move(free_targets.back());
+        free_targets.pop_back();
+        return render_target;
+    }
+
+    core::Image color_image{render_context_.GetDevice(), VkExtent3D{width, height, 1},
+                            hdr_ ? VK_FORMAT_R32G32B32A32_SFLOAT : RenderContext::default_vk_format_,
+                            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                            VMA_MEMORY_USAGE_GPU_ONLY};
+    return RenderTarget::default_create_func_(std::move(color_image));
+}
+
+void BatchRenderer::RecordReadback(CommandBuffer &command_buffer, Slot &slot) {
+    auto &color_view = slot.render_target->GetViews().at(0);
+    ImageMemoryBarrier image_barrier{};
+    image_barrier.old_layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    image_barrier.new_layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    image_barrier.src_access_mask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    image_barrier.dst_access_mask = VK_ACCESS_TRANSFER_READ_BIT;
+    image_barrier.src_stage_mask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    image_barrier.dst_stage_mask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    command_buffer.ImageMemoryBarrier(color_view, image_barrier);
+
+    std::vector<VkBufferImageCopy> regions(1);
+    regions[0].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    regions[0].imageSubresource.layerCount = 1;
+    regions[0].imageExtent = {slot.job.width, slot.job.height, 1};
+    command_buffer.CopyImageToBuffer(color_view.GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, *slot.staging,
+                                     regions);
+
+    BufferMemoryBarrier buffer_barrier{};
+    buffer_barrier.src_access_mask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    buffer_barrier.dst_access_mask = VK_ACCESS_HOST_READ_BIT;
+    buffer_barrier.src_stage_mask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    buffer_barrier.dst_stage_mask = VK_PIPELINE_STAGE_HOST_BIT;
+    command_buffer.BufferMemoryBarrier(*slot.staging, 0, VK_WHOLE_SIZE, buffer_barrier);
+}
+
+void BatchRenderer::Retire(Slot &slot) {
+    slot.pending = false;
+    auto job = std::move(slot.job);
+
+    BatchImage image;
+    image.width = job.width;
+    image.height = job.height;
+    image.hdr = hdr_;
+    const size_t kSize = size_t(job.width) * job.height * (hdr_ ? 4 * sizeof(float) : 4);
+    slot.staging->Invalidate();
+    const uint8_t *data = slot.staging->Map();
+    image.pixels.assign(data, data + kSize);
+    slot.staging->Unmap();
+
+    free_targets_[{job.width, job.height}].push_back(std::move(slot.render_target));
+
+    {
+        std::lock_guard<std::mutex> lock(encoding_mutex_);
+        encoding_count_++;
+    }
+    utility::ThreadPool::GetInstance().Submit([this, image = std::move(image), job = std::move(job)] {
+        try {
+            if (!job.filename.empty()) {
+                if (image.hdr) {
+                    fs::WriteImageHdr(reinterpret_cast<const float *>(image.pixels.data()), job.filename,
+                                      image.width, image.height, 4);
+                } else {
+                    fs::WriteImage(image.pixels.data(), job.filename, image.width, image.height, 4, image.width * 4);
+                }
+            }
+            if (job.on_complete) {
+                job.on_complete(image);
+            }
+        } catch (const std::exception &e) {
+            LOGE("Batch job {} failed: {}", job.filename, e.what())
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(encoding_mutex_);
+            encoding_count_--;
+        }
+        encoding_condition_.notify_all();
+    });
+}
+
+void BatchRenderer::WaitForEncoding() {
+    std::unique_lock<std::mutex> lock(encoding_mutex_);
+    encoding_condition_.wait(lock, [this] { return encoding_count_ == 0; });
+}
+
+}  // namespace vox
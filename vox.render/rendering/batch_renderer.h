@@ -0,0 +1,123 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+
+#include "vox.render/camera.h"
+#include "vox.render/core/buffer.h"
+#include "vox.render/rendering/render_context.h"
+#include "vox.render/rendering/render_target.h"
+
+namespace vox {
+/**
+ * @brief Image read back by the BatchRenderer, rows are tightly packed RGBA.
+ */
+struct BatchImage {
+    uint32_t width{0};
+    uint32_t height{0};
+    /** Four floats per pixel when true, four bytes otherwise */
+    bool hdr{false};
+    std::vector<uint8_t> pixels;
+};
+
+/**
+ * @brief One image to render offscreen.
+ */
+struct BatchJob {
+    /** Camera of the scene to render */
+    Camera *camera{nullptr};
+    uint32_t width{0};
+    uint32_t height{0};
+    /** Written to the screenshots folder without extension, .png or .hdr is appended, empty to skip */
+    std::string filename;
+    /** Called on a worker thread once the image is read back and written */
+    std::function<void(const BatchImage &image)> on_complete;
+};
+
+/**
+ * @brief Offscreen batch rendering for headless applications, throughput over latency.
+ *        Each job is rendered in its own RenderFrame into a target of its resolution taken from a pool, so with
+ *        several headless frames the next jobs are recorded while the previous ones execute.
+ *        The color target is copied into the staging buffer of the frame slot, which is read when the frame is
+ *        reused after its fence was waited on. Encoding and writing the images runs on the ThreadPool workers.
+ */
+class BatchRenderer {
+public:
+    /**
+     * Records the job into the render target, leaving its first view in VK_IMAGE_LAYOUT_PRESENT_SRC_KHR like
+     * GraphicsApplication::Draw.
+     */
+    using RecordFunc = std::function<void(CommandBuffer &command_buffer, RenderTarget &render_target,
+                                          const BatchJob &job)>;
+
+    /**
+     * @param render_context Headless context, see RenderContext::SetHeadlessFrameCount
+     * @param hdr Render to float targets written as Radiance hdr, 8 bit png otherwise
+     */
+    BatchRenderer(RenderContext &render_context, RecordFunc record, bool hdr = false);
+
+    ~BatchRenderer();
+
+    void Enqueue(BatchJob job);
+
+    [[nodiscard]] size_t PendingCount() const;
+
+    /**
+     * Render the queued jobs and return once every image is written.
+     */
+    void Flush();
+
+    /**
+     * Throughput of the last Flush.
+     */
+    [[nodiscard]] float ImagesPerSecond() const;
+
+    /**
+     * Release the pooled render targets, they are kept between flushes otherwise.
+     */
+    void ReleaseTargets();
+
+private:
+    struct Slot {
+        std::unique_ptr<core::Buffer> staging{nullptr};
+        std::unique_ptr<RenderTarget> render_target{nullptr};
+        BatchJob job;
+        bool pending{false};
+    };
+
+    std::unique_ptr<RenderTarget> AcquireTarget(uint32_t width, uint32_t height);
+
+    void RecordReadback(CommandBuffer &command_buffer, Slot &slot);
+
+    /**
+     * Copy the image of the slot out of its staging buffer and hand it to a worker.
+     */
+    void Retire(Slot &slot);
+
+    void WaitForEncoding();
+
+    RenderContext &render_context_;
+    RecordFunc record_;
+    bool hdr_{false};
+
+    std::deque<BatchJob> jobs_{};
+    std::vector<Slot> slots_{};
+    std::map<std::pair<uint32_t, uint32_t>, std::vector<std::unique_ptr<RenderTarget>>> free_targets_{};
+
+    std::mutex encoding_mutex_;
+    std::condition_variable encoding_condition_;
+    size_t encoding_count_{0};
+
+    float images_per_second_{0};
+};
+
+}  // namespace vox
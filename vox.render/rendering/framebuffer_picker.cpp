@@ -0,0 +1,312 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.render/rendering/framebuffer_picker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "vox.render/camera.h"
+#include "vox.render/components_manager.h"
+
+namespace vox {
+namespace {
+// the targets only grow, by steps of this size, so dragging a rectangle does not create a framebuffer per frame
+constexpr uint32_t kTargetGranularity = 64;
+
+uint32_t RoundUp(uint32_t value) {
+    return std::max(kTargetGranularity, (value + kTargetGranularity - 1) / kTargetGranularity * kTargetGranularity);
+}
+
+bool InsidePolygon(const std::vector<Vector2F> &points, float x, float y) {
+    bool inside = false;
+    for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++) {
+        if ((points[i].y > y) != (points[j].y > y) &&
+            x < (points[j].x - points[i].x) * (y - points[i].y) / (points[j].y - points[i].y) + points[i].x) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+}  // namespace
+
+FramebufferPicker::FramebufferPicker(RenderContext &render_context, Scene *scene, Camera *camera)
+    : render_context_(render_context),
+      camera_(camera),
+      pick_graph_(render_context.GetDevice()),
+      depth_format_(GetSuitableDepthFormat(render_context.GetDevice().GetGpu().GetHandle())) {
+    auto subpass = std::make_unique<ColorPickerSubpass>(render_context, scene, camera);
+    subpass_ = subpass.get();
+    render_pipeline_ = std::make_unique<RenderPipeline>();
+    render_pipeline_->AddSubpass(std::move(subpass));
+    auto clear_value = render_pipeline_->GetClearValue();
+    clear_value[0].color = {1.0f, 1.0f, 1.0f, 1.0f};
+    render_pipeline_->SetClearValue(clear_value);
+
+    slots_.resize(render_context.GetRenderFrames().size());
+}
+
+ColorPickerSubpass &FramebufferPicker::Subpass() { return *subpass_; }
+
+void FramebufferPicker::SetPickRadius(uint32_t pixels) { pick_radius_ = pixels; }
+
+void FramebufferPicker::Pick(const Vector2F &point, Callback callback) {
+    requests_.push_back({Mode::POINT, {ToViewportPixel(point)}, std::move(callback)});
+}
+
+void FramebufferPicker::PickRect(const Vector2F &corner0, const Vector2F &corner1, Callback callback) {
+    requests_.push_back({Mode::RECT, {ToViewportPixel(corner0), ToViewportPixel(corner1)}, std::move(callback)});
+}
+
+void FramebufferPicker::PickLasso(const std::vector<Vector2F> &points, Callback callback) {
+    Request request{Mode::LASSO, {}, std::move(callback)};
+    request.points.reserve(points.size());
+    for (const auto &point : points) {
+        request.points.push_back(ToViewportPixel(point));
+    }
+    requests_.push_back(std::move(request));
+}
+
+size_t FramebufferPicker::PendingCount() const {
+    return requests_.size() + std::count_if(slots_.begin(), slots_.end(), [](const Slot &slot) { return slot.pending; });
+}
+
+Vector2F FramebufferPicker::ToViewportPixel(const Vector2F &point) const {
+    const auto kViewport = camera_->Viewport();
+    const float kScaleX = static_cast<float>(camera_->FramebufferWidth()) / static_cast<float>(camera_->Width());
+    const float kScaleY = static_cast<float>(camera_->FramebufferHeight()) / static_cast<float>(camera_->Height());
+    return {point.x * kScaleX - kViewport.x * static_cast<float>(camera_->FramebufferWidth()),
+            point.y * kScaleY - kViewport.y * static_cast<float>(camera_->FramebufferHeight())};
+}
+
+VkRect2D FramebufferPicker::RegionOf(const Request &request) const {
+    const auto kViewport = camera_->Viewport();
+    const auto kViewWidth = static_cast<int32_t>(kViewport.z * static_cast<float>(camera_->FramebufferWidth()));
+    const auto kViewHeight = static_cast<int32_t>(kViewport.w * static_cast<float>(camera_->FramebufferHeight()));
+
+    float min_x = std::numeric_limits<float>::max();
+    float min_y = std::numeric_limits<float>::max();
+    float max_x = std::numeric_limits<float>::lowest();
+    float max_y = std::numeric_limits<float>::lowest();
+    for (const auto &point : request.points) {
+        min_x = std::min(min_x, point.x);
+        min_y = std::min(min_y, point.y);
+        max_x = std::max(max_x, point.x);
+        max_y = std::max(max_y, point.y);
+    }
+    if (request.mode == Mode::POINT) {
+        const auto kRadius = static_cast<float>(pick_radius_);
+        min_x -= kRadius;
+        min_y -= kRadius;
+        max_x += kRadius + 1.f;
+        max_y += kRadius + 1.f;
+    }
+
+    const int32_t kX0 = std::clamp(static_cast<int32_t>(std::floor(min_x)), 0, kViewWidth);
+    const int32_t kY0 = std::clamp(static_cast<int32_t>(std::floor(min_y)), 0, kViewHeight);
+    const int32_t kX1 = std::clamp(static_cast<int32_t>(std::ceil(max_x)), 0, kViewWidth);
+    const int32_t kY1 = std::clamp(static_cast<int32_t>(std::ceil(max_y)), 0, kViewHeight);
+
+    VkRect2D region{};
+    region.offset = {kX0, kY0};
+    region.extent = {static_cast<uint32_t>(std::max(kX1 - kX0, 0)), static_cast<uint32_t>(std::max(kY1 - kY0, 0))};
+    return region;
+}
+
+void FramebufferPicker::Draw(CommandBuffer &command_buffer) {
+    if (slots_.size() != render_context_.GetRenderFrames().size()) {
+        slots_.resize(render_context_.GetRenderFrames().size());
+    }
+    // the fence of the active frame was waited on, what it copied can be read
+    const uint32_t kFrameIndex = render_context_.GetActiveFrameIndex();
+    auto &slot = slots_[kFrameIndex];
+    if (slot.pending) {
+        Resolve(slot);
+    }
+
+    if (requests_.empty()) {
+        return;
+    }
+    auto request = std::move(requests_.front());
+    requests_.pop_front();
+
+    const auto kRegion = RegionOf(request);
+    if (kRegion.extent.width == 0 || kRegion.extent.height == 0) {
+        if (request.callback) {
+            request.callback({});
+        }
+        return;
+    }
+
+    if (slot.extent.width < kRegion.extent.width || slot.extent.height < kRegion.extent.height) {
+        slot.extent.width = std::max(RoundUp(kRegion.extent.width), slot.extent.width);
+        slot.extent.height = std::max(RoundUp(kRegion.extent.height), slot.extent.height);
+        // the graph places new images for the new extent
+        slot.render_target.reset();
+        slot.readback = std::make_unique<core::Buffer>(render_context_.GetDevice(),
+                                                       slot.extent.width * slot.extent.height * 4,
+                                                       VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU);
+    }
+
+    // only the region is rasterized, stretched over the corner of the target
+    VkViewport viewport{};
+    viewport.width = static_cast<float>(kRegion.extent.width);
+    viewport.height = static_cast<float>(kRegion.extent.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    command_buffer.SetViewport(0, {viewport});
+    VkRect2D scissor{};
+    scissor.extent = kRegion.extent;
+    command_buffer.SetScissor(0, {scissor});
+
+    const auto kViewport = camera_->Viewport();
+    const float kViewWidth = kViewport.z * static_cast<float>(camera_->FramebufferWidth());
+    const float kViewHeight = kViewport.w * static_cast<float>(camera_->FramebufferHeight());
+    subpass_->SetRegion(Vector4F(static_cast<float>(kRegion.offset.x) / kViewWidth,
+                                 static_cast<float>(kRegion.offset.y) / kViewHeight,
+                                 static_cast<float>(kRegion.extent.width) / kViewWidth,
+                                 static_cast<float>(kRegion.extent.height) / kViewHeight));
+
+    pick_graph_.Clear(kFrameIndex);
+    const auto kColor = pick_graph_.CreateImage(
+            "pickColor", {slot.extent, VK_FORMAT_R8G8B8A8_UNORM,
+                          VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT});
+    const auto kDepth = pick_graph_.CreateImage(
+            "pickDepth", {slot.extent, depth_format_, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT});
+    const auto kReadback = pick_graph_.ImportBuffer("pickReadback", *slot.readback);
+
+    pick_graph_.AddPass(
+            "Pick",
+            [&](RenderGraph::PassBuilder &builder) {
+                builder.Write(kColor, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                              VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+                builder.Write(kDepth,
+                              VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                              VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                                      VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                              VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+            },
+            [&](CommandBuffer &command_buffer) {
+                if (!slot.render_target) {
+                    std::vector<core::ImageView> views;
+                    views.emplace_back(pick_graph_.GetTransientImage(kColor), VK_IMAGE_VIEW_TYPE_2D);
+                    views.emplace_back(pick_graph_.GetTransientImage(kDepth), VK_IMAGE_VIEW_TYPE_2D);
+                    slot.render_target = std::make_unique<RenderTarget>(std::move(views));
+                }
+                render_pipeline_->Draw(command_buffer, *slot.render_target);
+                command_buffer.EndRenderPass();
+            });
+
+    pick_graph_.AddPass(
+            "Pick Readback",
+            [&](RenderGraph::PassBuilder &builder) {
+                builder.Read(kColor, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                             VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+                builder.Write(kReadback, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+            },
+            [&](CommandBuffer &command_buffer) {
+                std::vector<VkBufferImageCopy> regions(1);
+                regions[0].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                regions[0].imageSubresource.layerCount = 1;
+                regions[0].imageExtent = {kRegion.extent.width, kRegion.extent.height, 1};
+                command_buffer.CopyImageToBuffer(pick_graph_.GetTransientImage(kColor),
+                                                 VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, *slot.readback, regions);
+            });
+
+    pick_graph_.Export(kReadback, VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+    pick_graph_.Execute(command_buffer);
+
+    slot.pending = true;
+    slot.request = std::move(request);
+    slot.region = kRegion;
+    slot.primitives.clear();
+    for (const auto &[renderer, mesh] : subpass_->Primitives()) {
+        slot.primitives.emplace_back(renderer->InstanceId(), mesh);
+    }
+
+    VkExtent2D extent{camera_->FramebufferWidth(), camera_->FramebufferHeight()};
+    viewport.width = static_cast<float>(extent.width);
+    viewport.height = static_cast<float>(extent.height);
+    command_buffer.SetViewport(0, {viewport});
+    scissor.extent = extent;
+    command_buffer.SetScissor(0, {scissor});
+}
+
+void FramebufferPicker::Resolve(Slot &slot) {
+    slot.pending = false;
+    auto request = std::move(slot.request);
+
+    slot.readback->Invalidate();
+    const uint8_t *pixels = slot.readback->Map();
+
+    const auto kWidth = slot.region.extent.width;
+    const auto kHeight = slot.region.extent.height;
+    std::vector<uint32_t> ids;
+    if (request.mode == Mode::POINT) {
+        // the element nearest to the point
+        const float kCenterX = request.points[0].x - static_cast<float>(slot.region.offset.x);
+        const float kCenterY = request.points[0].y - static_cast<float>(slot.region.offset.y);
+        float nearest = std::numeric_limits<float>::max();
+        for (uint32_t y = 0; y < kHeight; y++) {
+            for (uint32_t x = 0; x < kWidth; x++) {
+                const uint8_t *pixel = pixels + (y * kWidth + x) * 4;
+                const uint32_t kId = pixel[0] | (pixel[1] << 8) | (pixel[2] << 16);
+                const float kDx = static_cast<float>(x) + 0.5f - kCenterX;
+                const float kDy = static_cast<float>(y) + 0.5f - kCenterY;
+                if (kId != 0xffffff && kDx * kDx + kDy * kDy < nearest) {
+                    nearest = kDx * kDx + kDy * kDy;
+                    ids.assign(1, kId);
+                }
+            }
+        }
+    } else {
+        for (uint32_t y = 0; y < kHeight; y++) {
+            for (uint32_t x = 0; x < kWidth; x++) {
+                const uint8_t *pixel = pixels + (y * kWidth + x) * 4;
+                const uint32_t kId = pixel[0] | (pixel[1] << 8) | (pixel[2] << 16);
+                if (kId == 0xffffff) {
+                    continue;
+                }
+                if (request.mode == Mode::LASSO &&
+                    !InsidePolygon(request.points, static_cast<float>(slot.region.offset.x + x) + 0.5f,
+                                   static_cast<float>(slot.region.offset.y + y) + 0.5f)) {
+                    continue;
+                }
+                ids.push_back(kId);
+            }
+        }
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    }
+    slot.readback->Unmap();
+
+    // several sub meshes of a renderer have their own id
+    std::vector<std::pair<uint64_t, MeshPtr>> picked;
+    for (auto id : ids) {
+        if (id < slot.primitives.size() &&
+            std::find(picked.begin(), picked.end(), slot.primitives[id]) == picked.end()) {
+            picked.push_back(slot.primitives[id]);
+        }
+    }
+    slot.primitives.clear();
+
+    std::vector<PickResult> results;
+    const auto &components_manager = ComponentsManager::GetSingleton();
+    for (auto &[instance_id, mesh] : picked) {
+        if (auto *renderer = components_manager.FindRenderer(instance_id)) {
+            results.emplace_back(renderer, std::move(mesh));
+        }
+    }
+
+    if (request.callback) {
+        request.callback(results);
+    }
+}
+
+}  // namespace vox
@@ -0,0 +1,112 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <deque>
+#include <functional>
+
+#include "vox.render/rendering/render_graph.h"
+#include "vox.render/rendering/render_pipeline.h"
+#include "vox.render/rendering/subpasses/color_picker_subpass.h"
+
+namespace vox {
+/**
+ * @brief Asynchronous framebuffer picking.
+ *        Only the pixels of the request are rendered: the picking pass draws the region into the corner of a small
+ *        render target, with the projection cropped and the culling frustum narrowed to it.
+ *        The ids are copied to a readback ring with one slot per render frame, a slot is read when its frame is reused,
+ *        once its fence was waited on, so the results arrive a few frames later and mapped memory in flight is never
+ *        read. The target and the copy are passes of a render graph, the target images are transient images of it.
+ */
+class FramebufferPicker {
+public:
+    using PickResult = std::pair<Renderer *, MeshPtr>;
+
+    /**
+     * Called from Draw with the unique elements picked, the nearest to the point first for a point pick.
+     * Renderers disabled or destroyed since the request was rendered are left out.
+     */
+    using Callback = std::function<void(const std::vector<PickResult> &results)>;
+
+    FramebufferPicker(RenderContext &render_context, Scene *scene, Camera *camera);
+
+    [[nodiscard]] ColorPickerSubpass &Subpass();
+
+    /**
+     * Distance in pixels around a picked point where an element is still picked, 0 by default.
+     */
+    void SetPickRadius(uint32_t pixels);
+
+    /**
+     * Pick the element at the screen coordinate position.
+     * @param point Position relative to the canvas, in window coordinates like Camera::ScreenPointToRay
+     */
+    void Pick(const Vector2F &point, Callback callback);
+
+    /**
+     * Pick every element visible in the rectangle between the two corners.
+     */
+    void PickRect(const Vector2F &corner0, const Vector2F &corner1, Callback callback);
+
+    /**
+     * Pick every element visible in the polygon.
+     */
+    void PickLasso(const std::vector<Vector2F> &points, Callback callback);
+
+    /**
+     * Requests not yet answered.
+     */
+    [[nodiscard]] size_t PendingCount() const;
+
+    /**
+     * Answer the request of the frame slot being reused, then render the next request.
+     * Must be called outside of a render pass, the viewport and scissor are set to the camera framebuffer afterwards.
+     */
+    void Draw(CommandBuffer &command_buffer);
+
+private:
+    enum class Mode { POINT, RECT, LASSO };
+
+    struct Request {
+        Mode mode;
+        // framebuffer pixels, relative to the camera viewport
+        std::vector<Vector2F> points;
+        Callback callback;
+    };
+
+    struct Slot {
+        // over the transient images of the slot's frame, rebuilt when their extent changes
+        std::unique_ptr<RenderTarget> render_target{nullptr};
+        VkExtent2D extent{0, 0};
+        std::unique_ptr<core::Buffer> readback{nullptr};
+        bool pending{false};
+        Request request;
+        VkRect2D region{};
+        // renderers by instance id, the renderers may be destroyed before the slot is resolved
+        std::vector<std::pair<uint64_t, MeshPtr>> primitives;
+    };
+
+    [[nodiscard]] Vector2F ToViewportPixel(const Vector2F &point) const;
+
+    [[nodiscard]] VkRect2D RegionOf(const Request &request) const;
+
+    void Resolve(Slot &slot);
+
+    RenderContext &render_context_;
+    Camera *camera_{nullptr};
+
+    std::unique_ptr<RenderPipeline> render_pipeline_{nullptr};
+    ColorPickerSubpass *subpass_{nullptr};
+    RenderGraph pick_graph_;
+    VkFormat depth_format_{VK_FORMAT_UNDEFINED};
+    uint32_t pick_radius_{0};
+
+    std::deque<Request> requests_{};
+    std::vector<Slot> slots_{};
+};
+
+}  // namespace vox
@@ -60,7 +60,11 @@ void PostProcessingComputePass::Draw(CommandBuffer &command_buffer, RenderTarget
     }
 
     // Dispatch compute
-    command_buffer.Dispatch(n_workgroups_[0], n_workgroups_[1], n_workgroups_[2]);
+    if (indirect_buffer_) {
+        command_buffer.DispatchIndirect(*indirect_buffer_, indirect_offset_);
+    } else {
+        command_buffer.Dispatch(n_workgroups_[0], n_workgroups_[1], n_workgroups_[2]);
+    }
 }
 
 // MARK: - Transition
@@ -116,9 +120,9 @@ void PostProcessingComputePass::TransitionImages(CommandBuffer &command_buffer,
                 // A storage image is either read-only or write-only;
                 // use shader reflection to figure out which case, then transition
                 // NOTE: Could add a <name -> readonly?> cache to make this faster?
-                auto resource =
-                        std::find_if(pipeline_layout.GetResources().begin(), pipeline_layout.GetResources().end(),
-                                     [&storage](const auto &res) { return res.set == 0 && res.name == storage.first; });
+                auto resource = std::find_if(
+                        pipeline_layout.GetResources().begin(), pipeline_layout.GetResources().end(),
+                        [&storage](const auto &res) { return res.set == 0 && res.name == storage.first.Name(); });
                 if (resource == pipeline_layout.GetResources().end()) {
                     // No such storage image to bind
                     continue;
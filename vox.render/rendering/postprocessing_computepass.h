@@ -37,6 +37,16 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Dispatch with the workgroup count written in the buffer, a VkDispatchIndirectCommand at the offset.
+     *        nullptr restores the dispatch size.
+     */
+    inline PostProcessingComputePass &SetIndirectDispatch(const core::Buffer *buffer, VkDeviceSize offset = 0) {
+        indirect_buffer_ = buffer;
+        indirect_offset_ = offset;
+        return *this;
+    }
+
     /**
      * @brief Gets the number of workgroups that will be dispatched each draw().
      */
@@ -70,6 +80,8 @@ public:
 private:
     std::shared_ptr<ShaderSource> cs_source_;
     std::array<uint32_t, 3> n_workgroups_{1, 1, 1};
+    const core::Buffer *indirect_buffer_{nullptr};
+    VkDeviceSize indirect_offset_{0};
 
     std::vector<ShaderData *> data_{};
     std::vector<uint8_t> push_constants_data_{};
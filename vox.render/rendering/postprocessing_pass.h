@@ -8,6 +8,7 @@
 
 #include <functional>
 
+#include "vox.base/tracer.h"
 #include "vox.render/core/command_buffer.h"
 #include "vox.render/rendering/render_context.h"
 #include "vox.render/rendering/render_target.h"
@@ -58,6 +59,8 @@ protected:
     bool prepared_{false};
 
     std::string debug_name_{};
+    // debug_name_ interned when it is set, for the GPU scopes which store names by pointer
+    const char *interned_debug_name_{""};
 
     RenderTarget *render_target_{nullptr};
     std::shared_ptr<core::Sampler> default_sampler_{};
@@ -162,6 +165,7 @@ public:
      */
     inline Self &SetDebugName(const std::string &new_debug_name) {
         debug_name_ = new_debug_name;
+        interned_debug_name_ = utility::Tracer::Intern(new_debug_name);
 
         return static_cast<Self &>(*this);
     }
@@ -6,18 +6,30 @@
 
 #include "vox.render/rendering/postprocessing_pipeline.h"
 
+#include "vox.render/stats/gpu_profiler.h"
+
 namespace vox {
 PostProcessingPipeline::PostProcessingPipeline(RenderContext &render_context, ShaderSource triangle_vs)
     : render_context_{&render_context}, triangle_vs_{std::move(triangle_vs)} {}
 
+void PostProcessingPipeline::SetGpuScope(const char *name, StatIndex stat, bool pass_scopes) {
+    gpu_scope_name_ = name;
+    gpu_scope_stat_ = stat;
+    gpu_pass_scopes_ = pass_scopes;
+}
+
 void PostProcessingPipeline::Draw(CommandBuffer &command_buffer, RenderTarget &default_render_target) {
+    ScopedGpuTimer pipeline_timer{command_buffer, gpu_scope_name_, gpu_scope_stat_};
     for (current_pass_index_ = 0; current_pass_index_ < passes_.size(); current_pass_index_++) {
         auto &pass = *passes_[current_pass_index_];
 
         if (pass.debug_name_.empty()) {
             pass.debug_name_ = fmt::format("PPP pass #{}", current_pass_index_);
+            pass.interned_debug_name_ = utility::Tracer::Intern(pass.debug_name_);
         }
         ScopedDebugLabel marker{command_buffer, pass.debug_name_.c_str()};
+        ScopedGpuTimer timer{command_buffer, gpu_scope_name_ && gpu_pass_scopes_ ? pass.interned_debug_name_ : nullptr,
+                             gpu_scope_stat_};
 
         if (!pass.prepared_) {
             ScopedDebugLabel marker{command_buffer, "Prepare"};
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "vox.render/rendering/postprocessing_pass.h"
+#include "vox.render/stats/stats_common.h"
 
 namespace vox {
 class PostProcessingRenderPass;
@@ -38,6 +39,13 @@ public:
      */
     void Draw(CommandBuffer &command_buffer, RenderTarget &default_render_target);
 
+    /**
+     * @brief Time each Draw as one GPU scope, booked to the given stat. Nothing is timed unless a name is set.
+     * @param name Scope name stored by pointer: a string literal, or a string returned by utility::Tracer::Intern()
+     * @param pass_scopes Also time every pass in a nested scope, each one uses a query of the bounded profiler budget
+     */
+    void SetGpuScope(const char *name, StatIndex stat, bool pass_scopes = false);
+
     /**
      * @brief Gets all of the passes in the pipeline.
      */
@@ -76,6 +84,10 @@ private:
     ShaderSource triangle_vs_;
     std::vector<std::unique_ptr<PostProcessingPassBase>> passes_{};
     size_t current_pass_index_{0};
+
+    const char *gpu_scope_name_{nullptr};
+    StatIndex gpu_scope_stat_{StatIndex::GPU_COMPUTE_TIME};
+    bool gpu_pass_scopes_{false};
 };
 
 }  // namespace vox
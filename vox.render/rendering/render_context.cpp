@@ -56,16 +56,18 @@ void RenderContext::Prepare(size_t thread_count, const RenderTarget::CreateFunc
             frames_.emplace_back(std::make_unique<RenderFrame>(device_, std::move(render_target), thread_count));
         }
     } else {
-        // Otherwise, create a single RenderFrame
+        // Otherwise, create a RenderFrame per headless frame in flight
         swapchain_ = nullptr;
 
-        auto color_image = core::Image{device_, VkExtent3D{surface_extent_.width, surface_extent_.height, 1},
-                                       default_vk_format_,  // We can use any format here that we like
-                                       VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
-                                       VMA_MEMORY_USAGE_GPU_ONLY};
+        for (uint32_t i = 0; i < headless_frame_count_; i++) {
+            auto color_image = core::Image{device_, VkExtent3D{surface_extent_.width, surface_extent_.height, 1},
+                                           default_vk_format_,  // We can use any format here that we like
+                                           VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                                           VMA_MEMORY_USAGE_GPU_ONLY};
 
-        auto render_target = create_render_target_func(std::move(color_image));
-        frames_.emplace_back(std::make_unique<RenderFrame>(device_, std::move(render_target), thread_count));
+            auto render_target = create_render_target_func(std::move(color_image));
+            frames_.emplace_back(std::make_unique<RenderFrame>(device_, std::move(render_target), thread_count));
+        }
     }
 
     create_render_target_func_ = create_render_target_func;
@@ -73,6 +75,11 @@ void RenderContext::Prepare(size_t thread_count, const RenderTarget::CreateFunc
     prepared_ = true;
 }
 
+void RenderContext::SetHeadlessFrameCount(uint32_t frame_count) {
+    assert(!prepared_ && "Headless frame count must be set before prepare");
+    headless_frame_count_ = std::max(frame_count, 1u);
+}
+
 void RenderContext::SetPresentModePriority(const std::vector<VkPresentModeKHR> &present_mode_priority_list) {
     assert(!present_mode_priority_list.empty() && "Priority list must not be empty");
     present_mode_priority_list_ = present_mode_priority_list;
@@ -277,6 +284,9 @@ void RenderContext::BeginFrame() {
             prev_frame.Reset();
             return;
         }
+    } else {
+        // Without a swapchain the frames are used in turn
+        active_frame_index_ = (active_frame_index_ + 1) % utility::ToU32(frames_.size());
     }
 
     // Now the frame is active again
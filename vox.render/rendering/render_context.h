@@ -38,7 +38,7 @@ namespace vox {
  * swapchain. A RenderFrame will then be created for each Swapchain image.
  *
  * For headless rendering (no swapchain), the RenderContext can be given a valid Device, and
- * a width and height. A single RenderFrame will then be created.
+ * a width and height. One RenderFrame per headless frame in flight will then be created.
  */
 class RenderContext {
 public:
@@ -84,6 +84,12 @@ public:
      */
     void SetSurfaceFormatPriority(const std::vector<VkSurfaceFormatKHR> &surface_format_priority_list);
 
+    /**
+     * @brief Sets the frames recorded while the previous ones execute in headless mode, must be called before
+     * prepare. The frames are used in turn, each waiting for its own fence.
+     */
+    void SetHeadlessFrameCount(uint32_t frame_count);
+
     /**
      * @brief Prepares the RenderFrames for rendering
      * @param thread_count The number of threads in the application, necessary to allocate this many resource pools for
@@ -268,6 +274,8 @@ private:
     VkSurfaceTransformFlagBitsKHR pre_transform_{VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR};
 
     size_t thread_count_{1};
+
+    uint32_t headless_frame_count_{1};
 };
 
 }  // namespace vox
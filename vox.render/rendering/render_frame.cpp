@@ -61,6 +61,8 @@ void RenderFrame::Reset() {
     }
 
     semaphore_pool_.Reset();
+
+    ++reset_count_;
 }
 
 std::vector<std::unique_ptr<CommandPool>> &RenderFrame::GetCommandPools(const Queue &queue,
@@ -201,4 +203,6 @@ BufferAllocation RenderFrame::AllocateBuffer(VkBufferUsageFlags usage, VkDeviceS
     return data;
 }
 
+uint64_t RenderFrame::GetResetCount() const { return reset_count_; }
+
 }  // namespace vox
@@ -124,6 +124,11 @@ public:
      */
     BufferAllocation AllocateBuffer(VkBufferUsageFlags usage, VkDeviceSize size, size_t thread_index = 0);
 
+    /**
+     * @brief Number of times the frame was reset, allocations made before the last reset are no longer valid
+     */
+    [[nodiscard]] uint64_t GetResetCount() const;
+
     /**
      * @brief Updates all the descriptor sets in the current frame at a specific thread index
      */
@@ -161,6 +166,8 @@ private:
     BufferAllocationStrategy buffer_allocation_strategy_{BufferAllocationStrategy::MULTIPLE_ALLOCATIONS_PER_BUFFER};
 
     std::map<VkBufferUsageFlags, std::vector<std::pair<BufferPool, BufferBlock *>>> buffer_pools_;
+
+    uint64_t reset_count_{0};
 };
 
 }  // namespace vox
@@ -0,0 +1,468 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.render/rendering/render_graph.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "vox.base/logging.h"
+#include "vox.render/core/command_buffer.h"
+#include "vox.render/core/device.h"
+#include "vox.render/error.h"
+#include "vox.render/rendering/render_graph_placement.h"
+
+namespace vox {
+bool RenderGraph::ImageDesc::operator==(const ImageDesc &other) const {
+    return extent.width == other.extent.width && extent.height == other.extent.height && format == other.format &&
+           usage == other.usage && sample_count == other.sample_count;
+}
+
+// MARK: - PassBuilder
+RenderGraph::PassBuilder::PassBuilder(RenderGraph &graph, uint32_t pass) : graph_(graph), pass_(pass) {}
+
+void RenderGraph::PassBuilder::Read(Handle resource,
+                                    VkPipelineStageFlags stage,
+                                    VkAccessFlags access,
+                                    VkImageLayout layout) {
+    auto &accesses = graph_.passes_[pass_].accesses;
+    auto iter = std::find_if(accesses.begin(), accesses.end(),
+                             [resource](const Access &access) { return access.resource == resource; });
+    if (iter == accesses.end()) {
+        accesses.push_back({resource, stage, access, layout, false});
+    } else {
+        // one barrier covers every access of the pass to the resource
+        iter->stage |= stage;
+        iter->access |= access;
+        if (layout != VK_IMAGE_LAYOUT_UNDEFINED) {
+            iter->layout = layout;
+        }
+    }
+}
+
+void RenderGraph::PassBuilder::Write(Handle resource,
+                                     VkPipelineStageFlags stage,
+                                     VkAccessFlags access,
+                                     VkImageLayout layout) {
+    Read(resource, stage, access, layout);
+    auto &accesses = graph_.passes_[pass_].accesses;
+    std::find_if(accesses.begin(), accesses.end(), [resource](const Access &access) {
+        return access.resource == resource;
+    })->write = true;
+}
+
+void RenderGraph::PassBuilder::SetSideEffect() { graph_.passes_[pass_].side_effect = true; }
+
+// MARK: - RenderGraph
+RenderGraph::RenderGraph(Device &device) : device_(device), transient_sets_(1) {}
+
+RenderGraph::~RenderGraph() {
+    for (auto &set : transient_sets_) {
+        DestroyTransientImages(device_, set);
+    }
+}
+
+void RenderGraph::Clear(uint32_t frame_index) {
+    passes_.clear();
+    resources_.clear();
+    compiled_ = false;
+
+    frame_index_ = frame_index;
+    if (transient_sets_.size() <= frame_index) {
+        transient_sets_.resize(frame_index + 1);
+    }
+}
+
+RenderGraph::Handle RenderGraph::AddResource(Resource &&resource) {
+    resources_.emplace_back(std::move(resource));
+    compiled_ = false;
+    return static_cast<Handle>(resources_.size() - 1);
+}
+
+RenderGraph::Handle RenderGraph::ImportBuffer(const std::string &name,
+                                              core::Buffer &buffer,
+                                              VkPipelineStageFlags stage,
+                                              VkAccessFlags access) {
+    Resource resource;
+    resource.name = name;
+    resource.buffer = &buffer;
+    resource.initial.write_stage = stage;
+    resource.initial.write_access = access;
+    return AddResource(std::move(resource));
+}
+
+RenderGraph::Handle RenderGraph::ImportImage(const std::string &name,
+                                             core::ImageView &image_view,
+                                             VkImageLayout layout,
+                                             VkPipelineStageFlags stage,
+                                             VkAccessFlags access) {
+    Resource resource;
+    resource.name = name;
+    resource.image_view = &image_view;
+    resource.initial.write_stage = stage;
+    resource.initial.write_access = access;
+    resource.initial.layout = layout;
+    return AddResource(std::move(resource));
+}
+
+RenderGraph::Handle RenderGraph::CreateImage(const std::string &name, const ImageDesc &desc) {
+    Resource resource;
+    resource.name = name;
+    resource.transient = true;
+    resource.desc = desc;
+    return AddResource(std::move(resource));
+}
+
+void RenderGraph::Export(Handle resource, VkPipelineStageFlags stage, VkAccessFlags access, VkImageLayout layout) {
+    auto &exported = resources_.at(resource);
+    exported.exported = true;
+    exported.export_access = {resource, stage, access, layout, false};
+    compiled_ = false;
+}
+
+void RenderGraph::AddPass(const std::string &name, const SetupFunc &setup, ExecuteFunc execute) {
+    Pass pass;
+    pass.name = name;
+    pass.execute = std::move(execute);
+    passes_.emplace_back(std::move(pass));
+
+    PassBuilder builder(*this, static_cast<uint32_t>(passes_.size() - 1));
+    setup(builder);
+    compiled_ = false;
+}
+
+core::Buffer &RenderGraph::GetBuffer(Handle resource) const {
+    auto buffer = resources_.at(resource).buffer;
+    if (buffer == nullptr) {
+        throw std::runtime_error("Render graph resource " + resources_[resource].name + " is not a buffer");
+    }
+    return *buffer;
+}
+
+core::ImageView &RenderGraph::GetImageView(Handle resource) const {
+    const auto &image = resources_.at(resource);
+    const auto &transient_images = transient_sets_[frame_index_].images;
+    if (image.transient && image.transient_image < transient_images.size()) {
+        return *transient_images[image.transient_image].image_view;
+    }
+    if (image.image_view == nullptr) {
+        throw std::runtime_error("Render graph resource " + image.name + " is not a placed image");
+    }
+    return *image.image_view;
+}
+
+core::Image &RenderGraph::GetTransientImage(Handle resource) const {
+    const auto &image = resources_.at(resource);
+    const auto &transient_images = transient_sets_[frame_index_].images;
+    if (!image.transient || image.transient_image >= transient_images.size()) {
+        throw std::runtime_error("Render graph resource " + image.name + " is not a placed transient image");
+    }
+    return *transient_images[image.transient_image].image;
+}
+
+uint32_t RenderGraph::GetCulledPassCount() const { return culled_pass_count_; }
+
+uint32_t RenderGraph::GetBarrierBatchCount() const { return barrier_batch_count_; }
+
+VkDeviceSize RenderGraph::GetTransientMemorySize() const {
+    VkDeviceSize size = 0;
+    for (const auto &set : transient_sets_) {
+        for (const auto &block : set.blocks) {
+            size += block.requirements.size;
+        }
+    }
+    return size;
+}
+
+// MARK: - Compile
+void RenderGraph::Compile() {
+    CullPasses();
+    PlaceTransientImages();
+    BuildBarriers();
+    compiled_ = true;
+}
+
+void RenderGraph::CullPasses() {
+    // walk back from the outputs: a pass is kept if it has side effects, writes a resource owned by the caller or
+    // writes what a kept pass reads
+    std::vector<bool> needed(resources_.size(), false);
+    culled_pass_count_ = 0;
+    for (auto pass = passes_.rbegin(); pass != passes_.rend(); ++pass) {
+        bool keep = pass->side_effect;
+        for (const auto &access : pass->accesses) {
+            const auto &resource = resources_[access.resource];
+            if (access.write && (!resource.transient || resource.exported || needed[access.resource])) {
+                keep = true;
+            }
+        }
+
+        pass->culled = !keep;
+        if (pass->culled) {
+            culled_pass_count_++;
+            continue;
+        }
+        for (const auto &access : pass->accesses) {
+            if (!access.write || resources_[access.resource].transient) {
+                needed[access.resource] = true;
+            }
+        }
+    }
+
+    for (auto &resource : resources_) {
+        resource.first_pass = ~0u;
+        resource.last_pass = 0;
+    }
+    for (uint32_t i = 0; i < passes_.size(); i++) {
+        if (passes_[i].culled) {
+            continue;
+        }
+        for (const auto &access : passes_[i].accesses) {
+            auto &resource = resources_[access.resource];
+            resource.first_pass = std::min(resource.first_pass, i);
+            resource.last_pass = std::max(resource.last_pass, i);
+        }
+    }
+}
+
+void RenderGraph::PlaceTransientImages() {
+    std::vector<TransientImage> required;
+    for (auto &resource : resources_) {
+        resource.transient_image = ~0u;
+        if (resource.transient && resource.first_pass != ~0u) {
+            resource.transient_image = static_cast<uint32_t>(required.size());
+            TransientImage image;
+            image.desc = resource.desc;
+            image.first_pass = resource.first_pass;
+            image.last_pass = resource.last_pass;
+            required.emplace_back(std::move(image));
+        }
+    }
+
+    auto &set = transient_sets_[frame_index_];
+    const bool kUnchanged = std::equal(
+            required.begin(), required.end(), set.images.begin(), set.images.end(),
+            [](const TransientImage &a, const TransientImage &b) {
+                return a.desc == b.desc && a.first_pass == b.first_pass && a.last_pass == b.last_pass;
+            });
+    if (kUnchanged) {
+        return;
+    }
+
+    // the set was last used by this frame index, whose fence was waited on: no frame in flight uses it anymore
+    DestroyTransientImages(device_, set);
+    set.images = std::move(required);
+
+    std::vector<TransientAllocation> allocations;
+    allocations.reserve(set.images.size());
+    for (auto &image : set.images) {
+        VkImageCreateInfo create_info{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+        create_info.imageType = VK_IMAGE_TYPE_2D;
+        create_info.format = image.desc.format;
+        create_info.extent = {image.desc.extent.width, image.desc.extent.height, 1};
+        create_info.mipLevels = 1;
+        create_info.arrayLayers = 1;
+        create_info.samples = image.desc.sample_count;
+        create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+        create_info.usage = image.desc.usage;
+        create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VK_CHECK(vkCreateImage(device_.GetHandle(), &create_info, nullptr, &image.handle));
+        vkGetImageMemoryRequirements(device_.GetHandle(), image.handle, &image.requirements);
+        allocations.push_back({image.requirements.size, image.requirements.alignment,
+                               image.requirements.memoryTypeBits, image.first_pass, image.last_pass});
+    }
+
+    std::vector<TransientBlock> blocks;
+    const auto kPlacement = PlaceTransientAllocations(allocations, blocks);
+    set.blocks.resize(blocks.size());
+    VmaAllocationCreateInfo allocation_info{};
+    allocation_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    for (size_t i = 0; i < blocks.size(); i++) {
+        auto &block = set.blocks[i];
+        block.requirements = {blocks[i].size, blocks[i].alignment, blocks[i].memory_type_bits};
+        VK_CHECK(vmaAllocateMemory(device_.GetMemoryAllocator(), &block.requirements, &allocation_info,
+                                   &block.allocation, nullptr));
+    }
+    for (size_t i = 0; i < set.images.size(); i++) {
+        auto &image = set.images[i];
+        image.block = kPlacement[i];
+        VK_CHECK(vmaBindImageMemory(device_.GetMemoryAllocator(), set.blocks[image.block].allocation, image.handle));
+        image.image = std::make_unique<core::Image>(device_, image.handle,
+                                                    VkExtent3D{image.desc.extent.width, image.desc.extent.height, 1},
+                                                    image.desc.format, image.desc.usage, image.desc.sample_count);
+        image.image_view = std::make_unique<core::ImageView>(*image.image, VK_IMAGE_VIEW_TYPE_2D);
+    }
+    LOGI("Render graph placed {} transient images of frame {} in {} memory blocks ({} bytes)", set.images.size(),
+         frame_index_, set.blocks.size(),
+         std::accumulate(blocks.begin(), blocks.end(), VkDeviceSize{0},
+                         [](VkDeviceSize size, const TransientBlock &block) { return size + block.size; }))
+}
+
+void RenderGraph::DestroyTransientImages(Device &device, TransientSet &set) {
+    for (auto &image : set.images) {
+        image.image_view.reset();
+        image.image.reset();
+        if (image.handle != VK_NULL_HANDLE) {
+            vkDestroyImage(device.GetHandle(), image.handle, nullptr);
+        }
+    }
+    set.images.clear();
+
+    for (auto &block : set.blocks) {
+        if (block.allocation != VK_NULL_HANDLE) {
+            vmaFreeMemory(device.GetMemoryAllocator(), block.allocation);
+        }
+    }
+    set.blocks.clear();
+}
+
+void RenderGraph::BuildBarriers() {
+    auto &set = transient_sets_[frame_index_];
+    std::vector<ResourceState> states(resources_.size());
+    for (size_t i = 0; i < resources_.size(); i++) {
+        states[i] = resources_[i].initial;
+    }
+
+    for (uint32_t i = 0; i < passes_.size(); i++) {
+        auto &pass = passes_[i];
+        pass.barriers = {};
+        if (pass.culled) {
+            continue;
+        }
+
+        for (const auto &access : pass.accesses) {
+            const auto &resource = resources_[access.resource];
+            auto &state = states[access.resource];
+            MemoryBlock *block = nullptr;
+            if (resource.transient) {
+                block = &set.blocks[set.images[resource.transient_image].block];
+                if (resource.first_pass == i) {
+                    // the memory held the previous occupant, its contents are discarded
+                    state = {};
+                    state.write_stage = block->last_stage;
+                    state.write_access = block->last_access;
+                }
+            }
+
+            Synchronize(state, access, resource, pass.barriers);
+
+            if (block) {
+                block->last_stage = state.write_stage | state.read_stage;
+                block->last_access = state.write_access;
+            }
+        }
+    }
+
+    final_barriers_ = {};
+    for (size_t i = 0; i < resources_.size(); i++) {
+        if (resources_[i].exported && !(resources_[i].transient && resources_[i].transient_image == ~0u)) {
+            Synchronize(states[i], resources_[i].export_access, resources_[i], final_barriers_);
+        }
+    }
+}
+
+void RenderGraph::Synchronize(ResourceState &state,
+                              const Access &access,
+                              const Resource &resource,
+                              BarrierBatch &batch) const {
+    const bool kIsImage = resource.buffer == nullptr;
+    const VkImageLayout kNewLayout = kIsImage && access.layout != VK_IMAGE_LAYOUT_UNDEFINED ? access.layout
+                                                                                            : state.layout;
+    const bool kTransition = kNewLayout != state.layout;
+
+    VkPipelineStageFlags src_stage;
+    if (kTransition || access.write) {
+        // writes and layout transitions wait for every access since the last write
+        src_stage = state.write_stage | state.read_stage;
+        if (src_stage == 0 && !kTransition) {
+            state = {access.stage, access.access, 0, 0, kNewLayout};
+            return;
+        }
+    } else {
+        // reads wait for the last write, unless an earlier read made it visible to the same stages and accesses
+        src_stage = state.write_stage;
+        const bool kVisible = (state.read_stage & access.stage) == access.stage &&
+                              (state.read_access & access.access) == access.access;
+        if (src_stage == 0 || kVisible) {
+            state.read_stage |= access.stage;
+            state.read_access |= access.access;
+            return;
+        }
+    }
+
+    batch.src_stage_mask |= src_stage != 0 ? src_stage : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    batch.dst_stage_mask |= access.stage;
+    if (kIsImage) {
+        const auto &image_view = GetImageView(access.resource);
+        auto subresource_range = image_view.GetSubresourceRange();
+        if (IsDepthOnlyFormat(image_view.GetFormat())) {
+            subresource_range.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        } else if (IsDepthStencilFormat(image_view.GetFormat())) {
+            subresource_range.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        }
+
+        VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+        barrier.srcAccessMask = state.write_access;
+        barrier.dstAccessMask = access.access;
+        barrier.oldLayout = state.layout;
+        barrier.newLayout = kNewLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image_view.GetImage().GetHandle();
+        barrier.subresourceRange = subresource_range;
+        batch.image_barriers.push_back(barrier);
+    } else {
+        VkBufferMemoryBarrier barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+        barrier.srcAccessMask = state.write_access;
+        barrier.dstAccessMask = access.access;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = resource.buffer->GetHandle();
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+        batch.buffer_barriers.push_back(barrier);
+    }
+
+    if (kTransition || access.write) {
+        // a layout transition is ordered before the stages of the access, later accesses wait for them
+        state.write_stage = access.stage;
+        state.write_access = access.write ? access.access : 0;
+        state.read_stage = access.write ? 0 : access.stage;
+        state.read_access = access.write ? 0 : access.access;
+    } else {
+        state.read_stage |= access.stage;
+        state.read_access |= access.access;
+    }
+    state.layout = kNewLayout;
+}
+
+// MARK: - Execute
+void RenderGraph::Execute(CommandBuffer &command_buffer) {
+    if (!compiled_) {
+        Compile();
+    }
+
+    barrier_batch_count_ = 0;
+    auto record = [&](const BarrierBatch &batch) {
+        if (!batch.buffer_barriers.empty() || !batch.image_barriers.empty()) {
+            command_buffer.PipelineBarrier(batch.src_stage_mask, batch.dst_stage_mask, batch.buffer_barriers,
+                                           batch.image_barriers);
+            barrier_batch_count_++;
+        }
+    };
+
+    for (auto &pass : passes_) {
+        if (pass.culled) {
+            continue;
+        }
+        record(pass.barriers);
+        if (pass.execute) {
+            pass.execute(command_buffer);
+        }
+    }
+    record(final_barriers_);
+}
+
+}  // namespace vox
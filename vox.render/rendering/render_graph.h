@@ -0,0 +1,259 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "vox.render/core/buffer.h"
+#include "vox.render/core/image.h"
+#include "vox.render/core/image_view.h"
+#include "vox.render/vk_common.h"
+
+namespace vox {
+class CommandBuffer;
+class Device;
+
+/**
+ * Passes of a frame with the buffers and images they read and write.
+ * Compile culls the passes whose writes are never consumed, lets transient images whose lifetimes do not overlap
+ * share memory, and derives the barriers between passes: the barriers needed before a pass are recorded with one
+ * vkCmdPipelineBarrier. Imported resources are owned by the caller and count as outputs, their writers are kept.
+ * The graph is rebuilt every frame with Clear. Each frame in flight has its own transient images and memory, kept
+ * while the transient descriptions and lifetimes of that frame are unchanged.
+ */
+class RenderGraph {
+public:
+    using Handle = uint32_t;
+
+    struct ImageDesc {
+        VkExtent2D extent{0, 0};
+        VkFormat format{VK_FORMAT_UNDEFINED};
+        VkImageUsageFlags usage{0};
+        VkSampleCountFlagBits sample_count{VK_SAMPLE_COUNT_1_BIT};
+
+        bool operator==(const ImageDesc &other) const;
+    };
+
+    class PassBuilder {
+    public:
+        void Read(Handle resource,
+                  VkPipelineStageFlags stage,
+                  VkAccessFlags access,
+                  VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED);
+
+        void Write(Handle resource,
+                   VkPipelineStageFlags stage,
+                   VkAccessFlags access,
+                   VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED);
+
+        /**
+         * Keep the pass even if nothing reads what it writes, e.g. a readback through a mapped buffer.
+         */
+        void SetSideEffect();
+
+    private:
+        friend class RenderGraph;
+
+        PassBuilder(RenderGraph &graph, uint32_t pass);
+
+        RenderGraph &graph_;
+        uint32_t pass_;
+    };
+
+    using SetupFunc = std::function<void(PassBuilder &)>;
+
+    using ExecuteFunc = std::function<void(CommandBuffer &)>;
+
+    explicit RenderGraph(Device &device);
+
+    ~RenderGraph();
+
+    RenderGraph(const RenderGraph &) = delete;
+
+    RenderGraph &operator=(const RenderGraph &) = delete;
+
+    /**
+     * Forget the passes and the resources of the last frame, the transient memory is kept.
+     * @param frame_index Active frame index of the render context: the transient images of a frame are only reused
+     *                    once its fence was waited on, they are never written while another frame reads them
+     */
+    void Clear(uint32_t frame_index = 0);
+
+    /**
+     * @param stage, access Last access to the buffer before the graph, 0 when it was synchronized already
+     */
+    Handle ImportBuffer(const std::string &name,
+                        core::Buffer &buffer,
+                        VkPipelineStageFlags stage = 0,
+                        VkAccessFlags access = 0);
+
+    /**
+     * @param layout Layout of the image before the graph
+     */
+    Handle ImportImage(const std::string &name,
+                       core::ImageView &image_view,
+                       VkImageLayout layout,
+                       VkPipelineStageFlags stage = 0,
+                       VkAccessFlags access = 0);
+
+    /**
+     * Image living for the passes using it, placed by Compile.
+     */
+    Handle CreateImage(const std::string &name, const ImageDesc &desc);
+
+    /**
+     * Declare the access following the graph: the writers are kept and the last barrier is recorded by Execute.
+     */
+    void Export(Handle resource,
+                VkPipelineStageFlags stage,
+                VkAccessFlags access,
+                VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED);
+
+    void AddPass(const std::string &name, const SetupFunc &setup, ExecuteFunc execute);
+
+    void Compile();
+
+    void Execute(CommandBuffer &command_buffer);
+
+    [[nodiscard]] core::Buffer &GetBuffer(Handle resource) const;
+
+    /**
+     * @remarks Transient images are placed by Compile, the view is valid in the execute functions.
+     */
+    [[nodiscard]] core::ImageView &GetImageView(Handle resource) const;
+
+    /**
+     * Image of a placed transient resource, e.g. to create a render target over it in an execute function.
+     */
+    [[nodiscard]] core::Image &GetTransientImage(Handle resource) const;
+
+    [[nodiscard]] uint32_t GetCulledPassCount() const;
+
+    /**
+     * Barrier calls recorded by the last Execute, each one covering every transition before a pass.
+     */
+    [[nodiscard]] uint32_t GetBarrierBatchCount() const;
+
+    /**
+     * Memory of the transient images of every frame in flight.
+     */
+    [[nodiscard]] VkDeviceSize GetTransientMemorySize() const;
+
+private:
+    struct Access {
+        Handle resource{0};
+        VkPipelineStageFlags stage{0};
+        VkAccessFlags access{0};
+        VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};
+        bool write{false};
+    };
+
+    struct BarrierBatch {
+        VkPipelineStageFlags src_stage_mask{0};
+        VkPipelineStageFlags dst_stage_mask{0};
+        std::vector<VkBufferMemoryBarrier> buffer_barriers{};
+        std::vector<VkImageMemoryBarrier> image_barriers{};
+    };
+
+    struct Pass {
+        std::string name;
+        ExecuteFunc execute;
+        std::vector<Access> accesses{};
+        bool side_effect{false};
+        bool culled{false};
+        BarrierBatch barriers{};
+    };
+
+    /**
+     * Synchronization state of a resource while the passes are walked: the last write and the reads after it.
+     */
+    struct ResourceState {
+        VkPipelineStageFlags write_stage{0};
+        VkAccessFlags write_access{0};
+        VkPipelineStageFlags read_stage{0};
+        VkAccessFlags read_access{0};
+        VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};
+    };
+
+    struct Resource {
+        std::string name;
+        core::Buffer *buffer{nullptr};
+        core::ImageView *image_view{nullptr};
+        ResourceState initial{};
+
+        bool exported{false};
+        Access export_access{};
+
+        // transient images
+        bool transient{false};
+        ImageDesc desc{};
+        uint32_t first_pass{~0u};
+        uint32_t last_pass{0};
+        uint32_t transient_image{~0u};
+    };
+
+    struct TransientImage {
+        ImageDesc desc{};
+        uint32_t first_pass{0};
+        uint32_t last_pass{0};
+        VkImage handle{VK_NULL_HANDLE};
+        VkMemoryRequirements requirements{};
+        uint32_t block{0};
+        std::unique_ptr<core::Image> image{nullptr};
+        std::unique_ptr<core::ImageView> image_view{nullptr};
+    };
+
+    /**
+     * Memory shared by transient images used by disjoint ranges of passes, the state of its last occupant orders the
+     * next occupant.
+     */
+    struct MemoryBlock {
+        VkMemoryRequirements requirements{};
+        VmaAllocation allocation{VK_NULL_HANDLE};
+        VkPipelineStageFlags last_stage{0};
+        VkAccessFlags last_access{0};
+    };
+
+    struct TransientSet {
+        std::vector<TransientImage> images{};
+        std::vector<MemoryBlock> blocks{};
+    };
+
+    Handle AddResource(Resource &&resource);
+
+    void CullPasses();
+
+    void PlaceTransientImages();
+
+    static void DestroyTransientImages(Device &device, TransientSet &set);
+
+    void BuildBarriers();
+
+    /**
+     * Add the barrier ordering the access after the state of the resource to the batch, if one is needed.
+     */
+    void Synchronize(ResourceState &state, const Access &access, const Resource &resource, BarrierBatch &batch) const;
+
+    Device &device_;
+
+    std::vector<Pass> passes_{};
+    std::vector<Resource> resources_{};
+    bool compiled_{false};
+
+    // one set per frame in flight, indexed by the frame index given to Clear
+    std::vector<TransientSet> transient_sets_{};
+    uint32_t frame_index_{0};
+
+    BarrierBatch final_barriers_{};
+    uint32_t culled_pass_count_{0};
+    uint32_t barrier_batch_count_{0};
+};
+
+}  // namespace vox
@@ -0,0 +1,56 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.render/rendering/render_graph_placement.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace vox {
+bool LifetimesOverlap(const TransientAllocation &a, const TransientAllocation &b) {
+    return a.first_pass <= b.last_pass && b.first_pass <= a.last_pass;
+}
+
+std::vector<uint32_t> PlaceTransientAllocations(const std::vector<TransientAllocation> &allocations,
+                                                std::vector<TransientBlock> &blocks) {
+    std::vector<uint32_t> order(allocations.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](uint32_t a, uint32_t b) { return allocations[a].size > allocations[b].size; });
+
+    blocks.clear();
+    std::vector<uint32_t> placement(allocations.size(), 0);
+    std::vector<std::vector<uint32_t>> block_allocations;
+    for (auto index : order) {
+        const auto &allocation = allocations[index];
+        uint32_t block = 0;
+        for (; block < blocks.size(); block++) {
+            if ((blocks[block].memory_type_bits & allocation.memory_type_bits) == 0) {
+                continue;
+            }
+            const bool kOverlap = std::any_of(
+                    block_allocations[block].begin(), block_allocations[block].end(),
+                    [&](uint32_t other) { return LifetimesOverlap(allocations[other], allocation); });
+            if (!kOverlap) {
+                break;
+            }
+        }
+        if (block == blocks.size()) {
+            blocks.emplace_back();
+            block_allocations.emplace_back();
+        }
+
+        auto &target = blocks[block];
+        target.size = std::max(target.size, allocation.size);
+        target.alignment = std::max(target.alignment, allocation.alignment);
+        target.memory_type_bits &= allocation.memory_type_bits;
+        block_allocations[block].push_back(index);
+        placement[index] = block;
+    }
+    return placement;
+}
+
+}  // namespace vox
@@ -0,0 +1,47 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace vox {
+/**
+ * Memory needed by a transient image of the render graph and the passes using it, first and last included.
+ */
+struct TransientAllocation {
+    uint64_t size{0};
+    uint64_t alignment{1};
+    uint32_t memory_type_bits{~0u};
+    uint32_t first_pass{0};
+    uint32_t last_pass{0};
+};
+
+/**
+ * Memory block shared by transient images: large and aligned enough for each of them, with the memory types they
+ * all accept.
+ */
+struct TransientBlock {
+    uint64_t size{0};
+    uint64_t alignment{1};
+    uint32_t memory_type_bits{~0u};
+};
+
+/**
+ * Two images alias only when no pass uses both, a pass ending one lifetime and starting the other included.
+ */
+[[nodiscard]] bool LifetimesOverlap(const TransientAllocation &a, const TransientAllocation &b);
+
+/**
+ * Place the largest images first, each one in the first block of compatible memory whose images it does not overlap.
+ * @param blocks Receives the blocks to allocate
+ * @return Block of each allocation
+ */
+std::vector<uint32_t> PlaceTransientAllocations(const std::vector<TransientAllocation> &allocations,
+                                                std::vector<TransientBlock> &blocks);
+
+}  // namespace vox
@@ -6,6 +6,8 @@
 
 #include "vox.render/rendering/render_pipeline.h"
 
+#include "vox.render/stats/gpu_profiler.h"
+
 namespace vox {
 RenderPipeline::RenderPipeline(std::vector<std::unique_ptr<Subpass>> &&subpasses) : subpasses_{std::move(subpasses)} {
     Prepare();
@@ -61,6 +63,7 @@ void RenderPipeline::Draw(CommandBuffer &command_buffer, RenderTarget &render_ta
             subpass->SetDebugName(fmt::format("RP subpass #{}", i));
         }
         ScopedDebugLabel subpass_debug_label{command_buffer, subpass->GetDebugName().c_str()};
+        ScopedGpuTimer subpass_timer{command_buffer, subpass->GetInternedDebugName(), StatIndex::GPU_RENDER_PASS_TIME};
 
         subpass->Draw(command_buffer);
     }
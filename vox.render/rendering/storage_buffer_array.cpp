@@ -0,0 +1,88 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.render/rendering/storage_buffer_array.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "vox.render/rendering/render_context.h"
+
+namespace vox {
+StorageBufferArray::StorageBufferArray(Device &device,
+                                       RenderContext &render_context,
+                                       size_t element_size,
+                                       size_t min_capacity)
+    : device_(device), render_context_(render_context), element_size_(element_size) {
+    const auto kFrameCount = std::max<size_t>(render_context.GetRenderFrames().size(), 1);
+    for (size_t i = 0; i < kFrameCount; i++) {
+        buffers_.emplace_back(std::make_unique<core::Buffer>(device_, std::max<size_t>(min_capacity, 1) * element_size_,
+                                                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                             VMA_MEMORY_USAGE_CPU_TO_GPU));
+        capacities_.push_back(std::max<size_t>(min_capacity, 1));
+    }
+    contents_.resize(kFrameCount);
+    valid_counts_.resize(kFrameCount, 0);
+}
+
+uint8_t *StorageBufferArray::Map(size_t count) {
+    active_frame_ = render_context_.GetActiveFrameIndex() % buffers_.size();
+    auto &capacity = capacities_[active_frame_];
+    if (capacity < count) {
+        // the fence of the active frame has been waited on, its buffer is not in use anymore
+        while (capacity < count) {
+            capacity *= 2;
+        }
+        buffers_[active_frame_] = std::make_unique<core::Buffer>(device_, capacity * element_size_,
+                                                                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                                 VMA_MEMORY_USAGE_CPU_TO_GPU);
+    }
+    // the caller writes the memory directly, the host copy does not mirror it anymore
+    valid_counts_[active_frame_] = 0;
+    return buffers_[active_frame_]->Map();
+}
+
+void StorageBufferArray::Flush() { buffers_[active_frame_]->Flush(); }
+
+void StorageBufferArray::Update(const void *data, size_t count) {
+    auto *mapped = Map(count);
+    if (count) {
+        std::copy_n(static_cast<const uint8_t *>(data), count * element_size_, mapped);
+    }
+    Flush();
+}
+
+size_t StorageBufferArray::UpdateChanged(const void *data, size_t count) {
+    const size_t kFrame = render_context_.GetActiveFrameIndex() % buffers_.size();
+    const size_t kValidCount = capacities_[kFrame] < count ? 0 : valid_counts_[kFrame];
+    auto *mapped = Map(count);
+    auto &content = contents_[active_frame_];
+    content.resize(capacities_[active_frame_] * element_size_);
+
+    const auto *source = static_cast<const uint8_t *>(data);
+    size_t written = 0;
+    for (size_t i = 0; i < count; i++) {
+        const size_t kOffset = i * element_size_;
+        if (i < kValidCount && std::memcmp(content.data() + kOffset, source + kOffset, element_size_) == 0) {
+            continue;
+        }
+        std::memcpy(content.data() + kOffset, source + kOffset, element_size_);
+        std::memcpy(mapped + kOffset, source + kOffset, element_size_);
+        written++;
+    }
+    valid_counts_[active_frame_] = std::max(kValidCount, count);
+
+    if (written) {
+        Flush();
+    }
+    return written;
+}
+
+core::Buffer *StorageBufferArray::Buffer() { return buffers_[active_frame_].get(); }
+
+size_t StorageBufferArray::Capacity() const { return capacities_[active_frame_]; }
+
+}  // namespace vox
@@ -0,0 +1,84 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "vox.render/core/buffer.h"
+
+namespace vox {
+class RenderContext;
+
+/**
+ * @brief Host visible storage buffer holding a runtime-sized array, one buffer per frame in flight.
+ *        The capacity grows by powers of two, shaders read the element count from a uniform, so neither the shader
+ *        layout nor its variant depends on the number of elements.
+ */
+class StorageBufferArray {
+public:
+    /**
+     * @param element_size Size of an element, laid out with the std430 rules
+     * @param min_capacity Number of elements the buffers are created with
+     */
+    StorageBufferArray(Device &device, RenderContext &render_context, size_t element_size, size_t min_capacity = 16);
+
+    /**
+     * @brief Make the buffer of the active frame large enough for the given count, and map it.
+     * @remarks The content is lost when the buffer grows, the next UpdateChanged rewrites every element.
+     * @return Mapped memory, to be flushed with Flush() once written
+     */
+    uint8_t *Map(size_t count);
+
+    void Flush();
+
+    /**
+     * @brief Copy the elements to the buffer of the active frame.
+     */
+    void Update(const void *data, size_t count);
+
+    template <typename T>
+    void Update(const std::vector<T> &elements) {
+        Update(elements.data(), elements.size());
+    }
+
+    /**
+     * @brief Copy only the elements which differ from the last content written to the buffer of the active frame.
+     *        A host copy of every frame buffer is kept for the comparison, so write-combined memory is never read.
+     * @return Number of elements written
+     */
+    size_t UpdateChanged(const void *data, size_t count);
+
+    template <typename T>
+    size_t UpdateChanged(const std::vector<T> &elements) {
+        return UpdateChanged(elements.data(), elements.size());
+    }
+
+    /**
+     * @brief Buffer of the last updated frame, to be bound with ShaderData::SetBufferFunctor.
+     */
+    [[nodiscard]] core::Buffer *Buffer();
+
+    /**
+     * @brief Number of elements the buffer of the last updated frame can hold.
+     */
+    [[nodiscard]] size_t Capacity() const;
+
+private:
+    Device &device_;
+    RenderContext &render_context_;
+    size_t element_size_;
+
+    std::vector<std::unique_ptr<core::Buffer>> buffers_{};
+    std::vector<size_t> capacities_{};
+    // host copies used by UpdateChanged, the first valid_counts_ elements mirror the frame buffer
+    std::vector<std::vector<uint8_t>> contents_{};
+    std::vector<size_t> valid_counts_{};
+    size_t active_frame_{0};
+};
+
+}  // namespace vox
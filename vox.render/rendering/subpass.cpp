@@ -8,6 +8,7 @@
 
 #include <utility>
 
+#include "vox.base/tracer.h"
 #include "vox.render/material/material.h"
 #include "vox.render/renderer.h"
 #include "vox.render/rendering/render_context.h"
@@ -58,7 +59,14 @@ void Subpass::SetSampleCount(VkSampleCountFlagBits sample_count) { sample_count_
 
 const std::string &Subpass::GetDebugName() const { return debug_name_; }
 
-void Subpass::SetDebugName(const std::string &name) { debug_name_ = name; }
+const char *Subpass::GetInternedDebugName() const { return interned_debug_name_; }
+
+void Subpass::SetDebugName(const std::string &name) {
+    debug_name_ = name;
+    interned_debug_name_ = utility::Tracer::Intern(name);
+}
+
+void Subpass::SetCamera(Camera *camera) { camera_ = camera; }
 
 bool Subpass::CompareFromNearToFar(const RenderElement &a, const RenderElement &b) {
     return (a.material->render_queue_ < b.material->render_queue_) ||
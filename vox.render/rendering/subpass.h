@@ -86,8 +86,18 @@ public:
 
     [[nodiscard]] const std::string &GetDebugName() const;
 
+    /**
+     * @brief The debug name interned when it is set, for the GPU scopes which store names by pointer
+     */
+    [[nodiscard]] const char *GetInternedDebugName() const;
+
     void SetDebugName(const std::string &name);
 
+    /**
+     * @brief Render from another camera of the scene, used by offscreen batch rendering
+     */
+    void SetCamera(Camera *camera);
+
 protected:
     RenderContext &render_context_;
     Scene *scene_{nullptr};
@@ -107,6 +117,7 @@ protected:
 
 private:
     std::string debug_name_{};
+    const char *interned_debug_name_{""};
 
     /**
      * @brief When creating the renderpass, pDepthStencilAttachment will
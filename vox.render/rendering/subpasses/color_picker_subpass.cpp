@@ -7,8 +7,10 @@
 #include "vox.render/rendering/subpasses/color_picker_subpass.h"
 
 #include "vox.base/logging.h"
+#include "vox.math/bounding_frustum.h"
 #include "vox.render/camera.h"
 #include "vox.render/components_manager.h"
+#include "vox.render/entity.h"
 #include "vox.render/mesh/mesh.h"
 #include "vox.render/renderer.h"
 #include "vox.render/shader/shader_manager.h"
@@ -39,31 +41,55 @@ uint32_t ColorPickerSubpass::ColorToId(const std::array<uint8_t, 4> &color) {
 }
 
 std::pair<Renderer *, MeshPtr> ColorPickerSubpass::GetObjectByColor(const std::array<uint8_t, 4> &color) {
-    auto iter = primitives_map_.find(ColorToId(color));
-    if (iter != primitives_map_.end()) {
-        return iter->second;
+    const uint32_t kId = ColorToId(color);
+    if (kId < primitives_.size()) {
+        return primitives_[kId];
     } else {
         return std::make_pair(nullptr, nullptr);
     }
 }
 
+const std::vector<std::pair<Renderer *, MeshPtr>> &ColorPickerSubpass::Primitives() const { return primitives_; }
+
+void ColorPickerSubpass::SetRegion(const Vector4F &region) { region_ = region; }
+
+const Vector4F &ColorPickerSubpass::Region() const { return region_; }
+
 void ColorPickerSubpass::Prepare() {}
 
 void ColorPickerSubpass::Draw(CommandBuffer &command_buffer) {
-    current_id_ = 0;
-    primitives_map_.clear();
+    primitives_.clear();
 
     auto compile_variant = ShaderVariant();
     scene_->shader_data.MergeVariants(compile_variant, compile_variant);
     camera_->shader_data_.MergeVariants(compile_variant, compile_variant);
 
+    // crop the projection to the region, in clip space
+    Matrix4x4F crop = Matrix4x4F::makeIdentity();
+    crop(0, 0) = 1.f / region_.z;
+    crop(0, 3) = (1.f - 2.f * region_.x - region_.z) / region_.z;
+    crop(1, 1) = 1.f / region_.w;
+    crop(1, 3) = (1.f - 2.f * region_.y - region_.w) / region_.w;
+
+    Camera::CameraData camera_data;
+    camera_data.view_mat = camera_->ViewMatrix();
+    camera_data.proj_mat = crop * camera_->ProjectionMatrix();
+    camera_data.vp_mat = camera_data.proj_mat * camera_data.view_mat;
+    camera_data.view_inv_mat = camera_->GetEntity()->transform->WorldMatrix();
+    camera_data.proj_inv_mat = camera_data.proj_mat.inverse();
+    camera_data.camera_pos = camera_->GetEntity()->transform->WorldPosition();
+    camera_allocation_ = render_context_.GetActiveFrame().AllocateBuffer(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                                                                         sizeof(Camera::CameraData), 0);
+    camera_allocation_.Update(camera_data);
+
+    BoundingFrustum frustum;
+    frustum.calculateFromMatrix(camera_data.vp_mat);
+
+    // ids are only compared, the draw order does not matter
     std::vector<RenderElement> opaque_queue;
     std::vector<RenderElement> alpha_test_queue;
     std::vector<RenderElement> transparent_queue;
-    ComponentsManager::GetSingleton().CallRender(camera_, opaque_queue, alpha_test_queue, transparent_queue);
-    std::sort(opaque_queue.begin(), opaque_queue.end(), CompareFromNearToFar);
-    std::sort(alpha_test_queue.begin(), alpha_test_queue.end(), CompareFromNearToFar);
-    std::sort(transparent_queue.begin(), transparent_queue.end(), CompareFromFarToNear);
+    ComponentsManager::GetSingleton().CallRender(frustum, opaque_queue, alpha_test_queue, transparent_queue, camera_, 0);
 
     DrawElement(command_buffer, opaque_queue, compile_variant);
     DrawElement(command_buffer, alpha_test_queue, compile_variant);
@@ -79,6 +105,10 @@ void ColorPickerSubpass::DrawElement(CommandBuffer &command_buffer,
         if (exclusive != exclusive_list_.end()) {
             continue;
         }
+        // vertices generated on the GPU can not be drawn by the picking shader
+        if (element.mesh->IndirectBuffer()) {
+            continue;
+        }
         auto macros = variant;
         auto &renderer = element.renderer;
         renderer->UpdateShaderData();
@@ -87,11 +117,10 @@ void ColorPickerSubpass::DrawElement(CommandBuffer &command_buffer,
         auto &mesh = element.mesh;
         ScopedDebugLabel submesh_debug_label{command_buffer, mesh->name_.c_str()};
 
-        primitives_map_[current_id_] = std::make_pair(renderer, mesh);
         auto &render_frame = render_context_.GetActiveFrame();
         auto allocation = render_frame.AllocateBuffer(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(Color), 0);
-        allocation.Update(IdToColor(current_id_));
-        current_id_ += 1;
+        allocation.Update(IdToColor(static_cast<uint32_t>(primitives_.size())));
+        primitives_.emplace_back(renderer, mesh);
 
         // pipeline state
         material_.multisample_state_.rasterization_samples = sample_count_;
@@ -111,10 +140,12 @@ void ColorPickerSubpass::DrawElement(CommandBuffer &command_buffer,
         command_buffer.BindPipelineLayout(pipeline_layout);
 
         // uniform & texture
-        DescriptorSetLayout &descriptor_set_layout = pipeline_layout.GetDescriptorSetLayout(0);
-        scene_->shader_data.BindData(command_buffer, descriptor_set_layout);
-        camera_->shader_data_.BindData(command_buffer, descriptor_set_layout);
-        renderer->shader_data_.BindData(command_buffer, descriptor_set_layout);
+        scene_->shader_data.BindData(command_buffer, pipeline_layout);
+        camera_->shader_data_.BindData(command_buffer, pipeline_layout);
+        renderer->shader_data_.BindData(command_buffer, pipeline_layout);
+        // cameraData of unlit.vert, cropped to the region
+        command_buffer.BindBuffer(camera_allocation_.GetBuffer(), camera_allocation_.GetOffset(),
+                                  camera_allocation_.GetSize(), 0, 5, 0);
         command_buffer.BindBuffer(allocation.GetBuffer(), allocation.GetOffset(), allocation.GetSize(), 0, 10, 0);
 
         // vertex buffer
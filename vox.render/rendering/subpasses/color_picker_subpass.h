@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "vox.render/buffer_pool.h"
 #include "vox.render/material/base_material.h"
 #include "vox.render/rendering/subpass.h"
 #include "vox.render/shader/shader_source.h"
@@ -43,6 +44,15 @@ public:
 
     void ClearExclusiveList();
 
+    /**
+     * Restrict the rendering to a region of the camera viewport, stretched over the whole render target.
+     * The culling frustum is narrowed to the region, so only the renderers it overlaps are drawn.
+     * @param region x, y, width, height in normalized viewport coordinates, the upper left corner is (0, 0)
+     */
+    void SetRegion(const Vector4F &region);
+
+    [[nodiscard]] const Vector4F &Region() const;
+
 public:
     /**
      * Convert id to RGB color value, 0 and 0xffffff are illegal values.
@@ -60,13 +70,19 @@ public:
      */
     std::pair<Renderer *, MeshPtr> GetObjectByColor(const std::array<uint8_t, 4> &color);
 
+    /**
+     * Elements drawn by the last Draw, indexed by id.
+     */
+    [[nodiscard]] const std::vector<std::pair<Renderer *, MeshPtr>> &Primitives() const;
+
 private:
     void DrawElement(CommandBuffer &command_buffer,
                      const std::vector<RenderElement> &items,
                      const ShaderVariant &variant);
 
-    uint32_t current_id_ = 0;
-    std::unordered_map<size_t, std::pair<Renderer *, MeshPtr>> primitives_map_;
+    std::vector<std::pair<Renderer *, MeshPtr>> primitives_;
+    Vector4F region_{0, 0, 1, 1};
+    BufferAllocation camera_allocation_;
 
     ColorPickerMaterial material_;
 
@@ -8,6 +8,7 @@
 
 #include "vox.render/camera.h"
 #include "vox.render/components_manager.h"
+#include "vox.render/material/bindless_texture_table.h"
 #include "vox.render/material/material.h"
 #include "vox.render/mesh/mesh.h"
 #include "vox.render/renderer.h"
@@ -63,7 +64,7 @@ void GeometrySubpass::DrawElement(CommandBuffer &command_buffer,
         auto &renderer = element.renderer;
         uint32_t shadow_count = ShadowManager::GetSingleton().ShadowCount();
         if (renderer->receive_shadow_ && shadow_count != 0) {
-            renderer->shader_data_.AddDefine(SHADOW_MAP_COUNT + std::to_string(shadow_count));
+            renderer->shader_data_.AddDefine(HAS_SHADOW_MAP);
         }
         renderer->UpdateShaderData();
         renderer->shader_data_.MergeVariants(macros, macros);
@@ -96,12 +97,14 @@ void GeometrySubpass::DrawElement(CommandBuffer &command_buffer,
         auto &pipeline_layout = PreparePipelineLayout(command_buffer, shader_modules);
         command_buffer.BindPipelineLayout(pipeline_layout);
 
-        // uniform & texture
-        DescriptorSetLayout &descriptor_set_layout = pipeline_layout.GetDescriptorSetLayout(0);
-        scene_->shader_data.BindData(command_buffer, descriptor_set_layout);
-        camera_->shader_data_.BindData(command_buffer, descriptor_set_layout);
-        renderer->shader_data_.BindData(command_buffer, descriptor_set_layout);
-        material->shader_data_.BindData(command_buffer, descriptor_set_layout);
+        // uniform & texture, the sets which did not change since the last draw are kept
+        scene_->shader_data.BindData(command_buffer, pipeline_layout);
+        camera_->shader_data_.BindData(command_buffer, pipeline_layout);
+        renderer->shader_data_.BindData(command_buffer, pipeline_layout);
+        material->shader_data_.BindData(command_buffer, pipeline_layout);
+        if (auto bindless_texture_table = BindlessTextureTable::GetSingletonPtr()) {
+            bindless_texture_table->Bind(command_buffer, pipeline_layout);
+        }
 
         // vertex buffer
         command_buffer.SetVertexInputState(mesh->VertexInputState());
@@ -120,7 +123,16 @@ void GeometrySubpass::DrawElement(CommandBuffer &command_buffer,
             command_buffer.BindIndexBuffer(index_buffer_binding->Buffer(), 0, index_buffer_binding->IndexType());
 
             // Draw submesh using indexed data
-            command_buffer.DrawIndexed(sub_mesh->Count(), mesh->InstanceCount(), sub_mesh->Start(), 0, 0);
+            if (mesh->IndirectBuffer()) {
+                command_buffer.DrawIndexedIndirect(*mesh->IndirectBuffer(), mesh->IndirectOffset(), 1,
+                                                   sizeof(VkDrawIndexedIndirectCommand));
+            } else {
+                command_buffer.DrawIndexed(sub_mesh->Count(), mesh->InstanceCount(), sub_mesh->Start(), 0, 0);
+            }
+        } else if (mesh->IndirectBuffer()) {
+            // Draw submesh with the vertex and instance count written on the GPU
+            command_buffer.DrawIndirect(*mesh->IndirectBuffer(), mesh->IndirectOffset(), 1,
+                                        sizeof(VkDrawIndirectCommand));
         } else {
             // Draw submesh using vertices only
             command_buffer.Draw(sub_mesh->Count(), mesh->InstanceCount(), 0, 0);
@@ -25,9 +25,9 @@ void ResourceBindingState::BindBuffer(const core::Buffer &buffer,
                                       uint32_t set,
                                       uint32_t binding,
                                       uint32_t array_element) {
-    resource_sets_[set].BindBuffer(buffer, offset, range, binding, array_element);
-
-    dirty_ = true;
+    if (resource_sets_[set].BindBuffer(buffer, offset, range, binding, array_element)) {
+        dirty_ = true;
+    }
 }
 
 void ResourceBindingState::BindImage(const core::ImageView &image_view,
@@ -35,27 +35,27 @@ void ResourceBindingState::BindImage(const core::ImageView &image_view,
                                      uint32_t set,
                                      uint32_t binding,
                                      uint32_t array_element) {
-    resource_sets_[set].BindImage(image_view, sampler, binding, array_element);
-
-    dirty_ = true;
+    if (resource_sets_[set].BindImage(image_view, sampler, binding, array_element)) {
+        dirty_ = true;
+    }
 }
 
 void ResourceBindingState::BindImage(const core::ImageView &image_view,
                                      uint32_t set,
                                      uint32_t binding,
                                      uint32_t array_element) {
-    resource_sets_[set].BindImage(image_view, binding, array_element);
-
-    dirty_ = true;
+    if (resource_sets_[set].BindImage(image_view, binding, array_element)) {
+        dirty_ = true;
+    }
 }
 
 void ResourceBindingState::BindInput(const core::ImageView &image_view,
                                      uint32_t set,
                                      uint32_t binding,
                                      uint32_t array_element) {
-    resource_sets_[set].BindInput(image_view, binding, array_element);
-
-    dirty_ = true;
+    if (resource_sets_[set].BindInput(image_view, binding, array_element)) {
+        dirty_ = true;
+    }
 }
 
 const std::unordered_map<uint32_t, ResourceSet> &ResourceBindingState::GetResourceSets() { return resource_sets_; }
@@ -68,46 +68,87 @@ void ResourceSet::Reset() {
 
 bool ResourceSet::IsDirty() const { return dirty_; }
 
-void ResourceSet::ClearDirty() { dirty_ = false; }
+bool ResourceSet::IsOffsetDirty() const { return offset_dirty_; }
+
+void ResourceSet::ClearDirty() {
+    dirty_ = false;
+    offset_dirty_ = false;
+
+    for (auto &binding_it : resource_bindings_) {
+        for (auto &element_it : binding_it.second) {
+            element_it.second.dirty = false;
+        }
+    }
+}
 
 void ResourceSet::ClearDirty(uint32_t binding, uint32_t array_element) {
     resource_bindings_[binding][array_element].dirty = false;
 }
 
-void ResourceSet::BindBuffer(
+bool ResourceSet::BindBuffer(
         const core::Buffer &buffer, VkDeviceSize offset, VkDeviceSize range, uint32_t binding, uint32_t array_element) {
-    resource_bindings_[binding][array_element].dirty = true;
-    resource_bindings_[binding][array_element].buffer = &buffer;
-    resource_bindings_[binding][array_element].offset = offset;
-    resource_bindings_[binding][array_element].range = range;
+    auto &resource_info = resource_bindings_[binding][array_element];
+    if (resource_info.buffer == &buffer && resource_info.range == range) {
+        if (resource_info.offset == offset) {
+            return false;
+        }
+        resource_info.dirty = true;
+        resource_info.offset = offset;
+        offset_dirty_ = true;
+        return true;
+    }
+
+    resource_info.dirty = true;
+    resource_info.buffer = &buffer;
+    resource_info.offset = offset;
+    resource_info.range = range;
 
     dirty_ = true;
+    return true;
 }
 
-void ResourceSet::BindImage(const core::ImageView &image_view,
+bool ResourceSet::BindImage(const core::ImageView &image_view,
                             const core::Sampler &sampler,
                             uint32_t binding,
                             uint32_t array_element) {
-    resource_bindings_[binding][array_element].dirty = true;
-    resource_bindings_[binding][array_element].image_view = &image_view;
-    resource_bindings_[binding][array_element].sampler = &sampler;
+    auto &resource_info = resource_bindings_[binding][array_element];
+    if (resource_info.image_view == &image_view && resource_info.sampler == &sampler) {
+        return false;
+    }
+
+    resource_info.dirty = true;
+    resource_info.image_view = &image_view;
+    resource_info.sampler = &sampler;
 
     dirty_ = true;
+    return true;
 }
 
-void ResourceSet::BindImage(const core::ImageView &image_view, uint32_t binding, uint32_t array_element) {
-    resource_bindings_[binding][array_element].dirty = true;
-    resource_bindings_[binding][array_element].image_view = &image_view;
-    resource_bindings_[binding][array_element].sampler = nullptr;
+bool ResourceSet::BindImage(const core::ImageView &image_view, uint32_t binding, uint32_t array_element) {
+    auto &resource_info = resource_bindings_[binding][array_element];
+    if (resource_info.image_view == &image_view && resource_info.sampler == nullptr) {
+        return false;
+    }
+
+    resource_info.dirty = true;
+    resource_info.image_view = &image_view;
+    resource_info.sampler = nullptr;
 
     dirty_ = true;
+    return true;
 }
 
-void ResourceSet::BindInput(const core::ImageView &image_view, uint32_t binding, uint32_t array_element) {
-    resource_bindings_[binding][array_element].dirty = true;
-    resource_bindings_[binding][array_element].image_view = &image_view;
+bool ResourceSet::BindInput(const core::ImageView &image_view, uint32_t binding, uint32_t array_element) {
+    auto &resource_info = resource_bindings_[binding][array_element];
+    if (resource_info.image_view == &image_view) {
+        return false;
+    }
+
+    resource_info.dirty = true;
+    resource_info.image_view = &image_view;
 
     dirty_ = true;
+    return true;
 }
 
 const BindingMap<ResourceInfo> &ResourceSet::GetResourceBindings() const { return resource_bindings_; }
@@ -36,6 +36,9 @@ struct ResourceInfo {
  *        by a command buffer.
  *
  * The ResourceSet has a one to one mapping with a DescriptorSet.
+ * Binding the resource already bound is a no-op, and a buffer bound again at another offset only makes the set
+ * offset dirty: the descriptor set can be reused if the binding is dynamic.
+ * The bind functions return whether the set changed.
  */
 class ResourceSet {
 public:
@@ -43,30 +46,37 @@ public:
 
     [[nodiscard]] bool IsDirty() const;
 
+    /**
+     * @brief Whether only buffer offsets changed, the changed bindings have their resource info dirty
+     */
+    [[nodiscard]] bool IsOffsetDirty() const;
+
     void ClearDirty();
 
     void ClearDirty(uint32_t binding, uint32_t array_element);
 
-    void BindBuffer(const core::Buffer &buffer,
+    bool BindBuffer(const core::Buffer &buffer,
                     VkDeviceSize offset,
                     VkDeviceSize range,
                     uint32_t binding,
                     uint32_t array_element);
 
-    void BindImage(const core::ImageView &image_view,
+    bool BindImage(const core::ImageView &image_view,
                    const core::Sampler &sampler,
                    uint32_t binding,
                    uint32_t array_element);
 
-    void BindImage(const core::ImageView &image_view, uint32_t binding, uint32_t array_element);
+    bool BindImage(const core::ImageView &image_view, uint32_t binding, uint32_t array_element);
 
-    void BindInput(const core::ImageView &image_view, uint32_t binding, uint32_t array_element);
+    bool BindInput(const core::ImageView &image_view, uint32_t binding, uint32_t array_element);
 
     [[nodiscard]] const BindingMap<ResourceInfo> &GetResourceBindings() const;
 
 private:
     bool dirty_{false};
 
+    bool offset_dirty_{false};
+
     BindingMap<ResourceInfo> resource_bindings_;
 };
 
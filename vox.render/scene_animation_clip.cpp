@@ -6,57 +6,155 @@
 
 #include "vox.render/scene_animation_clip.h"
 
-#include <iostream>
+#include <algorithm>
+#include <cmath>
 #include <utility>
 
+#include "vox.base/logging.h"
+
 namespace vox {
 SceneAnimationClip::SceneAnimationClip(std::string name) : name_(std::move(name)) {}
 
 const std::string &SceneAnimationClip::name() const { return name_; }
 
 void SceneAnimationClip::update(float delta_time) {
+    evaluate(delta_time);
+    apply_pose();
+}
+
+void SceneAnimationClip::evaluate(float delta_time) {
     current_time_ += delta_time;
-    if (current_time_ > end_) {
-        current_time_ -= end_;
+    if (end_ > 0.0f && current_time_ > end_) {
+        current_time_ = std::fmod(current_time_, end_);
+    }
+
+    std::fill(pose_masks_.begin(), pose_masks_.end(), 0);
+    for (size_t i = 0; i < channel_tracks_.size(); i++) {
+        const auto path = channel_paths_[i];
+        Vector4F value;
+        if (is_compressed()) {
+            if (channel_tracks_[i] >= compressed_tracks_.size()) continue;
+            const auto &track = compressed_tracks_[channel_tracks_[i]];
+            if (track.IsEmpty()) continue;
+
+            const uint32_t key = track.FindKey(current_time_, channel_cursors_[i]);
+            channel_cursors_[i] = key;
+            value = track.Sample(current_time_, key);
+        } else {
+            if (channel_tracks_[i] >= tracks_.size()) continue;
+            const auto &track = tracks_[channel_tracks_[i]];
+            if (track.key_count == 0) continue;
+
+            const uint32_t key = FindKey(track, channel_cursors_[i], current_time_);
+            channel_cursors_[i] = key;
+            value = SampleTrack(track, key, current_time_, path == AnimationChannel::ROTATION);
+        }
+
+        const uint32_t target = channel_targets_[i];
+        switch (path) {
+            case AnimationChannel::TRANSLATION:
+                pose_translations_[target] = Point3F(value.x, value.y, value.z);
+                pose_masks_[target] |= POSE_TRANSLATION;
+                break;
+            case AnimationChannel::ROTATION:
+                pose_rotations_[target] = QuaternionF(value.x, value.y, value.z, value.w);
+                pose_masks_[target] |= POSE_ROTATION;
+                break;
+            case AnimationChannel::SCALE:
+                pose_scales_[target] = Vector3F(value.x, value.y, value.z);
+                pose_masks_[target] |= POSE_SCALE;
+                break;
+        }
+    }
+}
+
+void SceneAnimationClip::apply_pose() {
+    for (size_t i = 0; i < targets_.size(); i++) {
+        const uint8_t mask = pose_masks_[i];
+        if (mask == 0) continue;
+
+        auto *transform = targets_[i]->transform;
+        transform->SetLocalPose(mask & POSE_TRANSLATION ? pose_translations_[i] : transform->Position(),
+                                mask & POSE_ROTATION ? pose_rotations_[i] : transform->RotationQuaternion(),
+                                mask & POSE_SCALE ? pose_scales_[i] : transform->Scale());
     }
+}
+
+void SceneAnimationClip::seek(float time) {
+    current_time_ = time;
+    std::fill(channel_cursors_.begin(), channel_cursors_.end(), 0);
+}
+
+float SceneAnimationClip::time() const { return current_time_; }
+
+uint32_t SceneAnimationClip::FindKey(const Track &track, uint32_t cursor, float time) const {
+    const float *times = key_times_.data() + track.first_key;
+    const uint32_t last = track.key_count - 1;
+    if (last == 0) return 0;
+
+    cursor = std::min(cursor, last - 1);
+    if (time >= times[cursor]) {
+        // forward playback moves by at most a couple of keys per frame
+        for (int step = 0; step < 2 && cursor + 1 < last && time >= times[cursor + 1]; step++) {
+            cursor++;
+        }
+        if (cursor + 1 == last || time < times[cursor + 1]) {
+            return cursor;
+        }
+    }
+
+    // looped or seeked
+    const float *iter = std::upper_bound(times, times + last, time);
+    return iter == times ? 0 : static_cast<uint32_t>(iter - times - 1);
+}
+
+Vector4F SceneAnimationClip::SampleTrack(const Track &track, uint32_t key, float time, bool is_rotation) const {
+    const float *times = key_times_.data() + track.first_key;
+    const Vector4F *values = key_values_.data() + track.first_value;
+    const bool is_cubic = track.interpolation == AnimationSampler::CUBICSPLINE;
+    const uint32_t stride = is_cubic ? 3 : 1;
+    const uint32_t offset = is_cubic ? 1 : 0;
+    const uint32_t last = track.key_count - 1;
+
+    if (last == 0 || time <= times[0]) return values[offset];
+    if (time >= times[last]) return values[last * stride + offset];
+
+    const float dt = times[key + 1] - times[key];
+    const float a = dt > 0.0f ? (time - times[key]) / dt : 0.0f;
+    switch (track.interpolation) {
+        case AnimationSampler::STEP:
+            return values[key];
 
-    for (auto &channel : channels_) {
-        AnimationSampler &sampler = samplers_[channel.sampler_index];
-        for (size_t i = 0; i < sampler.inputs.size() - 1; i++) {
-            if (sampler.interpolation != AnimationSampler::LINEAR) {
-                std::cout << "This sample only supports linear interpolations\n";
-                continue;
+        case AnimationSampler::LINEAR: {
+            const auto &v0 = values[key];
+            const auto &v1 = values[key + 1];
+            if (!is_rotation) {
+                return lerp(v0, v1, a);
             }
 
-            // Get the input keyframe values for the current time stamp
-            if ((current_time_ >= sampler.inputs[i]) && (current_time_ <= sampler.inputs[i + 1])) {
-                float a = (current_time_ - sampler.inputs[i]) / (sampler.inputs[i + 1] - sampler.inputs[i]);
-                if (channel.path == AnimationChannel::TRANSLATION) {
-                    auto interp = lerp(sampler.outputs_vec4[i], sampler.outputs_vec4[i + 1], a);
-                    channel.node->transform->SetPosition(Point3F(interp.x, interp.y, interp.z));
-                }
-                if (channel.path == AnimationChannel::ROTATION) {
-                    QuaternionF q1;
-                    q1.x = sampler.outputs_vec4[i].x;
-                    q1.y = sampler.outputs_vec4[i].y;
-                    q1.z = sampler.outputs_vec4[i].z;
-                    q1.w = sampler.outputs_vec4[i].w;
-
-                    QuaternionF q2;
-                    q2.x = sampler.outputs_vec4[i + 1].x;
-                    q2.y = sampler.outputs_vec4[i + 1].y;
-                    q2.z = sampler.outputs_vec4[i + 1].z;
-                    q2.w = sampler.outputs_vec4[i + 1].w;
-
-                    channel.node->transform->SetRotationQuaternion(slerp(q1, q2, a).normalized());
-                }
-                if (channel.path == AnimationChannel::SCALE) {
-                    auto interp = lerp(sampler.outputs_vec4[i], sampler.outputs_vec4[i + 1], a);
-                    channel.node->transform->SetScale(Vector3F(interp.x, interp.y, interp.z));
-                }
+            QuaternionF q1(v0.x, v0.y, v0.z, v0.w);
+            QuaternionF q2(v1.x, v1.y, v1.z, v1.w);
+            // shortest path
+            if (q1.dot(q2) < 0.0f) {
+                q2 = QuaternionF(-q2.x, -q2.y, -q2.z, -q2.w);
             }
+            const auto q = slerp(q1, q2, a);
+            return {q.x, q.y, q.z, q.w};
+        }
+
+        case AnimationSampler::CUBICSPLINE: {
+            // glTF cubic Hermite spline, tangents are scaled by the key interval
+            const float a2 = a * a;
+            const float a3 = a2 * a;
+            const auto &v0 = values[key * 3 + 1];
+            const auto &out_tangent = values[key * 3 + 2];
+            const auto &in_tangent = values[(key + 1) * 3];
+            const auto &v1 = values[(key + 1) * 3 + 1];
+            return v0 * (2.0f * a3 - 3.0f * a2 + 1.0f) + out_tangent * (dt * (a3 - 2.0f * a2 + a)) +
+                   v1 * (-2.0f * a3 + 3.0f * a2) + in_tangent * (dt * (a3 - a2));
         }
     }
+    return values[key * stride + offset];
 }
 
 float SceneAnimationClip::start() const { return start_; }
@@ -67,8 +165,111 @@ float SceneAnimationClip::end() const { return end_; }
 
 void SceneAnimationClip::set_end(float time) { end_ = time; }
 
-void SceneAnimationClip::add_sampler(const AnimationSampler &sampler) { samplers_.push_back(sampler); }
+void SceneAnimationClip::add_sampler(const AnimationSampler &sampler) {
+    if (is_compressed()) {
+        LOGE("Samplers can not be added to a compressed clip")
+        return;
+    }
+
+    const uint32_t stride = sampler.interpolation == AnimationSampler::CUBICSPLINE ? 3 : 1;
+    const auto key_count =
+            static_cast<uint32_t>(std::min(sampler.inputs.size(), sampler.outputs_vec4.size() / stride));
+
+    tracks_.push_back({sampler.interpolation, static_cast<uint32_t>(key_times_.size()), key_count,
+                       static_cast<uint32_t>(key_values_.size())});
+    key_times_.insert(key_times_.end(), sampler.inputs.begin(), sampler.inputs.begin() + key_count);
+    key_values_.insert(key_values_.end(), sampler.outputs_vec4.begin(),
+                       sampler.outputs_vec4.begin() + key_count * stride);
+}
+
+void SceneAnimationClip::add_channel(const AnimationChannel &channel) {
+    auto iter = std::find(targets_.begin(), targets_.end(), channel.node);
+    if (iter == targets_.end()) {
+        targets_.push_back(channel.node);
+        pose_masks_.push_back(0);
+        pose_translations_.emplace_back();
+        pose_rotations_.emplace_back();
+        pose_scales_.emplace_back(1, 1, 1);
+        iter = targets_.end() - 1;
+    }
+
+    channel_tracks_.push_back(channel.sampler_index);
+    channel_paths_.push_back(channel.path);
+    channel_targets_.push_back(static_cast<uint32_t>(iter - targets_.begin()));
+    channel_cursors_.push_back(0);
+}
+
+void SceneAnimationClip::compress(const AnimationCompressionSettings &settings) {
+    if (is_compressed()) return;
+
+    // tracks are compressed with the tolerance of the path animated by their first channel
+    std::vector<int> track_paths(tracks_.size(), -1);
+    for (size_t i = 0; i < channel_tracks_.size(); i++) {
+        if (channel_tracks_[i] < tracks_.size() && track_paths[channel_tracks_[i]] == -1) {
+            track_paths[channel_tracks_[i]] = channel_paths_[i];
+        }
+    }
+
+    // the resampling rate bounds the sample count and spaces the samples, both use the same validated value
+    float sample_rate = settings.sample_rate;
+    if (!(sample_rate >= 1.0f)) {
+        LOGW("Animation sample rate {} is invalid, clamped to 1 key per second", sample_rate)
+        sample_rate = 1.0f;
+    }
+
+    compressed_tracks_.resize(tracks_.size());
+    std::vector<float> times;
+    std::vector<Vector4F> values;
+    for (size_t i = 0; i < tracks_.size(); i++) {
+        const auto &track = tracks_[i];
+        if (track_paths[i] == -1 || track.key_count == 0) continue;
+
+        const auto path = static_cast<AnimationChannel::PathType>(track_paths[i]);
+        const bool is_rotation = path == AnimationChannel::ROTATION;
+        const float tolerance = is_rotation                              ? settings.rotation_tolerance
+                                : path == AnimationChannel::TRANSLATION ? settings.translation_tolerance
+                                                                        : settings.scale_tolerance;
+
+        times.clear();
+        values.clear();
+        const float *key_times = key_times_.data() + track.first_key;
+        if (track.interpolation == AnimationSampler::CUBICSPLINE) {
+            const float first = key_times[0];
+            const float last = key_times[track.key_count - 1];
+            const auto sample_count = static_cast<uint32_t>(std::ceil((last - first) * sample_rate)) + 1;
+            uint32_t key = 0;
+            for (uint32_t s = 0; s < sample_count; s++) {
+                const float time = s + 1 == sample_count ? last : first + static_cast<float>(s) / sample_rate;
+                key = FindKey(track, key, time);
+                times.push_back(time);
+                values.push_back(SampleTrack(track, key, time, is_rotation));
+            }
+        } else {
+            times.assign(key_times, key_times + track.key_count);
+            values.assign(key_values_.begin() + track.first_value,
+                          key_values_.begin() + track.first_value + track.key_count);
+        }
+
+        compressed_tracks_[i] =
+                CompressedAnimationTrack::Compress(times, values, track.interpolation == AnimationSampler::STEP,
+                                                   is_rotation, tolerance, settings.error_metric);
+    }
+
+    std::vector<Track>().swap(tracks_);
+    std::vector<float>().swap(key_times_);
+    std::vector<Vector4F>().swap(key_values_);
+    std::fill(channel_cursors_.begin(), channel_cursors_.end(), 0);
+}
 
-void SceneAnimationClip::add_channel(const AnimationChannel &channel) { channels_.push_back(channel); }
+bool SceneAnimationClip::is_compressed() const { return !compressed_tracks_.empty(); }
+
+size_t SceneAnimationClip::memory_size() const {
+    size_t size = tracks_.capacity() * sizeof(Track) + key_times_.capacity() * sizeof(float) +
+                  key_values_.capacity() * sizeof(Vector4F);
+    for (const auto &track : compressed_tracks_) {
+        size += track.MemorySize();
+    }
+    return size;
+}
 
 }  // namespace vox
@@ -8,9 +8,17 @@
 
 #include <string>
 
+#include "vox.render/animation_compression.h"
 #include "vox.render/entity.h"
 
 namespace vox {
+/**
+ * @brief Node animation clip, glTF semantics.
+ *        Samplers are flattened into SoA tracks: key times and key values of all tracks live in two contiguous arrays,
+ *        so the key search only touches times. Every channel keeps the key cursor of the previous evaluation, forward
+ *        playback advances it in amortized O(1) and seeking falls back to a binary search.
+ *        Once loaded, a clip can be compressed, its tracks are then decoded on the fly by the same evaluation.
+ */
 class SceneAnimationClip {
 public:
     struct AnimationChannel {
@@ -24,14 +32,36 @@ public:
         enum InterpolationType { LINEAR, STEP, CUBICSPLINE };
         InterpolationType interpolation;
         std::vector<float> inputs;
+        // CUBICSPLINE stores in-tangent, value and out-tangent for each key
         std::vector<Vector4F> outputs_vec4;
     };
 
 public:
     explicit SceneAnimationClip(std::string name);
 
+    /**
+     * @brief Evaluate the clip and write the pose to the animated nodes.
+     */
     void update(float delta_time);
 
+    /**
+     * @brief Advance the clip time and sample every channel into the pose buffer.
+     * @remarks Only touches the clip, clips can be evaluated concurrently.
+     */
+    void evaluate(float delta_time);
+
+    /**
+     * @brief Write the sampled pose, a single transform update per animated node.
+     */
+    void apply_pose();
+
+    /**
+     * @brief Jump to the given time, the next evaluation searches the keys from scratch.
+     */
+    void seek(float time);
+
+    [[nodiscard]] float time() const;
+
     [[nodiscard]] const std::string &name() const;
 
     [[nodiscard]] float start() const;
@@ -46,14 +76,57 @@ public:
 
     void add_channel(const AnimationChannel &channel);
 
+    /**
+     * @brief Replace the raw tracks by compressed ones, to be called once all samplers and channels were added.
+     *        Cubic spline tracks are resampled and compressed as linear tracks.
+     */
+    void compress(const AnimationCompressionSettings &settings = {});
+
+    [[nodiscard]] bool is_compressed() const;
+
+    /**
+     * @brief Memory used by the tracks, in bytes.
+     */
+    [[nodiscard]] size_t memory_size() const;
+
 private:
+    struct Track {
+        AnimationSampler::InterpolationType interpolation;
+        uint32_t first_key;
+        uint32_t key_count;
+        uint32_t first_value;
+    };
+
+    enum PoseMask : uint8_t { POSE_TRANSLATION = 0x1, POSE_ROTATION = 0x2, POSE_SCALE = 0x4 };
+
+    uint32_t FindKey(const Track &track, uint32_t cursor, float time) const;
+
+    Vector4F SampleTrack(const Track &track, uint32_t key, float time, bool is_rotation) const;
+
     std::string name_;
-    std::vector<AnimationSampler> samplers_;
-    std::vector<AnimationChannel> channels_;
     float start_ = std::numeric_limits<float>::max();
     float end_ = std::numeric_limits<float>::min();
 
     float current_time_ = 0.0f;
+
+    // tracks
+    std::vector<Track> tracks_;
+    std::vector<float> key_times_;
+    std::vector<Vector4F> key_values_;
+    std::vector<CompressedAnimationTrack> compressed_tracks_;
+
+    // channels, SoA
+    std::vector<uint32_t> channel_tracks_;
+    std::vector<AnimationChannel::PathType> channel_paths_;
+    std::vector<uint32_t> channel_targets_;
+    std::vector<uint32_t> channel_cursors_;
+
+    // pose, one entry per animated node
+    std::vector<Entity *> targets_;
+    std::vector<uint8_t> pose_masks_;
+    std::vector<Point3F> pose_translations_;
+    std::vector<QuaternionF> pose_rotations_;
+    std::vector<Vector3F> pose_scales_;
 };
 
 }  // namespace vox
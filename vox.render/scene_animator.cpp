@@ -21,7 +21,24 @@ void SceneAnimator::update(float delta_time) {
     }
 }
 
-void SceneAnimator::add_animation_clip(std::unique_ptr<SceneAnimationClip> &&clip) {
+void SceneAnimator::evaluate(float delta_time) {
+    if (active_animation_ != -1) {
+        animation_clips_[active_animation_]->evaluate(delta_time);
+    }
+}
+
+void SceneAnimator::apply_pose() {
+    if (active_animation_ != -1) {
+        animation_clips_[active_animation_]->apply_pose();
+    }
+}
+
+void SceneAnimator::add_animation_clip(std::unique_ptr<SceneAnimationClip> &&clip,
+                                       const std::optional<AnimationCompressionSettings> &compression) {
+    // the clip is fully loaded once it is handed to the animator, it is only sampled from now on
+    if (compression) {
+        clip->compress(*compression);
+    }
     animation_clips_.emplace_back(std::move(clip));
 }
 
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -24,7 +25,22 @@ public:
 
     void update(float delta_time);
 
-    void add_animation_clip(std::unique_ptr<SceneAnimationClip> &&clip);
+    /**
+     * Sample the active clip into its pose buffer, safe to call concurrently for different animators.
+     */
+    void evaluate(float delta_time);
+
+    /**
+     * Write the pose sampled by evaluate to the animated transforms.
+     */
+    void apply_pose();
+
+    /**
+     * Take a fully loaded clip. Its tracks are kept exact unless compression settings are given, the compression
+     * is lossy within their tolerances.
+     */
+    void add_animation_clip(std::unique_ptr<SceneAnimationClip> &&clip,
+                            const std::optional<AnimationCompressionSettings> &compression = std::nullopt);
 
     void play(const std::string &name);
 
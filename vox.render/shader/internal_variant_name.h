@@ -24,11 +24,6 @@ const std::string HAS_BLENDSHAPE_TEXTURE = "HAS_BLENDSHAPE_TEXTURE";
 const std::string HAS_BLENDSHAPE_NORMAL = "HAS_BLENDSHAPE_NORMAL";
 const std::string HAS_BLENDSHAPE_TANGENT = "HAS_BLENDSHAPE_TANGENT";
 
-// Skin
-const std::string HAS_SKIN = "HAS_SKIN";
-const std::string HAS_JOINT_TEXTURE = "HAS_JOINT_TEXTURE";
-const std::string JOINTS_COUNT = "JOINTS_COUNT ";
-
 // Material
 const std::string NEED_ALPHA_CUTOFF = "NEED_ALPHA_CUTOFF";
 const std::string NEED_WORLDPOS = "NEED_WORLDPOS";
@@ -44,11 +39,7 @@ const std::string HAS_EMISSIVEMAP = "HAS_EMISSIVEMAP";
 const std::string HAS_OCCLUSIONMAP = "HAS_OCCLUSIONMAP";
 const std::string HAS_SPECULARGLOSSINESSMAP = "HAS_SPECULARGLOSSINESSMAP";
 const std::string HAS_METALROUGHNESSMAP = "HAS_METALROUGHNESSMAP";
-
-// Light
-const std::string DIRECT_LIGHT_COUNT = "DIRECT_LIGHT_COUNT ";
-const std::string POINT_LIGHT_COUNT = "POINT_LIGHT_COUNT ";
-const std::string SPOT_LIGHT_COUNT = "SPOT_LIGHT_COUNT ";
+const std::string HAS_BINDLESS_TEXTURES = "HAS_BINDLESS_TEXTURES";
 
 // Enviroment
 const std::string HAS_SH = "HAS_SH";
@@ -56,14 +47,9 @@ const std::string HAS_SPECULAR_ENV = "HAS_SPECULAR_ENV";
 const std::string HAS_DIFFUSE_ENV = "HAS_DIFFUSE_ENV";
 
 // Particle Render
-const std::string NEED_PARTICLE_SCATTERING = "NEED_PARTICLE_SCATTERING";
 const std::string NEED_PARTICLE_VECTOR_FIELD = "NEED_PARTICLE_VECTOR_FIELD";
-const std::string NEED_PARTICLE_CURL_NOISE = "NEED_PARTICLE_CURL_NOISE";
-const std::string NEED_PARTICLE_VELOCITY_CONTROL = "NEED_PARTICLE_VELOCITY_CONTROL";
-const std::string PARTICLE_COUNT = "PARTICLE_COUNT ";
 
 // Shadow
-const std::string SHADOW_MAP_COUNT = "SHADOW_MAP_COUNT ";
-const std::string CUBE_SHADOW_MAP_COUNT = "CUBE_SHADOW_MAP_COUNT ";
+const std::string HAS_SHADOW_MAP = "HAS_SHADOW_MAP";
 
 }  // namespace vox
@@ -28,4 +28,21 @@ enum class Attributes : uint32_t {
     TOTAL_COUNT
 };
 
-}
+/**
+ * Descriptor sets by update frequency.
+ * ShaderData binds properties by name into whichever set the shaders declare them, so the convention is not
+ * enforced, but following it lets consecutive draws keep the sets which did not change: only the per-draw set is
+ * rebound, at new dynamic offsets.
+ */
+enum class DescriptorSetFrequency : uint32_t {
+    // scene and camera data: camera, lights, shadows, environment
+    PER_FRAME = 0,
+    // material data and textures
+    PER_MATERIAL = 1,
+    // renderer data, skinning and blend shapes
+    PER_DRAW = 2,
+    // unsized texture array of BindlessTextureTable
+    BINDLESS = 3,
+};
+
+}  // namespace vox
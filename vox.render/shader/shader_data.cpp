@@ -6,71 +6,151 @@
 
 #include "vox.render/shader/shader_data.h"
 
+#include "vox.render/core/command_pool.h"
+#include "vox.render/rendering/render_frame.h"
+
 namespace vox {
 ShaderData::ShaderData(Device &device) : device_(device) {}
 
 void ShaderData::BindData(CommandBuffer &command_buffer, DescriptorSetLayout &descriptor_set_layout) {
-    for (auto &allocation : shader_buffer_pools_) {
-        if (auto layout_binding = descriptor_set_layout.GetLayoutBinding(allocation.first)) {
-            command_buffer.BindBuffer(allocation.second.GetBuffer(), allocation.second.GetOffset(),
-                                      allocation.second.GetSize(), 0, layout_binding->binding, 0);
+    const auto &table = GetBindingTable(descriptor_set_layout);
+    const auto kSet = table.set;
+    for (const auto &slot : table.slots) {
+        switch (slot.kind) {
+            case SlotKind::BUFFER_POOL: {
+                auto &allocation = shader_buffer_pools_[slot.index].second;
+                command_buffer.BindBuffer(allocation.GetBuffer(), allocation.GetOffset(), allocation.GetSize(), kSet,
+                                          slot.binding, 0);
+                break;
+            }
+            case SlotKind::BUFFER:
+                BindUniform(command_buffer, shader_buffers_[slot.index].second, kSet, slot.binding);
+                break;
+            case SlotKind::BUFFER_FUNCTOR: {
+                auto buffer_ptr = shader_buffer_functors_[slot.index].second();
+                command_buffer.BindBuffer(*buffer_ptr, 0, buffer_ptr->GetSize(), kSet, slot.binding, 0);
+                break;
+            }
+            case SlotKind::SAMPLED_TEXTURE: {
+                auto &texture = *sampled_textures_[slot.index].second;
+                command_buffer.BindImage(texture.GetImageView(), *texture.GetSampler(), kSet, slot.binding, 0);
+                break;
+            }
+            case SlotKind::STORAGE_TEXTURE: {
+                auto &texture = *storage_textures_[slot.index].second;
+                command_buffer.BindImage(texture.GetImageView(), kSet, slot.binding, 0);
+                break;
+            }
         }
     }
+}
 
-    for (auto &buffer : shader_buffers_) {
-        if (auto layout_binding = descriptor_set_layout.GetLayoutBinding(buffer.first)) {
-            command_buffer.BindBuffer(*buffer.second, 0, buffer.second->GetSize(), 0, layout_binding->binding, 0);
-        }
+void ShaderData::BindData(CommandBuffer &command_buffer, const PipelineLayout &pipeline_layout) {
+    for (uint32_t set = 0; pipeline_layout.HasDescriptorSetLayout(set); ++set) {
+        BindData(command_buffer, pipeline_layout.GetDescriptorSetLayout(set));
     }
+}
 
-    for (auto &buffer : shader_buffer_functors_) {
-        if (auto layout_binding = descriptor_set_layout.GetLayoutBinding(buffer.first)) {
-            auto buffer_ptr = buffer.second();
-            command_buffer.BindBuffer(*buffer_ptr, 0, buffer_ptr->GetSize(), 0, layout_binding->binding, 0);
+const ShaderData::BindingTable &ShaderData::GetBindingTable(const DescriptorSetLayout &descriptor_set_layout) {
+    const auto kLayoutId = descriptor_set_layout.GetUniqueId();
+    for (const auto &table : binding_tables_) {
+        if (table.layout_id == kLayoutId) {
+            return table;
         }
     }
 
-    for (auto &texture : sampled_textures_) {
-        if (auto layout_binding = descriptor_set_layout.GetLayoutBinding(texture.first)) {
-            command_buffer.BindImage(texture.second->GetImageView(), *texture.second->GetSampler(), 0,
-                                     layout_binding->binding, 0);
+    BindingTable table{kLayoutId, descriptor_set_layout.GetIndex(), {}};
+    auto add_slots = [&](SlotKind kind, const auto &entries) {
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (auto layout_binding = descriptor_set_layout.GetLayoutBinding(entries[i].first)) {
+                table.slots.push_back({kind, static_cast<uint32_t>(i), layout_binding->binding});
+            }
         }
-    }
+    };
+    // same order as the entries were bound before, so a property set as several kinds resolves the same way
+    add_slots(SlotKind::BUFFER_POOL, shader_buffer_pools_);
+    add_slots(SlotKind::BUFFER, shader_buffers_);
+    add_slots(SlotKind::BUFFER_FUNCTOR, shader_buffer_functors_);
+    add_slots(SlotKind::SAMPLED_TEXTURE, sampled_textures_);
+    add_slots(SlotKind::STORAGE_TEXTURE, storage_textures_);
+
+    binding_tables_.push_back(std::move(table));
+    return binding_tables_.back();
+}
 
-    for (auto &texture : storage_textures_) {
-        if (auto layout_binding = descriptor_set_layout.GetLayoutBinding(texture.first)) {
-            command_buffer.BindImage(texture.second->GetImageView(), 0, layout_binding->binding, 0);
+void ShaderData::BindUniform(CommandBuffer &command_buffer, UniformData &uniform, uint32_t set, uint32_t binding) {
+    auto &command_pool = command_buffer.GetCommandPool();
+    auto frame = command_pool.GetRenderFrame();
+    if (frame == nullptr) {
+        if (uniform.buffer == nullptr || uniform.buffer->GetSize() < uniform.data.size()) {
+            uniform.buffer = std::make_unique<core::Buffer>(device_, uniform.data.size(),
+                                                            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                                                            VMA_MEMORY_USAGE_CPU_TO_GPU);
         }
+        uniform.buffer->Update(uniform.data);
+        command_buffer.BindBuffer(*uniform.buffer, 0, uniform.data.size(), set, binding, 0);
+        return;
+    }
+
+    if (uniform.frame != frame || uniform.frame_reset_count != frame->GetResetCount()) {
+        uniform.allocation = frame->AllocateBuffer(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, uniform.data.size(),
+                                                   command_pool.GetThreadIndex());
+        uniform.allocation.Update(uniform.data);
+        uniform.frame = frame;
+        uniform.frame_reset_count = frame->GetResetCount();
+    }
+    command_buffer.BindBuffer(uniform.allocation.GetBuffer(), uniform.allocation.GetOffset(),
+                              uniform.allocation.GetSize(), set, binding, 0);
+}
+
+void ShaderData::SetBufferData(const ShaderProperty &property, const void *data, size_t size) {
+    auto uniform = Find(shader_buffers_, property);
+    if (uniform == nullptr) {
+        shader_buffers_.emplace_back(property, UniformData{});
+        uniform = &shader_buffers_.back().second;
+        binding_tables_.clear();
     }
+    auto bytes = static_cast<const uint8_t *>(data);
+    uniform->data.assign(bytes, bytes + size);
+    // uploaded again by the next bind
+    uniform->frame = nullptr;
 }
 
-void ShaderData::SetData(const std::string &property_name, BufferAllocation &&value) {
-    shader_buffer_pools_.insert(std::make_pair(property_name, std::move(value)));
+void ShaderData::SetData(const ShaderProperty &property, BufferAllocation &&value) {
+    if (auto allocation = Find(shader_buffer_pools_, property)) {
+        *allocation = std::move(value);
+    } else {
+        shader_buffer_pools_.emplace_back(property, std::move(value));
+        binding_tables_.clear();
+    }
 }
 
-void ShaderData::SetBufferFunctor(const std::string &property_name, const std::function<core::Buffer *()> &functor) {
-    shader_buffer_functors_.insert(std::make_pair(property_name, functor));
+void ShaderData::SetBufferFunctor(const ShaderProperty &property, const std::function<core::Buffer *()> &functor) {
+    if (auto buffer_functor = Find(shader_buffer_functors_, property)) {
+        *buffer_functor = functor;
+    } else {
+        shader_buffer_functors_.emplace_back(property, functor);
+        binding_tables_.clear();
+    }
 }
 
-void ShaderData::SetSampledTexture(const std::string &texture_name,
+void ShaderData::SetSampledTexture(const ShaderProperty &property,
                                    const core::ImageView &image_view,
                                    core::Sampler *sampler) {
-    auto iter = sampled_textures_.find(texture_name);
-    if (iter == sampled_textures_.end()) {
-        sampled_textures_.insert(
-                std::make_pair(texture_name, std::make_unique<core::SampledImage>(image_view, sampler)));
+    if (auto texture = Find(sampled_textures_, property)) {
+        *texture = std::make_unique<core::SampledImage>(image_view, sampler);
     } else {
-        iter->second = std::make_unique<core::SampledImage>(image_view, sampler);
+        sampled_textures_.emplace_back(property, std::make_unique<core::SampledImage>(image_view, sampler));
+        binding_tables_.clear();
     }
 }
 
-void ShaderData::SetStorageTexture(const std::string &texture_name, const core::ImageView &image_view) {
-    auto iter = storage_textures_.find(texture_name);
-    if (iter == storage_textures_.end()) {
-        storage_textures_.insert(
-                std::make_pair(texture_name, std::make_unique<core::SampledImage>(image_view, nullptr)));
+void ShaderData::SetStorageTexture(const ShaderProperty &property, const core::ImageView &image_view) {
+    if (auto texture = Find(storage_textures_, property)) {
+        *texture = std::make_unique<core::SampledImage>(image_view, nullptr);
     } else {
-        iter->second = std::make_unique<core::SampledImage>(image_view, nullptr);
+        storage_textures_.emplace_back(property, std::make_unique<core::SampledImage>(image_view, nullptr));
+        binding_tables_.clear();
     }
 }
 
@@ -9,75 +9,87 @@
 #include "vox.render/buffer_pool.h"
 #include "vox.render/core/buffer.h"
 #include "vox.render/core/command_buffer.h"
+#include "vox.render/core/pipeline_layout.h"
 #include "vox.render/core/sampled_image.h"
+#include "vox.render/shader/shader_property.h"
 #include "vox.render/shader/shader_variant.h"
 #include "vox.render/texture.h"
 
 namespace vox {
+class RenderFrame;
+
 /**
  * Shader data collection,Correspondence includes shader properties data and macros data.
+ * Data is kept in flat vectors keyed by interned properties. BindData caches, for each descriptor set layout, the
+ * bindings of the entries the layout uses, the table is rebuilt only when an entry is added.
+ * Values set with SetData are copied, and sub-allocated from the uniform pool of the render frame when bound, so a
+ * frame in flight keeps reading its own copy; the allocation is reused by the other binds of the same frame.
  */
 class ShaderData {
 public:
+    template <typename T>
+    using Entries = std::vector<std::pair<ShaderProperty, T>>;
+
     explicit ShaderData(Device &device);
 
     void BindData(CommandBuffer &command_buffer, DescriptorSetLayout &descriptor_set_layout);
 
-    void SetBufferFunctor(const std::string &property_name, const std::function<core::Buffer *()> &functor);
+    /**
+     * Bind the data to every descriptor set of the layout: properties are found by name in whichever set the shaders
+     * declare them, see DescriptorSetFrequency.
+     */
+    void BindData(CommandBuffer &command_buffer, const PipelineLayout &pipeline_layout);
+
+    void SetBufferFunctor(const ShaderProperty &property, const std::function<core::Buffer *()> &functor);
+
+    void SetBufferFunctor(const std::string &property_name, const std::function<core::Buffer *()> &functor) {
+        SetBufferFunctor(ShaderProperty(property_name), functor);
+    }
 
-    void SetData(const std::string &property_name, BufferAllocation &&value);
+    void SetData(const ShaderProperty &property, BufferAllocation &&value);
+
+    void SetData(const std::string &property_name, BufferAllocation &&value) {
+        SetData(ShaderProperty(property_name), std::move(value));
+    }
 
     template <typename T>
-    void SetData(const std::string &property_name, T &value) {
-        auto iter = shader_buffers_.find(property_name);
-        if (iter == shader_buffers_.end()) {
-            shader_buffers_.insert(std::make_pair(
-                    property_name,
-                    std::make_unique<core::Buffer>(device_, sizeof(T), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                                                   VMA_MEMORY_USAGE_CPU_TO_GPU)));
-        }
-        iter = shader_buffers_.find(property_name);
-        iter->second->Update(&value, sizeof(T));
+    void SetData(const ShaderProperty &property, T &value) {
+        SetBufferData(property, &value, sizeof(T));
     }
 
     template <typename T>
-    void SetData(const std::string &property_name, std::vector<T> &value) {
-        auto iter = shader_buffers_.find(property_name);
-        if (iter == shader_buffers_.end()) {
-            shader_buffers_.insert(std::make_pair(
-                    property_name,
-                    std::make_unique<core::Buffer>(device_, sizeof(T) * value.size(),
-                                                   VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU)));
-        }
-        iter = shader_buffers_.find(property_name);
-        iter->second->Update(value.data(), sizeof(T) * value.size());
+    void SetData(const ShaderProperty &property, std::vector<T> &value) {
+        SetBufferData(property, value.data(), sizeof(T) * value.size());
     }
 
     template <typename T, size_t N>
-    void SetData(const std::string &property_name, std::array<T, N> &value) {
-        auto iter = shader_buffers_.find(property_name);
-        if (iter == shader_buffers_.end()) {
-            shader_buffers_.insert(std::make_pair(
-                    property_name,
-                    std::make_unique<core::Buffer>(device_, sizeof(T) * N, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                                                   VMA_MEMORY_USAGE_CPU_TO_GPU)));
-        }
-        iter = shader_buffers_.find(property_name);
-        iter->second->Update(value.data(), sizeof(T) * N);
+    void SetData(const ShaderProperty &property, std::array<T, N> &value) {
+        SetBufferData(property, value.data(), sizeof(T) * N);
+    }
+
+    template <typename T>
+    void SetData(const std::string &property_name, T &value) {
+        SetData(ShaderProperty(property_name), value);
     }
 
 public:
-    void SetSampledTexture(const std::string &texture_name, const core::ImageView &image_view, core::Sampler *sampler);
+    void SetSampledTexture(const ShaderProperty &property, const core::ImageView &image_view, core::Sampler *sampler);
+
+    void SetSampledTexture(const std::string &texture_name, const core::ImageView &image_view, core::Sampler *sampler) {
+        SetSampledTexture(ShaderProperty(texture_name), image_view, sampler);
+    }
+
+    void SetStorageTexture(const ShaderProperty &property, const core::ImageView &image_view);
 
-    void SetStorageTexture(const std::string &texture_name, const core::ImageView &image_view);
+    void SetStorageTexture(const std::string &texture_name, const core::ImageView &image_view) {
+        SetStorageTexture(ShaderProperty(texture_name), image_view);
+    }
 
-    [[nodiscard]] inline const std::unordered_map<std::string, std::unique_ptr<core::SampledImage>> &SampledTextures()
-            const {
+    [[nodiscard]] inline const Entries<std::unique_ptr<core::SampledImage>> &SampledTextures() const {
         return sampled_textures_;
     }
 
-    [[nodiscard]] inline const std::unordered_map<std::string, std::unique_ptr<core::SampledImage>> &StorageTextures()
-            const {
+    [[nodiscard]] inline const Entries<std::unique_ptr<core::SampledImage>> &StorageTextures() const {
         return storage_textures_;
     }
 
@@ -97,12 +109,55 @@ public:
     void MergeVariants(const ShaderVariant &variant, ShaderVariant &result) const;
 
 private:
+    enum class SlotKind : uint8_t { BUFFER_POOL, BUFFER_FUNCTOR, BUFFER, SAMPLED_TEXTURE, STORAGE_TEXTURE };
+
+    struct BindingSlot {
+        SlotKind kind;
+        uint32_t index;
+        uint32_t binding;
+    };
+
+    struct UniformData {
+        std::vector<uint8_t> data{};
+        // allocation of the frame which bound the data last, valid until the frame is reset
+        BufferAllocation allocation{};
+        RenderFrame *frame{nullptr};
+        uint64_t frame_reset_count{0};
+        // command buffers not recorded for a render frame, e.g. one time submits, use a dedicated buffer
+        std::unique_ptr<core::Buffer> buffer{nullptr};
+    };
+
+    struct BindingTable {
+        uint64_t layout_id;
+        uint32_t set;
+        std::vector<BindingSlot> slots;
+    };
+
+    template <typename T>
+    static T *Find(Entries<T> &entries, const ShaderProperty &property) {
+        for (auto &entry : entries) {
+            if (entry.first == property) {
+                return &entry.second;
+            }
+        }
+        return nullptr;
+    }
+
+    void SetBufferData(const ShaderProperty &property, const void *data, size_t size);
+
+    const BindingTable &GetBindingTable(const DescriptorSetLayout &descriptor_set_layout);
+
+    void BindUniform(CommandBuffer &command_buffer, UniformData &uniform, uint32_t set, uint32_t binding);
+
     Device &device_;
-    std::unordered_map<std::string, BufferAllocation> shader_buffer_pools_{};
-    std::unordered_map<std::string, std::function<core::Buffer *()>> shader_buffer_functors_{};
-    std::unordered_map<std::string, std::unique_ptr<core::Buffer>> shader_buffers_{};
-    std::unordered_map<std::string, std::unique_ptr<core::SampledImage>> sampled_textures_{};
-    std::unordered_map<std::string, std::unique_ptr<core::SampledImage>> storage_textures_{};
+    Entries<BufferAllocation> shader_buffer_pools_{};
+    Entries<std::function<core::Buffer *()>> shader_buffer_functors_{};
+    Entries<UniformData> shader_buffers_{};
+    Entries<std::unique_ptr<core::SampledImage>> sampled_textures_{};
+    Entries<std::unique_ptr<core::SampledImage>> storage_textures_{};
+
+    // invalidated when an entry is added, a few layouts per data so a linear search
+    std::vector<BindingTable> binding_tables_{};
 
     ShaderVariant variant_;
 };
@@ -0,0 +1,42 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.render/shader/shader_property.h"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace vox {
+namespace {
+struct PropertyRegistry {
+    std::mutex mutex;
+    // nodes are stable, properties keep a pointer to the key
+    std::unordered_map<std::string, uint32_t> ids;
+};
+
+PropertyRegistry &GetRegistry() {
+    static PropertyRegistry registry;
+    return registry;
+}
+
+std::pair<uint32_t, const std::string *> Intern(const std::string &name) {
+    auto &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto iter = registry.ids.try_emplace(name, static_cast<uint32_t>(registry.ids.size())).first;
+    return {iter->second, &iter->first};
+}
+
+}  // namespace
+
+ShaderProperty::ShaderProperty(const std::string &name) {
+    auto interned = Intern(name);
+    unique_id_ = interned.first;
+    name_ = interned.second;
+}
+
+uint32_t ShaderProperty::GetPropertyId(const std::string &name) { return Intern(name).first; }
+
+}  // namespace vox
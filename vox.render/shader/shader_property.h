@@ -0,0 +1,40 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace vox {
+/**
+ * Interned name of a shader resource.
+ * The name is hashed once when the property is created, comparing and looking up properties only uses the id.
+ * Properties are meant to be created once and kept, e.g. as members of the object which sets the data.
+ */
+class ShaderProperty {
+public:
+    explicit ShaderProperty(const std::string &name);
+
+    [[nodiscard]] inline uint32_t UniqueId() const { return unique_id_; }
+
+    [[nodiscard]] inline const std::string &Name() const { return *name_; }
+
+    inline bool operator==(const ShaderProperty &other) const { return unique_id_ == other.unique_id_; }
+
+    inline bool operator!=(const ShaderProperty &other) const { return unique_id_ != other.unique_id_; }
+
+    /**
+     * Id of a name, interned if it has never been seen.
+     */
+    static uint32_t GetPropertyId(const std::string &name);
+
+private:
+    uint32_t unique_id_;
+    const std::string *name_;
+};
+
+}  // namespace vox
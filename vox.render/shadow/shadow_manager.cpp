@@ -6,10 +6,13 @@
 
 #include "vox.render/shadow/shadow_manager.h"
 
+#include <iterator>
+
 #include "vox.math/matrix_utils.h"
 #include "vox.render/camera.h"
 #include "vox.render/entity.h"
 #include "vox.render/lighting/light_manager.h"
+#include "vox.render/stats/gpu_profiler.h"
 #include "vox.render/texture_manager.h"
 
 namespace vox {
@@ -32,6 +35,7 @@ ShadowManager::ShadowManager(Device &device, RenderContext &render_context, Scen
       camera_(camera),
       shadow_map_prop_("shadowMap"),
       shadow_data_prop_("shadowData"),
+      shadow_count_prop_("shadowCount"),
 
       cube_shadow_map_prop_("cubeShadowMap"),
       cube_shadow_data_prop_("cubeShadowData"),
@@ -52,6 +56,12 @@ ShadowManager::ShadowManager(Device &device, RenderContext &render_context, Scen
     sampler_create_info_.unnormalizedCoordinates = VK_FALSE;
     sampler_ = std::make_unique<core::Sampler>(device, sampler_create_info_);
 
+    shadow_datas_.resize(max_shadow_);
+    shadow_data_buffer_ = std::make_unique<StorageBufferArray>(device, render_context, sizeof(ShadowData), 4);
+    scene_->shader_data.SetBufferFunctor(shadow_data_prop_,
+                                         [this]() -> core::Buffer * { return shadow_data_buffer_->Buffer(); });
+    scene_->shader_data.SetData(shadow_count_prop_, shadow_count_);
+
     auto subpass = std::make_unique<ShadowSubpass>(render_context_, scene, camera);
     shadow_subpass_ = subpass.get();
     render_pipeline_ = std::make_unique<RenderPipeline>();
@@ -76,6 +86,16 @@ float ShadowManager::CascadeSplitLambda() const { return cascade_split_lambda_;
 
 void ShadowManager::SetCascadeSplitLambda(float value) { cascade_split_lambda_ = value; }
 
+uint32_t ShadowManager::LodBias() const { return lod_bias_; }
+
+void ShadowManager::SetLodBias(uint32_t value) { lod_bias_ = value; }
+
+void ShadowManager::SetCamera(Camera *camera) {
+    camera_ = camera;
+    // the casters select their level of detail for the same camera
+    shadow_subpass_->SetCamera(camera);
+}
+
 void ShadowManager::Draw(CommandBuffer &command_buffer) {
     used_shadow_.clear();
     DrawSpotShadowMap(command_buffer);
@@ -85,13 +105,15 @@ void ShadowManager::Draw(CommandBuffer &command_buffer) {
                 TextureManager::GetSingleton().PackedShadowMap(command_buffer, used_shadow_, shadow_map_resolution_);
         scene_->shader_data.SetSampledTexture(shadow_map_prop_, image->GetVkImageView(VK_IMAGE_VIEW_TYPE_2D_ARRAY),
                                               sampler_.get());
-        scene_->shader_data.SetData(shadow_data_prop_, shadow_datas_);
+        shadow_data_buffer_->Update(shadow_datas_.data(), used_shadow_.size());
     }
 
     cube_shadow_count_ = 0;
     DrawPointShadowMap(command_buffer);
-    if (cube_shadow_count_) {
-    }
+
+    shadow_count_.shadow_count = static_cast<uint32_t>(used_shadow_.size());
+    shadow_count_.cube_shadow_count = cube_shadow_count_;
+    scene_->shader_data.SetData(shadow_count_prop_, shadow_count_);
 }
 
 void ShadowManager::DrawSpotShadowMap(CommandBuffer &command_buffer) {
@@ -117,6 +139,7 @@ void ShadowManager::DrawSpotShadowMap(CommandBuffer &command_buffer) {
             shadow_subpass_->SetViewProjectionMatrix(shadow_datas_[shadow_count].vp[0]);
 
             RecordShadowPassImageMemoryBarrier(command_buffer, *render_target);
+            VOX_GPU_SCOPE(command_buffer, "Spot Shadow", StatIndex::GPU_SHADOW_TIME);
             render_pipeline_->Draw(command_buffer, *render_target);
             command_buffer.EndRenderPass();
             used_shadow_.emplace_back(render_target);
@@ -146,6 +169,10 @@ void ShadowManager::DrawDirectShadowMap(CommandBuffer &command_buffer) {
                 shadow_maps_.emplace_back(std::move(shadow_render_targets));
             }
 
+            // GPU scope names are stored by pointer, no string is built per frame
+            static constexpr const char *kCascadeScopeNames[] = {"Shadow Cascade 0", "Shadow Cascade 1",
+                                                                 "Shadow Cascade 2", "Shadow Cascade 3"};
+            static_assert(std::size(kCascadeScopeNames) == shadow_map_cascade_count_);
             for (int i = 0; i < shadow_map_cascade_count_; i++) {
                 shadow_subpass_->SetViewProjectionMatrix(shadow_datas_[shadow_count].vp[i]);
                 shadow_subpass_->SetViewport(viewport_[i]);
@@ -158,6 +185,7 @@ void ShadowManager::DrawDirectShadowMap(CommandBuffer &command_buffer) {
                 render_pipeline_->SetLoadStore(load_store);
 
                 RecordShadowPassImageMemoryBarrier(command_buffer, *render_target);
+                VOX_GPU_SCOPE(command_buffer, kCascadeScopeNames[i], StatIndex::GPU_SHADOW_TIME);
                 render_pipeline_->Draw(command_buffer, *render_target);
                 command_buffer.EndRenderPass();
             }
@@ -189,6 +217,7 @@ void ShadowManager::DrawPointShadowMap(CommandBuffer &command_buffer) {
             }
 
             for (const auto &i : cube_shadow_datas_[cube_shadow_count_].vp) {
+                VOX_GPU_SCOPE(command_buffer, "Point Shadow Face", StatIndex::GPU_SHADOW_TIME);
                 shadow_subpass_->SetViewProjectionMatrix(i);
                 render_pipeline_->Draw(command_buffer, *render_target);
             }
@@ -9,6 +9,8 @@
 #include "vox.base/singleton.h"
 #include "vox.render/lighting/point_light.h"
 #include "vox.render/rendering/render_pipeline.h"
+#include "vox.render/rendering/storage_buffer_array.h"
+#include "vox.render/shader/shader_property.h"
 #include "vox.render/shadow/shadow_subpass.h"
 
 namespace vox {
@@ -91,6 +93,18 @@ public:
 
     void SetCascadeSplitLambda(float value);
 
+    /**
+     * Extra levels of detail used when rendering shadow casters, on top of the main camera selection.
+     */
+    [[nodiscard]] uint32_t LodBias() const;
+
+    void SetLodBias(uint32_t value);
+
+    /**
+     * Camera the cascades are fitted to.
+     */
+    void SetCamera(Camera *camera);
+
     void Draw(CommandBuffer &command_buffer);
 
 private:
@@ -125,21 +139,32 @@ private:
     ShadowSubpass *shadow_subpass_{nullptr};
 
     float cascade_split_lambda_ = 0.5f;
+    uint32_t lod_bias_ = 1;
 
     VkSamplerCreateInfo sampler_create_info_;
     std::unique_ptr<core::Sampler> sampler_{nullptr};
 
     std::vector<RenderTarget *> used_shadow_;
     std::vector<std::vector<std::unique_ptr<RenderTarget>>> shadow_maps_{};
-    const std::string shadow_map_prop_;
-    const std::string shadow_data_prop_;
-    std::array<ShadowManager::ShadowData, ShadowManager::max_shadow_> shadow_datas_{};
+    const ShaderProperty shadow_map_prop_;
+    const ShaderProperty shadow_data_prop_;
+    std::vector<ShadowManager::ShadowData> shadow_datas_{};
+    std::unique_ptr<StorageBufferArray> shadow_data_buffer_{nullptr};
+
+    // shaders loop over the uniform counts, the variants do not depend on the number of shadows
+    struct ShadowCount {
+        uint32_t shadow_count;
+        uint32_t cube_shadow_count;
+        uint32_t pad[2];
+    };
+    ShadowCount shadow_count_{};
+    const ShaderProperty shadow_count_prop_;
 
     static uint32_t cube_shadow_count_;
     std::vector<std::vector<std::unique_ptr<RenderTarget>>> cube_shadow_maps_{};
     std::shared_ptr<Texture> packed_cube_texture_{nullptr};
-    const std::string cube_shadow_map_prop_;
-    const std::string cube_shadow_data_prop_;
+    const ShaderProperty cube_shadow_map_prop_;
+    const ShaderProperty cube_shadow_data_prop_;
     std::array<ShadowManager::CubeShadowData, ShadowManager::max_cube_shadow_> cube_shadow_datas_{};
 
     const std::array<std::pair<Vector3F, Vector3F>, 6> cube_map_direction_ = {
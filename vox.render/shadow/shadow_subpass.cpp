@@ -70,7 +70,8 @@ void ShadowSubpass::Draw(CommandBuffer &command_buffer) {
     std::vector<RenderElement> alpha_test_queue;
     std::vector<RenderElement> transparent_queue;
     ComponentsManager::GetSingleton().CallRender(BoundingFrustum(vp_), opaque_queue, alpha_test_queue,
-                                                 transparent_queue);
+                                                 transparent_queue, camera_, ShadowManager::GetSingleton().LodBias(),
+                                                 Renderer::LodPass::SHADOW);
     std::sort(opaque_queue.begin(), opaque_queue.end(), CompareFromNearToFar);
     std::sort(alpha_test_queue.begin(), alpha_test_queue.end(), CompareFromNearToFar);
     std::sort(transparent_queue.begin(), transparent_queue.end(), CompareFromFarToNear);
@@ -99,8 +100,7 @@ void ShadowSubpass::DrawElement(CommandBuffer &command_buffer,
             command_buffer.BindPipelineLayout(pipeline_layout);
 
             // uniform & texture
-            DescriptorSetLayout &descriptor_set_layout = pipeline_layout.GetDescriptorSetLayout(0);
-            renderer->shader_data_.BindData(command_buffer, descriptor_set_layout);
+            renderer->shader_data_.BindData(command_buffer, pipeline_layout);
 
             auto &sub_mesh = element.sub_mesh;
             auto &mesh = element.mesh;
@@ -0,0 +1,180 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.render/stats/gpu_profiler.h"
+
+#include <algorithm>
+
+#include "vox.base/logging.h"
+#include "vox.base/tracer.h"
+#include "vox.render/core/command_buffer.h"
+#include "vox.render/core/device.h"
+
+namespace vox {
+GpuProfiler *GpuProfiler::GetSingletonPtr() { return ms_singleton; }
+
+GpuProfiler &GpuProfiler::GetSingleton() {
+    assert(ms_singleton);
+    return (*ms_singleton);
+}
+
+GpuProfiler::GpuProfiler(Device &device, uint32_t frame_count, uint32_t max_scopes)
+    : max_scopes_(max_scopes), slots_(std::max(frame_count, 1u)) {
+    const auto &limits = device.GetGpu().GetProperties().limits;
+    const uint32_t valid_bits = device.GetSuitableGraphicsQueue().GetProperties().timestampValidBits;
+    if (!limits.timestampComputeAndGraphics || valid_bits == 0) {
+        LOGW("Timestamp queries are not supported, GPU timings are disabled")
+        return;
+    }
+
+    timestamp_period_ = limits.timestampPeriod;
+    timestamp_mask_ = valid_bits >= 64 ? ~0ull : (1ull << valid_bits) - 1;
+
+    VkQueryPoolCreateInfo query_pool_info{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+    query_pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    query_pool_info.queryCount = static_cast<uint32_t>(slots_.size()) * max_scopes_ * 2;
+    query_pool_ = std::make_unique<QueryPool>(device, query_pool_info);
+
+    timestamps_.reserve(max_scopes_ * 2);
+    results_.reserve(max_scopes_);
+}
+
+bool GpuProfiler::IsSupported() const { return query_pool_ != nullptr; }
+
+uint32_t GpuProfiler::FirstQuery(uint32_t slot) const { return slot * max_scopes_ * 2; }
+
+void GpuProfiler::BeginFrame(CommandBuffer &command_buffer, uint32_t frame_index) {
+    if (!query_pool_) return;
+
+    active_slot_ = frame_index % static_cast<uint32_t>(slots_.size());
+    auto &slot = slots_[active_slot_];
+    const uint32_t first_query = FirstQuery(active_slot_);
+
+    // the fence of this frame slot has been waited on, its queries are complete
+    if (slot.pending) {
+        Resolve(slot, first_query);
+    }
+
+    slot.scopes.clear();
+    slot.pending = false;
+    slot.cpu_timestamp = utility::Tracer::Timestamp();
+    command_buffer.ResetQueryPool(*query_pool_, first_query, max_scopes_ * 2);
+
+    recording_ = true;
+    scope_stack_.clear();
+    BeginScope(command_buffer, "Frame", StatIndex::GPU_FRAME_TIME);
+}
+
+void GpuProfiler::EndFrame(CommandBuffer &command_buffer) {
+    if (!recording_) return;
+
+    // close scopes left open, the root included
+    while (!scope_stack_.empty()) {
+        EndScope(command_buffer, scope_stack_.back());
+    }
+    slots_[active_slot_].pending = true;
+    recording_ = false;
+}
+
+uint32_t GpuProfiler::BeginScope(CommandBuffer &command_buffer, const char *name, StatIndex stat) {
+    auto &slot = slots_[active_slot_];
+    if (!recording_) {
+        return invalid_scope_;
+    }
+    if (slot.scopes.size() >= max_scopes_) {
+        if (!overflow_reported_) {
+            LOGW("GPU profiler is full with {} scopes, the scope {} and the following ones of the frame are not timed",
+                 max_scopes_, name)
+            overflow_reported_ = true;
+        }
+        return invalid_scope_;
+    }
+
+    const auto index = static_cast<uint32_t>(slot.scopes.size());
+    slot.scopes.push_back({name, stat, scope_stack_.empty() ? invalid_scope_ : scope_stack_.back(),
+                           static_cast<uint32_t>(scope_stack_.size())});
+    command_buffer.WriteTimestamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, *query_pool_,
+                                  FirstQuery(active_slot_) + index * 2);
+    scope_stack_.push_back(index);
+    return index;
+}
+
+void GpuProfiler::EndScope(CommandBuffer &command_buffer, uint32_t scope) {
+    if (!recording_ || scope == invalid_scope_) return;
+
+    assert(!scope_stack_.empty() && scope_stack_.back() == scope && "GPU scopes must be properly nested");
+    command_buffer.WriteTimestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, *query_pool_,
+                                  FirstQuery(active_slot_) + scope * 2 + 1);
+    scope_stack_.pop_back();
+}
+
+void GpuProfiler::Resolve(FrameSlot &slot, uint32_t first_query) {
+    if (slot.scopes.empty()) return;
+
+    const auto query_count = static_cast<uint32_t>(slot.scopes.size() * 2);
+    timestamps_.resize(query_count);
+    // no wait flag: a query which is not available yet keeps the previous results
+    if (query_pool_->GetResults(first_query, query_count, query_count * sizeof(uint64_t), timestamps_.data(),
+                                sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+        return;
+    }
+
+    const double period = static_cast<double>(timestamp_period_) * 1e-9;
+    const uint64_t base = timestamps_[0] & timestamp_mask_;
+    results_.clear();
+    for (size_t i = 0; i < slot.scopes.size(); ++i) {
+        const auto &scope = slot.scopes[i];
+        const uint64_t begin = (timestamps_[i * 2] & timestamp_mask_) - base;
+        const uint64_t end = (timestamps_[i * 2 + 1] & timestamp_mask_) - base;
+        results_.push_back({scope.name, scope.stat, scope.depth, static_cast<double>(begin) * period,
+                            end > begin ? static_cast<double>(end - begin) * period : 0.0});
+    }
+    frame_time_ = static_cast<float>(results_.front().duration);
+
+    // the GPU clock is not calibrated against the CPU one, zones start at the CPU time the frame was recorded
+    if (utility::Tracer::IsCapturing()) {
+        for (const auto &result : results_) {
+            const auto begin = slot.cpu_timestamp + static_cast<uint64_t>(result.begin * 1e9);
+            utility::Tracer::RecordZone(result.name, begin, begin + static_cast<uint64_t>(result.duration * 1e9),
+                                        "GPU");
+        }
+    }
+}
+
+const std::vector<GpuProfiler::ScopeResult> &GpuProfiler::GetResults() const { return results_; }
+
+float GpuProfiler::GetFrameTime() const { return frame_time_; }
+
+float GpuProfiler::GetStatTime(StatIndex stat) const {
+    if (stat == StatIndex::GPU_FRAME_TIME) {
+        return frame_time_;
+    }
+
+    double time = 0.0;
+    for (const auto &result : results_) {
+        if (result.depth == 1 && result.stat == stat) {
+            time += result.duration;
+        }
+    }
+    return static_cast<float>(time);
+}
+
+// MARK: - ScopedGpuTimer
+ScopedGpuTimer::ScopedGpuTimer(CommandBuffer &command_buffer, const char *name, StatIndex stat)
+    : command_buffer_(command_buffer) {
+    auto *profiler = GpuProfiler::GetSingletonPtr();
+    if (profiler && name) {
+        scope_ = profiler->BeginScope(command_buffer, name, stat);
+    }
+}
+
+ScopedGpuTimer::~ScopedGpuTimer() {
+    if (auto *profiler = GpuProfiler::GetSingletonPtr()) {
+        profiler->EndScope(command_buffer_, scope_);
+    }
+}
+
+}  // namespace vox
@@ -0,0 +1,142 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "vox.base/preprocessor.h"
+#include "vox.base/singleton.h"
+#include "vox.render/core/query_pool.h"
+#include "vox.render/stats/stats_common.h"
+
+namespace vox {
+class CommandBuffer;
+
+class Device;
+
+/**
+ * @brief Timestamp queries around the GPU work of a frame.
+ *        Each frame in flight owns a range of a query pool, and its results are read when the same frame slot comes
+ *        back, after its fence was waited on, so reading never stalls. Results are therefore N frames latent.
+ */
+class GpuProfiler : public Singleton<GpuProfiler> {
+public:
+    static GpuProfiler &GetSingleton();
+
+    static GpuProfiler *GetSingletonPtr();
+
+    static constexpr uint32_t invalid_scope_ = ~0u;
+
+    struct ScopeResult {
+        const char *name;
+        StatIndex stat;
+        uint32_t depth;
+        double begin;     // seconds from the start of the frame
+        double duration;  // seconds
+    };
+
+    /**
+     * @param device The device
+     * @param frame_count Number of frames in flight
+     * @param max_scopes Maximum number of scopes recorded per frame
+     */
+    GpuProfiler(Device &device, uint32_t frame_count, uint32_t max_scopes = 128);
+
+    [[nodiscard]] bool IsSupported() const;
+
+    /**
+     * @brief Read back the results of the given frame slot and start recording it again.
+     *        Must be called outside a render pass, before any scope of the frame.
+     */
+    void BeginFrame(CommandBuffer &command_buffer, uint32_t frame_index);
+
+    void EndFrame(CommandBuffer &command_buffer);
+
+    /**
+     * @brief Open a timed scope, nested in the currently open one.
+     * @param name Scope name stored by pointer: a string literal, or a string returned by utility::Tracer::Intern()
+     *             once, not per frame.
+     * @param stat Stat series the scope time is added to, when it is not nested in another scope.
+     * @return The scope handle, invalid_scope_ when the profiler is disabled or full. A full frame is reported once.
+     */
+    uint32_t BeginScope(CommandBuffer &command_buffer, const char *name, StatIndex stat);
+
+    void EndScope(CommandBuffer &command_buffer, uint32_t scope);
+
+    /**
+     * @brief Scopes of the last resolved frame, in recording order.
+     */
+    [[nodiscard]] const std::vector<ScopeResult> &GetResults() const;
+
+    /**
+     * @brief GPU time of the last resolved frame, in seconds.
+     */
+    [[nodiscard]] float GetFrameTime() const;
+
+    /**
+     * @brief Time of the top-level scopes of the given stat in the last resolved frame, in seconds.
+     */
+    [[nodiscard]] float GetStatTime(StatIndex stat) const;
+
+private:
+    struct Scope {
+        const char *name;
+        StatIndex stat;
+        uint32_t parent;
+        uint32_t depth;
+    };
+
+    struct FrameSlot {
+        std::vector<Scope> scopes;
+        uint64_t cpu_timestamp{0};
+        bool pending{false};
+    };
+
+    void Resolve(FrameSlot &slot, uint32_t first_query);
+
+    [[nodiscard]] uint32_t FirstQuery(uint32_t slot) const;
+
+    std::unique_ptr<QueryPool> query_pool_{nullptr};
+    float timestamp_period_{1.0f};
+    uint64_t timestamp_mask_{~0ull};
+    uint32_t max_scopes_;
+
+    std::vector<FrameSlot> slots_;
+    uint32_t active_slot_{0};
+    std::vector<uint32_t> scope_stack_;
+    bool recording_{false};
+    bool overflow_reported_{false};
+
+    std::vector<uint64_t> timestamps_;
+    std::vector<ScopeResult> results_;
+    float frame_time_{0.0f};
+};
+
+/**
+ * @brief A RAII GPU timer scope, no-op when no GpuProfiler exists or the name is null.
+ *        The name follows GpuProfiler::BeginScope.
+ */
+class ScopedGpuTimer final {
+public:
+    ScopedGpuTimer(CommandBuffer &command_buffer, const char *name, StatIndex stat);
+
+    ~ScopedGpuTimer();
+
+private:
+    CommandBuffer &command_buffer_;
+    uint32_t scope_{GpuProfiler::invalid_scope_};
+};
+
+template <>
+inline GpuProfiler *Singleton<GpuProfiler>::ms_singleton{nullptr};
+
+}  // namespace vox
+
+#define VOX_GPU_SCOPE(command_buffer, name, stat) \
+    ::vox::ScopedGpuTimer OPEN3D_CONCAT(__vox_gpu_scope_, __LINE__)(command_buffer, name, stat)
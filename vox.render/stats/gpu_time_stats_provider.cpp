@@ -0,0 +1,41 @@
+//  Copyright (c) 2022 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "vox.render/stats/gpu_time_stats_provider.h"
+
+#include "vox.render/stats/gpu_profiler.h"
+
+namespace vox {
+GpuTimeStatsProvider::GpuTimeStatsProvider(std::set<StatIndex> &requested_stats) {
+    auto *profiler = GpuProfiler::GetSingletonPtr();
+    if (!profiler || !profiler->IsSupported()) {
+        return;
+    }
+
+    for (auto index : {StatIndex::GPU_FRAME_TIME, StatIndex::GPU_RENDER_PASS_TIME,
+                       StatIndex::GPU_POST_PROCESSING_TIME, StatIndex::GPU_SHADOW_TIME, StatIndex::GPU_COMPUTE_TIME}) {
+        if (requested_stats.erase(index)) {
+            stats_.insert(index);
+        }
+    }
+}
+
+bool GpuTimeStatsProvider::IsAvailable(StatIndex index) const { return stats_.count(index) != 0; }
+
+StatsProvider::Counters GpuTimeStatsProvider::Sample(float delta_time) {
+    Counters res;
+    auto *profiler = GpuProfiler::GetSingletonPtr();
+    if (!profiler) {
+        return res;
+    }
+
+    for (auto index : stats_) {
+        res[index].result = profiler->GetStatTime(index);
+    }
+    return res;
+}
+
+}  // namespace vox
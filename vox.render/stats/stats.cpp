@@ -11,6 +11,7 @@
 #include "vox.render/core/device.h"
 #include "vox.render/error.h"
 #include "vox.render/stats/frame_time_stats_provider.h"
+#include "vox.render/stats/gpu_time_stats_provider.h"
 #include "vox.render/stats/hwcpipe_stats_provider.h"
 #include "vox.render/stats/vulkan_stats_provider.h"
 
@@ -45,6 +46,7 @@ void Stats::RequestStats(const std::set<StatIndex> &requested_stats, CounterSamp
     // All supported stats will be removed from the given 'stats' set by the provider's constructor
     // so subsequent providers only see requests for stats that aren't already supported.
     providers_.emplace_back(std::make_unique<FrameTimeStatsProvider>(stats));
+    providers_.emplace_back(std::make_unique<GpuTimeStatsProvider>(stats));
     providers_.emplace_back(std::make_unique<HWCPipeStatsProvider>(stats));
     providers_.emplace_back(std::make_unique<VulkanStatsProvider>(stats, sampling_config_, render_context_));
 
@@ -49,6 +49,12 @@ enum class StatIndex {
     GPU_EXT_READ_BYTES,
     GPU_EXT_WRITE_BYTES,
     GPU_TEX_CYCLES,
+
+    GPU_FRAME_TIME,
+    GPU_RENDER_PASS_TIME,
+    GPU_POST_PROCESSING_TIME,
+    GPU_SHADOW_TIME,
+    GPU_COMPUTE_TIME,
 };
 
 struct StatIndexHash {
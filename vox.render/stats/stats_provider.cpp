@@ -35,6 +35,11 @@ std::map<StatIndex, StatGraphData> StatsProvider::default_graph_map_{
         {StatIndex::GPU_FRAGMENT_JOBS, {"Fragment Jobs", "{:4.0f}/s"}},
         {StatIndex::GPU_FRAGMENT_CYCLES, {"Fragment Cycles", "{:4.1f} M/s", float(1e-6)}},
         {StatIndex::GPU_TEX_CYCLES, {"Shader Texture Cycles", "{:4.0f} k/s", float(1e-3)}},
+        {StatIndex::GPU_FRAME_TIME, {"GPU Frame Time", "{:3.2f} ms", 1000.0f}},
+        {StatIndex::GPU_RENDER_PASS_TIME, {"GPU Render Passes", "{:3.2f} ms", 1000.0f}},
+        {StatIndex::GPU_POST_PROCESSING_TIME, {"GPU Post Processing", "{:3.2f} ms", 1000.0f}},
+        {StatIndex::GPU_SHADOW_TIME, {"GPU Shadows", "{:3.2f} ms", 1000.0f}},
+        {StatIndex::GPU_COMPUTE_TIME, {"GPU Compute", "{:3.2f} ms", 1000.0f}},
         {StatIndex::GPU_EXT_READS, {"External Reads", "{:4.1f} M/s", float(1e-6)}},
         {StatIndex::GPU_EXT_WRITES, {"External Writes", "{:4.1f} M/s", float(1e-6)}},
         {StatIndex::GPU_EXT_READ_STALLS, {"External Read Stalls", "{:4.1f} M/s", float(1e-6)}},
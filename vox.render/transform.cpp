@@ -160,6 +160,15 @@ void Transform::SetLocalMatrix(const Matrix4x4F &value) {
     UpdateAllWorldFlag();
 }
 
+void Transform::SetLocalPose(const Point3F &position, const QuaternionF &rotation, const Vector3F &scale) {
+    position_ = position;
+    rotation_quaternion_ = rotation.normalized();
+    scale_ = scale;
+    SetDirtyFlagTrue(TransformFlag::LOCAL_MATRIX | TransformFlag::LOCAL_EULER);
+    SetDirtyFlagFalse(TransformFlag::LOCAL_QUAT);
+    UpdateAllWorldFlag();
+}
+
 Matrix4x4F Transform::WorldMatrix() {
     if (IsContainDirtyFlag(TransformFlag::WORLD_MATRIX)) {
         const auto kParent = GetParentTransform();
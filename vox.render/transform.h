@@ -126,6 +126,12 @@ public:
 
     void SetLocalMatrix(const Matrix4x4F &value);
 
+    /**
+     * Set local position, rotation and scale at once.
+     * @remarks The world dirty flags are propagated through the children a single time, instead of once per setter.
+     */
+    void SetLocalPose(const Point3F &position, const QuaternionF &rotation, const Vector3F &scale);
+
     /**
      * World matrix.
      * @remarks Need to re-assign after modification to ensure that the modification takes effect.
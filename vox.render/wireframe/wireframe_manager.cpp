@@ -6,13 +6,68 @@
 
 #include "vox.render/wireframe/wireframe_manager.h"
 
+#include "vox.math/constants.h"
 #include "vox.render/entity.h"
 #include "vox.render/material/base_material.h"
 #include "vox.render/mesh/mesh_manager.h"
+#include "vox.render/rendering/render_context.h"
 #include "vox.render/scene.h"
 #include "vox.render/shader/shader_manager.h"
 
 namespace vox {
+namespace {
+// debug geometry is never culled
+constexpr float kUnboundedExtent = 1e18f;
+
+constexpr uint32_t kSphereSegments = 32;
+
+std::vector<WireframeManager::RenderDebugVertex> UnitBox(float min_z) {
+    std::vector<WireframeManager::RenderDebugVertex> vertices;
+    vertices.reserve(24);
+    auto corner = [min_z](int i) {
+        return Vector3F(i & 1 ? 1.f : -1.f, i & 2 ? 1.f : -1.f, i & 4 ? 1.f : min_z);
+    };
+    for (int i = 0; i < 8; i++) {
+        for (int axis = 1; axis < 8; axis <<= 1) {
+            if (!(i & axis)) {
+                vertices.push_back({corner(i), 0});
+                vertices.push_back({corner(i | axis), 0});
+            }
+        }
+    }
+    return vertices;
+}
+
+std::vector<WireframeManager::RenderDebugVertex> UnitSphere() {
+    std::vector<WireframeManager::RenderDebugVertex> vertices;
+    vertices.reserve(3 * kSphereSegments * 2);
+    auto circle = [](uint32_t axis, uint32_t i) {
+        const float kTheta = 2.f * kPiF * static_cast<float>(i) / static_cast<float>(kSphereSegments);
+        Vector3F point;
+        point[axis] = 0;
+        point[(axis + 1) % 3] = std::cos(kTheta);
+        point[(axis + 2) % 3] = std::sin(kTheta);
+        return point;
+    };
+    for (uint32_t axis = 0; axis < 3; axis++) {
+        for (uint32_t i = 0; i < kSphereSegments; i++) {
+            vertices.push_back({circle(axis, i), 0});
+            vertices.push_back({circle(axis, i + 1), 0});
+        }
+    }
+    return vertices;
+}
+
+std::vector<WireframeManager::RenderDebugVertex> UnitArrow() {
+    const Vector3F kTip(0, 0, 1);
+    return {{Vector3F(0, 0, 0), 0}, {kTip, 0},
+            {kTip, 0},              {Vector3F(0.1f, 0, 0.8f), 0},
+            {kTip, 0},              {Vector3F(-0.1f, 0, 0.8f), 0},
+            {kTip, 0},              {Vector3F(0, 0.1f, 0.8f), 0},
+            {kTip, 0},              {Vector3F(0, -0.1f, 0.8f), 0}};
+}
+
+}  // namespace
 
 //-----------------------------------------------------------------------
 WireframeManager *WireframeManager::GetSingletonPtr() { return ms_singleton; }
@@ -22,12 +77,19 @@ WireframeManager &WireframeManager::GetSingleton() {
     return (*ms_singleton);
 }
 
-WireframeManager::WireframeManager(Entity *entity) : entity_(entity) {
-    material_ = std::make_shared<BaseMaterial>(entity->Scene()->Device());
+WireframeManager::WireframeManager(Entity *entity, RenderContext &render_context)
+    : entity_(entity), render_context_(render_context) {
+    auto &device = entity->Scene()->Device();
+    material_ = std::make_shared<BaseMaterial>(device);
     material_->vertex_source_ = ShaderManager::GetSingleton().LoadShader("base/wireframe.vert");
     material_->fragment_source_ = ShaderManager::GetSingleton().LoadShader("base/wireframe.frag");
     material_->input_assembly_state_.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
-    
+
+    instanced_material_ = std::make_shared<BaseMaterial>(device);
+    instanced_material_->vertex_source_ = ShaderManager::GetSingleton().LoadShader("base/wireframe-instanced.vert");
+    instanced_material_->fragment_source_ = ShaderManager::GetSingleton().LoadShader("base/wireframe.frag");
+    instanced_material_->input_assembly_state_.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+
     auto &vertex_input_attributes = vertex_input_state_.attributes;
     vertex_input_attributes.resize(2);
     vertex_input_attributes[0] = initializers::VertexInputAttributeDescription(0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0);
@@ -35,86 +97,163 @@ WireframeManager::WireframeManager(Entity *entity) : entity_(entity) {
 
     auto &vertex_input_bindings = vertex_input_state_.bindings;
     vertex_input_bindings.resize(1);
-    vertex_input_bindings[0] = vox::initializers::VertexInputBindingDescription(0, 4 * 4, VK_VERTEX_INPUT_RATE_VERTEX);
+    vertex_input_bindings[0] = vox::initializers::VertexInputBindingDescription(0, sizeof(RenderDebugVertex),
+                                                                                VK_VERTEX_INPUT_RATE_VERTEX);
+
+    // unit primitive at binding 0, transform columns and color per instance at binding 1
+    instanced_vertex_input_state_ = vertex_input_state_;
+    for (uint32_t column = 0; column < 4; column++) {
+        instanced_vertex_input_state_.attributes.push_back(initializers::VertexInputAttributeDescription(
+                1, 2 + column, VK_FORMAT_R32G32B32A32_SFLOAT, column * 16));
+    }
+    instanced_vertex_input_state_.attributes.push_back(
+            initializers::VertexInputAttributeDescription(1, 6, VK_FORMAT_R32_UINT, 64));
+    instanced_vertex_input_state_.bindings.push_back(vox::initializers::VertexInputBindingDescription(
+            1, sizeof(RenderDebugInstance), VK_VERTEX_INPUT_RATE_INSTANCE));
+
+    line_mesh_ = MeshManager::GetSingleton().LoadBufferMesh();
+    line_mesh_->SetVertexInputState(vertex_input_state_.bindings, vertex_input_state_.attributes);
+    line_mesh_->bounds_ = BoundingBox3F(Point3F(-kUnboundedExtent, -kUnboundedExtent, -kUnboundedExtent),
+                                        Point3F(kUnboundedExtent, kUnboundedExtent, kUnboundedExtent));
+    line_renderer_ = entity_->AddComponent<MeshRenderer>();
+    line_renderer_->SetMaterial(material_);
+    line_renderer_->SetMesh(line_mesh_);
+    line_renderer_->SetEnabled(false);
 
-    lines_.renderer = entity_->AddComponent<MeshRenderer>();
-    lines_.renderer->SetMaterial(material_);
+    CreatePrimitive(BOX, UnitBox(-1.f));
+    CreatePrimitive(SPHERE, UnitSphere());
+    CreatePrimitive(FRUSTUM, UnitBox(0.f));
+    CreatePrimitive(ARROW, UnitArrow());
 }
 
-void WireframeManager::RenderDebugBuffer::Clear() {
-    vertex.clear();
-    indices.clear();
+void WireframeManager::CreatePrimitive(Primitive primitive, const std::vector<RenderDebugVertex> &vertices) {
+    auto &device = entity_->Scene()->Device();
+    auto &buffer = primitives_[primitive];
+    const auto kSize = vertices.size() * sizeof(RenderDebugVertex);
+    buffer.unit_vertices = std::make_unique<core::Buffer>(device, kSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                                          VMA_MEMORY_USAGE_CPU_TO_GPU);
+    buffer.unit_vertices->Update(reinterpret_cast<const uint8_t *>(vertices.data()), kSize);
+
+    buffer.mesh = MeshManager::GetSingleton().LoadBufferMesh();
+    buffer.mesh->SetVertexInputState(instanced_vertex_input_state_.bindings, instanced_vertex_input_state_.attributes);
+    buffer.mesh->SetVertexBufferBinding(0, buffer.unit_vertices.get());
+    buffer.mesh->AddSubMesh(0, static_cast<uint32_t>(vertices.size()));
+    buffer.mesh->bounds_ = line_mesh_->bounds_;
+    buffer.renderer = entity_->AddComponent<MeshRenderer>();
+    buffer.renderer->SetMaterial(instanced_material_);
+    buffer.renderer->SetMesh(buffer.mesh);
+    buffer.renderer->SetEnabled(false);
+}
+
+core::Buffer *WireframeManager::RingBuffer::Write(
+        Device &device, size_t slot, const void *data, size_t size, VkBufferUsageFlags usage) {
+    if (slot >= buffers.size()) {
+        // the swapchain was recreated with more images
+        buffers.resize(slot + 1);
+    }
+    auto &buffer = buffers[slot];
+    if (buffer == nullptr || buffer->GetSize() < size) {
+        // the frame of the slot is done with the old buffer, grow geometrically to settle quickly
+        VkDeviceSize capacity = buffer == nullptr ? 4096 : buffer->GetSize();
+        while (capacity < size) {
+            capacity *= 2;
+        }
+        buffer = std::make_unique<core::Buffer>(device, capacity, usage, VMA_MEMORY_USAGE_CPU_TO_GPU);
+    }
+    buffer->Update(reinterpret_cast<const uint8_t *>(data), size);
+    return buffer.get();
 }
 
 void WireframeManager::Clear() {
-    points_.Clear();
-    lines_.Clear();
-    triangles_.Clear();
+    lines_.clear();
+    for (auto &primitive : primitives_) {
+        primitive.instances.clear();
+    }
 }
 
 void WireframeManager::AddLine(const Vector3F &a, const Vector3F &b, uint32_t color) {
-    lines_.vertex.push_back({a, color});
-    lines_.indices.push_back(static_cast<uint32_t>(lines_.indices.size()));
-    lines_.vertex.push_back({b, color});
-    lines_.indices.push_back(static_cast<uint32_t>(lines_.indices.size()));
+    lines_.push_back({a, color});
+    lines_.push_back({b, color});
 }
 
 void WireframeManager::AddLine(const Matrix4x4F &t, const Vector3F &a, const Vector3F &b, uint32_t color) {
-    lines_.vertex.push_back({t * a, color});
-    lines_.indices.push_back(static_cast<uint32_t>(lines_.indices.size()));
-    lines_.vertex.push_back({t * b, color});
-    lines_.indices.push_back(static_cast<uint32_t>(lines_.indices.size()));
+    lines_.push_back({t * a, color});
+    lines_.push_back({t * b, color});
+}
+
+void WireframeManager::AddBox(const Matrix4x4F &t,
+                              const Vector3F &center,
+                              const Vector3F &half_extents,
+                              uint32_t color) {
+    Matrix4x4F local = Matrix4x4F::makeIdentity();
+    for (uint32_t i = 0; i < 3; i++) {
+        local(i, i) = half_extents[i];
+        local(i, 3) = center[i];
+    }
+    primitives_[BOX].instances.push_back({t * local, color});
+}
+
+void WireframeManager::AddBox(const BoundingBox3F &box, uint32_t color) {
+    const Vector3F kLower(box.lower_corner.x, box.lower_corner.y, box.lower_corner.z);
+    const Vector3F kUpper(box.upper_corner.x, box.upper_corner.y, box.upper_corner.z);
+    AddBox(Matrix4x4F::makeIdentity(), (kLower + kUpper) * 0.5f, (kUpper - kLower) * 0.5f, color);
+}
+
+void WireframeManager::AddSphere(const Vector3F &center, float radius, uint32_t color) {
+    Matrix4x4F transform = Matrix4x4F::makeIdentity();
+    for (uint32_t i = 0; i < 3; i++) {
+        transform(i, i) = radius;
+        transform(i, 3) = center[i];
+    }
+    primitives_[SPHERE].instances.push_back({transform, color});
+}
+
+void WireframeManager::AddFrustum(const Matrix4x4F &view_projection, uint32_t color) {
+    primitives_[FRUSTUM].instances.push_back({view_projection.inverse(), color});
+}
+
+void WireframeManager::AddArrow(const Vector3F &start, const Vector3F &vec, uint32_t color) {
+    const float kLength = vec.length();
+    if (kLength <= 0.f) {
+        return;
+    }
+    const Vector3F kZ = vec / kLength;
+    const Vector3F kUp = std::abs(kZ.y) < 0.99f ? Vector3F(0, 1, 0) : Vector3F(1, 0, 0);
+    const Vector3F kX = kUp.cross(kZ).normalized();
+    const Vector3F kY = kZ.cross(kX);
+
+    Matrix4x4F transform = Matrix4x4F::makeIdentity();
+    for (uint32_t i = 0; i < 3; i++) {
+        transform(i, 0) = kX[i] * kLength;
+        transform(i, 1) = kY[i] * kLength;
+        transform(i, 2) = vec[i];
+        transform(i, 3) = start[i];
+    }
+    primitives_[ARROW].instances.push_back({transform, color});
 }
 
 void WireframeManager::Flush() {
-    if (!lines_.vertex.empty()) {
-        auto mesh = MeshManager::GetSingleton().LoadBufferMesh();
-        mesh->SetVertexInputState(vertex_input_state_.bindings, vertex_input_state_.attributes);
-        mesh->AddSubMesh(0, static_cast<uint32_t>(lines_.indices.size()));
-        lines_.renderer->SetMesh(mesh);
-
-        auto vertex_byte_length = static_cast<uint32_t>(lines_.vertex.size() * sizeof(RenderDebugVertex));
-        auto &device = entity_->Scene()->Device();
-        auto &queue = device.GetQueueByFlags(VK_QUEUE_GRAPHICS_BIT, 0);
-
-        // keep stage buffer alive until submit finish
-        std::vector<core::Buffer> transient_buffers;
-        auto &command_buffer = device.RequestCommandBuffer();
-
-        command_buffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-
-        core::Buffer stage_buffer{device, vertex_byte_length, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                  VMA_MEMORY_USAGE_CPU_ONLY};
-        stage_buffer.Update(lines_.vertex.data(), vertex_byte_length);
-        if (lines_.vertex_buffer == nullptr || lines_.vertex_buffer->GetSize() != vertex_byte_length) {
-            lines_.vertex_buffer = std::make_unique<core::Buffer>(
-                    device, vertex_byte_length, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                    VMA_MEMORY_USAGE_GPU_ONLY);
-        }
-        command_buffer.CopyBuffer(stage_buffer, *lines_.vertex_buffer, vertex_byte_length);
-        mesh->SetVertexBufferBinding(0, lines_.vertex_buffer.get());
-        transient_buffers.push_back(std::move(stage_buffer));
-
-        {
-            auto indices_size = lines_.indices.size() * sizeof(uint32_t);
-            core::Buffer stage_buffer{device, indices_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                      VMA_MEMORY_USAGE_CPU_ONLY};
-            stage_buffer.Update(lines_.indices.data(), indices_size);
-            core::Buffer new_index_buffer{device, indices_size,
-                                          VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-                                          VMA_MEMORY_USAGE_GPU_ONLY};
-            command_buffer.CopyBuffer(stage_buffer, new_index_buffer, indices_size);
-            mesh->SetIndexBufferBinding(
-                    std::make_unique<vox::IndexBufferBinding>(std::move(new_index_buffer), VK_INDEX_TYPE_UINT32));
-            transient_buffers.push_back(std::move(stage_buffer));
+    auto &device = entity_->Scene()->Device();
+    const size_t kSlot = render_context_.GetActiveFrameIndex();
+
+    line_renderer_->SetEnabled(!lines_.empty());
+    if (!lines_.empty()) {
+        auto buffer = line_ring_.Write(device, kSlot, lines_.data(), lines_.size() * sizeof(RenderDebugVertex),
+                                       VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+        line_mesh_->SetVertexBufferBinding(0, buffer);
+        line_mesh_->ClearSubMesh();
+        line_mesh_->AddSubMesh(0, static_cast<uint32_t>(lines_.size()));
+    }
+
+    for (auto &primitive : primitives_) {
+        primitive.renderer->SetEnabled(!primitive.instances.empty());
+        if (!primitive.instances.empty()) {
+            auto buffer = primitive.ring.Write(device, kSlot, primitive.instances.data(),
+                                               primitive.instances.size() * sizeof(RenderDebugInstance),
+                                               VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+            primitive.mesh->SetVertexBufferBinding(1, buffer);
+            primitive.mesh->SetInstanceCount(static_cast<uint32_t>(primitive.instances.size()));
         }
-        command_buffer.End();
-        queue.Submit(command_buffer, device.RequestFence());
-        device.GetFencePool().wait();
-        device.GetFencePool().reset();
-        device.GetCommandPool().ResetPool();
-    } else {
-        lines_.renderer->SetMesh(nullptr);
     }
 
     Clear();
@@ -9,12 +9,21 @@
 #include <vector>
 
 #include "vox.base/singleton.h"
+#include "vox.math/bounding_box3.h"
 #include "vox.math/matrix4x4.h"
 #include "vox.math/vector3.h"
-#include "vox.render/mesh/index_buffer_binding.h"
+#include "vox.render/mesh/buffer_mesh.h"
 #include "vox.render/mesh/mesh_renderer.h"
 
 namespace vox {
+class RenderContext;
+
+/**
+ * Immediate mode debug drawing.
+ * Lines are streamed every frame into persistently mapped buffers, one per frame in flight, so a flush is a memcpy:
+ * meshes and buffers are only created when a buffer has to grow.
+ * Boxes, spheres, frusta and arrows are instances of unit primitives, drawn with a transform and a color each.
+ */
 class WireframeManager : public Singleton<WireframeManager> {
 public:
     /**
@@ -42,24 +51,24 @@ public:
         uint32_t color;
     };
 
-    struct RenderDebugBuffer {
-        std::vector<RenderDebugVertex> vertex{};
-        std::vector<uint32_t> indices{};
-        std::unique_ptr<core::Buffer> vertex_buffer{nullptr};
-        std::unique_ptr<vox::IndexBufferBinding> indices_buffer{nullptr};
-        MeshRenderer *renderer{nullptr};
-
-        void Clear();
+    struct RenderDebugInstance {
+        Matrix4x4F transform;
+        uint32_t color;
     };
 
     static WireframeManager &GetSingleton();
 
     static WireframeManager *GetSingletonPtr();
 
-    explicit WireframeManager(Entity *entity);
+    WireframeManager(Entity *entity, RenderContext &render_context);
 
     void Clear();
 
+    /**
+     * Upload what was added since the last flush, to be drawn by the active frame.
+     * Must be called while the frame is being recorded, the buffers of its index were last read by the frame whose
+     * fence it waited for. Another flush in the same frame rewrites the same buffers.
+     */
     void Flush();
 
 public:
@@ -73,14 +82,62 @@ public:
         AddLine(t, start, start + vec, color);
     }
 
+public:
+    /**
+     * Box of the given half extents, centered on the origin of the transform.
+     */
+    void AddBox(const Matrix4x4F &t, const Vector3F &center, const Vector3F &half_extents, uint32_t color);
+
+    void AddBox(const BoundingBox3F &box, uint32_t color);
+
+    /**
+     * Sphere drawn as its three great circles.
+     */
+    void AddSphere(const Vector3F &center, float radius, uint32_t color);
+
+    /**
+     * Frustum of a view projection matrix, the corners are the unprojected clip space cube.
+     */
+    void AddFrustum(const Matrix4x4F &view_projection, uint32_t color);
+
+    void AddArrow(const Vector3F &start, const Vector3F &vec, uint32_t color);
+
 private:
+    enum Primitive { BOX = 0, SPHERE, FRUSTUM, ARROW, PRIMITIVE_COUNT };
+
+    /**
+     * Persistently mapped buffers of a stream, one per render frame, rewritten when the frame comes back.
+     */
+    struct RingBuffer {
+        std::vector<std::unique_ptr<core::Buffer>> buffers{};
+
+        core::Buffer *Write(Device &device, size_t slot, const void *data, size_t size, VkBufferUsageFlags usage);
+    };
+
+    struct PrimitiveBuffer {
+        std::unique_ptr<core::Buffer> unit_vertices{nullptr};
+        std::vector<RenderDebugInstance> instances{};
+        RingBuffer ring{};
+        std::shared_ptr<BufferMesh> mesh{nullptr};
+        MeshRenderer *renderer{nullptr};
+    };
+
+    void CreatePrimitive(Primitive primitive, const std::vector<RenderDebugVertex> &vertices);
+
     Entity *entity_{nullptr};
+    RenderContext &render_context_;
 
     MaterialPtr material_{nullptr};
-    RenderDebugBuffer points_{};
-    RenderDebugBuffer lines_{};
-    RenderDebugBuffer triangles_{};
+    MaterialPtr instanced_material_{nullptr};
     VertexInputState vertex_input_state_;
+    VertexInputState instanced_vertex_input_state_;
+
+    std::vector<RenderDebugVertex> lines_{};
+    RingBuffer line_ring_{};
+    std::shared_ptr<BufferMesh> line_mesh_{nullptr};
+    MeshRenderer *line_renderer_{nullptr};
+
+    PrimitiveBuffer primitives_[PRIMITIVE_COUNT];
 };
 template <>
 inline WireframeManager *Singleton<WireframeManager>::ms_singleton = nullptr;